@@ -49,6 +49,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 
 namespace cv
 {
@@ -189,7 +190,13 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
         if (len < INT_MAX)  // FIXIT similar code below doesn't have that check
         {
             sz.width = (int)len;
-            func(src1.ptr(), src1.step, src2.ptr(), src2.step, dst.ptr(), dst.step, sz.width, sz.height, 0);
+            size_t esz1 = bitwise ? 1 : CV_ELEM_SIZE1(type1);
+            parallelFor2D(sz, getElemwiseParts(dst.total()*dst.elemSize()), [&](const Range& rowRange, const Range& colRange)
+            {
+                size_t ofs = colRange.start*esz1;
+                func(src1.ptr(rowRange.start) + ofs, src1.step, src2.ptr(rowRange.start) + ofs, src2.step,
+                     dst.ptr(rowRange.start) + ofs, dst.step, colRange.size(), rowRange.size(), 0);
+            });
             return;
         }
     }
@@ -232,9 +239,6 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
         reallocate = !_dst.sameSize(*psrc1) || _dst.type() != type1;
     }
 
-    AutoBuffer<uchar> _buf;
-    uchar *scbuf = 0, *maskbuf = 0;
-
     _dst.createSameSize(*psrc1, type1);
     // if this is mask operation and dst has been reallocated,
     // we have to clear the destination
@@ -257,26 +261,27 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
         func = tab[depth1];
     CV_Assert(func);
 
+    const int nparts = getElemwiseParts(dst.total()*esz);
     if( !haveScalar )
     {
         const Mat* arrays[] = { &src1, &src2, &dst, &mask, 0 };
-        uchar* ptrs[4] = {};
 
-        NAryMatIterator it(arrays, ptrs);
-        size_t total = it.size, blocksize = total;
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t total)
+        {
+            size_t blocksize = total;
+            AutoBuffer<uchar> _buf;
+            uchar* maskbuf = 0;
 
-        if( blocksize*cn > INT_MAX )
-            blocksize = INT_MAX/cn;
+            if( blocksize*cn > INT_MAX )
+                blocksize = INT_MAX/cn;
 
-        if( haveMask )
-        {
-            blocksize = std::min(blocksize, blocksize0);
-            _buf.allocate(blocksize*esz);
-            maskbuf = _buf.data();
-        }
+            if( haveMask )
+            {
+                blocksize = std::min(blocksize, blocksize0);
+                _buf.allocate(blocksize*esz);
+                maskbuf = _buf.data();
+            }
 
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-        {
             for( size_t j = 0; j < total; j += blocksize )
             {
                 int bsz = (int)MIN(total - j, blocksize);
@@ -291,24 +296,22 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
                 bsz *= (int)esz;
                 ptrs[0] += bsz; ptrs[1] += bsz; ptrs[2] += bsz;
             }
-        }
+        });
     }
     else
     {
         const Mat* arrays[] = { &src1, &dst, &mask, 0 };
-        uchar* ptrs[3] = {};
 
-        NAryMatIterator it(arrays, ptrs);
-        size_t total = it.size, blocksize = std::min(total, blocksize0);
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t total)
+        {
+            size_t blocksize = std::min(total, blocksize0);
 
-        _buf.allocate(blocksize*(haveMask ? 2 : 1)*esz + 32);
-        scbuf = _buf.data();
-        maskbuf = alignPtr(scbuf + blocksize*esz, 16);
+            AutoBuffer<uchar> _buf(blocksize*(haveMask ? 2 : 1)*esz + 32);
+            uchar* scbuf = _buf.data();
+            uchar* maskbuf = alignPtr(scbuf + blocksize*esz, 16);
 
-        convertAndUnrollScalar( src2, src1.type(), scbuf, blocksize);
+            convertAndUnrollScalar( src2, src1.type(), scbuf, blocksize);
 
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-        {
             for( size_t j = 0; j < total; j += blocksize )
             {
                 int bsz = (int)MIN(total - j, blocksize);
@@ -323,7 +326,7 @@ static void binary_op( InputArray _src1, InputArray _src2, OutputArray _dst,
                 bsz *= (int)esz;
                 ptrs[0] += bsz; ptrs[1] += bsz;
             }
-        }
+        });
     }
 }
 
@@ -622,13 +625,18 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
         Mat src1 = psrc1->getMat(), src2 = psrc2->getMat(), dst = _dst.getMat();
         Size sz = getContinuousSize2D(src1, src2, dst, src1.channels());
-        if (!extendedFunc || extendedFunc(src1.ptr(), src1.step, src2.ptr(), src2.step,
-                                          dst.ptr(), dst.step, sz.width, sz.height, usrdata) != 0)
+        BinaryFuncC func = tab[depth1];
+        CV_Assert(func);
+        size_t esz1 = CV_ELEM_SIZE1(type1);
+        parallelFor2D(sz, getElemwiseParts(dst.total()*dst.elemSize()), [&](const Range& rowRange, const Range& colRange)
         {
-            BinaryFuncC func = tab[depth1];
-            CV_Assert(func);
-            func(src1.ptr(), src1.step, src2.ptr(), src2.step, dst.ptr(), dst.step, sz.width, sz.height, usrdata);
-        }
+            size_t ofs = colRange.start*esz1;
+            const uchar *sptr1 = src1.ptr(rowRange.start) + ofs, *sptr2 = src2.ptr(rowRange.start) + ofs;
+            uchar* dptr = dst.ptr(rowRange.start) + ofs;
+            if (!extendedFunc || extendedFunc(sptr1, src1.step, sptr2, src2.step,
+                                              dptr, dst.step, colRange.size(), rowRange.size(), usrdata) != 0)
+                func(sptr1, src1.step, sptr2, src2.step, dptr, dst.step, colRange.size(), rowRange.size(), usrdata);
+        });
         return;
     }
 
@@ -736,8 +744,6 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
     BinaryFunc copymask = getCopyMaskFunc(dsz);
     Mat src1 = psrc1->getMat(), src2 = psrc2->getMat(), dst = _dst.getMat(), mask = _mask.getMat();
 
-    AutoBuffer<uchar> _buf;
-    uchar *buf, *maskbuf = 0, *buf1 = 0, *buf2 = 0, *wbuf = 0;
     size_t bufesz = (cvtsrc1 ? wsz : 0) +
                     (cvtsrc2 || haveScalar ? wsz : 0) +
                     (cvtdst ? wsz : 0) +
@@ -745,39 +751,38 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
     BinaryFuncC func = tab[CV_MAT_DEPTH(wtype)];
     CV_Assert(func);
 
+    const int nparts = getElemwiseParts(dst.total()*std::max(dsz, esz1));
     if( !haveScalar )
     {
         const Mat* arrays[] = { &src1, &src2, &dst, &mask, 0 };
-        uchar* ptrs[4] = {};
 
-        NAryMatIterator it(arrays, ptrs);
-        size_t total = it.size, blocksize = total;
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t total)
+        {
+            size_t blocksize = total;
 
-        if( haveMask || cvtsrc1 || cvtsrc2 || cvtdst )
-            blocksize = std::min(blocksize, blocksize0);
+            if( haveMask || cvtsrc1 || cvtsrc2 || cvtdst )
+                blocksize = std::min(blocksize, blocksize0);
 
-        _buf.allocate(bufesz*blocksize + 64);
-        buf = _buf.data();
-        if( cvtsrc1 )
-        {
-            buf1 = buf, buf = alignPtr(buf + blocksize*wsz, 16);
-        }
-        if( cvtsrc2 )
-        {
-            buf2 = buf, buf = alignPtr(buf + blocksize*wsz, 16);
-        }
-        wbuf = maskbuf = buf;
-        if( cvtdst )
-        {
-            buf = alignPtr(buf + blocksize*wsz, 16);
-        }
-        if( haveMask )
-        {
-            maskbuf = buf;
-        }
+            AutoBuffer<uchar> _buf(bufesz*blocksize + 64);
+            uchar *buf = _buf.data(), *maskbuf = 0, *buf1 = 0, *buf2 = 0, *wbuf = 0;
+            if( cvtsrc1 )
+            {
+                buf1 = buf, buf = alignPtr(buf + blocksize*wsz, 16);
+            }
+            if( cvtsrc2 )
+            {
+                buf2 = buf, buf = alignPtr(buf + blocksize*wsz, 16);
+            }
+            wbuf = maskbuf = buf;
+            if( cvtdst )
+            {
+                buf = alignPtr(buf + blocksize*wsz, 16);
+            }
+            if( haveMask )
+            {
+                maskbuf = buf;
+            }
 
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-        {
             for( size_t j = 0; j < total; j += blocksize )
             {
                 int bsz = (int)MIN(total - j, blocksize);
@@ -824,37 +829,35 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
                 ptrs[0] += bsz*esz1; ptrs[1] += bsz*esz2; ptrs[2] += bsz*dsz;
             }
-        }
+        });
     }
     else
     {
         const Mat* arrays[] = { &src1, &dst, &mask, 0 };
-        uchar* ptrs[3] = {};
-
-        NAryMatIterator it(arrays, ptrs);
-        size_t total = it.size, blocksize = std::min(total, blocksize0);
 
-        _buf.allocate(bufesz*blocksize + 64);
-        buf = _buf.data();
-        if( cvtsrc1 )
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t total)
         {
-            buf1 = buf, buf = alignPtr(buf + blocksize * wsz, 16);
-        }
-        buf2 = buf; buf = alignPtr(buf + blocksize*wsz, 16);
-        wbuf = maskbuf = buf;
-        if( cvtdst )
-        {
-            buf = alignPtr(buf + blocksize * wsz, 16);
-        }
-        if( haveMask )
-        {
-            maskbuf = buf;
-        }
+            size_t blocksize = std::min(total, blocksize0);
 
-        convertAndUnrollScalar( src2, wtype, buf2, blocksize);
+            AutoBuffer<uchar> _buf(bufesz*blocksize + 64);
+            uchar *buf = _buf.data(), *maskbuf = 0, *buf1 = 0, *buf2 = 0, *wbuf = 0;
+            if( cvtsrc1 )
+            {
+                buf1 = buf, buf = alignPtr(buf + blocksize * wsz, 16);
+            }
+            buf2 = buf; buf = alignPtr(buf + blocksize*wsz, 16);
+            wbuf = maskbuf = buf;
+            if( cvtdst )
+            {
+                buf = alignPtr(buf + blocksize * wsz, 16);
+            }
+            if( haveMask )
+            {
+                maskbuf = buf;
+            }
+
+            convertAndUnrollScalar( src2, wtype, buf2, blocksize);
 
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-        {
             for( size_t j = 0; j < total; j += blocksize )
             {
                 int bsz = (int)MIN(total - j, blocksize);
@@ -902,7 +905,7 @@ static void arithm_op(InputArray _src1, InputArray _src2, OutputArray _dst,
 
                 ptrs[0] += bsz*esz1; ptrs[1] += bsz*dsz;
             }
-        }
+        });
     }
 }
 
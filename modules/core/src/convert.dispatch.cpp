@@ -4,6 +4,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 
 #include "convert.simd.hpp"
 #include "convert.simd_declarations.hpp" // defines CV_CPU_DISPATCH_MODES_ALL=AVX2,...,BASELINE based on CMakeLists.txt content
@@ -285,20 +286,24 @@ void Mat::convertTo(OutputArray dst, int type_, double alpha, double beta) const
     double scale[] = {alpha, beta};
     CV_Assert( func != 0 );
 
+    const int nparts = getElemwiseParts(src.total()*std::max(src.elemSize(), dstMat.elemSize()));
     if( dims <= 2 )
     {
         Size sz = getContinuousSize2D(src, dstMat, cn);
-        func(src.data, src.step, 0, 0, dstMat.data, dstMat.step, sz, scale);
+        const size_t sesz = CV_ELEM_SIZE1(sdepth), desz = CV_ELEM_SIZE1(ddepth);
+        parallelFor2D(sz, nparts, [&](const Range& rowRange, const Range& colRange)
+        {
+            func(src.ptr(rowRange.start) + colRange.start*sesz, src.step, 0, 0,
+                 dstMat.ptr(rowRange.start) + colRange.start*desz, dstMat.step, Size(colRange.size(), rowRange.size()), scale);
+        });
     }
     else
     {
         const Mat* arrays[] = {&src, &dstMat, 0};
-        uchar* ptrs[2] = {};
-        NAryMatIterator it(arrays, ptrs);
-        Size sz((int)(it.size*cn), 1);
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            func(ptrs[0], 1, 0, 0, ptrs[1], 1, sz, scale);
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t len)
+        {
+            func(ptrs[0], 1, 0, 0, ptrs[1], 1, Size((int)(len*cn), 1), scale);
+        });
     }
 }
 
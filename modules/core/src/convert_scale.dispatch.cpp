@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 
 #include "convert_scale.simd.hpp"
 #include "convert_scale.simd_declarations.hpp" // defines CV_CPU_DISPATCH_MODES_ALL=AVX2,...,BASELINE based on CMakeLists.txt content
@@ -99,20 +100,24 @@ void convertScaleAbs(InputArray _src, OutputArray _dst, double alpha, double bet
     BinaryFunc func = getCvtScaleAbsFunc(src.depth());
     CV_Assert( func != 0 );
 
+    const int nparts = getElemwiseParts(src.total()*src.elemSize());
     if( src.dims <= 2 )
     {
         Size sz = getContinuousSize2D(src, dst, cn);
-        func( src.ptr(), src.step, 0, 0, dst.ptr(), dst.step, sz, scale );
+        const size_t esz1 = src.elemSize1();
+        parallelFor2D(sz, nparts, [&](const Range& rowRange, const Range& colRange)
+        {
+            func( src.ptr(rowRange.start) + colRange.start*esz1, src.step, 0, 0,
+                  dst.ptr(rowRange.start) + colRange.start, dst.step, Size(colRange.size(), rowRange.size()), scale );
+        });
     }
     else
     {
         const Mat* arrays[] = {&src, &dst, 0};
-        uchar* ptrs[2] = {};
-        NAryMatIterator it(arrays, ptrs);
-        Size sz((int)it.size*cn, 1);
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
-            func( ptrs[0], 0, 0, 0, ptrs[1], 0, sz, scale );
+        parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t len)
+        {
+            func( ptrs[0], 0, 0, 0, ptrs[1], 0, Size((int)len*cn, 1), scale );
+        });
     }
 }
 
@@ -48,6 +48,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 
 
 namespace cv
@@ -463,21 +464,24 @@ void Mat::copyTo( OutputArray _dst, InputArray _mask ) const
     size_t esz = colorMask ? elemSize1() : elemSize();
     BinaryFunc copymask = getCopyMaskFunc(esz);
 
+    const int nparts = getElemwiseParts(total()*elemSize());
     if( dims <= 2 )
     {
         Mat src = *this;
         Size sz = getContinuousSize2D(src, dst, mask, mcn);
-        copymask(src.data, src.step, mask.data, mask.step, dst.data, dst.step, sz, &esz);
+        parallelFor2D(sz, nparts, [&](const Range& rowRange, const Range& colRange)
+        {
+            copymask(src.ptr(rowRange.start) + colRange.start*esz, src.step, mask.ptr(rowRange.start) + colRange.start, mask.step,
+                     dst.ptr(rowRange.start) + colRange.start*esz, dst.step, Size(colRange.size(), rowRange.size()), &esz);
+        });
         return;
     }
 
     const Mat* arrays[] = { this, &dst, &mask, 0 };
-    uchar* ptrs[3] = {};
-    NAryMatIterator it(arrays, ptrs);
-    Size sz((int)(it.size*mcn), 1);
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        copymask(ptrs[0], 0, ptrs[2], 0, ptrs[1], 0, sz, &esz);
+    parallelForPlanes(arrays, nparts, [&](int, uchar** ptrs, size_t, size_t len)
+    {
+        copymask(ptrs[0], 0, ptrs[2], 0, ptrs[1], 0, Size((int)(len*mcn), 1), &esz);
+    });
 }
 
 
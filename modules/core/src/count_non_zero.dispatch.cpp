@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 #include "stat.hpp"
 
 #include "count_non_zero.simd.hpp"
@@ -140,13 +141,16 @@ int countNonZero(InputArray _src)
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1] = {};
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, nz = 0;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        nz += func( ptrs[0], total );
+    const int nparts = getReductionParts(src.total()*src.elemSize());
+    std::vector<int> partNz(nparts, 0);
+    parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t, size_t len)
+    {
+        partNz[part] += func( ptrs[0], (int)len );
+    });
 
+    int nz = 0;
+    for( int p = 0; p < nparts; p++ )
+        nz += partNz[p];
     return nz;
 }
 
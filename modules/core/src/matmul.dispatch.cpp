@@ -898,9 +898,12 @@ void mulTransposed(InputArray _src, OutputArray _dst, bool ata,
     _dst.create( dsize, dsize, dtype );
     Mat dst = _dst.getMat();
 
+    const int fast_gemm_level = 16; // packed single precision GEMM is faster starting from these sizes
     if( src.data == dst.data || (stype == dtype &&
         (dst.cols >= gemm_level && dst.rows >= gemm_level &&
-         src.cols >= gemm_level && src.rows >= gemm_level)))
+         src.cols >= gemm_level && src.rows >= gemm_level)) ||
+        (stype == CV_32F && dtype == CV_32F && dst.rows >= fast_gemm_level &&
+         src.cols >= fast_gemm_level && src.rows >= fast_gemm_level) )
     {
         Mat src2;
         const Mat* tsrc = &src;
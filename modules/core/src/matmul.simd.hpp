@@ -728,6 +728,181 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/****************************************************************************************\
+*                             Packed GEMM (single precision)                             *
+\****************************************************************************************/
+
+#if CV_SIMD
+// D is split into tiles computed in parallel. For every KC elements of the dot products a tile
+// packs its part of A (scaled by alpha) into panels of GEMM_MR rows and its part of B into panels
+// of GEMM_NR columns, then the register-blocked micro-kernel accumulates GEMM_MR x GEMM_NR blocks.
+enum
+{
+    GEMM_VLANES = VTraits<v_float32>::max_nlanes,
+    GEMM_MR = 6,
+    GEMM_NR = GEMM_VLANES * 2,
+    GEMM_MC = GEMM_MR * 16,
+    GEMM_NC = 256,
+    GEMM_KC = 256
+};
+
+static bool useFastGemm32f( Size d_size, int len )
+{
+    return len >= 8 && d_size.width >= 4 && (double)d_size.width * d_size.height * len >= 8192;
+}
+
+static void gemmPackA32f( const float* a, size_t step0, size_t step1, int m, int k, float alpha, float* packed )
+{
+    for( int i = 0; i < m; i += GEMM_MR, a += step0 * GEMM_MR )
+    {
+        const int mr = std::min(m - i, (int)GEMM_MR);
+        for( int p = 0; p < k; p++, packed += GEMM_MR )
+        {
+            const float* ap = a + p * step1;
+            int r = 0;
+            for( ; r < mr; r++ )
+                packed[r] = ap[r * step0] * alpha;
+            for( ; r < GEMM_MR; r++ )
+                packed[r] = 0.f;
+        }
+    }
+}
+
+static void gemmPackB32f( const float* b, size_t step0, size_t step1, int k, int n, float* packed )
+{
+    for( int j = 0; j < n; j += GEMM_NR, b += step1 * GEMM_NR )
+    {
+        const int nr = std::min(n - j, (int)GEMM_NR);
+        for( int p = 0; p < k; p++, packed += GEMM_NR )
+        {
+            const float* bp = b + p * step0;
+            int c = 0;
+            if( step1 == 1 )
+            {
+                for( ; c < nr; c++ )
+                    packed[c] = bp[c];
+            }
+            else
+            {
+                for( ; c < nr; c++ )
+                    packed[c] = bp[c * step1];
+            }
+            for( ; c < GEMM_NR; c++ )
+                packed[c] = 0.f;
+        }
+    }
+}
+
+// d[0:m, 0:n] += a * b, a and b are panels of k packed columns and rows
+static void gemmMicroKernel32f( int k, const float* a, const float* b, float* d, size_t ldd, int m, int n )
+{
+    v_float32 s00 = vx_setzero_f32(), s01 = vx_setzero_f32(), s10 = vx_setzero_f32(), s11 = vx_setzero_f32();
+    v_float32 s20 = vx_setzero_f32(), s21 = vx_setzero_f32(), s30 = vx_setzero_f32(), s31 = vx_setzero_f32();
+    v_float32 s40 = vx_setzero_f32(), s41 = vx_setzero_f32(), s50 = vx_setzero_f32(), s51 = vx_setzero_f32();
+
+    for( int p = 0; p < k; p++, a += GEMM_MR, b += GEMM_NR )
+    {
+        v_float32 b0 = vx_load(b), b1 = vx_load(b + GEMM_VLANES), ai;
+        ai = vx_setall_f32(a[0]); s00 = v_fma(ai, b0, s00); s01 = v_fma(ai, b1, s01);
+        ai = vx_setall_f32(a[1]); s10 = v_fma(ai, b0, s10); s11 = v_fma(ai, b1, s11);
+        ai = vx_setall_f32(a[2]); s20 = v_fma(ai, b0, s20); s21 = v_fma(ai, b1, s21);
+        ai = vx_setall_f32(a[3]); s30 = v_fma(ai, b0, s30); s31 = v_fma(ai, b1, s31);
+        ai = vx_setall_f32(a[4]); s40 = v_fma(ai, b0, s40); s41 = v_fma(ai, b1, s41);
+        ai = vx_setall_f32(a[5]); s50 = v_fma(ai, b0, s50); s51 = v_fma(ai, b1, s51);
+    }
+
+    if( m == GEMM_MR && n == GEMM_NR )
+    {
+        float* d0 = d;
+        v_store(d0, v_add(vx_load(d0), s00)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s01)); d0 += ldd;
+        v_store(d0, v_add(vx_load(d0), s10)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s11)); d0 += ldd;
+        v_store(d0, v_add(vx_load(d0), s20)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s21)); d0 += ldd;
+        v_store(d0, v_add(vx_load(d0), s30)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s31)); d0 += ldd;
+        v_store(d0, v_add(vx_load(d0), s40)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s41)); d0 += ldd;
+        v_store(d0, v_add(vx_load(d0), s50)); v_store(d0 + GEMM_VLANES, v_add(vx_load(d0 + GEMM_VLANES), s51));
+        return;
+    }
+
+    float buf[GEMM_MR * GEMM_NR];
+    v_store(buf, s00); v_store(buf + GEMM_VLANES, s01);
+    v_store(buf + GEMM_NR, s10); v_store(buf + GEMM_NR + GEMM_VLANES, s11);
+    v_store(buf + GEMM_NR * 2, s20); v_store(buf + GEMM_NR * 2 + GEMM_VLANES, s21);
+    v_store(buf + GEMM_NR * 3, s30); v_store(buf + GEMM_NR * 3 + GEMM_VLANES, s31);
+    v_store(buf + GEMM_NR * 4, s40); v_store(buf + GEMM_NR * 4 + GEMM_VLANES, s41);
+    v_store(buf + GEMM_NR * 5, s50); v_store(buf + GEMM_NR * 5 + GEMM_VLANES, s51);
+    for( int i = 0; i < m; i++, d += ldd )
+        for( int j = 0; j < n; j++ )
+            d[j] += buf[i * GEMM_NR + j];
+}
+
+static void fastGemm32f( const Mat& A, const Mat& B, const Mat& C, float alpha, float beta,
+                         Mat& D, int len, int flags )
+{
+    CV_INSTRUMENT_REGION();
+
+    const int M = D.rows, N = D.cols, K = len;
+    const size_t astep = A.step / sizeof(float), bstep = B.step / sizeof(float);
+    const size_t cstep = C.empty() ? 0 : C.step / sizeof(float), ldd = D.step / sizeof(float);
+    const size_t a_step0 = flags & GEMM_1_T ? 1 : astep, a_step1 = flags & GEMM_1_T ? astep : 1;
+    const size_t b_step0 = flags & GEMM_2_T ? 1 : bstep, b_step1 = flags & GEMM_2_T ? bstep : 1;
+    const bool haveC = !C.empty() && beta != 0.f, transC = (flags & GEMM_3_T) != 0;
+
+    const int MC = std::min((int)GEMM_MC, divUp(M, GEMM_MR) * GEMM_MR);
+    const int NC = std::min((int)GEMM_NC, divUp(N, GEMM_NR) * GEMM_NR);
+    const int KC = std::min((int)GEMM_KC, K);
+    const int m_tiles = divUp(M, MC), n_tiles = divUp(N, NC);
+
+    auto fn = [&](const Range& r)
+    {
+        AutoBuffer<float> _buf((size_t)KC * (MC + NC) + CV_SIMD_WIDTH / sizeof(float));
+        float* packedA = alignPtr(_buf.data(), CV_SIMD_WIDTH);
+        float* packedB = packedA + (size_t)KC * MC;
+        for( int tile = r.start; tile < r.end; tile++ )
+        {
+            const int i0 = (tile / n_tiles) * MC, j0 = (tile % n_tiles) * NC;
+            const int mc = std::min(M - i0, MC), nc = std::min(N - j0, NC);
+            float* d = D.ptr<float>(i0) + j0;
+
+            for( int i = 0; i < mc; i++ )
+            {
+                float* di = d + i * ldd;
+                if( !haveC )
+                    memset(di, 0, nc * sizeof(float));
+                else if( !transC )
+                {
+                    const float* ci = C.ptr<float>(i0 + i) + j0;
+                    for( int j = 0; j < nc; j++ )
+                        di[j] = ci[j] * beta;
+                }
+                else
+                {
+                    const float* ci = C.ptr<float>(j0) + i0 + i;
+                    for( int j = 0; j < nc; j++ )
+                        di[j] = ci[j * cstep] * beta;
+                }
+            }
+
+            for( int k0 = 0; k0 < K; k0 += KC )
+            {
+                const int kc = std::min(K - k0, KC);
+                gemmPackA32f(A.ptr<float>() + i0 * a_step0 + k0 * a_step1, a_step0, a_step1, mc, kc, alpha, packedA);
+                gemmPackB32f(B.ptr<float>() + k0 * b_step0 + j0 * b_step1, b_step0, b_step1, kc, nc, packedB);
+                for( int i = 0; i < mc; i += GEMM_MR )
+                    for( int j = 0; j < nc; j += GEMM_NR )
+                        gemmMicroKernel32f(kc, packedA + (size_t)i * kc, packedB + (size_t)j * kc, d + i * ldd + j, ldd,
+                                           std::min(mc - i, (int)GEMM_MR), std::min(nc - j, (int)GEMM_NR));
+            }
+        }
+    };
+
+    const int ntiles = m_tiles * n_tiles;
+    if( ntiles > 1 && (double)M * N * K >= (1 << 21) )
+        parallel_for_(Range(0, ntiles), fn);
+    else
+        fn(Range(0, ntiles));
+}
+#endif // CV_SIMD
+
 static void gemmImpl( Mat A, Mat B, double alpha,
            Mat C, double beta, Mat D, int flags )
 {
@@ -1020,6 +1195,15 @@ static void gemmImpl( Mat A, Mat B, double alpha,
         }
     }
 
+#if CV_SIMD
+    if( type == CV_32FC1 && useFastGemm32f(d_size, len) &&
+        D.data != A.data && D.data != B.data && (!(flags & GEMM_3_T) || C.data != D.data) )
+    {
+        fastGemm32f(A, B, C, (float)alpha, (float)beta, D, len, flags);
+        return;
+    }
+#endif
+
     {
     size_t b_step = B.step;
     GEMMSingleMulFunc singleMulFunc;
@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 #include "opencv2/core/openvx/ovx_defs.hpp"
 #include "stat.hpp"
 
@@ -139,48 +140,59 @@ Scalar mean(InputArray _src, InputArray _mask)
     CV_Assert( cn <= 4 && func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2] = {};
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    bool blockSum = depth <= CV_16S;
-    size_t esz = 0, nz0 = 0;
+    const bool blockSum = depth <= CV_16S;
+    const int intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
+    const size_t esz = src.elemSize();
 
-    if( blockSum )
+    // Partial sums of the parts are added in the same order for any number of threads
+    struct PartSum
     {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf.data();
-
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
+        Scalar s;
+        int buf[4];
+        int count;
+        size_t nz;
+    };
+    const int nparts = getReductionParts(src.total()*esz);
+    std::vector<PartSum> parts(nparts);
+    for( int p = 0; p < nparts; p++ )
+    {
+        std::fill(parts[p].buf, parts[p].buf + 4, 0);
+        parts[p].count = 0;
+        parts[p].nz = 0;
     }
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t, size_t len)
     {
-        for( j = 0; j < total; j += blockSize )
+        PartSum& ps = parts[part];
+        int total = (int)len, blockSize = blockSum ? std::min(total, intSumBlockSize) : total;
+        uchar* buf = blockSum ? (uchar*)ps.buf : (uchar*)&ps.s[0];
+        for( int j = 0; j < total; j += blockSize )
         {
             int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)buf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            if( blockSum && ps.count + bsz > intSumBlockSize )
             {
-                for( k = 0; k < cn; k++ )
+                for( int c = 0; c < cn; c++ )
                 {
-                    s[k] += buf[k];
-                    buf[k] = 0;
+                    ps.s[c] += ps.buf[c];
+                    ps.buf[c] = 0;
                 }
-                count = 0;
+                ps.count = 0;
             }
+            int nz = func( ptrs[0], ptrs[1], buf, bsz, cn );
+            ps.count += nz;
+            ps.nz += nz;
             ptrs[0] += bsz*esz;
             if( ptrs[1] )
                 ptrs[1] += bsz;
         }
+    });
+
+    size_t nz0 = 0;
+    for( int p = 0; p < nparts; p++ )
+    {
+        for( k = 0; k < cn; k++ )
+            s[k] += parts[p].s[k] + parts[p].buf[k];
+        nz0 += parts[p].nz;
     }
     return s*(nz0 ? 1./nz0 : 0);
 }
@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 #include "opencv2/core/openvx/ovx_defs.hpp"
 #include "stat.hpp"
 #include "opencv2/core/detail/dispatch_helper.impl.hpp"
@@ -1545,24 +1546,54 @@ void cv::minMaxIdx(InputArray _src, double* minVal,
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2] = {};
-    NAryMatIterator it(arrays, ptrs);
+
+    // Parts are combined in order, so the first of equal extremums is found for any number of threads
+    struct PartMinMax
+    {
+        size_t minidx, maxidx;
+        int iminval, imaxval;
+        float fminval, fmaxval;
+        double dminval, dmaxval;
+    };
+    PartMinMax init;
+    init.minidx = init.maxidx = 0;
+    init.iminval = INT_MAX; init.imaxval = INT_MIN;
+    init.fminval = std::numeric_limits<float>::infinity(); init.fmaxval = -init.fminval;
+    init.dminval = std::numeric_limits<double>::infinity(); init.dmaxval = -init.dminval;
+    const int nparts = getReductionParts(src.total()*src.elemSize());
+    std::vector<PartMinMax> parts(nparts, init);
+
+    parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t idx, size_t len)
+    {
+        PartMinMax& pm = parts[part];
+        int *minval = &pm.iminval, *maxval = &pm.imaxval;
+        if( depth == CV_32F )
+            minval = (int*)&pm.fminval, maxval = (int*)&pm.fmaxval;
+        else if( depth == CV_64F )
+            minval = (int*)&pm.dminval, maxval = (int*)&pm.dmaxval;
+        func( ptrs[0], ptrs[1], minval, maxval, &pm.minidx, &pm.maxidx, (int)len*cn, idx*cn + 1 );
+    });
 
     size_t minidx = 0, maxidx = 0;
     int iminval = INT_MAX, imaxval = INT_MIN;
-    float  fminval = std::numeric_limits<float>::infinity(),  fmaxval = -fminval;
-    double dminval = std::numeric_limits<double>::infinity(), dmaxval = -dminval;
-    size_t startidx = 1;
-    int *minval = &iminval, *maxval = &imaxval;
-    int planeSize = (int)it.size*cn;
-
-    if( depth == CV_32F )
-        minval = (int*)&fminval, maxval = (int*)&fmaxval;
-    else if( depth == CV_64F )
-        minval = (int*)&dminval, maxval = (int*)&dmaxval;
-
-    for( size_t i = 0; i < it.nplanes; i++, ++it, startidx += planeSize )
-        func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, planeSize, startidx );
+    float  fminval = init.fminval, fmaxval = init.fmaxval;
+    double dminval = init.dminval, dmaxval = init.dmaxval;
+    for( int p = 0; p < nparts; p++ )
+    {
+        const PartMinMax& pm = parts[p];
+        if( pm.minidx != 0 && (minidx == 0 || (depth == CV_32F ? pm.fminval < fminval :
+                                               depth == CV_64F ? pm.dminval < dminval : pm.iminval < iminval)) )
+        {
+            minidx = pm.minidx;
+            iminval = pm.iminval; fminval = pm.fminval; dminval = pm.dminval;
+        }
+        if( pm.maxidx != 0 && (maxidx == 0 || (depth == CV_32F ? pm.fmaxval > fmaxval :
+                                               depth == CV_64F ? pm.dmaxval > dmaxval : pm.imaxval > imaxval)) )
+        {
+            maxidx = pm.maxidx;
+            imaxval = pm.imaxval; fmaxval = pm.fmaxval; dmaxval = pm.dmaxval;
+        }
+    }
 
     if (!src.empty() && mask.empty())
     {
@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 #include "stat.hpp"
 
 /****************************************************************************************\
@@ -687,16 +688,16 @@ double norm( InputArray _src, int normType, InputArray _mask )
         int cellSize = normType == NORM_HAMMING ? 1 : 2;
 
         const Mat* arrays[] = {&src, 0};
-        uchar* ptrs[1] = {};
-        NAryMatIterator it(arrays, ptrs);
-        int total = (int)it.size;
-        int result = 0;
-
-        for( size_t i = 0; i < it.nplanes; i++, ++it )
+        const int nparts = getReductionParts(src.total()*src.elemSize());
+        std::vector<int> partResult(nparts, 0);
+        parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t, size_t len)
         {
-            result += hal::normHamming(ptrs[0], total, cellSize);
-        }
+            partResult[part] += hal::normHamming(ptrs[0], (int)len, cellSize);
+        });
 
+        int result = 0;
+        for( int p = 0; p < nparts; p++ )
+            result += partResult[p];
         return result;
     }
 
@@ -704,75 +705,93 @@ double norm( InputArray _src, int normType, InputArray _mask )
     CV_Assert( func != 0 );
 
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2] = {};
-    union
+    union NormResult
     {
         double d;
         int i;
         float f;
+    };
+
+    // Results of the parts are combined in the same order for any number of threads
+    struct PartResult
+    {
+        NormResult result;
+        int isum;
+        int count;
+    };
+    const int nparts = getReductionParts(src.total()*src.elemSize());
+    std::vector<PartResult> parts(nparts);
+    for (int p = 0; p < nparts; p++)
+    {
+        parts[p].result.d = 0;
+        parts[p].isum = 0;
+        parts[p].count = 0;
     }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    CV_CheckLT((size_t)it.size, (size_t)INT_MAX, "");
+    const bool intSum = (normType == NORM_L1 && depth <= CV_16S) ||
+                        ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S);
 
-    if ((normType == NORM_L1 && depth <= CV_16S) ||
-        ((normType == NORM_L2 || normType == NORM_L2SQR) && depth <= CV_8S))
+    parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t, size_t len)
     {
-        // special case to handle "integer" overflow in accumulator
+        CV_CheckLT(len, (size_t)INT_MAX, "");
+        PartResult& pr = parts[part];
         const size_t esz = src.elemSize();
-        const int total = (int)it.size;
-        const int intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
-        const int blockSize = std::min(total, intSumBlockSize);
-        int isum = 0;
-        int count = 0;
-
-        for (size_t i = 0; i < it.nplanes; i++, ++it)
+        const int total = (int)len;
+        if (intSum)
         {
+            // special case to handle "integer" overflow in accumulator
+            const int intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
+            const int blockSize = std::min(total, intSumBlockSize);
             for (int j = 0; j < total; j += blockSize)
             {
                 int bsz = std::min(total - j, blockSize);
-                func(ptrs[0], ptrs[1], (uchar*)&isum, bsz, cn);
-                count += bsz;
-                if (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total))
+                if (pr.count + bsz > intSumBlockSize)
                 {
-                    result.d += isum;
-                    isum = 0;
-                    count = 0;
+                    pr.result.d += pr.isum;
+                    pr.isum = 0;
+                    pr.count = 0;
                 }
+                func(ptrs[0], ptrs[1], (uchar*)&pr.isum, bsz, cn);
+                pr.count += bsz;
                 ptrs[0] += bsz*esz;
                 if (ptrs[1])
                     ptrs[1] += bsz;
             }
         }
-    }
-    else if (depth == CV_16F)
-    {
-        const size_t esz = src.elemSize();
-        const int total = (int)it.size;
-        const int blockSize = std::min(total, divUp(1024, cn));
-        AutoBuffer<float, 1026/*divUp(1024,3)*3*/> fltbuf(blockSize * cn);
-        float* data0 = fltbuf.data();
-        for (size_t i = 0; i < it.nplanes; i++, ++it)
+        else if (depth == CV_16F)
         {
+            const int blockSize = std::min(total, divUp(1024, cn));
+            AutoBuffer<float, 1026/*divUp(1024,3)*3*/> fltbuf(blockSize * cn);
+            float* data0 = fltbuf.data();
             for (int j = 0; j < total; j += blockSize)
             {
                 int bsz = std::min(total - j, blockSize);
                 hal::cvt16f32f((const hfloat*)ptrs[0], data0, bsz * cn);
-                func((uchar*)data0, ptrs[1], (uchar*)&result.f, bsz, cn);
+                func((uchar*)data0, ptrs[1], (uchar*)&pr.result.f, bsz, cn);
                 ptrs[0] += bsz*esz;
                 if (ptrs[1])
                     ptrs[1] += bsz;
             }
         }
-    }
-    else
-    {
-        // generic implementation
-        for (size_t i = 0; i < it.nplanes; i++, ++it)
+        else
         {
-            func(ptrs[0], ptrs[1], (uchar*)&result, (int)it.size, cn);
+            // generic implementation
+            func(ptrs[0], ptrs[1], (uchar*)&pr.result, total, cn);
         }
+    });
+
+    NormResult result;
+    result.d = 0;
+    for (int p = 0; p < nparts; p++)
+    {
+        const NormResult& r = parts[p].result;
+        if (normType != NORM_INF)
+            result.d += r.d + parts[p].isum;
+        else if (depth == CV_64F)
+            result.d = std::max(result.d, r.d);
+        else if (depth == CV_32F || depth == CV_16F)
+            result.f = std::max(result.f, r.f);
+        else
+            result.i = std::max(result.i, r.i);
     }
 
     if( normType == NORM_INF )
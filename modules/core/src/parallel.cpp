@@ -151,6 +151,7 @@
 #  define CV_PARALLEL_FRAMEWORK "ms-concurrency"
 #elif defined HAVE_PTHREADS_PF
 #  define CV_PARALLEL_FRAMEWORK "pthreads"
+#  define CV_PARALLEL_FRAMEWORK_NESTED_CALLS 1  // ThreadPool schedules nested and concurrent jobs
 #endif
 
 #include <atomic>
@@ -517,6 +518,14 @@ void parallel_for_(const cv::Range& range, const cv::ParallelLoopBody& body, dou
     if (range.empty())
         return;
 
+#ifdef CV_PARALLEL_FRAMEWORK_NESTED_CALLS
+    if (!cv::parallel::getCurrentParallelForAPI())
+    {
+        parallel_for_impl(range, body, nstripes);
+        return;
+    }
+#endif
+
     static std::atomic<bool> flagNestedParallelFor(false);
     bool isNotNestedRegion = !flagNestedParallelFor.load();
     if (isNotNestedRegion)
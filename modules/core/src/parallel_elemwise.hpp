@@ -0,0 +1,138 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_CORE_SRC_PARALLEL_ELEMWISE_HPP
+#define OPENCV_CORE_SRC_PARALLEL_ELEMWISE_HPP
+
+#include <opencv2/core/utils/configuration.private.hpp>
+
+namespace cv {
+
+/* Element-wise operations and reductions over large arrays are split into parts processed
+ * by parallel_for_(). The parts depend on the size of the data only, so reductions combine
+ * partial results in the same order for any number of threads.
+ */
+
+// Arrays smaller than this (in bytes) are processed in one part
+static inline size_t getParallelElemwiseThreshold()
+{
+    static size_t threshold = utils::getConfigurationParameterSizeT("OPENCV_CORE_PARALLEL_ELEMWISE_THRESHOLD", 1 << 20);
+    return threshold;
+}
+
+// Number of parts for a reduction over @p bytes of data
+static inline int getReductionParts(size_t bytes)
+{
+    const size_t threshold = getParallelElemwiseThreshold(), maxParts = 256;
+    if (bytes < threshold || bytes < 2)
+        return 1;
+    size_t partBytes = std::max(threshold / 4, (size_t)4096);
+    return (int)std::min(std::max(bytes / partBytes, (size_t)2), maxParts);
+}
+
+// Number of parts for an element-wise operation over @p bytes of data
+static inline int getElemwiseParts(size_t bytes)
+{
+    return getNumThreads() > 1 ? getReductionParts(bytes) : 1;
+}
+
+// NAryMatIterator which can start from any plane
+class SeekableMatIterator : public NAryMatIterator
+{
+public:
+    SeekableMatIterator(const Mat** _arrays, uchar** _ptrs) : NAryMatIterator(_arrays, _ptrs) {}
+
+    void seek(size_t plane)
+    {
+        if (plane == 0)
+            return;
+        idx = plane - 1;  // pointers are computed from the index
+        ++*this;
+    }
+};
+
+/** @brief Calls fn(part, ptrs, idx, len) for @p nparts parts of the arrays iterated by NAryMatIterator.
+ *
+ * @p arrays is a NULL-terminated list as for NAryMatIterator. ptrs point to the first of len elements
+ * of the part in every array (NULL for empty arrays), idx is the index of this element in all planes.
+ * A part crossing planes is passed in several calls with the same part index. Parts are split at
+ * multiples of 64 elements.
+ */
+template<typename Fn>
+static void parallelForPlanes(const Mat** arrays, int nparts, const Fn& fn)
+{
+    enum { MAX_ARRAYS = 8 };
+    uchar* ptrs[MAX_ARRAYS] = {};
+    NAryMatIterator it(arrays, ptrs);
+    CV_Assert(it.narrays <= MAX_ARRAYS);
+    const size_t planeSize = it.size, total = planeSize * it.nplanes, nblocks = total / 64;
+    if (nparts <= 1 || nblocks < 2)
+    {
+        for (size_t i = 0; i < it.nplanes; i++, ++it)
+            fn(0, ptrs, i * planeSize, planeSize);
+        return;
+    }
+    nparts = (int)std::min((size_t)nparts, nblocks);
+
+    parallel_for_(Range(0, nparts), [&](const Range& r) {
+        for (int part = r.start; part < r.end; part++)
+        {
+            size_t start = nblocks * part / nparts * 64;
+            size_t end = part + 1 == nparts ? total : nblocks * (part + 1) / nparts * 64;
+            uchar* planePtrs[MAX_ARRAYS] = {};
+            uchar* partPtrs[MAX_ARRAYS] = {};
+            SeekableMatIterator pit(arrays, planePtrs);
+            size_t plane = start / planeSize, ofs = start - plane * planeSize;
+            pit.seek(plane);
+            while (start < end)
+            {
+                size_t len = std::min(planeSize - ofs, end - start);
+                for (int k = 0; k < pit.narrays; k++)
+                    partPtrs[k] = planePtrs[k] ? planePtrs[k] + ofs * arrays[k]->elemSize() : 0;
+                fn(part, partPtrs, start, len);
+                start += len;
+                ofs = 0;
+                ++pit;
+            }
+        }
+    });
+}
+
+/** @brief Calls fn(rows, cols) for @p nparts parts of a 2D operation of sz.width x sz.height elements.
+ *
+ * Rows are split between parts if there are enough of them, otherwise rows are split at multiples
+ * of 64 elements as well.
+ */
+template<typename Fn>
+static void parallelFor2D(Size sz, int nparts, const Fn& fn)
+{
+    if (nparts <= 1 || (sz.height < 2 && sz.width < 128))
+    {
+        fn(Range(0, sz.height), Range(0, sz.width));
+        return;
+    }
+    if (sz.height >= nparts)
+    {
+        parallel_for_(Range(0, nparts), [&](const Range& r) {
+            fn(Range((int)((int64)sz.height * r.start / nparts), (int)((int64)sz.height * r.end / nparts)),
+               Range(0, sz.width));
+        });
+        return;
+    }
+    const int nblocks = (sz.width + 63) / 64;
+    const int colParts = std::min((nparts + sz.height - 1) / sz.height, nblocks);
+    parallel_for_(Range(0, sz.height * colParts), [&](const Range& r) {
+        for (int i = r.start; i < r.end; i++)
+        {
+            int y = i / colParts, part = i - y * colParts;
+            int x0 = (int)((int64)nblocks * part / colParts * 64);
+            int x1 = part + 1 == colParts ? sz.width : (int)((int64)nblocks * (part + 1) / colParts * 64);
+            fn(Range(y, y + 1), Range(x0, x1));
+        }
+    });
+}
+
+} // namespace cv
+
+#endif // OPENCV_CORE_SRC_PARALLEL_ELEMWISE_HPP
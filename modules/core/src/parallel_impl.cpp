@@ -18,12 +18,8 @@
 
 #include <opencv2/core/utils/trace.private.hpp>
 
-//#define CV_PROFILE_THREADS 64
-//#define getTickCount getCPUTickCount  // use this if getTickCount() calls are expensive (and getCPUTickCount() is accurate)
-
-//#define CV_USE_GLOBAL_WORKERS_COND_VAR  // not effective on many-core systems (10+)
-
 #include <atomic>
+#include <deque>
 
 // Spin lock's OS-level yield
 #ifdef DECLARE_CV_YIELD
@@ -82,6 +78,15 @@ static int CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT = (int)utils::getConfigurationPar
 class WorkerThread;
 class ParallelJob;
 
+/* Work-stealing pool of worker threads.
+ *
+ * Every parallel_for_() call is a job (a group of tasks) which is published in a queue:
+ * jobs of application threads go to the shared queue, nested jobs of worker threads go to
+ * the own queue of the worker. The calling thread always executes tasks of its job, idle
+ * workers steal jobs from all queues: the job with the fewest workers is taken first, so
+ * concurrent and nested parallel_for_() calls share the pool instead of running serially.
+ * Several threads work on the same job, tasks are split into chunks by an atomic counter.
+ */
 class ThreadPool
 {
 public:
@@ -112,84 +117,35 @@ public:
 
     void setNumOfThreads(unsigned n);
 
+    // Takes the queued job with the fewest workers, returns NULL if there are no free tasks
+    Ptr<ParallelJob> takeJob(const WorkerThread& worker);
+
+    void notifyJobCompleted();
+
     ThreadPool();
 
     ~ThreadPool();
 
     unsigned num_threads;
 
-    pthread_mutex_t mutex;  // guards fields (job/threads) from non-worker threads (concurrent parallel_for calls)
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    pthread_cond_t cond_thread_wake;
-#endif
+    pthread_mutex_t mutex;  // guards reconfiguration from concurrent parallel_for calls of non-worker threads
+
+    pthread_mutex_t mutex_queue;  // guards queues of jobs and the list of worker threads
+    std::deque< Ptr<ParallelJob> > queue;  // jobs of non-worker threads
+    std::atomic<int> num_queued_jobs;  // jobs in all queues, checked by workers without locks
+    std::atomic<int> num_active_jobs;
 
     pthread_mutex_t mutex_notify;
     pthread_cond_t cond_thread_task_complete;
 
-    std::vector< Ptr<WorkerThread> > threads;
+    pthread_key_t worker_key;  // WorkerThread of the current thread
 
-    Ptr<ParallelJob> job;
-
-#ifdef CV_PROFILE_THREADS
-    double tickFreq;
-    int64 jobSubmitTime;
-    struct ThreadStatistics
-    {
-        ThreadStatistics() : threadWait(0)
-        {
-            reset();
-        }
-        void reset()
-        {
-            threadWake = 0;
-            threadExecuteStart = 0;
-            threadExecuteStop = 0;
-            executedTasks = 0;
-            keepActive = false;
-            threadPing = getTickCount();
-        }
-        int64 threadWait; // don't reset by default
-        int64 threadPing; // don't reset by default
-        int64 threadWake;
-        int64 threadExecuteStart;
-        int64 threadExecuteStop;
-        int64 threadFree;
-        unsigned executedTasks;
-        bool keepActive;
-
-        int64 dummy_[8]; // separate cache lines
-
-        void dump(int id, int64 baseTime, double tickFreq)
-        {
-            if (id < 0)
-                std::cout << "Main: ";
-            else
-                printf("T%03d: ", id + 2);
-            printf("wait=% 10.1f   ping=% 6.1f",
-                    threadWait > 0 ? (threadWait - baseTime) / tickFreq * 1e6 : -0.0,
-                    threadPing > 0 ? (threadPing - baseTime) / tickFreq * 1e6 : -0.0);
-            if (threadWake > 0)
-                printf("   wake=% 6.1f",
-                    (threadWake > 0 ? (threadWake - baseTime) / tickFreq * 1e6 : -0.0));
-            if (threadExecuteStart > 0)
-            {
-                printf("   exec=% 6.1f - % 6.1f   tasksDone=%5u   free=% 6.1f",
-                    (threadExecuteStart > 0 ? (threadExecuteStart - baseTime) / tickFreq * 1e6 : -0.0),
-                    (threadExecuteStop > 0 ? (threadExecuteStop - baseTime) / tickFreq * 1e6 : -0.0),
-                    executedTasks,
-                    (threadFree > 0 ? (threadFree - baseTime) / tickFreq * 1e6 : -0.0));
-                if (id >= 0)
-                    printf(" active=%s\n", keepActive ? "true" : "false");
-                else
-                    printf("\n");
-            }
-            else
-                printf("   ------------------------------------------------------------------------------\n");
-        }
-    };
-    ThreadStatistics threads_stat[CV_PROFILE_THREADS]; // 0 - main thread, 1..N - worker threads
-#endif
+    std::vector< Ptr<WorkerThread> > threads;
 
+private:
+    void pushJob(const Ptr<ParallelJob>& job, WorkerThread* worker);
+    void removeJob(const Ptr<ParallelJob>& job, WorkerThread* worker);
+    void wakeWorkers(size_t count);
 };
 
 class WorkerThread
@@ -202,15 +158,13 @@ public:
 
     std::atomic<bool> stop_thread;
 
-    std::atomic<bool> has_wake_signal;
+    bool has_wake_signal;  // guarded by mutex
+    bool isActive;  // false while the thread sleeps, guarded by mutex
 
-    Ptr<ParallelJob> job;
+    std::deque< Ptr<ParallelJob> > queue;  // nested jobs of the thread, guarded by thread_pool.mutex_queue
 
     pthread_mutex_t mutex;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    volatile bool isActive;
     pthread_cond_t cond_thread_wake;
-#endif
 
     WorkerThread(ThreadPool& thread_pool_, unsigned id_) :
         thread_pool(thread_pool_),
@@ -218,10 +172,8 @@ public:
         posix_thread(0),
         is_created(false),
         stop_thread(false),
-        has_wake_signal(false)
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-        , isActive(true)
-#endif
+        has_wake_signal(false),
+        isActive(true)
     {
         CV_LOG_VERBOSE(NULL, 1, "MainThread: initializing new worker: " << id);
         int res = pthread_mutex_init(&mutex, NULL);
@@ -230,14 +182,12 @@ public:
             CV_LOG_ERROR(NULL, id << ": Can't create thread mutex: res = " << res);
             return;
         }
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         res = pthread_cond_init(&cond_thread_wake, NULL);
         if (res != 0)
         {
             CV_LOG_ERROR(NULL, id << ": Can't create thread condition variable: res = " << res);
             return;
         }
-#endif
         res = pthread_create(&posix_thread, NULL, thread_loop_wrapper, (void*)this);
         if (res != 0)
         {
@@ -254,25 +204,29 @@ public:
         CV_LOG_VERBOSE(NULL, 1, "MainThread: destroy worker thread: " << id);
         if (is_created)
         {
-            if (!stop_thread)
-            {
-                pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
-                stop_thread = true;
-                pthread_mutex_unlock(&mutex);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                pthread_cond_broadcast(&thread_pool.cond_thread_wake);
-#else
-                pthread_cond_signal(&cond_thread_wake);
-#endif
-            }
+            pthread_mutex_lock(&mutex);  // to avoid signal miss due pre-check
+            stop_thread = true;
+            has_wake_signal = true;
+            pthread_mutex_unlock(&mutex);
+            pthread_cond_signal(&cond_thread_wake);
             pthread_join(posix_thread, NULL);
         }
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
         pthread_cond_destroy(&cond_thread_wake);
-#endif
         pthread_mutex_destroy(&mutex);
     }
 
+    // Wakes the thread if it sleeps, returns false if it is busy or already has the signal
+    bool wake()
+    {
+        pthread_mutex_lock(&mutex);
+        bool need_signal = !isActive && !has_wake_signal;
+        has_wake_signal = true;
+        pthread_mutex_unlock(&mutex);
+        if (need_signal)
+            pthread_cond_signal(&cond_thread_wake);
+        return need_signal;
+    }
+
     void thread_body();
     static void* thread_loop_wrapper(void* thread_object)
     {
@@ -287,7 +241,7 @@ public:
 class ParallelJob
 {
 public:
-    ParallelJob(const ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_) :
+    ParallelJob(ThreadPool& thread_pool_, const Range& range_, const ParallelLoopBody& body_, int nstripes_) :
         thread_pool(thread_pool_),
         body(body_),
         range(range_),
@@ -296,8 +250,8 @@ public:
     {
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::ParallelJob(" << (void*)this << ")");
         current_task.store(0, std::memory_order_relaxed);
+        completed_tasks.store(0, std::memory_order_relaxed);
         active_thread_count.store(0, std::memory_order_relaxed);
-        completed_thread_count.store(0, std::memory_order_relaxed);
         dummy0_[0] = 0, dummy1_[0] = 0, dummy2_[0] = 0; // compiler warning
     }
 
@@ -306,7 +260,9 @@ public:
         CV_LOG_VERBOSE(NULL, 5, "ParallelJob::~ParallelJob(" << (void*)this << ")");
     }
 
-    unsigned execute(bool is_worker_thread)
+    // Executes free tasks of the job, the thread which completes the last task of the job
+    // notifies the owner (the thread which has called parallel_for_)
+    unsigned execute(bool is_owner)
     {
         unsigned executed_tasks = 0;
         const int task_count = range.size();
@@ -322,25 +278,33 @@ public:
             if (id >= task_count)
                 break; // no more free tasks
 
-            executed_tasks += chunk_size;
             int start_id = id;
             int end_id = std::min(task_count, id + chunk_size);
             CV_LOG_VERBOSE(NULL, 9, "Thread: job " << start_id << "-" << end_id);
 
-            //TODO: if (not pending exception)
-            {
-                body.operator()(Range(range.start + start_id, range.start + end_id));
-            }
-            if (is_worker_thread && is_completed)
+            body.operator()(Range(range.start + start_id, range.start + end_id));
+
+            executed_tasks += end_id - start_id;
+            int completed = completed_tasks.fetch_add(end_id - start_id, std::memory_order_seq_cst) + (end_id - start_id);
+            if (completed == task_count)
             {
-                CV_LOG_ERROR(NULL, "\t\t\t\tBUG! Job: " << (void*)this << " " << id << " " << active_thread_count << " " << completed_thread_count);
-                CV_Assert(!is_completed); // TODO Dbg this
+                is_completed = true;
+                if (!is_owner)
+                {
+                    CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying the owner thread");
+                    thread_pool.notifyJobCompleted();
+                }
             }
         }
         return executed_tasks;
     }
 
-    const ThreadPool& thread_pool;
+    bool hasFreeTasks() const
+    {
+        return current_task.load(std::memory_order_relaxed) < range.size();
+    }
+
+    ThreadPool& thread_pool;
     const ParallelLoopBody& body;
     const Range range;
     const unsigned nstripes;
@@ -348,154 +312,88 @@ public:
     std::atomic<int> current_task;  // next free part of job
     int64 dummy0_[8];  // avoid cache-line reusing for the same atomics
 
-    std::atomic<int> active_thread_count;  // number of threads worked on this job
+    std::atomic<int> completed_tasks;  // number of executed tasks
     int64 dummy1_[8];  // avoid cache-line reusing for the same atomics
 
-    std::atomic<int> completed_thread_count;  // number of threads completed any activities on this job
+    std::atomic<int> active_thread_count;  // number of worker threads which work on this job
     int64 dummy2_[8];  // avoid cache-line reusing for the same atomics
 
     std::atomic<bool> is_completed;
-
-    // TODO exception handling
 };
 
 
-// Disable thread sanitization check when CV_USE_GLOBAL_WORKERS_COND_VAR is not
-// set because it triggers as the main thread reads isActive while the children
-// thread writes it (but it all works out because a mutex is locked in the main
-// thread and isActive re-checked).
-// This is to solve issue #19463.
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR) && defined(__clang__) && defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-__attribute__((no_sanitize("thread")))
-#endif
-#endif
 void WorkerThread::thread_body()
 {
     (void)cv::utils::getThreadID(); // notify OpenCV about new thread
     CV_LOG_VERBOSE(NULL, 5, "Thread: new thread: " << id);
+    pthread_setspecific(thread_pool.worker_key, this);
 
     bool allow_active_wait = true;
 
-#ifdef CV_PROFILE_THREADS
-    ThreadPool::ThreadStatistics& stat = thread_pool.threads_stat[id + 1];
-#endif
-
     while (!stop_thread)
     {
-        CV_LOG_VERBOSE(NULL, 5, "Thread: ... loop iteration: allow_active_wait=" << allow_active_wait << "   has_wake_signal=" << has_wake_signal);
+        Ptr<ParallelJob> j = thread_pool.takeJob(*this);
+        if (j)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "Thread: processing job size=" << j->range.size() << " done=" << j->current_task);
+            j->execute(false);
+            int active = j->active_thread_count.fetch_sub(1, std::memory_order_seq_cst);
+            allow_active_wait = true;
+            if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0 && active >= CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0)
+                allow_active_wait = false; // turn off a half of threads
+            continue;
+        }
+
+        CV_LOG_VERBOSE(NULL, 5, "Thread: no free jobs: allow_active_wait=" << allow_active_wait);
         if (allow_active_wait && CV_WORKER_ACTIVE_WAIT > 0)
         {
             allow_active_wait = false;
+            bool has_jobs = false;
             for (int i = 0; i < CV_WORKER_ACTIVE_WAIT; i++)
             {
-                if (has_wake_signal)
+                has_jobs = thread_pool.num_queued_jobs.load(std::memory_order_acquire) > 0;
+                if (has_jobs || stop_thread)
                     break;
                 if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
                     CV_PAUSE(16);
                 else
                     CV_YIELD();
             }
+            if (has_jobs)
+                continue;
         }
+
         pthread_mutex_lock(&mutex);
-#ifdef CV_PROFILE_THREADS
-        stat.threadWait = getTickCount();
-#endif
-        while (!has_wake_signal) // to handle spurious wakeups
+        // new jobs are counted before the pusher checks isActive, so a wake signal can't be missed
+        while (!has_wake_signal && !stop_thread && thread_pool.num_queued_jobs.load(std::memory_order_seq_cst) == 0)
         {
-            //CV_LOG_VERBOSE(NULL, 5, "Thread: wait (sleep) ...");
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_wait(&thread_pool.cond_thread_wake, &mutex);
-#else
             isActive = false;
             pthread_cond_wait(&cond_thread_wake, &mutex);
             isActive = true;
-#endif
-            CV_LOG_VERBOSE(NULL, 5, "Thread: wake ... (has_wake_signal=" << has_wake_signal << " stop_thread=" << stop_thread << ")")
+            CV_LOG_VERBOSE(NULL, 5, "Thread: wake ... (has_wake_signal=" << has_wake_signal << " stop_thread=" << stop_thread << ")");
         }
-#ifdef CV_PROFILE_THREADS
-        stat.threadWake = getTickCount();
-#endif
-
-        CV_LOG_VERBOSE(NULL, 5, "Thread: checking for new job");
-        if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT == 0)
-            allow_active_wait = true;
-        Ptr<ParallelJob> j_ptr; swap(j_ptr, job);
         has_wake_signal = false;
         pthread_mutex_unlock(&mutex);
-
-        if (!stop_thread)
-        {
-            ParallelJob* j = j_ptr;
-            if (j)
-            {
-                CV_LOG_VERBOSE(NULL, 5, "Thread: job size=" << j->range.size() << " done=" << j->current_task);
-                if (j->current_task < j->range.size())
-                {
-                    int other = j->active_thread_count.fetch_add(1, std::memory_order_seq_cst);
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: processing new job (with " << other << " other threads)"); CV_UNUSED(other);
-#ifdef CV_PROFILE_THREADS
-                    stat.threadExecuteStart = getTickCount();
-                    stat.executedTasks = j->execute(true);
-                    stat.threadExecuteStop = getTickCount();
-#else
-                    j->execute(true);
-#endif
-                    int completed = j->completed_thread_count.fetch_add(1, std::memory_order_seq_cst) + 1;
-                    int active = j->active_thread_count.load(std::memory_order_acquire);
-                    if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT > 0)
-                    {
-                        allow_active_wait = true;
-                        if (active >= CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT && (id & 1) == 0) // turn off a half of threads
-                            allow_active_wait = false;
-                    }
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: completed job processing: " << active << " " << completed);
-                    if (active == completed)
-                    {
-                        bool need_signal = !j->is_completed;
-                        j->is_completed = true;
-                        j = NULL; j_ptr.release();
-                        if (need_signal)
-                        {
-                            CV_LOG_VERBOSE(NULL, 5, "Thread: job finished => notifying the main thread");
-                            pthread_mutex_lock(&thread_pool.mutex_notify);  // to avoid signal miss due pre-check condition
-                            // empty
-                            pthread_mutex_unlock(&thread_pool.mutex_notify);
-                            pthread_cond_broadcast/*pthread_cond_signal*/(&thread_pool.cond_thread_task_complete);
-                        }
-                    }
-                }
-                else
-                {
-                    CV_LOG_VERBOSE(NULL, 5, "Thread: no free job tasks");
-                }
-            }
-        }
-#ifdef CV_PROFILE_THREADS
-        stat.threadFree = getTickCount();
-        stat.keepActive = allow_active_wait;
-#endif
+        if (CV_WORKER_ACTIVE_WAIT_THREADS_LIMIT == 0)
+            allow_active_wait = true;
     }
 }
 
 ThreadPool::ThreadPool()
 {
-#ifdef CV_PROFILE_THREADS
-    tickFreq = getTickFrequency();
-#endif
-
     int res = 0;
     res |= pthread_mutex_init(&mutex, NULL);
+    res |= pthread_mutex_init(&mutex_queue, NULL);
     res |= pthread_mutex_init(&mutex_notify, NULL);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    res |= pthread_cond_init(&cond_thread_wake, NULL);
-#endif
     res |= pthread_cond_init(&cond_thread_task_complete, NULL);
+    res |= pthread_key_create(&worker_key, NULL);
 
     if (0 != res)
     {
         CV_LOG_FATAL(NULL, "Failed to initialize ThreadPool (pthreads)");
     }
+    num_queued_jobs.store(0, std::memory_order_relaxed);
+    num_active_jobs.store(0, std::memory_order_relaxed);
     num_threads = defaultNumberOfThreads();
 }
 
@@ -507,26 +405,13 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
     if (new_threads_count < threads.size())
     {
         CV_LOG_VERBOSE(NULL, 1, "MainThread: reduce worker pool: " << threads.size() << " => " << new_threads_count);
-        std::vector< Ptr<WorkerThread> > release_threads(threads.size() - new_threads_count);
-        for (size_t i = new_threads_count; i < threads.size(); ++i)
-        {
-            pthread_mutex_lock(&threads[i]->mutex);  // to avoid signal miss due pre-check
-            threads[i]->stop_thread = true;
-            threads[i]->has_wake_signal = true;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_mutex_unlock(&threads[i]->mutex);
-            pthread_cond_broadcast/*pthread_cond_signal*/(&threads[i]->cond_thread_wake); // wake thread
-#else
-            pthread_mutex_unlock(&threads[i]->mutex);
-#endif
-            std::swap(threads[i], release_threads[i - new_threads_count]);
-        }
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-        CV_LOG_VERBOSE(NULL, 1, "MainThread: notify worker threads about termination...");
-        pthread_cond_broadcast(&cond_thread_wake); // wake all threads
-#endif
+        std::vector< Ptr<WorkerThread> > release_threads(threads.begin() + new_threads_count, threads.end());
+        pthread_mutex_lock(&mutex_queue);
         threads.resize(new_threads_count);
-        release_threads.clear();  // calls thread_join which want to lock mutex
+        pthread_mutex_unlock(&mutex_queue);
+        // Stopped threads complete jobs which they have taken, nested jobs of these threads
+        // are not visible for other workers anymore and are executed by their owners.
+        release_threads.clear();  // calls thread_join
         return false;
     }
     else
@@ -534,7 +419,10 @@ bool ThreadPool::reconfigure_(unsigned new_threads_count)
         CV_LOG_VERBOSE(NULL, 1, "MainThread: upgrade worker pool: " << threads.size() << " => " << new_threads_count);
         for (size_t i = threads.size(); i < new_threads_count; ++i)
         {
-            threads.push_back(Ptr<WorkerThread>(new WorkerThread(*this, (unsigned)i))); // spawn more threads
+            Ptr<WorkerThread> thread(new WorkerThread(*this, (unsigned)i)); // spawn more threads
+            pthread_mutex_lock(&mutex_queue);
+            threads.push_back(thread);
+            pthread_mutex_unlock(&mutex_queue);
         }
     }
     return false;
@@ -544,171 +432,148 @@ ThreadPool::~ThreadPool()
 {
     reconfigure(0);
     pthread_cond_destroy(&cond_thread_task_complete);
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-    pthread_cond_destroy(&cond_thread_wake);
-#endif
+    pthread_key_delete(worker_key);
     pthread_mutex_destroy(&mutex);
+    pthread_mutex_destroy(&mutex_queue);
     pthread_mutex_destroy(&mutex_notify);
 }
 
+void ThreadPool::pushJob(const Ptr<ParallelJob>& job, WorkerThread* worker)
+{
+    pthread_mutex_lock(&mutex_queue);
+    if (worker)
+        worker->queue.push_back(job);
+    else
+        queue.push_back(job);
+    num_queued_jobs.fetch_add(1, std::memory_order_seq_cst);
+    // the owner executes tasks too
+    wakeWorkers(std::min(static_cast<size_t>(job->range.size()) - 1, threads.size()));
+    pthread_mutex_unlock(&mutex_queue);
+}
+
+void ThreadPool::removeJob(const Ptr<ParallelJob>& job, WorkerThread* worker)
+{
+    pthread_mutex_lock(&mutex_queue);
+    std::deque< Ptr<ParallelJob> >& q = worker ? worker->queue : queue;
+    for (size_t i = 0; i < q.size(); i++)
+    {
+        if (q[i] == job)
+        {
+            q.erase(q.begin() + i);
+            num_queued_jobs.fetch_sub(1, std::memory_order_seq_cst);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mutex_queue);
+}
+
+// mutex_queue must be locked
+void ThreadPool::wakeWorkers(size_t count)
+{
+    CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads: " << count);
+    for (size_t i = 0; i < threads.size() && count > 0; i++)
+    {
+        if (threads[i]->wake())
+            count--;
+    }
+}
+
+Ptr<ParallelJob> ThreadPool::takeJob(const WorkerThread& worker)
+{
+    Ptr<ParallelJob> best;
+    int best_threads = INT_MAX;
+    pthread_mutex_lock(&mutex_queue);
+    const size_t n = threads.size();
+    // Nested jobs of other workers first (starting from the next worker to spread the threads), the
+    // threads which wait for them are blocked. Jobs without free tasks are removed from queues.
+    for (size_t k = 0; k <= n; k++)
+    {
+        std::deque< Ptr<ParallelJob> >& q = k < n ? threads[(worker.id + 1 + k) % n]->queue : queue;
+        for (size_t i = 0; i < q.size();)
+        {
+            if (!q[i]->hasFreeTasks())
+            {
+                q.erase(q.begin() + i);
+                num_queued_jobs.fetch_sub(1, std::memory_order_seq_cst);
+                continue;
+            }
+            int active = q[i]->active_thread_count.load(std::memory_order_relaxed);
+            if (active < best_threads)
+            {
+                best = q[i];
+                best_threads = active;
+            }
+            i++;
+        }
+    }
+    if (best)
+        best->active_thread_count.fetch_add(1, std::memory_order_seq_cst);
+    pthread_mutex_unlock(&mutex_queue);
+    return best;
+}
+
+void ThreadPool::notifyJobCompleted()
+{
+    pthread_mutex_lock(&mutex_notify);  // to avoid signal miss due pre-check condition
+    // empty
+    pthread_mutex_unlock(&mutex_notify);
+    pthread_cond_broadcast(&cond_thread_task_complete);
+}
+
 void ThreadPool::run(const Range& range, const ParallelLoopBody& body, double nstripes)
 {
-    CV_LOG_VERBOSE(NULL, 1, "MainThread: new parallel job: num_threads=" << num_threads << "   range=" << range.size() << "   nstripes=" << nstripes << "   job=" << (void*)job);
-#ifdef CV_PROFILE_THREADS
-    jobSubmitTime = getTickCount();
-    threads_stat[0].reset();
-    threads_stat[0].threadWait = jobSubmitTime;
-    threads_stat[0].threadWake = jobSubmitTime;
-#endif
+    CV_LOG_VERBOSE(NULL, 1, "MainThread: new parallel job: num_threads=" << num_threads << "   range=" << range.size() << "   nstripes=" << nstripes << "   active_jobs=" << num_active_jobs);
     if (getNumOfThreads() > 1 &&
-        job == NULL &&
         (range.size() * nstripes >= 2 || (range.size() > 1 && nstripes <= 0))
     )
     {
-        pthread_mutex_lock(&mutex);
-        if (job != NULL)
+        WorkerThread* worker = (WorkerThread*)pthread_getspecific(worker_key);
+        if (!worker)
         {
+            // worker threads can't stop or join other workers, nested jobs use the current pool
+            pthread_mutex_lock(&mutex);
+            reconfigure_(num_threads - 1);
             pthread_mutex_unlock(&mutex);
-            body(range);
-            return;
         }
-        reconfigure_(num_threads - 1);
 
-        {
-            CV_LOG_VERBOSE(NULL, 1, "MainThread: initialize parallel job: " << range.size());
-            job = Ptr<ParallelJob>(new ParallelJob(*this, range, body, nstripes));
-            pthread_mutex_unlock(&mutex);
+        CV_LOG_VERBOSE(NULL, 1, "MainThread: initialize parallel job: " << range.size() << (worker ? " (nested)" : ""));
+        Ptr<ParallelJob> job(new ParallelJob(*this, range, body, nstripes));
+        num_active_jobs.fetch_add(1, std::memory_order_seq_cst);
+        pushJob(job, worker);
 
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads...");
-            size_t num_threads_to_wake = std::min(static_cast<size_t>(range.size()), threads.size());
-            for (size_t i = 0; i < num_threads_to_wake; ++i)
-            {
-                if (job->current_task >= job->range.size())
-                    break;
-                WorkerThread& thread = *(threads[i].get());
-                if (
-#if defined(__clang__) && defined(__has_feature)
-#if __has_feature(thread_sanitizer)
-                        1 ||  // Robust workaround to avoid data race warning of `thread.job`
-#endif
-#endif
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                        thread.isActive ||
-#endif
-                        thread.has_wake_signal
-                        || !thread.job.empty()  // #10881
-                )
-                {
-                    pthread_mutex_lock(&thread.mutex);
-                    thread.job = job;
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    bool isActive = thread.isActive;
-#endif
-                    thread.has_wake_signal = true;
-#ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-                    pthread_mutex_unlock(&thread.mutex);
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    if (!isActive)
-                    {
-                        pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-                    }
-#endif
-                }
-                else
-                {
-                    CV_Assert(thread.job.empty());
-                    thread.job = job;
-                    thread.has_wake_signal = true;
-#ifdef CV_PROFILE_THREADS
-                    threads_stat[i + 1].reset();
-#endif
-#if !defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-                    pthread_cond_broadcast/*pthread_cond_signal*/(&thread.cond_thread_wake); // wake thread
-#endif
-                }
-            }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadPing = getTickCount();
-#endif
-#if defined(CV_USE_GLOBAL_WORKERS_COND_VAR)
-            pthread_cond_broadcast(&cond_thread_wake); // wake all threads
-#endif
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadWake = getTickCount();
-#endif
-            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake worker threads... (done)");
+        job->execute(true);
+        CV_Assert(job->current_task >= job->range.size());
+        // all tasks are taken: no more workers can join the job
+        removeJob(job, worker);
 
+        if (!job->is_completed && CV_MAIN_THREAD_ACTIVE_WAIT > 0)
+        {
+            for (int i = 0; i < CV_MAIN_THREAD_ACTIVE_WAIT; i++)  // don't spin too much in any case (inaccurate getTickCount())
             {
-                ParallelJob& j = *(this->job);
-#ifdef CV_PROFILE_THREADS
-                threads_stat[0].threadExecuteStart = getTickCount();
-                threads_stat[0].executedTasks = j.execute(false);
-                threads_stat[0].threadExecuteStop = getTickCount();
-#else
-                j.execute(false);
-#endif
-                CV_Assert(j.current_task >= j.range.size());
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: complete self-tasks: " << j.active_thread_count << " " << j.completed_thread_count);
-                if (job->is_completed || j.active_thread_count == 0)
+                if (job->is_completed)
                 {
-                    job->is_completed = true;
-                    CV_LOG_VERBOSE(NULL, 5, "MainThread: no WIP worker threads");
+                    CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (active wait) " << job->completed_tasks);
+                    break;
                 }
+                if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
+                    CV_PAUSE(16);
                 else
-                {
-                    if (CV_MAIN_THREAD_ACTIVE_WAIT > 0)
-                    {
-                        for (int i = 0; i < CV_MAIN_THREAD_ACTIVE_WAIT; i++)  // don't spin too much in any case (inaccurate getTickCount())
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (active wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            if (CV_ACTIVE_WAIT_PAUSE_LIMIT > 0 && (i < CV_ACTIVE_WAIT_PAUSE_LIMIT || (i & 1)))
-                                CV_PAUSE(16);
-                            else
-                                CV_YIELD();
-                        }
-                    }
-                    if (!job->is_completed)
-                    {
-                        CV_LOG_VERBOSE(NULL, 5, "MainThread: prepare wait " << j.active_thread_count << " " << j.completed_thread_count);
-                        pthread_mutex_lock(&mutex_notify);
-                        for (;;)
-                        {
-                            if (job->is_completed)
-                            {
-                                CV_LOG_VERBOSE(NULL, 5, "MainThread: job finalize (wait) " << j.active_thread_count << " " << j.completed_thread_count);
-                                break;
-                            }
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wait completion (sleep) ...");
-                            pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
-                            CV_LOG_VERBOSE(NULL, 5, "MainThread: wake");
-                        }
-                        pthread_mutex_unlock(&mutex_notify);
-                    }
-                }
-            }
-#ifdef CV_PROFILE_THREADS
-            threads_stat[0].threadFree = getTickCount();
-            std::cout << "Job: sz=" << range.size() << " nstripes=" << nstripes << "    Time: " << (threads_stat[0].threadFree - jobSubmitTime) / tickFreq * 1e6 << " usec" << std::endl;
-            for (int i = 0; i < (int)threads.size() + 1; i++)
-            {
-                threads_stat[i].dump(i - 1, jobSubmitTime, tickFreq);
+                    CV_YIELD();
             }
-#endif
-            if (job)
+        }
+        if (!job->is_completed)
+        {
+            CV_LOG_VERBOSE(NULL, 5, "MainThread: prepare wait " << job->completed_tasks);
+            pthread_mutex_lock(&mutex_notify);
+            while (!job->is_completed)
             {
-                pthread_mutex_lock(&mutex);
-                CV_LOG_VERBOSE(NULL, 5, "MainThread: job release");
-                CV_Assert(job->is_completed);
-                job.release();
-                pthread_mutex_unlock(&mutex);
+                CV_LOG_VERBOSE(NULL, 5, "MainThread: wait completion (sleep) ...");
+                pthread_cond_wait(&cond_thread_task_complete, &mutex_notify);
             }
+            pthread_mutex_unlock(&mutex_notify);
         }
+        CV_LOG_VERBOSE(NULL, 5, "MainThread: job release");
+        num_active_jobs.fetch_sub(1, std::memory_order_seq_cst);
     }
     else
     {
@@ -727,7 +592,7 @@ void ThreadPool::setNumOfThreads(unsigned n)
     {
         num_threads = n;
         if (n == 1)
-           if (job == NULL) reconfigure(0);  // stop worker threads immediately
+           if (num_active_jobs == 0) reconfigure(0);  // stop worker threads immediately
     }
 }
 
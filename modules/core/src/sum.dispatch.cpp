@@ -5,6 +5,7 @@
 
 #include "precomp.hpp"
 #include "opencl_kernels_core.hpp"
+#include "parallel_elemwise.hpp"
 #include "stat.hpp"
 
 #include "sum.simd.hpp"
@@ -203,46 +204,53 @@ Scalar sum(InputArray _src)
     CV_Assert( cn <= 4 && func != 0 );
 
     const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1] = {};
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    size_t esz = 0;
-    bool blockSum = depth < CV_32S;
-
-    if( blockSum )
-    {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf.data();
+    const bool blockSum = depth < CV_32S;
+    const int intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
+    const size_t esz = src.elemSize();
 
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
+    // Partial sums of the parts are added in the same order for any number of threads
+    struct PartSum
+    {
+        Scalar s;
+        int buf[4];
+        int count;
+    };
+    const int nparts = getReductionParts(src.total()*esz);
+    std::vector<PartSum> parts(nparts);
+    for( int p = 0; p < nparts; p++ )
+    {
+        std::fill(parts[p].buf, parts[p].buf + 4, 0);
+        parts[p].count = 0;
     }
 
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
+    parallelForPlanes(arrays, nparts, [&](int part, uchar** ptrs, size_t, size_t len)
     {
-        for( j = 0; j < total; j += blockSize )
+        PartSum& ps = parts[part];
+        int total = (int)len, blockSize = blockSum ? std::min(total, intSumBlockSize) : total;
+        uchar* buf = blockSum ? (uchar*)ps.buf : (uchar*)&ps.s[0];
+        for( int j = 0; j < total; j += blockSize )
         {
             int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], 0, (uchar*)buf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
+            if( blockSum && ps.count + bsz > intSumBlockSize )
             {
-                for( k = 0; k < cn; k++ )
+                for( int c = 0; c < cn; c++ )
                 {
-                    s[k] += buf[k];
-                    buf[k] = 0;
+                    ps.s[c] += ps.buf[c];
+                    ps.buf[c] = 0;
                 }
-                count = 0;
+                ps.count = 0;
             }
+            func( ptrs[0], 0, buf, bsz, cn );
+            ps.count += bsz;
             ptrs[0] += bsz*esz;
         }
+    });
+
+    Scalar s;
+    for( int p = 0; p < nparts; p++ )
+    {
+        for( k = 0; k < cn; k++ )
+            s[k] += parts[p].s[k] + parts[p].buf[k];
     }
     return s;
 }
@@ -3295,4 +3295,75 @@ TEST_P(Core_LUT, accuracy_multi)
 
 INSTANTIATE_TEST_CASE_P(/**/, Core_LUT, LutMatType::all());
 
+TEST(Core_Arithm, parallel_elemwise_and_reductions)
+{
+    // 3D arrays of several MB which are split into parts, the ROI is iterated plane by plane
+    const int sz[] = {3, 700, 800};
+    Mat big8u(3, sz, CV_8UC3), big32f(3, sz, CV_32FC1), mask(3, sz, CV_8UC1);
+    RNG& rng = theRNG();
+    rng.fill(big8u, RNG::UNIFORM, 0, 256);
+    rng.fill(big32f, RNG::UNIFORM, -100, 100);
+    rng.fill(mask, RNG::UNIFORM, 0, 2);
+    const Range roi[] = {Range::all(), Range(1, 699), Range(3, 797)};
+    Mat src8u = big8u(roi), src32f = big32f(roi), msk = mask(roi);
+    Mat src2d = big32f.reshape(1, 2100);
+
+    // the first of equal minimums is found
+    src32f.at<float>(1, 600, 10) = -200.f;
+    src32f.at<float>(2, 500, 10) = -200.f;
+
+    const int nthreads = getNumThreads();
+    Mat dst[2][6];
+    Scalar sums[2], means[2];
+    int nz[2];
+    double norms[2][3], minVals[2], maxVals[2];
+    int minIdx[2][3], maxIdx[2][3];
+    for (int i = 0; i < 2; i++)
+    {
+        setNumThreads(i == 0 ? 1 : 4);
+        cv::add(src8u, Scalar(10, 20, 30), dst[i][0], noArray(), CV_16S);
+        cv::multiply(src32f, src32f, dst[i][1], 0.5);
+        src8u.convertTo(dst[i][2], CV_32F, 0.25, 1);
+        convertScaleAbs(src2d, dst[i][3], 2);
+        dst[i][4] = Mat::zeros(src32f.dims, src32f.size, src32f.type());
+        src32f.copyTo(dst[i][4], msk);
+        bitwise_xor(src2d, Scalar::all(1), dst[i][5]);
+        sums[i] = sum(src32f);
+        means[i] = mean(src8u, msk);
+        nz[i] = countNonZero(msk);
+        norms[i][0] = cvtest::norm(src8u, NORM_L1);
+        norms[i][1] = cvtest::norm(src32f, NORM_L2, msk);
+        norms[i][2] = cvtest::norm(src32f, NORM_INF);
+        cv::minMaxIdx(src32f, &minVals[i], &maxVals[i], minIdx[i], maxIdx[i]);
+    }
+    setNumThreads(nthreads);
+
+    for (int k = 0; k < 6; k++)
+        EXPECT_EQ(0, cvtest::norm(dst[0][k], dst[1][k], NORM_INF)) << k;
+    // reductions don't depend on the number of threads
+    for (int c = 0; c < 4; c++)
+    {
+        EXPECT_EQ(sums[0][c], sums[1][c]);
+        EXPECT_EQ(means[0][c], means[1][c]);
+    }
+    EXPECT_EQ(nz[0], nz[1]);
+    for (int k = 0; k < 3; k++)
+        EXPECT_EQ(norms[0][k], norms[1][k]);
+    EXPECT_EQ(minVals[0], minVals[1]);
+    EXPECT_EQ(maxVals[0], maxVals[1]);
+
+    Mat flat32f = src32f.clone(), flatMask = msk.clone();
+    double refSum = 0;
+    for (size_t i = 0; i < flat32f.total(); i++)
+        refSum += flat32f.ptr<float>()[i];
+    EXPECT_NEAR(refSum, sums[1][0], 1e-6 * src32f.total() * 100);
+    EXPECT_EQ((int)cvtest::norm(flatMask, NORM_L1), nz[1]);
+    EXPECT_EQ(-200., minVals[1]);
+    EXPECT_EQ(1, minIdx[1][0]);
+    EXPECT_EQ(600, minIdx[1][1]);
+    EXPECT_EQ(10, minIdx[1][2]);
+    for (int k = 0; k < 3; k++)
+        EXPECT_EQ(maxVals[1], src32f.at<float>(maxIdx[1])) << k;
+}
+
 }} // namespace
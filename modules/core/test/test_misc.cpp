@@ -9,6 +9,7 @@
 #include <opencv2/core/utils/fp_control_utils.hpp>
 
 #include <chrono>
+#include <set>
 #include <thread>
 
 namespace opencv_test { namespace {
@@ -304,6 +305,66 @@ TEST(Core_Parallel, propagate_fp_denormals_ignore_hint)
     }
 }
 
+TEST(Core_Parallel, nested_and_concurrent_calls)
+{
+    if (std::string(cv::currentParallelFramework()) != "pthreads")
+        throw SkipTestException("Nested and concurrent calls are checked for the pthreads backend only");
+    const int prevNumThreads = cv::getNumThreads();
+    cv::setNumThreads(4);
+
+    // Application threads call parallel_for_() at the same time, the loop bodies call it again
+    const int ncallers = 3, nouter = 8, ninner = 8;
+    std::vector<Mat> results(ncallers);
+    std::vector<std::set<int> > outerThreads(ncallers);
+    std::vector<int> stolenInner(ncallers, 0);
+    cv::Mutex mutex;
+    std::vector<std::thread> callers;
+    for (int c = 0; c < ncallers; c++)
+    {
+        callers.push_back(std::thread([&, c]() {
+            Mat& res = results[c];
+            res = Mat::zeros(nouter, ninner, CV_32S);
+            parallel_for_(Range(0, nouter), [&](const Range& r) {
+                for (int i = r.start; i < r.end; i++)
+                {
+                    const int outerThread = cv::utils::getThreadID();
+                    {
+                        cv::AutoLock lock(mutex);
+                        outerThreads[c].insert(outerThread);
+                    }
+                    parallel_for_(Range(0, ninner), [&](const Range& r2) {
+                        for (int j = r2.start; j < r2.end; j++)
+                        {
+                            res.at<int>(i, j) += i * ninner + j + 1;
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        if (cv::utils::getThreadID() != outerThread)
+                        {
+                            cv::AutoLock lock(mutex);
+                            stolenInner[c]++;
+                        }
+                    });
+                }
+            });
+        }));
+    }
+    for (size_t c = 0; c < callers.size(); c++)
+        callers[c].join();
+    cv::setNumThreads(prevNumThreads);
+
+    Mat ref(nouter, ninner, CV_32S);
+    for (int i = 0; i < (int)ref.total(); i++)
+        ref.at<int>(i) = i + 1;
+    int stolen = 0;
+    for (int c = 0; c < ncallers; c++)
+    {
+        EXPECT_EQ(0, cvtest::norm(ref, results[c], NORM_INF)) << "caller " << c;
+        EXPECT_GT(outerThreads[c].size(), 1u) << "caller " << c;  // every caller gets workers of the pool
+        stolen += stolenInner[c];
+    }
+    EXPECT_GT(stolen, 0);  // nested loops are executed by other threads too
+}
+
 TEST(Core_Version, consistency)
 {
     // this test verifies that OpenCV version loaded in runtime
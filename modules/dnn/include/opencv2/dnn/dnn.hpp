@@ -104,7 +104,7 @@ CV__DNN_INLINE_NS_BEGIN
         DNN_TARGET_CUDA_FP16,
         DNN_TARGET_HDDL,
         DNN_TARGET_NPU,
-        DNN_TARGET_CPU_FP16, // Only the ARM platform is supported. Low precision computing, accelerate model inference.
+        DNN_TARGET_CPU_FP16, // ARM and x86 with AVX2 and F16C (FP16 weights only) are supported. Low precision computing, accelerate model inference.
     };
 
     /**
@@ -461,6 +461,42 @@ CV__DNN_INLINE_NS_BEGIN
         virtual ~Layer();
     };
 
+    /**
+     * @brief Methods of computing the ranges of activations for quantization.
+     * @see QuantizationParams
+     */
+    enum QuantizationCalibration
+    {
+        DNN_CALIB_MINMAX = 0,     //!< Default. The full range of values of the calibration data.
+        DNN_CALIB_PERCENTILE = 1, //!< Outliers out of the given percentile of values are clipped.
+        DNN_CALIB_ENTROPY = 2,    //!< The range minimizes KL divergence between the original and quantized distributions.
+    };
+
+    /** @brief Parameters of post-training quantization.
+     *
+     * @see Net::quantize
+     */
+    struct CV_EXPORTS_W_SIMPLE QuantizationParams
+    {
+        CV_WRAP QuantizationParams();
+
+        CV_PROP_RW int inputsDtype;   //!< Datatype of quantized net's inputs. Can be CV_32F or CV_8S.
+        CV_PROP_RW int outputsDtype;  //!< Datatype of quantized net's outputs. Can be CV_32F or CV_8S.
+        CV_PROP_RW bool perChannel;   //!< Quantize weights of convolution and fully connected layers per channel.
+        CV_PROP_RW QuantizationCalibration calibration; //!< Method of computing the ranges of activations.
+        CV_PROP_RW double percentile; //!< DNN_CALIB_PERCENTILE clips values below 100 - percentile and above percentile, e.g. 99.99.
+        /** Maximal relative L2 error of the network outputs on the calibration data. If it is positive,
+         *  the most sensitive layers are kept in FP32 until the error of the quantized network is below it.
+         *  Sensitivity of a layer is the error of the network where only this layer is quantized. */
+        CV_PROP_RW double maxError;
+        CV_PROP_RW std::vector<String> fp32Layers;  //!< Names of layers which are not quantized.
+        /** File (.yml, .xml or .json) with the calibration table of a previous quantization:
+         *  scales and zeropoints of all the layers and the list of FP32 layers. If it is set, calibration
+         *  data is used only to set up the network and to measure the error of the quantized network. */
+        CV_PROP_RW String calibrationTable;
+        CV_PROP_RW String saveCalibrationTable;  //!< File which the calibration table is written to.
+    };
+
     /** @brief This class allows to create and manipulate comprehensive artificial neural networks.
      *
      * Neural network is presented as directed acyclic graph (DAG), where vertices are Layer instances,
@@ -667,6 +703,13 @@ CV__DNN_INLINE_NS_BEGIN
          */
         CV_WRAP Net quantize(InputArrayOfArrays calibData, int inputsDtype, int outputsDtype, bool perChannel=true);
 
+        /** @brief Returns a quantized Net from a floating-point Net.
+         *  @param calibData Calibration data to compute the quantization parameters and to measure the error
+         *  of the quantized network.
+         *  @param params Parameters of calibration and mixed precision, see QuantizationParams.
+         */
+        CV_WRAP Net quantize(InputArrayOfArrays calibData, const QuantizationParams& params);
+
         /** @brief Returns input scale and zeropoint for a quantized Net.
          *  @param scales output parameter for returning input scales.
          *  @param zeropoints output parameter for returning input zeropoints.
@@ -679,6 +722,24 @@ CV__DNN_INLINE_NS_BEGIN
          */
         CV_WRAP void getOutputDetails(CV_OUT std::vector<float>& scales, CV_OUT std::vector<int>& zeropoints) const;
 
+        /** @brief Returns a copy of the network which shares constant weights with this one.
+         *  @details The copy has own inputs, intermediate blobs and backend state, so the network and its
+         *  copy can be used concurrently from different threads. Preferable backend, target and other
+         *  settings are copied. Weights and kernels prepacked by CPU implementations of convolution
+         *  and Gemm layers are shared read-only between all the copies of the network.
+         *  Layers of the copy are created from the loaded weights, so changes made by setParam() are not copied.
+         */
+        CV_WRAP Net clone() const;
+
+        /** @brief Saves the network with its weights to a binary file which can be loaded by readNetFromCompiled().
+         *  @param path path to the output file.
+         *  @details Weights prepacked by CPU implementations of convolution and Gemm layers are saved as well
+         *  if the network has been initialized by forward(), so they are not computed again after loading.
+         *  Prepacked weights depend on the instruction set of the CPU and are ignored on other platforms.
+         *  Changes made by setParam() are not saved.
+         */
+        CV_WRAP void save(CV_WRAP_FILE_PATH const String& path) const;
+
         /**
          * @brief Compile Halide layers.
          * @param[in] scheduler Path to YAML file with scheduling directives.
@@ -831,6 +892,9 @@ CV__DNN_INLINE_NS_BEGIN
          * @param netInputShapes vector of shapes for all net inputs.
          * @param weights output parameter to store resulting bytes for weights.
          * @param blobs output parameter to store resulting bytes for intermediate blobs.
+         * @details For the OpenCV backend on CPU intermediate blobs share memory according to their live ranges,
+         * so @p blobs is a peak memory of the static memory plan and network inputs. If the planner is not used
+         * (other backends and targets, OPENCV_DNN_MEMORY_PLANNER=0) @p blobs is a sum of all the layers outputs.
          */
         void getMemoryConsumption(const std::vector<MatShape>& netInputShapes,
                                           CV_OUT size_t& weights, CV_OUT size_t& blobs) const; // FIXIT: CV_WRAP
@@ -884,6 +948,46 @@ CV__DNN_INLINE_NS_BEGIN
          */
         CV_WRAP int64 getPerfProfile(CV_OUT std::vector<double>& timings);
 
+        /** @brief Enables or disables collecting of the detailed per-layer profile.
+         *
+         * While profiling is enabled, every forward pass records for each layer its wall time, FLOPs,
+         * bytes of inputs, outputs and weights, the used kernel (e.g. Winograd or generic convolution)
+         * and the number of threads, as well as the memory of all network blobs for the run.
+         * Enabling drops the previously collected profile, disabling keeps it for dumpProfile() and dumpProfileToFile().
+         * Supported by DNN_BACKEND_OPENCV.
+         *
+         * @param enable true to start profiling, false to stop it.
+         */
+        CV_WRAP void enableProfiling(bool enable);
+
+        /** @brief Returns the table with per-layer statistics (mean, min and max time, FLOPs, bytes)
+         * of the collected profile, the slowest layers first.
+         */
+        CV_WRAP String dumpProfile();
+
+        /** @brief Saves the collected profile to the JSON file in Chrome trace event format.
+         *
+         * The file can be opened in chrome://tracing or Perfetto UI.
+         * @param path path to output file with .json extension
+         */
+        CV_WRAP void dumpProfileToFile(CV_WRAP_FILE_PATH const String& path);
+
+        /** @brief Sets the number of layers which can be executed concurrently.
+         *
+         * Independent branches of the network (e.g. Inception blocks, FPN or multi-output detection heads)
+         * are executed by @p nthreads threads, including the calling one. Layers are still parallelized
+         * internally by the OpenCV thread pool (see cv::setNumThreads()), which is shared by concurrent layers.
+         * Layers which share memory of blobs are executed in order, so the memory reuse limits the concurrency.
+         * The default value is taken from OPENCV_DNN_INTER_OP_THREADS (1, layers are executed one by one).
+         * Supported by DNN_BACKEND_OPENCV on CPU targets. Layers are executed one by one while profiling is enabled.
+         *
+         * @param nthreads number of inter-op threads, 1 to disable the concurrent execution.
+         */
+        CV_WRAP void setNumInterOpThreads(int nthreads);
+
+        /** @brief Returns the number of inter-op threads, see setNumInterOpThreads(). */
+        CV_WRAP int getNumInterOpThreads() const;
+
 
         struct Impl;
         inline Impl* getImpl() const { return impl.get(); }
@@ -893,6 +997,43 @@ CV__DNN_INLINE_NS_BEGIN
         Ptr<Impl> impl;
     };
 
+    /** @brief Runs inference requests from multiple threads as batches.
+     *
+     * Requests are queued and concatenated along the first (batch) dimension into a single
+     * network input. A batch is forwarded when it has @p maxBatchSize samples or when
+     * @p maxDelay milliseconds have passed since the first request of the batch was queued.
+     * The network output is split back along the first dimension and returned through AsyncArray.
+     *
+     * Requests with different shapes or types are forwarded in separate batches.
+     * The network must not be used directly while the scheduler is alive.
+     */
+    class CV_EXPORTS BatchingScheduler
+    {
+    public:
+        /** @brief Creates scheduler and starts the worker thread.
+         *  @param net network with a single input which supports variable batch size.
+         *  @param maxBatchSize maximal number of samples in the batch.
+         *  @param maxDelay maximal time in milliseconds to wait for other requests.
+         *  @param outputName name of the layer which output is needed. By default the last layer is used.
+         */
+        BatchingScheduler(const Net& net, int maxBatchSize = 8, double maxDelay = 1.0,
+                          const String& outputName = String());
+
+        /** @brief Processes all the queued requests and stops the worker thread. */
+        ~BatchingScheduler();
+
+        /** @brief Queues inference request.
+         *  @param blob input blob with one or several samples along the first dimension.
+         *  @returns output of the network for the samples of @p blob.
+         *  @details This method can be called concurrently from multiple threads.
+         */
+        AsyncArray forwardAsync(InputArray blob);
+
+        struct Impl;
+    protected:
+        Ptr<Impl> impl;
+    };
+
     /** @brief Reads a network model stored in <a href="https://pjreddie.com/darknet/">Darknet</a> model files.
     *  @param cfgFile      path to the .cfg file with text description of the network architecture.
     *  @param darknetModel path to the .weights file with learned network.
@@ -976,6 +1117,9 @@ CV__DNN_INLINE_NS_BEGIN
     /** @brief Reads a network model stored in <a href="https://www.tensorflow.org/lite">TFLite</a> framework's format.
       * @param model  path to the .tflite file with binary flatbuffers description of the network architecture
       * @returns Net object.
+      *
+      * The file is mapped into memory (see OPENCV_DNN_MAP_WEIGHTS) and constant tensors refer to the mapped pages,
+      * so they are shared between processes which load the same model.
       */
     CV_EXPORTS_W Net readNetFromTFLite(CV_WRAP_FILE_PATH const String &model);
 
@@ -993,6 +1137,15 @@ CV__DNN_INLINE_NS_BEGIN
       */
     CV_EXPORTS Net readNetFromTFLite(const char *bufferModel, size_t lenModel);
 
+    /** @brief Reads a network saved by Net::save().
+      * @param path path to the file.
+      * @returns Net object.
+      *
+      * Weights are mapped into memory instead of reading, so they are shared between the processes
+      * which load the same file. Network import and packing of the weights are skipped.
+      */
+    CV_EXPORTS_W Net readNetFromCompiled(CV_WRAP_FILE_PATH const String& path);
+
     /**
      *  @brief Reads a network model stored in <a href="http://torch.ch">Torch7</a> framework's format.
      *  @param model    path to the file, dumped from Torch by using torch.save() function.
@@ -1100,6 +1253,9 @@ CV__DNN_INLINE_NS_BEGIN
     /** @brief Reads a network model <a href="https://onnx.ai/">ONNX</a>.
      *  @param onnxFile path to the .onnx file with text description of the network architecture.
      *  @returns Network object that ready to do forward, throw an exception in failure cases.
+     *
+     *  Tensors stored in external data files are mapped into memory (see OPENCV_DNN_MAP_WEIGHTS),
+     *  so their pages are shared between processes which load the same model.
      */
     CV_EXPORTS_W Net readNetFromONNX(CV_WRAP_FILE_PATH const String &onnxFile);
 
@@ -1144,6 +1300,7 @@ CV__DNN_INLINE_NS_BEGIN
      *
      * @note
      * The order and usage of `scalefactor` and `mean` are (input - mean) * scalefactor.
+     * Per-channel standard deviation is applied as `scalefactor` = 1 / std.
      */
     CV_EXPORTS_W Mat blobFromImage(InputArray image, double scalefactor=1.0, const Size& size = Size(),
                                    const Scalar& mean = Scalar(), bool swapRB=false, bool crop=false,
@@ -1226,7 +1383,7 @@ CV__DNN_INLINE_NS_BEGIN
         CV_PROP_RW Size size;    //!< Spatial size for output image.
         CV_PROP_RW Scalar mean;  //!< Scalar with mean values which are subtracted from channels.
         CV_PROP_RW bool swapRB;  //!< Flag which indicates that swap first and last channels
-        CV_PROP_RW int ddepth;   //!< Depth of output blob. Choose CV_32F or CV_8U.
+        CV_PROP_RW int ddepth;   //!< Depth of output blob. Choose CV_32F, CV_16F or CV_8U.
         CV_PROP_RW DataLayout datalayout; //!< Order of output dimensions. Choose DNN_LAYOUT_NCHW or DNN_LAYOUT_NHWC.
         CV_PROP_RW ImagePaddingMode paddingmode;   //!< Image padding mode. @see ImagePaddingMode.
         CV_PROP_RW Scalar borderValue;   //!< Value used in padding mode for padding.
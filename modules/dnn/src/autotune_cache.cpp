@@ -0,0 +1,188 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "autotune_cache.hpp"
+
+#include <cstdio>  // std::rename, std::remove
+#include <fstream>
+
+#include <opencv2/core/utils/logger.hpp>
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+#ifdef __linux__
+static std::string readLine(const std::string& path)
+{
+    std::ifstream f(path.c_str());
+    std::string line;
+    std::getline(f, line);
+    return line;
+}
+#endif
+
+static std::string describePlatform()
+{
+    std::string platform;
+#ifdef __linux__
+    {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+        {
+            if (line.compare(0, 10, "model name") == 0)
+            {
+                size_t pos = line.find(':');
+                if (pos != std::string::npos)
+                    platform = line.substr(line.find_first_not_of(' ', pos + 1)) + "; ";
+                break;
+            }
+        }
+    }
+#endif
+    platform += format("cpus=%d;", getNumberOfCPUs());
+    for (int feature = 1; feature < CV_HARDWARE_MAX_FEATURE; feature++)
+    {
+        if (!checkHardwareSupport(feature))
+            continue;
+        String name = getHardwareFeatureName(feature);
+        if (!name.empty())
+            platform += " " + name;
+    }
+#ifdef __linux__
+    // Sizes of caches define the best blocking
+    for (int i = 0; i < 8; i++)
+    {
+        std::string dir = format("/sys/devices/system/cpu/cpu0/cache/index%d/", i);
+        std::string level = readLine(dir + "level"), size = readLine(dir + "size");
+        if (level.empty() || size.empty())
+            break;
+        std::string type = readLine(dir + "type");
+        platform += format("; L%s%s=%s", level.c_str(), type == "Data" ? "d" : type == "Instruction" ? "i" : "",
+                           size.c_str());
+    }
+#endif
+    return platform;
+}
+
+static int getFileFormat(const std::string& path)
+{
+    size_t pos = path.rfind('.');
+    std::string ext = pos == std::string::npos ? std::string() : toLowerCase(path.substr(pos + 1));
+    if (ext == "xml")
+        return FileStorage::FORMAT_XML;
+    if (ext == "json")
+        return FileStorage::FORMAT_JSON;
+    return FileStorage::FORMAT_YAML;
+}
+
+AutotuneCache& AutotuneCache::getInstance()
+{
+    static AutotuneCache* instance = new AutotuneCache();
+    return *instance;
+}
+
+AutotuneCache::AutotuneCache()
+    : path(getParam_DNN_AUTOTUNE_CACHE())
+    , platform(describePlatform())
+{
+    load();
+}
+
+bool AutotuneCache::get(const std::string& key, std::vector<int>& params)
+{
+    AutoLock lock(mutex);
+    std::map<std::pair<std::string, std::string>, std::vector<int> >::const_iterator it =
+            entries.find(std::make_pair(platform, key));
+    if (it == entries.end())
+        return false;
+    params = it->second;
+    return true;
+}
+
+void AutotuneCache::put(const std::string& key, const std::vector<int>& params)
+{
+    AutoLock lock(mutex);
+    entries[std::make_pair(platform, key)] = params;
+    if (path.empty())
+        return;
+    // Other processes may have added their entries
+    load();
+    save();
+}
+
+void AutotuneCache::load()
+{
+    if (path.empty())
+        return;
+    try
+    {
+        FileStorage fs;
+        if (!fs.open(path, FileStorage::READ))
+            return;
+        FileNode nodes = fs["entries"];
+        for (FileNodeIterator it = nodes.begin(); it != nodes.end(); ++it)
+        {
+            FileNode node = *it;
+            std::string entryPlatform = (std::string)node["platform"], key = (std::string)node["key"];
+            std::vector<int> params;
+            node["params"] >> params;
+            if (!key.empty() && !params.empty())
+                entries.insert(std::make_pair(std::make_pair(entryPlatform, key), params));
+        }
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_WARNING(NULL, "DNN/Autotune: can't read cache file '" << path << "': " << e.what());
+    }
+}
+
+void AutotuneCache::save()
+{
+    // Readers never see a partially written file
+    std::string tmpPath = format("%s.%llx.tmp", path.c_str(), (unsigned long long)getTickCount());
+    try
+    {
+        FileStorage fs(tmpPath, FileStorage::WRITE | getFileFormat(path));
+        if (!fs.isOpened())
+        {
+            CV_LOG_WARNING(NULL, "DNN/Autotune: can't write cache file '" << tmpPath << "'");
+            return;
+        }
+        fs << "entries" << "[";
+        std::map<std::pair<std::string, std::string>, std::vector<int> >::const_iterator it;
+        for (it = entries.begin(); it != entries.end(); ++it)
+        {
+            fs << "{";
+            fs << "platform" << it->first.first;
+            fs << "key" << it->first.second;
+            fs << "params" << it->second;
+            fs << "}";
+        }
+        fs << "]";
+        fs.release();
+    }
+    catch (const cv::Exception& e)
+    {
+        CV_LOG_WARNING(NULL, "DNN/Autotune: can't write cache file '" << tmpPath << "': " << e.what());
+        std::remove(tmpPath.c_str());
+        return;
+    }
+#ifdef _WIN32
+    std::remove(path.c_str());  // rename() doesn't replace existing files
+#endif
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        CV_LOG_WARNING(NULL, "DNN/Autotune: can't replace cache file '" << path << "'");
+        std::remove(tmpPath.c_str());
+    }
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
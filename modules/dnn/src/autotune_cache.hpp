@@ -0,0 +1,50 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_AUTOTUNE_CACHE_HPP__
+#define __OPENCV_DNN_SRC_AUTOTUNE_CACHE_HPP__
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/** @brief Parameters of kernels selected by benchmarks on the first run (see OPENCV_DNN_AUTOTUNE).
+ *
+ * The best parameters depend on the CPU, so entries are stored per platform: CPU features,
+ * number of CPUs and sizes of caches. If OPENCV_DNN_AUTOTUNE_CACHE is set, entries are read
+ * from this file on first use and new ones are written back, so every process of the same
+ * machine benchmarks a shape only once. Entries of other platforms are kept in the file.
+ */
+class AutotuneCache
+{
+public:
+    static AutotuneCache& getInstance();
+
+    /// Returns false if there is no entry for the key on this platform
+    bool get(const std::string& key, std::vector<int>& params);
+
+    /// Stores the parameters and updates the cache file
+    void put(const std::string& key, const std::vector<int>& params);
+
+    /// Description of the platform which entries are stored for
+    const std::string& getPlatform() const { return platform; }
+
+private:
+    AutotuneCache();
+
+    // Reads entries of the file which are not in the cache yet
+    void load();
+    void save();
+
+    Mutex mutex;
+    std::string path;
+    std::string platform;
+    std::map<std::pair<std::string, std::string>, std::vector<int> > entries;  // (platform, key) -> params
+};
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_AUTOTUNE_CACHE_HPP__
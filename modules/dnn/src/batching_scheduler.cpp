@@ -0,0 +1,298 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include <opencv2/core/detail/async_promise.hpp>
+#include <opencv2/core/utils/logger.hpp>
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+
+
+struct BatchingScheduler::Impl
+{
+    struct Request
+    {
+        Mat blob;
+        AsyncPromise promise;
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+        std::chrono::steady_clock::time_point arrival;
+#endif
+    };
+
+    Net net;
+    int maxBatchSize;
+    double maxDelay;  // milliseconds
+    String outputName;
+
+    Impl(const Net& net_, int maxBatchSize_, double maxDelay_, const String& outputName_)
+        : net(net_)
+        , maxBatchSize(maxBatchSize_)
+        , maxDelay(maxDelay_)
+        , outputName(outputName_)
+    {
+        CV_Assert(!net.empty());
+        CV_CheckGT(maxBatchSize, 0, "");
+        CV_CheckGE(maxDelay, 0.0, "");
+    }
+
+    static int batchSize(const Mat& blob)
+    {
+        return blob.dims > 0 ? blob.size[0] : 0;
+    }
+
+    // Samples of both blobs can be concatenated along the first dimension.
+    static bool isCompatible(const Mat& a, const Mat& b)
+    {
+        if (a.type() != b.type() || a.dims != b.dims)
+            return false;
+        for (int i = 1; i < a.dims; i++)
+        {
+            if (a.size[i] != b.size[i])
+                return false;
+        }
+        return true;
+    }
+
+    // The caller has dropped its AsyncArray, so nobody waits for the result. That is not an error.
+    static bool isAbandoned(const cv::Exception& e)
+    {
+        return e.code == Error::StsError && e.err == "Associated AsyncArray has been destroyed";
+    }
+
+    static void setValue(AsyncPromise& promise, const Mat& value)
+    {
+        try
+        {
+            promise.setValue(value);
+        }
+        catch (const cv::Exception& e)
+        {
+            if (!isAbandoned(e))
+                throw;
+        }
+    }
+
+    static void setException(AsyncPromise& promise)
+    {
+        try
+        {
+#if CV__EXCEPTION_PTR
+            promise.setException(std::current_exception());
+#else
+            promise.setException(cv::Exception(Error::StsError, "Batched inference failed", CV_Func, __FILE__, __LINE__));
+#endif
+        }
+        catch (const cv::Exception& e)
+        {
+            if (!isAbandoned(e))
+                CV_LOG_ERROR(NULL, "DNN: Exception occurred during batched inference exception propagation");
+        }
+        catch (...)
+        {
+            CV_LOG_ERROR(NULL, "DNN: Exception occurred during batched inference exception propagation");
+        }
+    }
+
+    // Runs requests which are known to be compatible as a single batch.
+    void forwardBatch(std::vector<Request>& requests)
+    {
+        CV_TRACE_FUNCTION();
+        CV_Assert(!requests.empty());
+
+        try
+        {
+            Mat input;
+            int total = 0;
+            for (size_t i = 0; i < requests.size(); i++)
+                total += batchSize(requests[i].blob);
+
+            if (requests.size() == 1)
+            {
+                input = requests[0].blob;
+            }
+            else
+            {
+                const Mat& first = requests[0].blob;
+                std::vector<int> inputShape(first.size.p, first.size.p + first.dims);
+                inputShape[0] = total;
+                input.create(first.dims, &inputShape[0], first.type());
+                uchar* dst = input.ptr();
+                for (size_t i = 0; i < requests.size(); i++)
+                {
+                    const Mat& blob = requests[i].blob;
+                    size_t size = blob.total() * blob.elemSize();
+                    memcpy(dst, blob.ptr(), size);
+                    dst += size;
+                }
+            }
+
+            net.setInput(input);
+            Mat output = net.forward(outputName);
+
+            if (requests.size() == 1)
+            {
+                setValue(requests[0].promise, output);
+                return;
+            }
+
+            if (output.dims < 1 || output.size[0] != total)
+            {
+                CV_Error(Error::StsUnmatchedSizes, cv::format("DNN: network output doesn't keep batch dimension "
+                                                              "(expected %d samples)", total));
+            }
+
+            std::vector<Range> ranges(output.dims, Range::all());
+            int start = 0;
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                int n = batchSize(requests[i].blob);
+                ranges[0] = Range(start, start + n);
+                start += n;
+                try
+                {
+                    setValue(requests[i].promise, output(&ranges[0]));
+                }
+                catch (...)
+                {
+                    setException(requests[i].promise);
+                }
+            }
+        }
+        catch (...)
+        {
+            for (size_t i = 0; i < requests.size(); i++)
+                setException(requests[i].promise);
+        }
+    }
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Request> queue;
+    int queuedSamples = 0;
+    bool stopped = false;
+    std::thread worker;
+
+    void start()
+    {
+        worker = std::thread(&Impl::run, this);
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        cond.notify_all();
+        if (worker.joinable())
+            worker.join();
+    }
+
+    AsyncArray enqueue(const Mat& blob)
+    {
+        Request request;
+        request.blob = blob;
+        request.arrival = std::chrono::steady_clock::now();
+        AsyncArray result = request.promise.getArrayResult();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            CV_Assert(!stopped);
+            queuedSamples += batchSize(blob);
+            queue.push_back(std::move(request));
+        }
+        cond.notify_all();
+        return result;
+    }
+
+    void run()
+    {
+        std::vector<Request> batch;
+        for (;;)
+        {
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait(lock, [&] { return stopped || !queue.empty(); });
+                if (queue.empty())
+                    break;  // stopped
+
+                // Wait for more requests until the batch is full or time is out.
+                const auto deadline = queue.front().arrival +
+                        std::chrono::microseconds((int64)(maxDelay * 1000));
+                cond.wait_until(lock, deadline, [&] { return stopped || queuedSamples >= maxBatchSize; });
+
+                // Take compatible requests in order of arrival.
+                int samples = 0;
+                while (!queue.empty())
+                {
+                    Request& request = queue.front();
+                    int n = batchSize(request.blob);
+                    if (!batch.empty() &&
+                        (samples + n > maxBatchSize || !isCompatible(batch[0].blob, request.blob)))
+                        break;
+                    samples += n;
+                    queuedSamples -= n;
+                    batch.push_back(std::move(request));
+                    queue.pop_front();
+                }
+            }
+            forwardBatch(batch);
+        }
+    }
+#endif
+};
+
+
+BatchingScheduler::BatchingScheduler(const Net& net, int maxBatchSize, double maxDelay, const String& outputName)
+    : impl(makePtr<Impl>(net, maxBatchSize, maxDelay, outputName))
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    impl->start();
+#endif
+}
+
+BatchingScheduler::~BatchingScheduler()
+{
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    if (impl)
+        impl->stop();
+#endif
+}
+
+AsyncArray BatchingScheduler::forwardAsync(InputArray blob)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+
+    Mat input = blob.getMat();
+    CV_Assert(!input.empty());
+    // Own the data because the caller may reuse the buffer before the request is processed.
+    input = input.clone();
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    return impl->enqueue(input);
+#else
+    std::vector<Impl::Request> requests(1);
+    requests[0].blob = input;
+    AsyncArray result = requests[0].promise.getArrayResult();
+    impl->forwardBatch(requests);
+    return result;
+#endif
+}
+
+
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -18,6 +18,9 @@ CV__DNN_INLINE_NS_BEGIN
 Mutex& getInitializationMutex();
 void initializeLayerFactory();
 
+/// DNN_TARGET_CPU_FP16 is supported: ARMv8, or x86 with AVX2 and F16C (FP16 weights only)
+bool haveCPU_FP16Target();
+
 extern bool DNN_DIAGNOSTICS_RUN;
 extern bool DNN_SKIP_REAL_IMPORT;
 
@@ -31,6 +34,27 @@ size_t getParam_DNN_NETWORK_DUMP();
 /// This parameter is useful to run with valgrind memory errors detection
 bool getParam_DNN_DISABLE_MEMORY_OPTIMIZATIONS();
 
+/// Use static memory planner for intermediate blobs of CPU targets
+bool getParam_DNN_MEMORY_PLANNER();
+
+/// Number of allocation plans (per distinct set of input shapes) kept by every network
+size_t getParam_DNN_PLAN_CACHE_SIZE();
+
+/// Map model files into memory instead of reading them (weights are shared through the page cache)
+bool getParam_DNN_MAP_WEIGHTS();
+
+/// Default number of layers which are executed concurrently by every network, see Net::setNumInterOpThreads()
+int getParam_DNN_INTER_OP_THREADS();
+
+/// Select parameters of CPU kernels by benchmarks on the first run of every layer shape
+bool getParam_DNN_AUTOTUNE();
+
+/// File which keeps results of autotuning between runs (empty: in-process cache only)
+std::string getParam_DNN_AUTOTUNE_CACHE();
+
+/// Minimal percentage of zero weight blocks to use block-sparse kernels of convolution and fully connected layers
+size_t getParam_DNN_SPARSE_WEIGHTS_THRESHOLD();
+
 #ifdef HAVE_OPENCL
 bool getParam_DNN_OPENCL_ALLOW_ALL_DEVICES();
 #endif
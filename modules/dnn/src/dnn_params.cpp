@@ -25,6 +25,48 @@ bool getParam_DNN_DISABLE_MEMORY_OPTIMIZATIONS()
     return DNN_DISABLE_MEMORY_OPTIMIZATIONS;
 }
 
+bool getParam_DNN_MEMORY_PLANNER()
+{
+    static bool DNN_MEMORY_PLANNER = utils::getConfigurationParameterBool("OPENCV_DNN_MEMORY_PLANNER", true);
+    return DNN_MEMORY_PLANNER;
+}
+
+size_t getParam_DNN_PLAN_CACHE_SIZE()
+{
+    static size_t DNN_PLAN_CACHE_SIZE = utils::getConfigurationParameterSizeT("OPENCV_DNN_PLAN_CACHE_SIZE", 4);
+    return DNN_PLAN_CACHE_SIZE;
+}
+
+bool getParam_DNN_MAP_WEIGHTS()
+{
+    static bool DNN_MAP_WEIGHTS = utils::getConfigurationParameterBool("OPENCV_DNN_MAP_WEIGHTS", true);
+    return DNN_MAP_WEIGHTS;
+}
+
+int getParam_DNN_INTER_OP_THREADS()
+{
+    static int DNN_INTER_OP_THREADS = (int)utils::getConfigurationParameterSizeT("OPENCV_DNN_INTER_OP_THREADS", 1);
+    return DNN_INTER_OP_THREADS;
+}
+
+bool getParam_DNN_AUTOTUNE()
+{
+    static bool DNN_AUTOTUNE = utils::getConfigurationParameterBool("OPENCV_DNN_AUTOTUNE", false);
+    return DNN_AUTOTUNE;
+}
+
+std::string getParam_DNN_AUTOTUNE_CACHE()
+{
+    static std::string DNN_AUTOTUNE_CACHE = utils::getConfigurationParameterString("OPENCV_DNN_AUTOTUNE_CACHE", "");
+    return DNN_AUTOTUNE_CACHE;
+}
+
+size_t getParam_DNN_SPARSE_WEIGHTS_THRESHOLD()
+{
+    static size_t DNN_SPARSE_WEIGHTS_THRESHOLD = utils::getConfigurationParameterSizeT("OPENCV_DNN_SPARSE_WEIGHTS_THRESHOLD", 70);
+    return DNN_SPARSE_WEIGHTS_THRESHOLD;
+}
+
 #ifdef HAVE_OPENCL
 bool getParam_DNN_OPENCL_ALLOW_ALL_DEVICES()
 {
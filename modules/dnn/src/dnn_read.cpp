@@ -55,6 +55,10 @@ Net readNet(const String& _model, const String& _config, const String& _framewor
     {
         return readNetFromONNX(model);
     }
+    if (framework == "compiled" || modelExt == "cvdnn")
+    {
+        return readNetFromCompiled(model);
+    }
     CV_Error(Error::StsError, "Cannot determine an origin framework of files: " + model + (config.empty() ? "" : ", " + config));
 }
 
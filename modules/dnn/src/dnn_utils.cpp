@@ -5,6 +5,7 @@
 #include "precomp.hpp"
 
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 #include <opencv2/core/utils/logger.hpp>
 
 
@@ -126,6 +127,226 @@ Mat blobFromImagesWithParams(InputArrayOfArrays images, const Image2BlobParams&
     return blob;
 }
 
+// Normalizes a row of 8-bit image with cn interleaved channels: dst = (src - mean) * scale.
+// The k-th channel is written either to planes[k] (NCHW) or to out[x * cn + order[k]] (NHWC).
+// order[] swaps the channels, so it is its own inverse.
+template<int cn>
+static void normalizeRow8u(const uchar* src, int width, float* const* planes, float* out,
+                           const int* order, const float* mean, const float* scale)
+{
+    int x = 0;
+#if CV_SIMD
+    const int vlanes = VTraits<v_uint8>::vlanes(), flanes = VTraits<v_float32>::vlanes();
+    v_float32 vmean[4], vscale[4];
+    for (int k = 0; k < cn; k++)
+    {
+        vmean[k] = vx_setall_f32(mean[k]);
+        vscale[k] = vx_setall_f32(scale[k]);
+    }
+    for (; x <= width - vlanes; x += vlanes)
+    {
+        v_uint8 u[4];
+        if (cn == 1)
+            u[0] = vx_load(src + x);
+        else if (cn == 3)
+            v_load_deinterleave(src + x * 3, u[0], u[1], u[2]);
+        else
+            v_load_deinterleave(src + x * 4, u[0], u[1], u[2], u[3]);
+
+        v_float32 f[4][4];  // [channel][quarter of the vector]
+        for (int k = 0; k < cn; k++)
+        {
+            v_uint16 w0, w1;
+            v_uint32 d[4];
+            v_expand(u[k], w0, w1);
+            v_expand(w0, d[0], d[1]);
+            v_expand(w1, d[2], d[3]);
+            for (int q = 0; q < 4; q++)
+                f[k][q] = v_mul(v_sub(v_cvt_f32(v_reinterpret_as_s32(d[q])), vmean[k]), vscale[k]);
+        }
+        for (int q = 0; q < 4; q++)
+        {
+            if (planes)
+            {
+                for (int k = 0; k < cn; k++)
+                    v_store(planes[k] + x + q * flanes, f[k][q]);
+            }
+            else
+            {
+                float* p = out + (x + q * flanes) * cn;
+                if (cn == 1)
+                    v_store(p, f[0][q]);
+                else if (cn == 3)
+                    v_store_interleave(p, f[order[0]][q], f[order[1]][q], f[order[2]][q]);
+                else
+                    v_store_interleave(p, f[order[0]][q], f[order[1]][q], f[order[2]][q], f[order[3]][q]);
+            }
+        }
+    }
+#endif
+    for (; x < width; x++)
+    {
+        for (int k = 0; k < cn; k++)
+        {
+            float v = ((float)src[x * cn + k] - mean[k]) * scale[k];
+            if (planes)
+                planes[k][x] = v;
+            else
+                out[x * cn + order[k]] = v;
+        }
+    }
+}
+
+static bool blobFromImagesFused(std::vector<UMat>&, UMat&, const Image2BlobParams&, const Scalar&, const Scalar&)
+{
+    return false;
+}
+
+// Single pass conversion of 8-bit images to CV_32F or CV_16F blob. Every output row is produced at once:
+// conversion to float, mean subtraction, scaling, swapping of channels, letterbox padding and the change
+// of layout. Images are resized by cv::resize in advance, so the result is the same as of the generic path.
+// mean and scalefactor are expected in the order of image channels.
+static bool blobFromImagesFused(std::vector<Mat>& images, Mat& blob, const Image2BlobParams& param,
+                                const Scalar& mean, const Scalar& scalefactor)
+{
+    const int nch = images[0].channels();
+    if ((param.ddepth != CV_32F && param.ddepth != CV_16F) || (nch != 1 && nch != 3 && nch != 4) ||
+        (param.datalayout != DNN_LAYOUT_NCHW && param.datalayout != DNN_LAYOUT_NHWC))
+        return false;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        if (images[i].type() != CV_8UC(nch) || images[i].dims != 2)
+            return false;
+    }
+
+    const int nimages = (int)images.size();
+    const Size size = param.size == Size() ? images[0].size() : param.size;
+    std::vector<Mat> srcs(nimages);
+    std::vector<Rect> rois(nimages, Rect(Point(), size));  // area of the output filled by the image
+    for (int i = 0; i < nimages; i++)
+    {
+        const Mat& img = images[i];
+        Size imgSize = img.size();
+        if (size == imgSize)
+        {
+            srcs[i] = img;
+        }
+        else if (param.paddingmode == DNN_PMODE_CROP_CENTER)
+        {
+            float resizeFactor = std::max(size.width / (float)imgSize.width,
+                                          size.height / (float)imgSize.height);
+            Mat resized;
+            resize(img, resized, Size(), resizeFactor, resizeFactor, INTER_LINEAR);
+            Rect crop(Point(0.5 * (resized.cols - size.width),
+                            0.5 * (resized.rows - size.height)),
+                      size);
+            srcs[i] = resized(crop);
+        }
+        else if (param.paddingmode == DNN_PMODE_LETTERBOX)
+        {
+            float resizeFactor = std::min(size.width / (float)imgSize.width,
+                                          size.height / (float)imgSize.height);
+            int rh = int(imgSize.height * resizeFactor);
+            int rw = int(imgSize.width * resizeFactor);
+            resize(img, srcs[i], Size(rw, rh), 0, 0, INTER_LINEAR);
+            rois[i] = Rect((size.width - rw)/2, (size.height - rh)/2, rw, rh);
+        }
+        else
+        {
+            resize(img, srcs[i], size, 0, 0, INTER_LINEAR);
+        }
+    }
+
+    const bool nhwc = param.datalayout == DNN_LAYOUT_NHWC;
+    const bool fp16 = param.ddepth == CV_16F;
+    const int width = size.width, height = size.height;
+    if (nhwc)
+    {
+        int sz[] = { nimages, height, width, nch };
+        blob.create(4, sz, param.ddepth);
+    }
+    else
+    {
+        int sz[] = { nimages, nch, height, width };
+        blob.create(4, sz, param.ddepth);
+    }
+
+    int order[4];
+    float m[4], s[4], border[4];
+    for (int k = 0; k < nch; k++)
+    {
+        order[k] = param.swapRB && nch > 2 && k != 1 && k < 3 ? 2 - k : k;
+        m[k] = (float)mean[k];
+        s[k] = (float)scalefactor[k];
+        border[k] = ((float)saturate_cast<uchar>(param.borderValue[k]) - m[k]) * s[k];
+    }
+
+    parallel_for_(Range(0, nimages * height), [&](const Range& r)
+    {
+        // FP16 rows are computed in float and converted after
+        AutoBuffer<float> rowbuf(fp16 ? width * nch : 1);
+        for (int idx = r.start; idx < r.end; idx++)
+        {
+            const int i = idx / height, y = idx % height;
+            const Rect& roi = rois[i];
+            float* planes[4] = {};
+            float* out = NULL;
+            if (nhwc)
+                out = fp16 ? rowbuf.data() : blob.ptr<float>(i, y);
+            else
+            {
+                for (int k = 0; k < nch; k++)
+                    planes[k] = fp16 ? rowbuf.data() + order[k] * width : blob.ptr<float>(i, order[k]) + y * width;
+            }
+
+            const bool inside = roi.y <= y && y < roi.y + roi.height;
+            for (int x = 0; x < width; x++)
+            {
+                if (inside && x == roi.x)
+                    x = roi.x + roi.width;  // skip the image
+                if (x >= width)
+                    break;
+                for (int k = 0; k < nch; k++)
+                {
+                    if (nhwc)
+                        out[x * nch + order[k]] = border[k];
+                    else
+                        planes[k][x] = border[k];
+                }
+            }
+
+            if (inside)
+            {
+                const uchar* src = srcs[i].ptr<uchar>(y - roi.y);
+                float* roiPlanes[4] = {};
+                for (int k = 0; k < nch; k++)
+                    roiPlanes[k] = nhwc ? NULL : planes[k] + roi.x;
+                float* roiOut = nhwc ? out + roi.x * nch : NULL;
+                float* const* p = nhwc ? NULL : roiPlanes;
+                if (nch == 1)
+                    normalizeRow8u<1>(src, roi.width, p, roiOut, order, m, s);
+                else if (nch == 3)
+                    normalizeRow8u<3>(src, roi.width, p, roiOut, order, m, s);
+                else
+                    normalizeRow8u<4>(src, roi.width, p, roiOut, order, m, s);
+            }
+
+            if (fp16)
+            {
+                if (nhwc)
+                    Mat(1, width * nch, CV_32F, rowbuf.data()).convertTo(Mat(1, width * nch, CV_16F, blob.ptr(i, y)), CV_16F);
+                else
+                {
+                    for (int c = 0; c < nch; c++)
+                        Mat(1, width, CV_32F, rowbuf.data() + c * width).convertTo(
+                            Mat(1, width, CV_16F, blob.ptr<hfloat>(i, c) + y * width), CV_16F);
+                }
+            }
+        }
+    });
+    return true;
+}
+
 template<class Tmat>
 void blobFromImagesWithParamsImpl(InputArrayOfArrays images_, Tmat& blob_, const Image2BlobParams& param)
 {
@@ -135,8 +356,8 @@ void blobFromImagesWithParamsImpl(InputArrayOfArrays images_, Tmat& blob_, const
         CV_Error(Error::StsBadArg, error_message);
     }
 
-    CV_CheckType(param.ddepth, param.ddepth == CV_32F || param.ddepth == CV_8U,
-                 "Blob depth should be CV_32F or CV_8U");
+    CV_CheckType(param.ddepth, param.ddepth == CV_32F || param.ddepth == CV_16F || param.ddepth == CV_8U,
+                 "Blob depth should be CV_32F, CV_16F or CV_8U");
     Size size = param.size;
 
     std::vector<Tmat> images;
@@ -167,6 +388,19 @@ void blobFromImagesWithParamsImpl(InputArrayOfArrays images_, Tmat& blob_, const
         }
     }
 
+    if (blobFromImagesFused(images, blob_, param, mean, scalefactor))
+        return;
+
+    if (param.ddepth == CV_16F)
+    {
+        Image2BlobParams param32 = param;
+        param32.ddepth = CV_32F;
+        Tmat blob32;
+        blobFromImagesWithParamsImpl(images_, blob32, param32);
+        blob32.convertTo(blob_, CV_16F);
+        return;
+    }
+
     for (size_t i = 0; i < images.size(); i++)
     {
         Size imgSize = images[i].size();
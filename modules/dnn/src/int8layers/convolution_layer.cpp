@@ -11,6 +11,8 @@
 #include "opencv2/core/hal/intrin.hpp"
 #include "../op_timvx.hpp"
 #include "../ie_ngraph.hpp"
+#include "../layers/cpu_kernels/convolution.hpp"
+#include "../shared_weights.hpp"
 #include <iostream>
 #include <numeric>
 
@@ -157,7 +159,7 @@ public:
 };
 
 //TODO: simultaneously convolution and bias addition for cache optimization
-class ConvolutionLayerInt8Impl CV_FINAL : public BaseConvolutionLayerInt8Impl
+class ConvolutionLayerInt8Impl CV_FINAL : public BaseConvolutionLayerInt8Impl, public SharedWeightsHolder
 {
 public:
     enum { VEC_ALIGN = 32, DFT_TYPE = CV_8S };
@@ -166,6 +168,7 @@ public:
     std::vector<float> outputMultiplier;
     Mat activationLUT;
     Ptr<ActivationLayerInt8> activ;
+    Ptr<FastConvInt8> fastConvImpl;
 
     ConvolutionLayerInt8Impl(const LayerParams &params) : BaseConvolutionLayerInt8Impl(params){}
 
@@ -272,6 +275,8 @@ public:
             biasvec[i] = biasMat.at<int>(i);
             outputMultiplier[i] = outMult.at<float>(i);
         }
+        // Paddings may depend on the input shape.
+        fastConvImpl.release();
     }
 
     bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE
@@ -1532,12 +1537,45 @@ public:
         CV_Assert(outputs[0].size[1] % ngroups == 0);
 
         int nstripes = std::max(getNumThreads(), 1);
-        Mat outputInt32 = Mat(shape(outputs[0]), CV_32S);
+        int outCn = outputs[0].size[1];
 
-        ParallelConv::run(inputs[0], outputInt32, weightsMat, outputMultiplier, biasvec, activationLUT, kernel_size, strides,
-                          pads_begin, pads_end, dilations, activ.get(), ngroups, nstripes, input_zp, output_zp);
+        // Depthwise and 3D convolutions are processed by ParallelConv.
+        if (kernel_size.size() <= 2 && !(inpGroupCn == 1 && outCn == ngroups))
+        {
+            if (!fastConvImpl)
+            {
+                int inpCn = inputs[0].size[1];
+                std::function<Ptr<FastConvInt8>()> pack = [&]() {
+                    return initFastConvInt8(weightsMat, ngroups, outCn, inpCn, kernel_size, strides,
+                                            dilations, pads_begin, input_zp);
+                };
+                // Packed weights depend on the original weights only, so they can be shared between copies of the network.
+                if (sharedWeights)
+                {
+                    std::vector<Mat> sources(1, blobs[0]);
+                    std::string key = format("%s/conv_int8:K=%d,C=%d,pad=%d,%d,zp=%d", name.c_str(), outCn, inpCn,
+                                             (int)pads_begin[0], (int)pads_begin.back(), input_zp);
+                    fastConvImpl = sharedWeights->get<FastConvInt8>(key, sources, pack);
+                }
+                else
+                {
+                    fastConvImpl = pack();
+                }
+            }
 
-        outputInt32.convertTo(outputs[0], CV_8S);
+            const int* lut = activ && !activationLUT.empty() ? activationLUT.ptr<int>() : 0;
+            runFastConvInt8(inputs[0], outputs[0], fastConvImpl, nstripes, &biasvec[0], &outputMultiplier[0],
+                            output_zp, lut);
+        }
+        else
+        {
+            Mat outputInt32 = Mat(shape(outputs[0]), CV_32S);
+
+            ParallelConv::run(inputs[0], outputInt32, weightsMat, outputMultiplier, biasvec, activationLUT, kernel_size, strides,
+                              pads_begin, pads_end, dilations, activ.get(), ngroups, nstripes, input_zp, output_zp);
+
+            outputInt32.convertTo(outputs[0], CV_8S);
+        }
 
 #if CV_SSE3
         _MM_SET_FLUSH_ZERO_MODE(ftzMode);
@@ -0,0 +1,279 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "inter_op_scheduler.hpp"
+
+#include <opencv2/core/utils/fp_control_utils.hpp>
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <thread>
+#endif
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+// Memory which is read or written by a layer
+struct BlobAccess
+{
+    const uchar* begin;
+    const uchar* end;
+    int node;
+    bool write;
+};
+
+static void addAccess(std::vector<BlobAccess>& accesses, const Mat& m, int node, bool write)
+{
+    if (m.empty() || !m.data)
+        return;
+    BlobAccess access = { m.data, m.dataend, node, write };
+    accesses.push_back(access);
+}
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+struct InterOpScheduler::Workers
+{
+    std::mutex mutex;
+    std::condition_variable cond;  // a new run is started or the state of the current one is changed
+    std::vector<std::thread> threads;
+    bool stop;
+    int64 runId;
+    int busy;  // helper threads which are processing the current run
+
+    // State of the current run
+    std::vector<Node>* nodes;
+    const std::function<void(LayerData&)>* forwardLayer;
+    std::vector<int> pending;  // number of not finished predecessors, -1 for layers out of the run
+    std::priority_queue<int, std::vector<int>, std::greater<int> > ready;  // the lowest id first
+    int remaining;  // not finished layers
+    std::exception_ptr error;
+
+    explicit Workers(int numHelpers)
+        : stop(false), runId(0), busy(0), nodes(0), forwardLayer(0), remaining(0)
+    {
+        for (int i = 0; i < numHelpers; i++)
+            threads.push_back(std::thread(&Workers::helperLoop, this));
+    }
+
+    ~Workers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cond.notify_all();
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+    }
+
+    // Forwards ready layers until all layers of the run are finished or one of them has failed
+    void process(std::unique_lock<std::mutex>& lock)
+    {
+        while (!error && remaining > 0)
+        {
+            if (ready.empty())
+            {
+                cond.wait(lock);
+                continue;
+            }
+            int i = ready.top();
+            ready.pop();
+            lock.unlock();
+            std::exception_ptr e;
+            try
+            {
+                (*forwardLayer)(*(*nodes)[i].ld);
+            }
+            catch (...)
+            {
+                e = std::current_exception();
+            }
+            lock.lock();
+            if (e)
+            {
+                if (!error)
+                    error = e;
+            }
+            else
+            {
+                remaining--;
+                const std::vector<int>& successors = (*nodes)[i].successors;
+                for (size_t j = 0; j < successors.size(); j++)
+                {
+                    int& n = pending[successors[j]];
+                    if (n > 0 && --n == 0)
+                        ready.push(successors[j]);
+                }
+            }
+            cond.notify_all();
+        }
+    }
+
+    void helperLoop()
+    {
+        // The same as in Net::forward() of the calling thread
+        FPDenormalsIgnoreHintScope fp_denormals_ignore_scope;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        int64 lastRunId = runId;
+        for (;;)
+        {
+            cond.wait(lock, [&]() { return stop || runId != lastRunId; });
+            if (stop)
+                break;
+            lastRunId = runId;
+            busy++;
+            process(lock);
+            busy--;
+            cond.notify_all();
+        }
+    }
+};
+#else
+struct InterOpScheduler::Workers {};
+#endif
+
+InterOpScheduler::InterOpScheduler(int numThreads_)
+    : numThreads(numThreads_)
+    , built(false)
+{
+    CV_CheckGT(numThreads, 1, "");
+}
+
+InterOpScheduler::~InterOpScheduler()
+{
+    // nothing
+}
+
+void InterOpScheduler::reset()
+{
+    nodes.clear();
+    built = false;
+}
+
+void InterOpScheduler::build(MapIdToLayerData& layers)
+{
+    CV_TRACE_FUNCTION();
+
+    nodes.clear();
+    std::map<int, int> nodeIds;
+    for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        nodeIds[it->first] = (int)nodes.size();
+        Node node;
+        node.ld = &it->second;
+        nodes.push_back(node);
+    }
+
+    std::vector<BlobAccess> accesses, layerAccesses;
+    for (int i = 0; i < (int)nodes.size(); i++)
+    {
+        const LayerData& ld = *nodes[i].ld;
+        std::vector<int>& predecessors = nodes[i].predecessors;
+        for (size_t j = 0; j < ld.inputBlobsId.size(); j++)
+        {
+            std::map<int, int>::const_iterator it = nodeIds.find(ld.inputBlobsId[j].lid);
+            if (it != nodeIds.end() && it->second != i)
+                predecessors.push_back(it->second);
+        }
+
+        // Blobs may share memory with blobs of any previous layer (in-place layers, reused buffers)
+        layerAccesses.clear();
+        for (size_t j = 0; j < ld.inputBlobs.size(); j++)
+        {
+            if (ld.inputBlobs[j])
+                addAccess(layerAccesses, *ld.inputBlobs[j], i, false);
+        }
+        for (size_t j = 0; j < ld.outputBlobs.size(); j++)
+            addAccess(layerAccesses, ld.outputBlobs[j], i, true);
+        for (size_t j = 0; j < ld.internals.size(); j++)
+            addAccess(layerAccesses, ld.internals[j], i, true);
+        for (size_t j = 0; j < layerAccesses.size(); j++)
+        {
+            const BlobAccess& a = layerAccesses[j];
+            for (size_t k = 0; k < accesses.size(); k++)
+            {
+                const BlobAccess& b = accesses[k];
+                if ((a.write || b.write) && a.begin < b.end && b.begin < a.end)
+                    predecessors.push_back(b.node);
+            }
+        }
+        accesses.insert(accesses.end(), layerAccesses.begin(), layerAccesses.end());
+
+        std::sort(predecessors.begin(), predecessors.end());
+        predecessors.erase(std::unique(predecessors.begin(), predecessors.end()), predecessors.end());
+        for (size_t j = 0; j < predecessors.size(); j++)
+            nodes[predecessors[j]].successors.push_back(i);
+    }
+    built = true;
+}
+
+void InterOpScheduler::run(MapIdToLayerData& layers, int lastLayerId,
+                           const std::function<void(LayerData&)>& forwardLayer)
+{
+    CV_TRACE_FUNCTION();
+
+    if (!built)
+        build(layers);
+    CV_Assert(nodes.size() == layers.size());
+
+#ifdef OPENCV_DISABLE_THREAD_SUPPORT
+    for (size_t i = 0; i < nodes.size() && nodes[i].ld->id <= lastLayerId; i++)
+    {
+        if (!nodes[i].ld->flag)
+            forwardLayer(*nodes[i].ld);
+    }
+#else
+    if (!workers)
+        workers = makePtr<Workers>(numThreads - 1);
+    Workers& w = *workers;
+
+    std::unique_lock<std::mutex> lock(w.mutex);
+    w.nodes = &nodes;
+    w.forwardLayer = &forwardLayer;
+    w.pending.assign(nodes.size(), -1);
+    w.remaining = 0;
+    w.error = std::exception_ptr();
+    for (size_t i = 0; i < nodes.size() && nodes[i].ld->id <= lastLayerId; i++)
+    {
+        if (nodes[i].ld->flag)
+            continue;
+        // predecessors have lower ids, so they are already counted
+        int n = 0;
+        for (size_t j = 0; j < nodes[i].predecessors.size(); j++)
+            n += w.pending[nodes[i].predecessors[j]] >= 0;
+        w.pending[i] = n;
+        if (n == 0)
+            w.ready.push((int)i);
+        w.remaining++;
+    }
+    w.runId++;
+    w.cond.notify_all();
+
+    w.process(lock);
+    w.cond.wait(lock, [&]() { return w.busy == 0; });
+
+    std::exception_ptr error = w.error;
+    w.error = std::exception_ptr();
+    w.remaining = 0;
+    w.ready = std::priority_queue<int, std::vector<int>, std::greater<int> >();
+    w.nodes = 0;
+    w.forwardLayer = 0;
+    lock.unlock();
+    if (error)
+        std::rethrow_exception(error);
+#endif
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -0,0 +1,62 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_INTER_OP_SCHEDULER_HPP__
+#define __OPENCV_DNN_SRC_INTER_OP_SCHEDULER_HPP__
+
+#include "layer_internals.hpp"  // LayerData
+
+#include <functional>
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/** @brief Runs independent layers of the network concurrently (see Net::setNumInterOpThreads()).
+ *
+ * Dependencies are built from the connections of layers and from the memory of their blobs:
+ * layers which access the same memory, and at least one of them writes it, are executed in the
+ * order of their ids. So buffers reused by BlobManager or MemoryPlanner are handled as well.
+ * The calling thread and numThreads - 1 helper threads take ready layers, the lowest id first.
+ * Layers still use parallel_for_() internally, concurrent layers share the thread pool
+ * (other parallel backends than pthreads run a layer in its inter-op thread if the pool is busy).
+ */
+class InterOpScheduler
+{
+public:
+    typedef std::map<int, LayerData> MapIdToLayerData;
+
+    explicit InterOpScheduler(int numThreads);
+    ~InterOpScheduler();
+
+    int getNumThreads() const { return numThreads; }
+
+    /// Drops the dependencies, they are rebuilt by the next run() (blobs are reallocated)
+    void reset();
+
+    /// Calls forwardLayer for not forwarded layers (flag == 0) with ids up to @p lastLayerId
+    void run(MapIdToLayerData& layers, int lastLayerId, const std::function<void(LayerData&)>& forwardLayer);
+
+private:
+    struct Node
+    {
+        LayerData* ld;
+        std::vector<int> predecessors, successors;
+    };
+
+    void build(MapIdToLayerData& layers);
+
+    int numThreads;
+    std::vector<Node> nodes;
+    bool built;
+
+    struct Workers;  // helper threads and state of the current run
+    Ptr<Workers> workers;
+};
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_INTER_OP_SCHEDULER_HPP__
@@ -40,6 +40,20 @@ struct LayerPin
     }
 };
 
+/** @brief Base class of layers which finalize() may not depend on shapes of inputs and outputs.
+ *
+ * Such layers are finalized once: reallocation of the network for other input shapes
+ * doesn't call finalize() again. Change of the target or of the layer weights (Net::setParam())
+ * finalizes the layer again.
+ */
+struct LayerFinalizeInfo
+{
+    virtual ~LayerFinalizeInfo() {}
+
+    /// Returns true if finalize() uses only weights, parameters and target of the layer.
+    virtual bool isFinalizeShapeIndependent() const = 0;
+};
+
 struct LayerData
 {
     LayerData()
@@ -47,6 +61,7 @@ struct LayerData
         , dtype(CV_32F)
         , skip(false)
         , flag(0)
+        , finalized(false)
     {}
     LayerData(int _id, const String& _name, const String& _type, const int& _dtype, LayerParams& _params)
         : id(_id)
@@ -56,6 +71,7 @@ struct LayerData
         , params(_params)
         , skip(false)
         , flag(0)
+        , finalized(false)
     {
         CV_TRACE_FUNCTION();
 
@@ -95,6 +111,8 @@ struct LayerData
     bool skip;
 
     int flag;
+    // Layer::finalize() was called for the current target and weights (see LayerFinalizeInfo).
+    bool finalized;
 
 
     void resetAllocation()
@@ -115,6 +133,7 @@ struct LayerData
 
         skip = false;
         flag = 0;
+        finalized = false;
 
 #ifdef HAVE_CUDA
         cudaD2HBackgroundTransfers.clear();
@@ -4,7 +4,9 @@
 
 #include "../precomp.hpp"
 #include "cpu_kernels/fast_gemm.hpp"
-#include "cpu_kernels/softmax.hpp"
+#include "cpu_kernels/fast_attention.hpp"
+#include "../shared_weights.hpp"
+#include "../net_profiler.hpp"
 
 #include <opencv2/dnn/shape_utils.hpp>
 
@@ -24,8 +26,15 @@ static void packWeight(size_t num_heads, size_t head_size, size_t input_hidden_s
     }
 }
 
+struct AttentionPackedWeights {
+    FastGemmPackedB q, k, v;
+};
+
 // Operator spec: https://github.com/microsoft/onnxruntime/blob/v1.16.1/docs/ContribOperators.md#com.microsoft.Attention
-class AttentionLayerImpl CV_FINAL : public AttentionLayer {
+// Optional inputs and outputs: `past` key/value cache [2, B, N, P, H] is the last input,
+// `present` cache [2, B, N, P + S, H] is the second output (has_present=true).
+// They let autoregressive decoders process only the new tokens at each step.
+class AttentionLayerImpl CV_FINAL : public AttentionLayer, public SharedWeightsHolder, public LayerKernelInfo {
  public:
     AttentionLayerImpl(const LayerParams &params) {
         setParamsFrom(params);
@@ -52,6 +61,11 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
 
         output_ndims = params.get<int>("output_ndims", 3);
 
+        unidirectional = params.get<bool>("unidirectional", false);
+        has_present = params.get<bool>("has_present", false);
+        has_past = false;
+        past_len = 0;
+
         is_prepacked = false;
     }
 
@@ -64,7 +78,7 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
                                  std::vector<MatShape> &outputs,
                                  std::vector<MatShape> &internals) const CV_OVERRIDE {
         int num_inputs = inputs.size() + blobs.size();
-        CV_CheckEQ(num_inputs, 3, "DNN/Attention: three inputs are required");
+        CV_Check(num_inputs, num_inputs == 3 || num_inputs == 4, "DNN/Attention: three inputs and optional past are required");
         const auto &input_shape = inputs[0];
         const auto &weight_shape = blobs.empty() ? inputs[1] : shape(blobs.front());
         const auto &bias_shape = blobs.empty() ? inputs[2] : shape(blobs.back());
@@ -75,11 +89,14 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
         CV_CheckEQ(input_shape[2], weight_shape[0], "DNN/Attention: invalid input shape");
         CV_CheckEQ(weight_shape[1], bias_shape[0], "DNN/Attention: invalid weight or bias shape");
 
+        // the output has v_hidden_size channels, which may differ from the input ones
+        const int v_hidden_size_ = weight_shape.back() - static_cast<int>(qkv_hidden_sizes[0] + qkv_hidden_sizes[1]);
         if (output_ndims == 3) {
-            outputs.assign(1, inputs[0]);
+            MatShape output_shape{input_shape[0], input_shape[1], v_hidden_size_};
+            outputs.assign(1, output_shape);
         } else if (output_ndims == 2) {
-            int batch = input_shape[0], seq_len = input_shape[1], input_hidden_size = input_shape[2];
-            MatShape output_shape{batch * seq_len, input_hidden_size};
+            int batch = input_shape[0], seq_len = input_shape[1];
+            MatShape output_shape{batch * seq_len, v_hidden_size_};
             outputs.assign(1, output_shape);
         } else {
             CV_Error(Error::StsBadArg, format("DNN/Attention: invalid output dimension %zu, valid value is 2 or 3", output_ndims));
@@ -90,16 +107,61 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
                   num_heads_ = static_cast<int>(num_heads),
                   v_head_size_ = static_cast<int>((hidden_size_ - qkv_hidden_sizes[0] - qkv_hidden_sizes[1]) / num_heads);
 
-        MatShape gemm_buffer_shape{batch_size_, seq_len_, hidden_size_},
-                 attention_prob_shape{batch_size_ * num_heads_, seq_len_, seq_len_},
-                 output_buffer_shape{batch_size_ * num_heads_, seq_len_, v_head_size_};
+        MatShape gemm_buffer_shape{batch_size_, seq_len_, hidden_size_};
         internals.assign(1, gemm_buffer_shape);
-        internals.push_back(attention_prob_shape);
-        internals.push_back(output_buffer_shape);
+
+        const bool with_past = num_inputs == 4;
+        if (with_past || has_present) {
+            CV_CheckEQ(qkv_hidden_sizes[1], static_cast<size_t>(hidden_size_ - qkv_hidden_sizes[0] - qkv_hidden_sizes[1]),
+                       "DNN/Attention: key and value hidden sizes must be equal to use past/present");
+            int past_len_ = 0;
+            if (with_past) {
+                const auto &past_shape = inputs.back();
+                CV_CheckEQ(past_shape.size(), static_cast<size_t>(5), "DNN/Attention: invalid past dimension");
+                CV_CheckTrue(past_shape[0] == 2 && past_shape[1] == batch_size_ && past_shape[2] == num_heads_ &&
+                             past_shape[4] == v_head_size_, "DNN/Attention: invalid past shape");
+                past_len_ = past_shape[3];
+            }
+            MatShape kv_cache_shape{2, batch_size_, num_heads_, past_len_ + seq_len_, v_head_size_};
+            if (has_present)
+                outputs.push_back(kv_cache_shape);
+            else
+                internals.push_back(kv_cache_shape);
+        }
 
         return false;
     }
 
+    std::string getKernelName() const CV_OVERRIDE {
+        std::string kernel = "fastAttention";
+        if (unidirectional)
+            kernel += "/causal";
+        if (has_past || has_present)
+            kernel += "/kv_cache";
+        return kernel;
+    }
+
+    bool exportPacked(std::string& key, std::vector<Mat>& data) const CV_OVERRIDE {
+        if (!packed_qkv || packedKey.empty())
+            return false;
+        key = packedKey;
+        data.resize(3);
+        data[0] = packed_qkv->q.exportData();
+        data[1] = packed_qkv->k.exportData();
+        data[2] = packed_qkv->v.exportData();
+        return true;
+    }
+
+    void importPacked(const std::string& key, const std::vector<Mat>& data) CV_OVERRIDE {
+        CV_Assert(sharedWeights && !blobs.empty());
+        CV_CheckEQ(data.size(), (size_t)3, "DNN/Attention: unexpected packed weights");
+        auto packed = makePtr<AttentionPackedWeights>();
+        packed->q.importData(data[0]);
+        packed->k.importData(data[1]);
+        packed->v.importData(data[2]);
+        sharedWeights->preload(key, std::vector<Mat>(1, blobs.front()), packed);
+    }
+
     virtual void finalize(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr) CV_OVERRIDE {
         opt.init();
 
@@ -109,6 +171,8 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
         batch_size = static_cast<size_t>(input_shape[0]);
         seq_len = static_cast<size_t>(input_shape[1]);
         input_hidden_size = static_cast<size_t>(input_shape[2]);
+        has_past = inputs.size() + blobs.size() == 4;
+        past_len = has_past ? static_cast<size_t>(inputs.back().size[3]) : 0;
 
         const auto &weight = blobs.empty() ? inputs[1] : blobs.front();
         const auto weight_shape = shape(weight);
@@ -117,15 +181,31 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
         qkv_head_sizes[2] = static_cast<size_t>(qkv_hidden_sizes[2] / num_heads);
 
         if (!blobs.empty()) {
-            const auto *weight_data = weight.ptr<const float>();
-            packWeight(num_heads, qkv_head_sizes[0], input_hidden_size, weight_data,                                             hidden_size, packed_weight_q, opt);
-            packWeight(num_heads, qkv_head_sizes[1], input_hidden_size, weight_data + qkv_hidden_sizes[0],                       hidden_size, packed_weight_k, opt);
-            packWeight(num_heads, qkv_head_sizes[2], input_hidden_size, weight_data + qkv_hidden_sizes[0] + qkv_hidden_sizes[1], hidden_size, packed_weight_v, opt);
+            std::function<Ptr<AttentionPackedWeights>()> pack = [&]() {
+                return packWeights(weight.ptr<const float>());
+            };
+            if (sharedWeights) {
+                // Layout of packed weights depends on the platform, so it is a part of the key.
+                packedKey = format("%s/attention:heads=%d,qkv=%d,%d,%d,in=%d,isa=%d%d%d%d", name.c_str(), (int)num_heads,
+                                   (int)qkv_hidden_sizes[0], (int)qkv_hidden_sizes[1], (int)qkv_hidden_sizes[2], (int)input_hidden_size,
+                                   (int)opt.use_avx, (int)opt.use_avx2, (int)opt.use_neon, (int)opt.use_lasx);
+                packed_qkv = sharedWeights->get<AttentionPackedWeights>(packedKey, std::vector<Mat>(1, weight), pack);
+            } else {
+                packed_qkv = pack();
+            }
 
             is_prepacked = true;
         }
     }
 
+    Ptr<AttentionPackedWeights> packWeights(const float *weight_data) const {
+        auto packed = makePtr<AttentionPackedWeights>();
+        packWeight(num_heads, qkv_head_sizes[0], input_hidden_size, weight_data,                                             hidden_size, packed->q.buf, opt);
+        packWeight(num_heads, qkv_head_sizes[1], input_hidden_size, weight_data + qkv_hidden_sizes[0],                       hidden_size, packed->k.buf, opt);
+        packWeight(num_heads, qkv_head_sizes[2], input_hidden_size, weight_data + qkv_hidden_sizes[0] + qkv_hidden_sizes[1], hidden_size, packed->v.buf, opt);
+        return packed;
+    }
+
     void forward(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr, OutputArrayOfArrays internals_arr) CV_OVERRIDE {
         CV_TRACE_FUNCTION();
         CV_TRACE_ARG_VALUE(name, "name", name.c_str());
@@ -144,23 +224,45 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
         // prepack weights
         if (!is_prepacked) {
             const auto &weight = blobs.empty() ? inputs[1] : blobs.front();
-            const auto *weight_data = weight.ptr<const float>();
-            packWeight(num_heads, qkv_head_sizes[0], input_hidden_size, weight_data,                                             hidden_size, packed_weight_q, opt);
-            packWeight(num_heads, qkv_head_sizes[1], input_hidden_size, weight_data + qkv_hidden_sizes[0],                       hidden_size, packed_weight_k, opt);
-            packWeight(num_heads, qkv_head_sizes[2], input_hidden_size, weight_data + qkv_hidden_sizes[0] + qkv_hidden_sizes[1], hidden_size, packed_weight_v, opt);
+            packed_qkv = packWeights(weight.ptr<const float>());
 
             is_prepacked = true;
         }
 
-        float *packed_weights[3] = {packed_weight_q.data(), packed_weight_k.data(), packed_weight_v.data()};
+        const FastGemmPackedB &packed_weight_q = packed_qkv->q, &packed_weight_k = packed_qkv->k, &packed_weight_v = packed_qkv->v;
+        const float *packed_weights[3] = {packed_weight_q.data(), packed_weight_k.data(), packed_weight_v.data()};
         size_t packed_weights_size[3] = {packed_weight_q.size() / num_heads, packed_weight_k.size() / num_heads, packed_weight_v.size() / num_heads};
 
         // Compute Q/K/V
+        // Q: [B, N, S, H]. K, V: [B, N, S, H] or, with the key/value cache, the last S rows of [B, N, P + S, H]
+        const size_t kv_len = past_len + seq_len;
         auto &gemm_buffer = internals[0];
         auto *Q = gemm_buffer.ptr<float>();
         auto *K = Q + batch_size * seq_len * qkv_hidden_sizes[0];
         auto *V = K + batch_size * seq_len * qkv_hidden_sizes[1];
-        float *QKV[3] = {Q, K, V}; // Q, K, V: [B, N, S, H]
+        size_t head_steps[3] = {seq_len * qkv_head_sizes[0], seq_len * qkv_head_sizes[1], seq_len * qkv_head_sizes[2]};
+        size_t seq_offsets[3] = {0, 0, 0};
+        if (has_past || has_present) {
+            Mat &kv_cache = has_present ? outputs[1] : internals[1];
+            K = kv_cache.ptr<float>();
+            V = K + batch_size * num_heads * kv_len * qkv_head_sizes[1];
+            head_steps[1] = kv_len * qkv_head_sizes[1];
+            head_steps[2] = kv_len * qkv_head_sizes[2];
+            seq_offsets[1] = past_len * qkv_head_sizes[1];
+            seq_offsets[2] = past_len * qkv_head_sizes[2];
+
+            if (past_len > 0) {
+                const float *past = inputs.back().ptr<const float>();
+                const size_t past_step = past_len * qkv_head_sizes[1];
+                float *dst = K;
+                for (size_t i = 0; i < 2 * batch_size * num_heads; i++) {
+                    std::memcpy(dst, past, past_step * sizeof(float));
+                    past += past_step;
+                    dst += head_steps[1];
+                }
+            }
+        }
+        float *QKV[3] = {Q, K, V};
         {
             const auto &input = inputs[0];
             const auto &bias = blobs.empty() ? inputs[2] : blobs.back();
@@ -179,7 +281,7 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
 
                     int input_offset = batch_index * seq_len * input_hidden_size;
                     int bias_offset = qkv_index * qkv_hidden_sizes[0] + head_index * head_size;
-                    int dst_offset = (batch_index * num_heads + head_index) * (seq_len * head_size);
+                    size_t dst_offset = (batch_index * num_heads + head_index) * head_steps[qkv_index] + seq_offsets[qkv_index];
 
                     // broadcast bias ([NH] -> [BN, SH]) and make copy to dst
                     const auto *bias_data_src = bias_data + bias_offset;
@@ -202,70 +304,10 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
             parallel_for_(Range(0, loops), fn, nstripes);
         }
 
-        // Compute Softmax(scale * MatMul(Q, K))
-        auto &attention_prob = internals[1];
-        {
-            auto *output = attention_prob.ptr<float>();
-
-            auto loops = batch_size * num_heads;
-            auto seq_len_square = seq_len * seq_len;
-            auto qk_head_size = qkv_head_sizes[0];
-            auto qk_inner_size = seq_len * qk_head_size;
-
-            // Compute scale * matmul(Q, K)
-            opt.multi_thread = false;
-            parallel_for_(Range(0, loops), [&] (const Range r) {
-                for (int i = r.start; i < r.end; i++) {
-                    const int output_offset = i * seq_len_square;
-
-                    const auto *q = Q + qk_inner_size * i, *k = K + qk_inner_size * i;
-                    fastGemm(false, true, seq_len, qk_head_size, seq_len, qk_head_size,
-                             scale, q, qk_head_size, 1,
-                             k, qk_head_size, 1, 0.f,
-                             output + output_offset, seq_len, opt);
-                }
-            }, loops * seq_len * qk_head_size * seq_len * (1 / 1024.0));
-
-            // Compute softmax on the last dimension
-            softmax(attention_prob, attention_prob, shape(attention_prob).size() - 1);
-        }
-
-        // Compute MatMul(attention_prob, V)
-        auto &output_buffer = internals[2];
-        {
-            auto *output = outputs[0].ptr<float>();
-            auto *output_buff = output_buffer.ptr<float>();
-            const auto *prob = attention_prob.ptr<const float>();
-
-            auto loops = batch_size * num_heads;
-            auto prob_inner_size = seq_len * seq_len;
-            auto v_head_size = qkv_head_sizes[2];
-            auto v_inner_size = seq_len * v_head_size;
-
-            opt.multi_thread = false;
-            parallel_for_(Range(0, loops), [&] (const Range &r) {
-                for (int i = r.start; i < r.end; i++) {
-                    const int output_offset = i * v_inner_size;
-
-                    const auto *p = prob + i * prob_inner_size, *v = V + i * v_inner_size;
-                    fastGemm(false, false, seq_len, seq_len, seq_len, v_head_size,
-                             1.f, p, seq_len, 1,
-                             v, v_head_size, 1, 0.f,
-                             output_buff + output_offset, v_head_size, opt);
-
-                    // tranpose on the fly
-                    const int batch_index = static_cast<int>(i / num_heads);
-                    const int head_index = static_cast<int>(i % num_heads);
-                    auto *src = output_buff + output_offset;
-                    auto *dst = output + (batch_index * seq_len * num_heads + head_index) * v_head_size;
-                    for (int j = 0; j < seq_len; j++) {
-                        std::memcpy(dst, src, v_head_size * sizeof(float));
-                        src += v_head_size;
-                        dst += qkv_hidden_sizes[2];
-                    }
-                }
-            }, loops * seq_len * seq_len * v_head_size * (1 / 1024.0));
-        }
+        // Compute MatMul(Softmax(scale * MatMul(Q, K)), V) without materializing the attention probabilities
+        fastAttention(batch_size, num_heads, seq_len, kv_len, qkv_head_sizes[0], qkv_head_sizes[2], scale, unidirectional,
+                      Q, K, head_steps[1], V, head_steps[2],
+                      outputs[0].ptr<float>(), qkv_hidden_sizes[2], opt);
     }
 
  private:
@@ -273,6 +315,8 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
     std::vector<size_t> qkv_hidden_sizes; // order: {qk_hidden_size, qk_hidden_size, v_hidden_size}
     float scale;
     size_t output_ndims;
+    bool unidirectional; // causal mask
+    bool has_present;
 
     std::vector<size_t> qkv_head_sizes; // order: {qk_head_size, qk_head_size, v_head_size}
 
@@ -280,11 +324,12 @@ class AttentionLayerImpl CV_FINAL : public AttentionLayer {
     size_t seq_len;
     size_t input_hidden_size;
     size_t hidden_size;
+    bool has_past;
+    size_t past_len;
 
     bool is_prepacked;
-    std::vector<float> packed_weight_q;
-    std::vector<float> packed_weight_k;
-    std::vector<float> packed_weight_v;
+    Ptr<AttentionPackedWeights> packed_qkv;  // may be shared between copies of the network
+    std::string packedKey;
 
     FastGemmOpt opt;
 };
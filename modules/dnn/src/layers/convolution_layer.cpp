@@ -70,6 +70,10 @@ using namespace cv::dnn::cuda4dnn;
 #endif
 
 #include "cpu_kernels/convolution.hpp"
+#include "cpu_kernels/sparse_weights.hpp"
+#include "../shared_weights.hpp"
+#include "../net_profiler.hpp"
+#include "../autotune_cache.hpp"
 
 namespace cv
 {
@@ -243,7 +247,7 @@ public:
 
 
 //TODO: simultaneously convolution and bias addition for cache optimization
-class ConvolutionLayerImpl CV_FINAL : public BaseConvolutionLayerImpl
+class ConvolutionLayerImpl CV_FINAL : public BaseConvolutionLayerImpl, public SharedWeightsHolder, public LayerKernelInfo
 {
 public:
     enum { VEC_ALIGN = 8, DFT_TYPE = CV_32F };
@@ -253,6 +257,12 @@ public:
     Ptr<ActivationLayer> activ;
 
     Ptr<FastConv> fastConvImpl;
+    std::string fastConvKey;
+    bool autotune;  // select the algorithm and blocking of fastConvImpl by benchmarks
+    FastConvBlocking fastConvBlocking;
+    MatShape tunedShape;  // input shape which fastConvBlocking is selected for
+    bool useSparse = false;  // weights are pruned, the block-sparse kernel is used instead of fastConvImpl
+    SparseWeights sparseWeights;
 
 #ifdef HAVE_OPENCL
     Ptr<OCL4DNNConvSpatial<float> > convolutionOp;
@@ -271,6 +281,7 @@ public:
 
     ConvolutionLayerImpl(const LayerParams &params) : BaseConvolutionLayerImpl(params)
     {
+        autotune = params.get<bool>("autotune", getParam_DNN_AUTOTUNE());
 #ifdef HAVE_OPENCL
         newActiv = false;
         activType = OCL4DNN_CONV_FUSED_ACTIV_NONE;
@@ -283,6 +294,36 @@ public:
 #endif
     }
 
+    bool exportPacked(std::string& key, std::vector<Mat>& data) const CV_OVERRIDE
+    {
+        if (!fastConvImpl || fastConvKey.empty())
+            return false;
+        key = fastConvKey;
+        exportFastConv(*fastConvImpl, data);
+        return true;
+    }
+
+    std::string getKernelName() const CV_OVERRIDE
+    {
+        if (useSparse && !sparseWeights.empty())
+            return "SparseConv";
+        return fastConvImpl ? fastConvKernelName(*fastConvImpl) : std::string();
+    }
+
+    void importPacked(const std::string& key, const std::vector<Mat>& data) CV_OVERRIDE
+    {
+        CV_Assert(sharedWeights);
+        Ptr<FastConv> conv = importFastConv(data);
+        if (conv)
+            sharedWeights->preload(key, packedSources(), conv);
+    }
+
+    // Blobs which packed weights are computed from.
+    std::vector<Mat> packedSources() const
+    {
+        return std::vector<Mat>(blobs.begin(), blobs.begin() + (hasBias() ? 2 : 1));
+    }
+
     MatShape computeColRowShape(const MatShape &inpShape, const MatShape &outShape) const CV_OVERRIDE
     {
         CV_Assert(!blobs.empty());
@@ -431,6 +472,13 @@ public:
             weightsMat.release();
         }
 
+        // The sparse kernel is vectorized for the horizontal stride 1. Depthwise convolutions have
+        // a dedicated kernel.
+        int ngroups = blobs.empty() ? 1 : inputs[0].size[1] / blobs[0].size[1];
+        useSparse = !blobs.empty() && preferableTarget == DNN_TARGET_CPU && inputs[0].dims == 4 &&
+                    kernel_size.size() == 2 && strides[1] == 1 && blobs[0].size[1] > 1 &&
+                    useSparseWeights(weightsMat, ngroups);
+
         weightsMultipliers.assign(numOutput, 1.0);
 
         Mat biasMat = hasBias() ? blobs[1].reshape(1, numOutput) : Mat();
@@ -1287,26 +1335,206 @@ public:
                 conv_dim = CONV_3D;
 
             // Initialization of FastCovn2d, pack weight.
+            bool packed = false;
+            int K = outputs[0].size[1];
+            int C = inputs[0].size[1];
+            bool useFP16 = preferableTarget == DNN_TARGET_CPU_FP16;
+            // Winograd only works when input h and w >= 12.
+            bool canUseWinograd = useWinograd && conv_dim == CONV_2D && inputs[0].size[2] >= 12 && inputs[0].size[3] >= 12;
+
+            // Weights packed in advance (e.g. loaded with the compiled network) are used as is
+            if (useSparse && sparseWeights.empty() && sharedWeights &&
+                sharedWeights->find<FastConv>(getFastConvKey(K, C, conv_dim, useFP16, canUseWinograd), packedSources()))
+                useSparse = false;
+
+            if (useSparse && !variableWeight)
+            {
+                // Packed after fusions, scales of the fused layers keep zero weights
+                if (sparseWeights.empty())
+                {
+                    packSparseConvWeights(weightsMat, ngroups, kernel_size, dilations, pads_begin, sparseWeights);
+                    weightsMat.release();
+                }
+                runSparseConv(inputs[0], outputs[0], sparseWeights, strides, biasvec.data(), activ.get(), fusedAdd);
+                return;
+            }
+
             if (!fastConvImpl || variableWeight)
             {
-                int K = outputs[0].size[1];
-                int C = inputs[0].size[1];
+                CV_Assert(outputs[0].size[1] % ngroups == 0);
+                fastConvImpl = packFastConv(ngroups, K, C, conv_dim, useFP16, canUseWinograd, variableWeight, fastConvKey);
+                packed = true;
+            }
 
-                // Winograd only works when input h and w >= 12.
-                bool canUseWinograd = useWinograd && conv_dim == CONV_2D && inputs[0].size[2] >= 12 && inputs[0].size[3] >= 12;
+            if (autotune && shape(inputs[0]) != tunedShape)
+            {
+                // The generic convolution may be faster than Winograd (e.g. for few channels),
+                // weights can be packed for it only while weightsMat is available.
+                std::function<Ptr<FastConv>(std::string&)> packGeneric;
+                if (packed && !variableWeight)
+                    packGeneric = [&](std::string& key) {
+                        return packFastConv(ngroups, K, C, conv_dim, useFP16, false, false, key);
+                    };
+                autotuneFastConv(inputs[0], outputs[0], nstripes, packGeneric);
+                tunedShape = shape(inputs[0]);
+            }
 
-                CV_Assert(outputs[0].size[1] % ngroups == 0);
-                fastConvImpl = initFastConv(weightsMat, &biasvec[0], ngroups, K, C, kernel_size, strides,
-                                            dilations, pads_begin, pads_end, conv_dim,
-                                            preferableTarget == DNN_TARGET_CPU_FP16, canUseWinograd);
+            if (packed)
+            {
                 // This is legal to release weightsMat here as this is not used anymore for
                 // OpenCV inference. If network needs to be reinitialized (new shape, new backend)
                 // a new version of weightsMat is created at .finalize() from original weights
                 weightsMat.release();
             }
 
-            runFastConv(inputs[0], outputs[0], fastConvImpl, nstripes, activ, reluslope, fusedAdd);
+            runFastConv(inputs[0], outputs[0], fastConvImpl, nstripes, activ, reluslope, fusedAdd, fastConvBlocking);
+        }
+    }
+
+    // Layout of packed weights depends on the platform, so it is a part of the key.
+    std::string getFastConvKey(int K, int C, int conv_dim, bool useFP16, bool canUseWinograd) const
+    {
+        return format("%s/conv:K=%d,C=%d,dim=%d,fp16=%d,wino=%d,fused=%d,mr=%d,nr=%d,avx=%d",
+                      name.c_str(), K, C, conv_dim, (int)useFP16, (int)canUseWinograd,
+                      (int)(fusedWeights || fusedBias), CONV_MR_FP32, CONV_NR_FP32,
+                      (int)(checkHardwareSupport(CPU_AVX) || checkHardwareSupport(CPU_AVX2)));
+    }
+
+    // Packs weightsMat or takes the packed weights from the shared storage.
+    Ptr<FastConv> packFastConv(int ngroups, int K, int C, int conv_dim, bool useFP16, bool canUseWinograd,
+                               bool variableWeight, std::string& packedKey)
+    {
+        std::function<Ptr<FastConv>()> pack = [&]() {
+            return initFastConv(weightsMat, &biasvec[0], ngroups, K, C, kernel_size, strides,
+                                dilations, pads_begin, pads_end, conv_dim,
+                                useFP16, canUseWinograd);
+        };
+        std::string key = getFastConvKey(K, C, conv_dim, useFP16, canUseWinograd);
+        Ptr<FastConv> packed;
+        if (sharedWeights && !variableWeight)
+        {
+            // Packed weights are shared between copies of the network if they are computed
+            // from constant weights only. Weights fused from other layers may be only preloaded
+            // with the compiled network.
+            if (!fusedWeights && !fusedBias)
+            {
+                packed = sharedWeights->get<FastConv>(key, packedSources(), pack);
+            }
+            else
+            {
+                packed = sharedWeights->find<FastConv>(key, packedSources());
+            }
+        }
+        packedKey = variableWeight ? std::string() : key;
+        return packed ? packed : pack();
+    }
+
+    // Selects the algorithm and blocking of fastConvImpl for the input shape. Results of benchmarks
+    // are stored in AutotuneCache, so they are reused by other layers and networks of the same shape.
+    void autotuneFastConv(const Mat& input, const Mat& output, int nstripes,
+                          const std::function<Ptr<FastConv>(std::string&)>& packGeneric)
+    {
+        CV_TRACE_FUNCTION();
+
+        fastConvBlocking = FastConvBlocking();
+        const int convType = fastConvImpl->conv_type;
+        if (convType == CONV_TYPE_DEPTHWISE || convType == CONV_TYPE_DEPTHWISE_REMAIN)
+            return;  // nothing to tune
+
+        std::string key = format("conv:input=%s,K=%d,groups=%d,kernel=%s,strides=%s,dilations=%s,pads=%s%s,"
+                                 "type=%d,fp16=%d,fp16w=%d,threads=%d,activ=%s,add=%d",
+                                 toString(shape(input)).c_str(), fastConvImpl->K, fastConvImpl->ngroups,
+                                 toString(kernel_size).c_str(), toString(strides).c_str(),
+                                 toString(dilations).c_str(), toString(pads_begin).c_str(),
+                                 toString(pads_end).c_str(), convType, (int)fastConvImpl->useFP16,
+                                 (int)fastConvImpl->useFP16Weights, nstripes,
+                                 activ ? activ->type.c_str() : "none", (int)fusedAdd);
+
+        AutotuneCache& cache = AutotuneCache::getInstance();
+        std::vector<int> params;
+        if (!cache.get(key, params) || params.size() != 4)
+        {
+            // The output of the network is not changed by benchmarks
+            Mat scratch;
+            auto measure = [&](const Ptr<FastConv>& conv, const FastConvBlocking& blocking) {
+                double best = DBL_MAX;
+                for (int i = 0; i < 4; i++)  // the first run warms up caches
+                {
+                    output.copyTo(scratch);  // added to the result if fusedAdd is set
+                    int64 t = getTickCount();
+                    runFastConv(input, scratch, conv, nstripes, activ, reluslope, fusedAdd, blocking);
+                    t = getTickCount() - t;
+                    if (i > 0)
+                        best = std::min(best, (double)t);
+                }
+                return best;
+            };
+
+            Ptr<FastConv> generic = fastConvImpl;
+            std::string genericKey;
+            double winogradTime = DBL_MAX;
+            if (convType == CONV_TYPE_WINOGRAD3X3)
+            {
+                winogradTime = measure(fastConvImpl, fastConvBlocking);
+                generic = packGeneric ? packGeneric(genericKey) : Ptr<FastConv>();
+            }
+
+            FastConvBlocking best;
+            double bestTime = DBL_MAX;
+            if (generic)
+            {
+                // Sizes are selected one by one, a small gain is treated as noise
+                bestTime = measure(generic, best);
+                const int kBlocks[] = { 16, 64 }, stripePixels[] = { 28, 112 }, cBlocks[] = { 128, 512 };
+                for (int i = 0; i < 2; i++)
+                {
+                    FastConvBlocking blocking = best;
+                    blocking.kBlock = kBlocks[i];
+                    double t = measure(generic, blocking);
+                    if (t < bestTime * 0.97)
+                        bestTime = t, best = blocking;
+                }
+                for (int i = 0; i < 2; i++)
+                {
+                    FastConvBlocking blocking = best;
+                    blocking.stripePixels = stripePixels[i];
+                    double t = measure(generic, blocking);
+                    if (t < bestTime * 0.97)
+                        bestTime = t, best = blocking;
+                }
+                for (int i = 0; i < 2; i++)
+                {
+                    FastConvBlocking blocking = best;
+                    blocking.cBlock = cBlocks[i];
+                    double t = measure(generic, blocking);
+                    if (t < bestTime * 0.97)
+                        bestTime = t, best = blocking;
+                }
+            }
+
+            int bestType = winogradTime <= bestTime ? CONV_TYPE_WINOGRAD3X3 : CONV_TYPE_GENERIC;
+            params.assign(1, bestType);
+            params.push_back(best.kBlock);
+            params.push_back(best.cBlock);
+            params.push_back(best.stripePixels);
+            cache.put(key, params);
+            CV_LOG_DEBUG(NULL, "DNN/Autotune: " << name << " " << key << ": type=" << bestType
+                         << " kBlock=" << best.kBlock << " cBlock=" << best.cBlock
+                         << " stripePixels=" << best.stripePixels);
+            if (bestType != convType && generic)
+            {
+                fastConvImpl = generic;
+                fastConvKey = genericKey;
+            }
+        }
+        else if (params[0] != convType && params[0] == CONV_TYPE_GENERIC && packGeneric)
+        {
+            fastConvImpl = packGeneric(fastConvKey);
         }
+
+        fastConvBlocking.kBlock = params[1];
+        fastConvBlocking.cBlock = params[2];
+        fastConvBlocking.stripePixels = params[3];
     }
 
 #ifdef HAVE_CUDA
@@ -1458,7 +1686,16 @@ public:
         int karea = std::accumulate(kernel_size.begin(), kernel_size.end(), 1, std::multiplies<size_t>());
         for (int i = 0; i < outputs.size(); i++)
         {
-            flops += total(outputs[i])*(CV_BIG_INT(2)*karea*inputs[i][1] + 1);
+            // Zero blocks of pruned weights are skipped by the sparse kernel
+            double density = 1.0;
+            if (!blobs.empty() && kernel_size.size() == 2 && inputs[i][1] % blobs[0].size[1] == 0)
+            {
+                Mat weights = blobs[0].reshape(1, numOutput);
+                int ngroups = inputs[i][1] / blobs[0].size[1];
+                if (useSparseWeights(weights, ngroups))
+                    density = getBlockDensity(weights, ngroups);
+            }
+            flops += total(outputs[i])*((int64)(2.0*karea*inputs[i][1]*density) + 1);
         }
 
         return flops;
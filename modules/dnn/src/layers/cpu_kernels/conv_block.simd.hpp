@@ -10,6 +10,9 @@ CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
 
 void convBlock_F32(int np, const float* a, const float* b, float* c, int ldc, bool init_c, int width, const int convMR, const int convNR);
 
+// FP16 weights, FP32 inputs and accumulation (x86 with F16C). Only the AVX2 instance is implemented.
+void convBlock_F32_F16W(int np, const hfloat* a, const float* b, float* c, int ldc, bool init_c, int width,
+                        const int convMR, const int convNR);
 
 // FP 16 branch.
 void convBlock_F16(int np, const char * _a, const char * _b, char * _c, int ldc, bool init_c, int width,
@@ -131,6 +134,77 @@ void convBlock_F32(int np, const float* a, const float* b, float* c, int ldc, bo
     _mm256_zeroupper();
 }
 
+#if CV_AVX2
+// The same as convBlock_F32(), but CONV_MR weights of every step are stored in FP16
+// and converted by F16C. The loop is not split by width, because the block is loaded by 8 columns anyway.
+void convBlock_F32_F16W(int np, const hfloat* a, const float* b, float* c, int ldc, bool init_c, int width,
+                        const int convMR, const int convNR)
+{
+    CV_Assert(convMR == 4 && convNR == 24);
+    __m256 c00 = _mm256_setzero_ps(), c01 = c00, c02 = c00;
+    __m256 c10 = c00, c11 = c00, c12 = c00;
+    __m256 c20 = c00, c21 = c00, c22 = c00;
+    __m256 c30 = c00, c31 = c00, c32 = c00;
+    const int nb = width > 16 ? 3 : width > 8 ? 2 : 1;
+
+    for (int p = 0; p < np; p++, a += convMR, b += convNR)
+    {
+        __m128 a4 = _mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)a));
+        __m256 a0 = _mm256_broadcastss_ps(a4);
+        __m256 a1 = _mm256_broadcastss_ps(_mm_movehdup_ps(a4));
+        __m256 a2 = _mm256_broadcastss_ps(_mm_movehl_ps(a4, a4));
+        __m256 a3 = _mm256_broadcastss_ps(_mm_shuffle_ps(a4, a4, _MM_SHUFFLE(3, 3, 3, 3)));
+
+        __m256 b0 = _mm256_load_ps(b);
+        c00 = _mm256_fmadd_ps(b0, a0, c00);
+        c10 = _mm256_fmadd_ps(b0, a1, c10);
+        c20 = _mm256_fmadd_ps(b0, a2, c20);
+        c30 = _mm256_fmadd_ps(b0, a3, c30);
+        if (nb > 1)
+        {
+            __m256 b1 = _mm256_load_ps(b + 8);
+            c01 = _mm256_fmadd_ps(b1, a0, c01);
+            c11 = _mm256_fmadd_ps(b1, a1, c11);
+            c21 = _mm256_fmadd_ps(b1, a2, c21);
+            c31 = _mm256_fmadd_ps(b1, a3, c31);
+            if (nb > 2)
+            {
+                __m256 b2 = _mm256_load_ps(b + 16);
+                c02 = _mm256_fmadd_ps(b2, a0, c02);
+                c12 = _mm256_fmadd_ps(b2, a1, c12);
+                c22 = _mm256_fmadd_ps(b2, a2, c22);
+                c32 = _mm256_fmadd_ps(b2, a3, c32);
+            }
+        }
+    }
+
+    if (!init_c)
+    {
+        c00 = _mm256_add_ps(c00, _mm256_load_ps(c));
+        c01 = _mm256_add_ps(c01, _mm256_load_ps(c + 8));
+        c02 = _mm256_add_ps(c02, _mm256_load_ps(c + 16));
+
+        c10 = _mm256_add_ps(c10, _mm256_load_ps(c + ldc));
+        c11 = _mm256_add_ps(c11, _mm256_load_ps(c + ldc + 8));
+        c12 = _mm256_add_ps(c12, _mm256_load_ps(c + ldc + 16));
+
+        c20 = _mm256_add_ps(c20, _mm256_load_ps(c + ldc*2));
+        c21 = _mm256_add_ps(c21, _mm256_load_ps(c + ldc*2 + 8));
+        c22 = _mm256_add_ps(c22, _mm256_load_ps(c + ldc*2 + 16));
+
+        c30 = _mm256_add_ps(c30, _mm256_load_ps(c + ldc*3));
+        c31 = _mm256_add_ps(c31, _mm256_load_ps(c + ldc*3 + 8));
+        c32 = _mm256_add_ps(c32, _mm256_load_ps(c + ldc*3 + 16));
+    }
+
+    _mm256_storeu_ps(c, c00), _mm256_storeu_ps(c+8, c01), _mm256_storeu_ps(c+16, c02);
+    _mm256_storeu_ps(c + ldc, c10), _mm256_storeu_ps(c + ldc + 8, c11), _mm256_storeu_ps(c + ldc + 16, c12);
+    _mm256_storeu_ps(c + ldc*2, c20), _mm256_storeu_ps(c + ldc*2 + 8, c21), _mm256_storeu_ps(c + ldc*2 + 16, c22);
+    _mm256_storeu_ps(c + ldc*3, c30), _mm256_storeu_ps(c + ldc*3 + 8, c31), _mm256_storeu_ps(c + ldc*3 + 16, c32);
+    _mm256_zeroupper();
+}
+#endif
+
 #endif
 
 #if CV_NEON
@@ -0,0 +1,255 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+// INT8 convolution with the same blocking scheme as FP32 runFastConv():
+// the output plane is split into tiles of CONV_NR_INT8 pixels, input of every tile
+// is packed (im2col) once and multiplied by blocks of CONV_MR_INT8 packed output channels.
+
+#include "../../precomp.hpp"
+#include "convolution.hpp"
+
+#include "conv_int8_block.simd.hpp"
+#include "layers/cpu_kernels/conv_int8_block.simd_declarations.hpp" // defines CV_CPU_DISPATCH_MODES_ALL=AVX2,...,BASELINE based on CMakeLists.txt content
+
+namespace cv { namespace dnn {
+
+Ptr<FastConvInt8> initFastConvInt8(
+        InputArray _weightsMat,
+        int ngroups,
+        int K, int C,
+        const std::vector<size_t>& kernel_size,
+        const std::vector<size_t>& strides,
+        const std::vector<size_t>& dilations,
+        const std::vector<size_t>& pads_begin,
+        int inpZp)
+{
+    Ptr<FastConvInt8> conv = makePtr<FastConvInt8>();
+
+    CV_Assert(ngroups > 0 && K > 0 && C > 0 && K % ngroups == 0 && C % ngroups == 0);
+    CV_Assert(kernel_size.size() == 1 || kernel_size.size() == 2);
+    CV_Assert(kernel_size.size() == strides.size() && kernel_size.size() == dilations.size() &&
+              kernel_size.size() == pads_begin.size());
+
+    const bool conv1d = kernel_size.size() == 1;
+    conv->ngroups = ngroups;
+    conv->K = K; conv->C = C;
+    conv->Hk = conv1d ? 1 : (int)kernel_size[0];
+    conv->Wk = (int)kernel_size.back();
+    conv->stride_h = conv1d ? 1 : (int)strides[0];
+    conv->stride_w = (int)strides.back();
+    conv->dilation_h = conv1d ? 1 : (int)dilations[0];
+    conv->dilation_w = (int)dilations.back();
+    conv->pad_top = conv1d ? 0 : (int)pads_begin[0];
+    conv->pad_left = (int)pads_begin.back();
+    conv->inpZp = inpZp;
+
+    Mat weightsMat = _weightsMat.getMat();
+    CV_CheckTypeEQ(weightsMat.type(), CV_8S, "");
+    const int Kg = K/ngroups, Cg = C/ngroups;
+    const int KK = Cg*conv->Hk*conv->Wk;
+    CV_Assert(weightsMat.rows == K && weightsMat.cols >= KK);
+
+    const int Kblocks = conv->getKBlocks(), nquads = conv->getKQuads();
+    const size_t blocksize = (size_t)nquads*CONV_MR_INT8*4;
+    conv->weightsBuf.assign(ngroups*Kblocks*blocksize, 0);
+    conv->weightsSum.assign(ngroups*Kblocks*CONV_MR_INT8, 0);
+    int8_t* weightsBufPtr = conv->weightsBuf.data();
+    int* weightsSumPtr = conv->weightsSum.data();
+
+    // Layout: [g][k_block][quad][CONV_MR_INT8][4].
+    parallel_for_(Range(0, ngroups*Kblocks), [&](const Range& r0) {
+    for (int gk = r0.start; gk < r0.end; gk++)
+    {
+        int g = gk / Kblocks, k0 = (gk - g*Kblocks)*CONV_MR_INT8;
+        int8_t* packed_wptr = weightsBufPtr + gk*blocksize;
+        int dk = std::min(Kg - k0, CONV_MR_INT8);
+        for (int k = 0; k < dk; k++)
+        {
+            const int8_t* wptr = weightsMat.ptr<int8_t>(g*Kg + k0 + k);
+            int sum = 0;
+            for (int i = 0; i < KK; i++)
+            {
+                packed_wptr[((i >> 2)*CONV_MR_INT8 + k)*4 + (i & 3)] = wptr[i];
+                sum += wptr[i];
+            }
+            weightsSumPtr[gk*CONV_MR_INT8 + k] = sum;
+        }
+    }});
+
+    return conv;
+}
+
+static void convBlock_INT8(int np, const int8_t* a, const int8_t* b, int* c, int ldc, const int* wsum,
+                           const Ptr<FastConvInt8>& conv)
+{
+#if CV_TRY_AVX512_CLX
+    if (conv->useVNNI)
+        opt_AVX512_CLX::convBlock_INT8(np, a, b, c, ldc, wsum, CONV_MR_INT8, CONV_NR_INT8);
+    else
+#endif
+#if CV_TRY_AVX2
+    if (conv->useAVX2)
+        opt_AVX2::convBlock_INT8(np, a, b, c, ldc, wsum, CONV_MR_INT8, CONV_NR_INT8);
+    else
+#endif
+#if CV_TRY_NEON_DOTPROD && CV_NEON_AARCH64
+    if (conv->useNEON_DOTPROD)
+        opt_NEON_DOTPROD::convBlock_INT8(np, a, b, c, ldc, wsum, CONV_MR_INT8, CONV_NR_INT8);
+    else
+#endif
+        cpu_baseline::convBlock_INT8(np, a, b, c, ldc, wsum, CONV_MR_INT8, CONV_NR_INT8);
+}
+
+void runFastConvInt8(InputArray _input, OutputArray _output, const Ptr<FastConvInt8>& conv, int ntasks,
+                     const int* bias, const float* multiplier, int outZp, const int* activLUT)
+{
+    Mat input = _input.getMat();
+    Mat output = _output.getMat();
+    CV_Assert(conv);
+    CV_CheckTypeEQ(input.type(), CV_8S, "");
+    CV_CheckTypeEQ(output.type(), CV_8S, "");
+    CV_Assert(input.isContinuous() && output.isContinuous());
+    CV_Assert((input.dims == 3 || input.dims == 4) && output.dims == input.dims);
+    CV_Assert(bias && multiplier);
+
+    const int N = input.size[0], C = input.size[1];
+    const int Hi = input.dims == 4 ? input.size[2] : 1, Wi = input.size[input.dims - 1];
+    const int K = output.size[1];
+    const int H0 = output.dims == 4 ? output.size[2] : 1, W0 = output.size[output.dims - 1];
+    CV_Assert(output.size[0] == N && C == conv->C && K == conv->K);
+
+    const int ngroups = conv->ngroups, Kg = K/ngroups, Cg = C/ngroups;
+    const int Hk = conv->Hk, Wk = conv->Wk;
+    const int stride_h = conv->stride_h, stride_w = conv->stride_w;
+    const int dilation_h = conv->dilation_h, dilation_w = conv->dilation_w;
+    const int pad_top = conv->pad_top, pad_left = conv->pad_left;
+    const int8_t inpZp = saturate_cast<int8_t>(conv->inpZp);
+    const int KK = Cg*Hk*Wk;
+    const int Kblocks = conv->getKBlocks(), nquads = conv->getKQuads();
+    const size_t inp_planesize = (size_t)Hi*Wi, out_planesize = (size_t)H0*W0;
+    const int ntiles = (int)((out_planesize + CONV_NR_INT8 - 1)/CONV_NR_INT8);
+    const bool conv1x1 = Hk == 1 && Wk == 1 && stride_h == 1 && stride_w == 1 &&
+                         pad_top == 0 && pad_left == 0 && H0 == Hi && W0 == Wi;
+
+    // When there are not enough tiles, output channels are split as well to load all the threads.
+    int kchunks = 1;
+    while ((size_t)N*ngroups*ntiles*kchunks < (size_t)ntasks*4 && Kblocks >= kchunks*8)
+        kchunks *= 2;
+    const int kblocks_per_chunk = (Kblocks + kchunks - 1)/kchunks;
+
+    const int8_t* inp0 = input.ptr<int8_t>();
+    int8_t* out0 = output.ptr<int8_t>();
+    const int8_t* weights0 = conv->weightsBuf.data();
+    const int* wsum0 = conv->weightsSum.data();
+    const size_t wblocksize = (size_t)nquads*CONV_MR_INT8*4;
+    const size_t total = (size_t)N*ngroups*ntiles*kchunks;
+
+    parallel_for_(Range(0, (int)total), [&](const Range& r0) {
+        AutoBuffer<int8_t> inpbuf_((size_t)nquads*CONV_NR_INT8*4);
+        AutoBuffer<int> cbuf_(CONV_MR_INT8*CONV_NR_INT8);
+        AutoBuffer<int> ofsbuf_(CONV_NR_INT8*2);
+        int8_t* inpbuf = inpbuf_.data();
+        int* cbuf = cbuf_.data();
+        int* yofs = ofsbuf_.data();
+        int* xofs = yofs + CONV_NR_INT8;
+
+        for (int task = r0.start; task < r0.end; task++)
+        {
+            int kchunk = task % kchunks;
+            int tile = (task / kchunks) % ntiles;
+            int ng = task / (kchunks*ntiles);
+            int n = ng / ngroups, g = ng - n*ngroups;
+            int p0 = tile*CONV_NR_INT8;
+            int len = (int)std::min((size_t)CONV_NR_INT8, out_planesize - p0);
+            const int8_t* inptr = inp0 + (n*C + g*Cg)*inp_planesize;
+
+            // Pack the input tile as [quad][CONV_NR_INT8][4]. Padding pixels get the input zero point,
+            // so they don't contribute to the result; padding channels and columns are zero.
+            if (len < CONV_NR_INT8 || KK % 4 != 0)
+                memset(inpbuf, 0, (size_t)nquads*CONV_NR_INT8*4);
+
+            if (conv1x1)
+            {
+                for (int k = 0; k < KK; k++)
+                {
+                    const int8_t* src = inptr + k*inp_planesize + p0;
+                    int8_t* dst = inpbuf + (k >> 2)*CONV_NR_INT8*4 + (k & 3);
+                    for (int j = 0; j < len; j++)
+                        dst[j*4] = src[j];
+                }
+            }
+            else
+            {
+                for (int j = 0; j < len; j++)
+                {
+                    int y0 = (p0 + j) / W0, x0 = p0 + j - y0*W0;
+                    yofs[j] = y0*stride_h - pad_top;
+                    xofs[j] = x0*stride_w - pad_left;
+                }
+                for (int c = 0, k = 0; c < Cg; c++)
+                {
+                    const int8_t* src = inptr + c*inp_planesize;
+                    for (int ky = 0; ky < Hk; ky++)
+                    {
+                        for (int kx = 0; kx < Wk; kx++, k++)
+                        {
+                            int dy = ky*dilation_h, dx = kx*dilation_w;
+                            int8_t* dst = inpbuf + (k >> 2)*CONV_NR_INT8*4 + (k & 3);
+                            for (int j = 0; j < len; j++)
+                            {
+                                int yi = yofs[j] + dy, xi = xofs[j] + dx;
+                                dst[j*4] = (unsigned)yi < (unsigned)Hi && (unsigned)xi < (unsigned)Wi ?
+                                           src[yi*Wi + xi] : inpZp;
+                            }
+                        }
+                    }
+                }
+            }
+
+            int kb0 = kchunk*kblocks_per_chunk, kb1 = std::min(kb0 + kblocks_per_chunk, Kblocks);
+            for (int kb = kb0; kb < kb1; kb++)
+            {
+                size_t gkb = (size_t)g*Kblocks + kb;
+                convBlock_INT8(nquads, weights0 + gkb*wblocksize, inpbuf, cbuf, CONV_NR_INT8,
+                               wsum0 + gkb*CONV_MR_INT8, conv);
+
+                // Requantize the block: bias, scale, output zero point and activation.
+                int k0 = kb*CONV_MR_INT8, dk = std::min(Kg - k0, CONV_MR_INT8);
+                for (int i = 0; i < dk; i++)
+                {
+                    int k = g*Kg + k0 + i;
+                    const int* cptr = cbuf + i*CONV_NR_INT8;
+                    int8_t* outptr = out0 + (n*K + k)*out_planesize + p0;
+                    int biasval = bias[k];
+                    float mult = multiplier[k];
+                    int j = 0;
+                    if (activLUT)
+                    {
+                        for (; j < len; j++)
+                        {
+                            int v = outZp + cvRound((cptr[j] + biasval)*mult);
+                            outptr[j] = (int8_t)activLUT[std::min(std::max(v, -128), 127) + 128];
+                        }
+                        continue;
+                    }
+#if CV_SIMD128
+                    v_int32x4 vbias = v_setall_s32(biasval), vzp = v_setall_s32(outZp);
+                    v_float32x4 vmult = v_setall_f32(mult);
+                    for (; j <= len - 8; j += 8)
+                    {
+                        v_int32x4 s0 = v_add(v_load(cptr + j), vbias), s1 = v_add(v_load(cptr + j + 4), vbias);
+                        s0 = v_add(vzp, v_round(v_mul(v_cvt_f32(s0), vmult)));
+                        s1 = v_add(vzp, v_round(v_mul(v_cvt_f32(s1), vmult)));
+                        v_pack_store(outptr + j, v_pack(s0, s1));  // saturates to [-128, 127]
+                    }
+#endif
+                    for (; j < len; j++)
+                        outptr[j] = saturate_cast<int8_t>(outZp + cvRound((cptr[j] + biasval)*mult));
+                }
+            }
+        }
+    }, ntasks);
+}
+
+}} // namespace cv::dnn
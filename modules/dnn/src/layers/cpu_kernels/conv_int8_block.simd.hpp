@@ -0,0 +1,214 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace dnn {
+CV_CPU_OPTIMIZATION_NAMESPACE_BEGIN
+
+// Computes c[i][j] = sum_p(a[p][i][0..3] * b[p][j][0..3]) for the block of convMR x convNR int32 outputs.
+// a is [np][convMR][4] packed weights, b is [np][convNR][4] packed inputs,
+// wsum contains sums of the convMR rows of weights (required by kernels which use unsigned inputs).
+void convBlock_INT8(int np, const int8_t* a, const int8_t* b, int* c, int ldc, const int* wsum,
+                    const int convMR, const int convNR);
+
+#if !defined(CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY)
+
+#if CV_AVX2
+
+#if CV_AVX_512VNNI
+// VNNI multiplies unsigned bytes by signed ones, so inputs are shifted by 128 and
+// the result is corrected by 128*sum(weights) at the end.
+#define CONV_INT8_LOAD_B(bv, ptr) \
+    __m256i bv = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(ptr)), _mm256_set1_epi8((char)0x80))
+#define CONV_INT8_LOAD_A(av, ptr) \
+    __m256i av = _mm256_set1_epi32(*(const int*)(ptr))
+#define CONV_INT8_DOT(c, bv, av) c = _mm256_dpbusd_epi32(c, bv, av)
+#else
+// Exact emulation: even and odd bytes are sign-extended to 16 bits and multiplied by pairs.
+#define CONV_INT8_SPLIT(v, x) \
+    __m256i v##e = _mm256_srai_epi16(_mm256_slli_epi16(x, 8), 8), v##o = _mm256_srai_epi16(x, 8)
+#define CONV_INT8_LOAD_B(bv, ptr) \
+    CONV_INT8_SPLIT(bv, _mm256_loadu_si256((const __m256i*)(ptr)))
+#define CONV_INT8_LOAD_A(av, ptr) \
+    CONV_INT8_SPLIT(av, _mm256_set1_epi32(*(const int*)(ptr)))
+#define CONV_INT8_DOT(c, bv, av) \
+    c = _mm256_add_epi32(c, _mm256_add_epi32(_mm256_madd_epi16(bv##e, av##e), _mm256_madd_epi16(bv##o, av##o)))
+#endif
+
+void convBlock_INT8(int np, const int8_t* a, const int8_t* b, int* c, int ldc, const int* wsum,
+                    const int convMR, const int convNR)
+{
+    CV_Assert(convMR == 4 && convNR == 24);
+    __m256i c00 = _mm256_setzero_si256(), c01 = c00, c02 = c00;
+    __m256i c10 = c00, c11 = c00, c12 = c00;
+    __m256i c20 = c00, c21 = c00, c22 = c00;
+    __m256i c30 = c00, c31 = c00, c32 = c00;
+
+    for (int p = 0; p < np; p++, a += convMR*4, b += convNR*4)
+    {
+        CONV_INT8_LOAD_B(b0, b);
+        CONV_INT8_LOAD_B(b1, b + 32);
+        CONV_INT8_LOAD_B(b2, b + 64);
+
+        CONV_INT8_LOAD_A(a0, a);
+        CONV_INT8_DOT(c00, b0, a0); CONV_INT8_DOT(c01, b1, a0); CONV_INT8_DOT(c02, b2, a0);
+        CONV_INT8_LOAD_A(a1, a + 4);
+        CONV_INT8_DOT(c10, b0, a1); CONV_INT8_DOT(c11, b1, a1); CONV_INT8_DOT(c12, b2, a1);
+        CONV_INT8_LOAD_A(a2, a + 8);
+        CONV_INT8_DOT(c20, b0, a2); CONV_INT8_DOT(c21, b1, a2); CONV_INT8_DOT(c22, b2, a2);
+        CONV_INT8_LOAD_A(a3, a + 12);
+        CONV_INT8_DOT(c30, b0, a3); CONV_INT8_DOT(c31, b1, a3); CONV_INT8_DOT(c32, b2, a3);
+    }
+
+#if CV_AVX_512VNNI
+    __m256i s = _mm256_set1_epi32(wsum[0] * 128);
+    c00 = _mm256_sub_epi32(c00, s); c01 = _mm256_sub_epi32(c01, s); c02 = _mm256_sub_epi32(c02, s);
+    s = _mm256_set1_epi32(wsum[1] * 128);
+    c10 = _mm256_sub_epi32(c10, s); c11 = _mm256_sub_epi32(c11, s); c12 = _mm256_sub_epi32(c12, s);
+    s = _mm256_set1_epi32(wsum[2] * 128);
+    c20 = _mm256_sub_epi32(c20, s); c21 = _mm256_sub_epi32(c21, s); c22 = _mm256_sub_epi32(c22, s);
+    s = _mm256_set1_epi32(wsum[3] * 128);
+    c30 = _mm256_sub_epi32(c30, s); c31 = _mm256_sub_epi32(c31, s); c32 = _mm256_sub_epi32(c32, s);
+#else
+    CV_UNUSED(wsum);
+#endif
+
+    _mm256_storeu_si256((__m256i*)c, c00);
+    _mm256_storeu_si256((__m256i*)(c + 8), c01);
+    _mm256_storeu_si256((__m256i*)(c + 16), c02);
+    _mm256_storeu_si256((__m256i*)(c + ldc), c10);
+    _mm256_storeu_si256((__m256i*)(c + ldc + 8), c11);
+    _mm256_storeu_si256((__m256i*)(c + ldc + 16), c12);
+    _mm256_storeu_si256((__m256i*)(c + ldc*2), c20);
+    _mm256_storeu_si256((__m256i*)(c + ldc*2 + 8), c21);
+    _mm256_storeu_si256((__m256i*)(c + ldc*2 + 16), c22);
+    _mm256_storeu_si256((__m256i*)(c + ldc*3), c30);
+    _mm256_storeu_si256((__m256i*)(c + ldc*3 + 8), c31);
+    _mm256_storeu_si256((__m256i*)(c + ldc*3 + 16), c32);
+}
+
+#undef CONV_INT8_LOAD_A
+#undef CONV_INT8_LOAD_B
+#undef CONV_INT8_DOT
+#ifdef CONV_INT8_SPLIT
+#undef CONV_INT8_SPLIT
+#endif
+
+#elif defined(CV_NEON_DOT) && CV_NEON_AARCH64
+
+void convBlock_INT8(int np, const int8_t* a, const int8_t* b, int* c, int ldc, const int* wsum,
+                    const int convMR, const int convNR)
+{
+    CV_Assert(convMR == 4 && convNR == 24);
+    CV_UNUSED(wsum);
+    int32x4_t c00 = vdupq_n_s32(0), c01 = c00, c02 = c00, c03 = c00, c04 = c00, c05 = c00;
+    int32x4_t c10 = c00, c11 = c00, c12 = c00, c13 = c00, c14 = c00, c15 = c00;
+    int32x4_t c20 = c00, c21 = c00, c22 = c00, c23 = c00, c24 = c00, c25 = c00;
+    int32x4_t c30 = c00, c31 = c00, c32 = c00, c33 = c00, c34 = c00, c35 = c00;
+
+    for (int p = 0; p < np; p++, a += convMR*4, b += convNR*4)
+    {
+        // 4 bytes of weights of every row of the block fit into a single register.
+        int8x16_t a0 = vld1q_s8(a);
+        int8x16_t b0 = vld1q_s8(b), b1 = vld1q_s8(b + 16), b2 = vld1q_s8(b + 32);
+        int8x16_t b3 = vld1q_s8(b + 48), b4 = vld1q_s8(b + 64), b5 = vld1q_s8(b + 80);
+
+        c00 = vdotq_laneq_s32(c00, b0, a0, 0); c01 = vdotq_laneq_s32(c01, b1, a0, 0);
+        c02 = vdotq_laneq_s32(c02, b2, a0, 0); c03 = vdotq_laneq_s32(c03, b3, a0, 0);
+        c04 = vdotq_laneq_s32(c04, b4, a0, 0); c05 = vdotq_laneq_s32(c05, b5, a0, 0);
+
+        c10 = vdotq_laneq_s32(c10, b0, a0, 1); c11 = vdotq_laneq_s32(c11, b1, a0, 1);
+        c12 = vdotq_laneq_s32(c12, b2, a0, 1); c13 = vdotq_laneq_s32(c13, b3, a0, 1);
+        c14 = vdotq_laneq_s32(c14, b4, a0, 1); c15 = vdotq_laneq_s32(c15, b5, a0, 1);
+
+        c20 = vdotq_laneq_s32(c20, b0, a0, 2); c21 = vdotq_laneq_s32(c21, b1, a0, 2);
+        c22 = vdotq_laneq_s32(c22, b2, a0, 2); c23 = vdotq_laneq_s32(c23, b3, a0, 2);
+        c24 = vdotq_laneq_s32(c24, b4, a0, 2); c25 = vdotq_laneq_s32(c25, b5, a0, 2);
+
+        c30 = vdotq_laneq_s32(c30, b0, a0, 3); c31 = vdotq_laneq_s32(c31, b1, a0, 3);
+        c32 = vdotq_laneq_s32(c32, b2, a0, 3); c33 = vdotq_laneq_s32(c33, b3, a0, 3);
+        c34 = vdotq_laneq_s32(c34, b4, a0, 3); c35 = vdotq_laneq_s32(c35, b5, a0, 3);
+    }
+
+    vst1q_s32(c, c00); vst1q_s32(c + 4, c01); vst1q_s32(c + 8, c02);
+    vst1q_s32(c + 12, c03); vst1q_s32(c + 16, c04); vst1q_s32(c + 20, c05);
+    vst1q_s32(c + ldc, c10); vst1q_s32(c + ldc + 4, c11); vst1q_s32(c + ldc + 8, c12);
+    vst1q_s32(c + ldc + 12, c13); vst1q_s32(c + ldc + 16, c14); vst1q_s32(c + ldc + 20, c15);
+    vst1q_s32(c + ldc*2, c20); vst1q_s32(c + ldc*2 + 4, c21); vst1q_s32(c + ldc*2 + 8, c22);
+    vst1q_s32(c + ldc*2 + 12, c23); vst1q_s32(c + ldc*2 + 16, c24); vst1q_s32(c + ldc*2 + 20, c25);
+    vst1q_s32(c + ldc*3, c30); vst1q_s32(c + ldc*3 + 4, c31); vst1q_s32(c + ldc*3 + 8, c32);
+    vst1q_s32(c + ldc*3 + 12, c33); vst1q_s32(c + ldc*3 + 16, c34); vst1q_s32(c + ldc*3 + 20, c35);
+}
+
+#else
+
+void convBlock_INT8(int np, const int8_t* a, const int8_t* b, int* c, int ldc, const int* wsum,
+                    const int convMR, const int convNR)
+{
+    CV_UNUSED(wsum);
+#if CV_SIMD128
+    if (convMR == 4 && convNR % 12 == 0)
+    {
+        // Columns are processed by 12 to keep all the accumulators in registers.
+        for (int j0 = 0; j0 < convNR; j0 += 12)
+        {
+            v_int32x4 c00 = v_setzero_s32(), c01 = c00, c02 = c00;
+            v_int32x4 c10 = c00, c11 = c00, c12 = c00;
+            v_int32x4 c20 = c00, c21 = c00, c22 = c00;
+            v_int32x4 c30 = c00, c31 = c00, c32 = c00;
+            const int8_t* aptr = a;
+            const int8_t* bptr = b + j0*4;
+
+            for (int p = 0; p < np; p++, aptr += convMR*4, bptr += convNR*4)
+            {
+                v_int8x16 b0 = v_load(bptr), b1 = v_load(bptr + 16), b2 = v_load(bptr + 32);
+                const int* wptr = (const int*)aptr;
+
+                v_int8x16 a0 = v_reinterpret_as_s8(v_setall_s32(wptr[0]));
+                c00 = v_dotprod_expand(b0, a0, c00); c01 = v_dotprod_expand(b1, a0, c01); c02 = v_dotprod_expand(b2, a0, c02);
+                a0 = v_reinterpret_as_s8(v_setall_s32(wptr[1]));
+                c10 = v_dotprod_expand(b0, a0, c10); c11 = v_dotprod_expand(b1, a0, c11); c12 = v_dotprod_expand(b2, a0, c12);
+                a0 = v_reinterpret_as_s8(v_setall_s32(wptr[2]));
+                c20 = v_dotprod_expand(b0, a0, c20); c21 = v_dotprod_expand(b1, a0, c21); c22 = v_dotprod_expand(b2, a0, c22);
+                a0 = v_reinterpret_as_s8(v_setall_s32(wptr[3]));
+                c30 = v_dotprod_expand(b0, a0, c30); c31 = v_dotprod_expand(b1, a0, c31); c32 = v_dotprod_expand(b2, a0, c32);
+            }
+
+            int* cptr = c + j0;
+            v_store(cptr, c00); v_store(cptr + 4, c01); v_store(cptr + 8, c02);
+            v_store(cptr + ldc, c10); v_store(cptr + ldc + 4, c11); v_store(cptr + ldc + 8, c12);
+            v_store(cptr + ldc*2, c20); v_store(cptr + ldc*2 + 4, c21); v_store(cptr + ldc*2 + 8, c22);
+            v_store(cptr + ldc*3, c30); v_store(cptr + ldc*3 + 4, c31); v_store(cptr + ldc*3 + 8, c32);
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < convMR; i++)
+    {
+        for (int j = 0; j < convNR; j++)
+            c[i*ldc + j] = 0;
+    }
+    for (int p = 0; p < np; p++, a += convMR*4, b += convNR*4)
+    {
+        for (int i = 0; i < convMR; i++)
+        {
+            const int8_t* aptr = a + i*4;
+            int* cptr = c + i*ldc;
+            for (int j = 0; j < convNR; j++)
+            {
+                const int8_t* bptr = b + j*4;
+                cptr[j] += aptr[0]*bptr[0] + aptr[1]*bptr[1] + aptr[2]*bptr[2] + aptr[3]*bptr[3];
+            }
+        }
+    }
+}
+
+#endif
+
+#endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
+
+CV_CPU_OPTIMIZATION_NAMESPACE_END
+}} // namespace cv::dnn
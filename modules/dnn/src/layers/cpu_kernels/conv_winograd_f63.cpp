@@ -222,13 +222,13 @@ int runWinograd63(InputArray _input, InputArray _fusedAddMat, OutputArray _outpu
 #ifdef CONV_ARM_FP16
     if (useFP16)
     {
-        CV_Assert(!conv->weightsWinoBuf_FP16.empty());
+        CV_Assert(conv->hasWeightsWinoFP16());
         wptr0 = (char *)conv->getWeightsWinoFP16();
     }
     else
 #endif
     {
-        CV_Assert(!conv->weightsWinoBuf.empty());
+        CV_Assert(conv->hasWeightsWino());
         wptr0 = (char *)conv->getWeightsWino();
     }
 
@@ -64,26 +64,124 @@ static inline void _cvt32f16f(const float* src, __fp16* dst, int len)
 }
 #endif
 
+// DNN_TARGET_CPU_FP16 on x86: FP16 weights are converted by F16C in the AVX2 kernel.
+static bool haveFP16Weights(const FastConv& conv)
+{
+#if CV_TRY_AVX2
+    return conv.useAVX2 && checkHardwareSupport(CPU_FP16);
+#else
+    CV_UNUSED(conv);
+    return false;
+#endif
+}
+
 float* FastConv::getWeights()
 {
+    if (!importedWeights.empty())
+        return importedWeights.ptr<float>();
     return alignPtr(weightsBuf.data(), VEC_ALIGN);
 }
 
 float* FastConv::getWeightsWino()
 {
+    if (!importedWeightsWino.empty())
+        return importedWeightsWino.ptr<float>();
     return alignPtr(weightsWinoBuf.data(), VEC_ALIGN);
 }
 
 hfloat* FastConv::getWeightsFP16()
 {
+    if (!importedWeightsFP16.empty())
+        return importedWeightsFP16.ptr<hfloat>();
     return alignPtr(weightsBuf_FP16.data(), VEC_ALIGN);
 }
 
 hfloat* FastConv::getWeightsWinoFP16()
 {
+    if (!importedWeightsWinoFP16.empty())
+        return importedWeightsWinoFP16.ptr<hfloat>();
     return alignPtr(weightsWinoBuf_FP16.data(), VEC_ALIGN);
 }
 
+// Packed weights start from the aligned address, so only this part of the buffer is exported.
+template<typename T>
+static Mat exportAlignedBuf(const std::vector<T>& buf, const Mat& imported, int type)
+{
+    if (!imported.empty())
+        return imported;
+    if (buf.empty())
+        return Mat();
+    const T* ptr = alignPtr((T*)buf.data(), VEC_ALIGN);
+    return Mat(1, (int)(buf.data() + buf.size() - ptr), type, (void*)ptr);
+}
+
+// Aligned data is used as is (usually it refers to the mapped file), other data is copied into the buffer.
+template<typename T>
+static void importAlignedBuf(const Mat& m, std::vector<T>& buf, Mat& imported)
+{
+    buf.clear();
+    imported.release();
+    if (m.empty())
+        return;
+    CV_Assert(m.isContinuous() && m.elemSize() == sizeof(T));
+    if (isAligned<VEC_ALIGN>(m.data))
+    {
+        imported = m.reshape(1, 1);
+        return;
+    }
+    buf.resize(m.total() + VEC_ALIGN);
+    memcpy(alignPtr(buf.data(), VEC_ALIGN), m.data, m.total()*sizeof(T));
+}
+
+void exportFastConv(const FastConv& conv, std::vector<Mat>& data)
+{
+    const int params[] = {
+        conv.ngroups, conv.K, conv.C, conv.Hk, conv.Wk, conv.Dk,
+        conv.stride_h, conv.stride_w, conv.stride_d,
+        conv.dilation_h, conv.dilation_w, conv.dilation_d,
+        conv.pad_top, conv.pad_bottom, conv.pad_left, conv.pad_right, conv.pad_front, conv.pad_behind,
+        conv.conv_type, conv.conv_dim, (int)conv.useFP16, (int)conv.useFP16Weights
+    };
+    data.resize(6);
+    Mat(1, (int)(sizeof(params)/sizeof(params[0])), CV_32S, (void*)params).copyTo(data[0]);
+    data[1] = exportAlignedBuf(conv.weightsBuf, conv.importedWeights, CV_32F);
+    data[2] = exportAlignedBuf(conv.weightsWinoBuf, conv.importedWeightsWino, CV_32F);
+    data[3] = conv.biasBuf.empty() ? Mat() : Mat(conv.biasBuf, false);
+    data[4] = exportAlignedBuf(conv.weightsBuf_FP16, conv.importedWeightsFP16, CV_16F);
+    data[5] = exportAlignedBuf(conv.weightsWinoBuf_FP16, conv.importedWeightsWinoFP16, CV_16F);
+}
+
+Ptr<FastConv> importFastConv(const std::vector<Mat>& data)
+{
+    CV_CheckEQ(data.size(), (size_t)6, "DNN: unexpected packed convolution weights");
+    CV_CheckTypeEQ(data[0].type(), CV_32S, "");
+    CV_CheckEQ(data[0].total(), (size_t)22, "DNN: unexpected packed convolution weights");
+
+    Ptr<FastConv> conv = makePtr<FastConv>();
+    const int* params = data[0].ptr<int>();
+    conv->ngroups = params[0]; conv->K = params[1]; conv->C = params[2];
+    conv->Hk = params[3]; conv->Wk = params[4]; conv->Dk = params[5];
+    conv->stride_h = params[6]; conv->stride_w = params[7]; conv->stride_d = params[8];
+    conv->dilation_h = params[9]; conv->dilation_w = params[10]; conv->dilation_d = params[11];
+    conv->pad_top = params[12]; conv->pad_bottom = params[13]; conv->pad_left = params[14];
+    conv->pad_right = params[15]; conv->pad_front = params[16]; conv->pad_behind = params[17];
+    conv->conv_type = params[18]; conv->conv_dim = params[19]; conv->useFP16 = params[20] != 0;
+    conv->useFP16Weights = params[21] != 0;
+    if (conv->useFP16 && !checkHardwareSupport(CPU_NEON_FP16))
+        return Ptr<FastConv>();
+    if (conv->useFP16Weights && !haveFP16Weights(*conv))
+        return Ptr<FastConv>();
+
+    importAlignedBuf(data[1], conv->weightsBuf, conv->importedWeights);
+    importAlignedBuf(data[2], conv->weightsWinoBuf, conv->importedWeightsWino);
+    // Bias is small (K values), so it is copied.
+    if (!data[3].empty())
+        data[3].reshape(1, 1).copyTo(conv->biasBuf);
+    importAlignedBuf(data[4], conv->weightsBuf_FP16, conv->importedWeightsFP16);
+    importAlignedBuf(data[5], conv->weightsWinoBuf_FP16, conv->importedWeightsWinoFP16);
+    return conv;
+}
+
 Ptr<FastConv> initFastConv(
         InputArray _weightsMat,
         float* srcBias,
@@ -191,6 +289,8 @@ Ptr<FastConv> initFastConv(
         CV_LOG_ONCE_WARNING(NULL, "DNN: the CPU does not support the instruction set required by FP16, fallback to FP32.");
     }
 #endif
+    if (_useFP16 && conv->conv_type == CONV_TYPE_GENERIC && haveFP16Weights(*conv))
+        conv->useFP16Weights = true;
 
     float *srcWeights = (float *)weightsMat.data;
     if (conv->conv_type == CONV_TYPE_DEPTHWISE || conv->conv_type == CONV_TYPE_DEPTHWISE_REMAIN)
@@ -442,6 +542,15 @@ Ptr<FastConv> initFastConv(
                 }
             }});
         }
+
+        // Weights are packed in FP32 and converted, the layout is the same.
+        if (conv->useFP16Weights)
+        {
+            conv->weightsBuf_FP16.resize(nweights + VEC_ALIGN);
+            Mat dst(1, (int)nweights, CV_16F, conv->getWeightsFP16());
+            Mat(1, (int)nweights, CV_32F, weightsPtr).convertTo(dst, CV_16F);
+            std::vector<float>().swap(conv->weightsBuf);
+        }
     }
     else
         CV_Error(cv::Error::StsUnsupportedFormat, "Unknown convolution type.");
@@ -1095,8 +1204,22 @@ static inline void packInputData(char* inpbuf_task, float* inp, const int* ofsta
     }
 }
 
+std::string fastConvKernelName(const FastConv& conv)
+{
+    std::string name = conv.conv_type == CONV_TYPE_WINOGRAD3X3 ? "FastConv/Winograd" :
+                       conv.conv_type == CONV_TYPE_DEPTHWISE ? "FastConv/depthwise" :
+                       conv.conv_type == CONV_TYPE_DEPTHWISE_REMAIN ? "FastConv/depthwise_generic" :
+                       "FastConv/generic";
+    if (conv.useFP16)
+        name += "/FP16";
+    else if (conv.useFP16Weights)
+        name += "/FP16_weights";
+    return name;
+}
+
 void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& conv, int ntasks,
-                   const Ptr<ActivationLayer>& actLayer, const std::vector<float>& reluslope, bool fusedAdd)
+                   const Ptr<ActivationLayer>& actLayer, const std::vector<float>& reluslope, bool fusedAdd,
+                   const FastConvBlocking& blocking)
 {
     Mat input = _input.getMat();
     Mat output = _output.getMat();
@@ -1168,7 +1291,7 @@ void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& co
 
     if (conv->conv_type == CONV_TYPE_WINOGRAD3X3) // winograd
     {
-        CV_Assert((!conv->weightsWinoBuf.empty() || !conv->weightsWinoBuf_FP16.empty()) && input.dims == 4 && conv_dim == CONV_2D);
+        CV_Assert((conv->hasWeightsWino() || conv->hasWeightsWinoFP16()) && input.dims == 4 && conv_dim == CONV_2D);
         if (runWinograd63(input, fusedAddMat, output, conv, ntasks, minval, maxval, activ, ifMinMaxAct))
             return;
     }
@@ -1260,12 +1383,17 @@ void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& co
         esz = sizeof(__fp16);
     }
 #endif
+    // size of the packed weights element, inputs are FP32 if only the weights are FP16.
+    const int wesz = conv->useFP16Weights ? (int)sizeof(hfloat) : esz;
 
-    int MAX_STRIPES = conv->conv_type == CONV_TYPE_DEPTHWISE_REMAIN ? 1 : (56 + CONV_NR - 1)/CONV_NR;
+    CV_Assert_N(blocking.kBlock > 0, blocking.cBlock > 0, blocking.stripePixels > 0);
+    int MAX_STRIPES = conv->conv_type == CONV_TYPE_DEPTHWISE_REMAIN ? 1 :
+            (blocking.stripePixels + CONV_NR - 1)/CONV_NR;
 
-    // Friendly to L1 cache
-    const int K_BLOCK_SIZE = conv->conv_type == CONV_TYPE_DEPTHWISE_REMAIN ? 1 : 32;
-    const int C_BLOCK_SIZE = 256;
+    // Friendly to L1 cache. K blocks are processed by CONV_MR channels.
+    const int K_BLOCK_SIZE = conv->conv_type == CONV_TYPE_DEPTHWISE_REMAIN ? 1 :
+            alignSize(blocking.kBlock, CONV_MR);
+    const int C_BLOCK_SIZE = blocking.cBlock;
 
     int Kg_nblocks = (Kg + CONV_MR-1)/CONV_MR;
     int Kg_aligned = Kg_nblocks * CONV_MR;
@@ -1427,13 +1555,19 @@ void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& co
 #ifdef CONV_ARM_FP16
                 if (useFP16)
                 {
-                    CV_Assert(!conv->weightsBuf_FP16.empty());
+                    CV_Assert(conv->hasWeightsFP16());
                     weights = (char *)conv->getWeightsFP16();
                 }
                 else
 #endif
+                if (conv->useFP16Weights)
+                {
+                    CV_Assert(conv->hasWeightsFP16());
+                    weights = (char *)conv->getWeightsFP16();
+                }
+                else
                 {
-                    CV_Assert(!conv->weightsBuf.empty());
+                    CV_Assert(conv->hasWeights());
                     weights = (char *)conv->getWeights();
                 }
                 // optional branch, only for depth-wise convolution which was implemented by generic convolution.
@@ -1489,7 +1623,7 @@ void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& co
                 }
 
                 CV_Assert(weights);
-                weights += g * Kg_aligned * DkHkWkCg * esz;
+                weights += g * Kg_aligned * DkHkWkCg * wesz;
 
                 const float *biasptr = conv->biasBuf.data() + Kg * g;
                 int ldc = nstripes * CONV_NR;
@@ -1509,14 +1643,16 @@ void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& co
                         {
                             const int outLen = std::min(out_width - stripe * CONV_NR, CONV_NR);
 
-                            char *wptr = weights + (k0_block * DkHkWkCg + c0 * CONV_MR) * esz;
+                            char *wptr = weights + (k0_block * DkHkWkCg + c0 * CONV_MR) * wesz;
                             float *cptr = cbuf_task + stripe * CONV_NR;
                             hfloat* cptr_f16 = (hfloat*)cbuf_task + stripe*CONV_NR;
                             for (int k = k0_block; k < k1_block; k += CONV_MR,
-                                    wptr += DkHkWkCg * CONV_MR * esz, cptr += CONV_MR * ldc, cptr_f16 += CONV_MR * ldc)
+                                    wptr += DkHkWkCg * CONV_MR * wesz, cptr += CONV_MR * ldc, cptr_f16 += CONV_MR * ldc)
                             {
 #if CV_TRY_AVX2
-                                if (conv->useAVX2)
+                                if (conv->useFP16Weights)
+                                    opt_AVX2::convBlock_F32_F16W(c1 - c0, (const hfloat *)wptr, (const float *)inptr, cptr, ldc, c0 == 0, outLen, CONV_MR, CONV_NR);
+                                else if (conv->useAVX2)
                                     opt_AVX2::convBlock_F32(c1 - c0, (const float *)wptr, (const float *)inptr, cptr, ldc, c0 == 0, outLen, CONV_MR, CONV_NR);
                                 else
 #endif
@@ -32,6 +32,11 @@
 #define CONV_NR_FP32 24
 #endif
 
+// INT8 convolution: each step of the micro-kernel multiplies MR x 4 weights by 4 x NR inputs,
+// which maps onto 4-way int8 dot product instructions (AVX-512 VNNI, ARMv8.2 SDOT).
+#define CONV_MR_INT8 4
+#define CONV_NR_INT8 24
+
 enum {
     CONV_WINO_STEP=6,
     CONV_WINO_KSIZE=3,
@@ -67,9 +72,20 @@ struct FastConv
     hfloat* getWeightsFP16();
     hfloat* getWeightsWinoFP16();
 
+    // Packed weights loaded with the compiled network (see importFastConv()). They refer to
+    // the mapped file and are used instead of the buffers above, which are empty in this case.
+    Mat importedWeights, importedWeightsWino, importedWeightsFP16, importedWeightsWinoFP16;
+    bool hasWeights() const { return !weightsBuf.empty() || !importedWeights.empty(); }
+    bool hasWeightsWino() const { return !weightsWinoBuf.empty() || !importedWeightsWino.empty(); }
+    bool hasWeightsFP16() const { return !weightsBuf_FP16.empty() || !importedWeightsFP16.empty(); }
+    bool hasWeightsWinoFP16() const { return !weightsWinoBuf_FP16.empty() || !importedWeightsWinoFP16.empty(); }
+
     int conv_type;
     int conv_dim;  // Flag for conv1d, conv2d, or conv3d.
     bool useFP16 = false; // Only ARMv8 is supported.
+    // x86 with AVX2 and F16C: weights of the generic convolution are stored in FP16 (weightsBuf_FP16),
+    // inputs and accumulators are FP32.
+    bool useFP16Weights = false;
 #if CV_SIMD128
     bool useSIMD128 = true;
 #else
@@ -102,9 +118,27 @@ Ptr<FastConv> initFastConv(
         const bool useFP16,
         bool useWinograd);
 
+// Serialization of packed weights for compiled networks. Exported Mats refer to the buffers of conv.
+// importFastConv() returns empty pointer if the weights can't be used on this platform.
+void exportFastConv(const FastConv& conv, std::vector<Mat>& data);
+Ptr<FastConv> importFastConv(const std::vector<Mat>& data);
+
+// Cache blocking of the generic convolution, the defaults are good for most CPUs.
+// Sizes may be selected per layer by benchmarks (see OPENCV_DNN_AUTOTUNE).
+struct FastConvBlocking
+{
+    int kBlock = 32;        // output channels per block, rounded up to CONV_MR
+    int cBlock = 256;       // elements of the reduction (kernel size * input channels) per block
+    int stripePixels = 56;  // output pixels computed by a task at once, rounded up to CONV_NR
+};
+
 // It contains different computing branches, like winograd, 1x1 conv.
 void runFastConv(InputArray _input, OutputArray _output, const Ptr<FastConv>& conv, int ntasks,
-                   const Ptr<ActivationLayer>& actLayer, const std::vector<float>& reluslope, bool fusedAdd);
+                   const Ptr<ActivationLayer>& actLayer, const std::vector<float>& reluslope, bool fusedAdd,
+                   const FastConvBlocking& blocking = FastConvBlocking());
+
+// Name of the computing branch used by runFastConv(), reported by the profiler.
+std::string fastConvKernelName(const FastConv& conv);
 
 void runDepthwise(InputArray _input, OutputArray _output, const Ptr<FastConv>& conv, ActivationLayer* activ,
                   const std::vector<float>& reluslope, bool fusedAdd);
@@ -112,6 +146,44 @@ void runDepthwise(InputArray _input, OutputArray _output, const Ptr<FastConv>& c
 int runWinograd63(InputArray _input, InputArray _fusedAddMat, OutputArray _output, const Ptr<FastConv>& conv, int ntasks,
                   float minval, float maxval, ActivationLayer* activ, bool ifMinMaxAct);
 
+struct FastConvInt8
+{
+    int ngroups;
+    int K, C, Hk, Wk;
+    int stride_h, stride_w;
+    int dilation_h, dilation_w;
+    int pad_top, pad_left;
+    int inpZp;  // input zero point, used for padding.
+
+    // Weights are packed by blocks of CONV_MR_INT8 output channels. Inside the block
+    // every 4 consecutive weights of each channel are stored together, zero padded.
+    std::vector<int8_t> weightsBuf;
+    std::vector<int> weightsSum;  // sum of weights of each output channel (including padding channels).
+    int getKBlocks() const { return (K / ngroups + CONV_MR_INT8 - 1) / CONV_MR_INT8; }
+    int getKQuads() const { return (C / ngroups * Hk * Wk + 3) / 4; }
+
+    bool useAVX2    = checkHardwareSupport(CPU_AVX2);
+    bool useVNNI    = checkHardwareSupport(CPU_AVX512_CLX);  // 256-bit VNNI kernel
+    bool useNEON_DOTPROD = checkHardwareSupport(CPU_NEON_DOTPROD);
+};
+
+// return a FastConvInt8 instance. 1D convolution is handled as 2D one with kernel height 1.
+Ptr<FastConvInt8> initFastConvInt8(
+        InputArray weightsMat,
+        int ngroups,
+        int K, int C,
+        const std::vector<size_t>& kernel_size,
+        const std::vector<size_t>& strides,
+        const std::vector<size_t>& dilations,
+        const std::vector<size_t>& pads_begin,
+        int inpZp);
+
+// Computes INT8 convolution and requantizes the result:
+// out = saturate_cast<int8_t>(outZp + round((conv + bias[k]) * multiplier[k])),
+// then, if activLUT is not null, out = activLUT[out + 128].
+void runFastConvInt8(InputArray _input, OutputArray _output, const Ptr<FastConvInt8>& conv, int ntasks,
+                     const int* bias, const float* multiplier, int outZp, const int* activLUT);
+
 // Work around of NEON, the following functions are only used internally.
 namespace opt_NEON {
 #if CV_NEON
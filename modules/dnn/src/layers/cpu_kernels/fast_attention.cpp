@@ -0,0 +1,135 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "../../precomp.hpp"
+#include "fast_attention.hpp"
+
+namespace cv { namespace dnn {
+
+// Tile sizes: a tile of scores is FAST_ATTENTION_BLOCK_Q x FAST_ATTENTION_BLOCK_KV floats (32KB)
+enum { FAST_ATTENTION_BLOCK_Q = 64, FAST_ATTENTION_BLOCK_KV = 128 };
+
+// buf[j] = exp(buf[j] - max_val), returns the sum
+static float expSubSum(float *buf, int n, float max_val) {
+    int j = 0;
+    float s = 0.f;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const int nlanes = VTraits<v_float32>::vlanes();
+    v_float32 vmax = vx_setall_f32(max_val), vs = vx_setzero_f32();
+    for (; j <= n - nlanes; j += nlanes) {
+        v_float32 val = v_exp(v_sub(vx_load(buf + j), vmax));
+        v_store(buf + j, val);
+        vs = v_add(vs, val);
+    }
+    s = v_reduce_sum(vs);
+#endif
+    for (; j < n; j++) {
+        buf[j] = expf(buf[j] - max_val);
+        s += buf[j];
+    }
+    return s;
+}
+
+void fastAttention(size_t batch, size_t num_heads, size_t seq_len, size_t kv_len,
+                   size_t qk_head_size, size_t v_head_size, float scale, bool causal,
+                   const float *Q, const float *K, size_t kv_head_step_k,
+                   const float *V, size_t kv_head_step_v,
+                   float *Y, size_t ldy, const FastGemmOpt &opt) {
+    CV_Assert(!causal || kv_len >= seq_len);
+    CV_CheckGE(kv_head_step_k, kv_len * qk_head_size, "DNN/fastAttention: invalid key step");
+    CV_CheckGE(kv_head_step_v, kv_len * v_head_size, "DNN/fastAttention: invalid value step");
+
+    const int block_q = (int)std::min(seq_len, (size_t)FAST_ATTENTION_BLOCK_Q),
+              block_kv = (int)std::min(kv_len, (size_t)FAST_ATTENTION_BLOCK_KV);
+    const size_t q_blocks = (seq_len + block_q - 1) / block_q;
+    const size_t past_len = kv_len - seq_len; // used by the causal mask only
+    const int qk = (int)qk_head_size, vh = (int)v_head_size;
+
+    // tiles are processed by a single thread
+    FastGemmOpt tile_opt = opt;
+    tile_opt.multi_thread = false;
+
+    size_t loops = batch * num_heads * q_blocks;
+    double nstripes = loops * block_q * kv_len * (qk_head_size + v_head_size) * (1 / 1024.0);
+    parallel_for_(Range(0, (int)loops), [&](const Range &r) {
+        AutoBuffer<float> buf_(block_q * block_kv + block_q * vh + 2 * block_q);
+        float *scores = buf_.data();
+        float *acc = scores + block_q * block_kv;
+        float *row_max = acc + block_q * vh;
+        float *row_sum = row_max + block_q;
+
+        for (int task = r.start; task < r.end; task++) {
+            const size_t bh = task / q_blocks;
+            const size_t q0 = (task % q_blocks) * block_q;
+            const int nq = (int)std::min((size_t)block_q, seq_len - q0);
+
+            const float *q = Q + bh * seq_len * qk_head_size + q0 * qk_head_size;
+            const float *k = K + bh * kv_head_step_k, *v = V + bh * kv_head_step_v;
+            // the last query of the tile attends to the keys [0, kv_end)
+            const size_t kv_end = causal ? std::min(kv_len, past_len + q0 + nq) : kv_len;
+
+            for (int i = 0; i < nq; i++) {
+                row_max[i] = -FLT_MAX;
+                row_sum[i] = 0.f;
+            }
+            std::memset(acc, 0, nq * vh * sizeof(float));
+
+            for (size_t k0 = 0; k0 < kv_end; k0 += block_kv) {
+                const int nk = (int)std::min((size_t)block_kv, kv_end - k0);
+
+                // scores = scale * q * k^T
+                fastGemm(false, true, nq, qk, nk, qk,
+                         scale, q, qk, 1,
+                         k + k0 * qk_head_size, qk, 1, 0.f,
+                         scores, nk, tile_opt);
+
+                // online softmax: rescale the accumulated values to the new row maximum
+                for (int i = 0; i < nq; i++) {
+                    float *s = scores + i * nk;
+                    int nvalid = nk;
+                    if (causal)
+                        nvalid = (int)std::min((ptrdiff_t)nk, (ptrdiff_t)(past_len + q0 + i + 1) - (ptrdiff_t)k0);
+                    if (nvalid <= 0) {
+                        std::memset(s, 0, nk * sizeof(float));
+                        continue;
+                    }
+
+                    float m = row_max[i];
+                    for (int j = 0; j < nvalid; j++)
+                        m = std::max(m, s[j]);
+                    const float corr = expf(row_max[i] - m);
+                    const float sum = expSubSum(s, nvalid, m);
+                    for (int j = nvalid; j < nk; j++)
+                        s[j] = 0.f;
+
+                    row_sum[i] = row_sum[i] * corr + sum;
+                    row_max[i] = m;
+                    if (corr != 1.f) {
+                        float *a = acc + i * vh;
+                        for (int j = 0; j < vh; j++)
+                            a[j] *= corr;
+                    }
+                }
+
+                // acc += p * v
+                fastGemm(false, false, nq, nk, nk, vh,
+                         1.f, scores, nk, 1,
+                         v + k0 * v_head_size, vh, 1, 1.f,
+                         acc, vh, tile_opt);
+            }
+
+            const size_t batch_index = bh / num_heads, head_index = bh % num_heads;
+            float *y = Y + (batch_index * seq_len + q0) * ldy + head_index * v_head_size;
+            for (int i = 0; i < nq; i++) {
+                const float inv_sum = 1.f / row_sum[i];
+                const float *a = acc + i * vh;
+                float *y_i = y + i * ldy;
+                for (int j = 0; j < vh; j++)
+                    y_i[j] = a[j] * inv_sum;
+            }
+        }
+    }, nstripes);
+}
+
+}} // cv::dnn
@@ -0,0 +1,30 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_DNN_FAST_ATTENTION_HPP
+#define OPENCV_DNN_FAST_ATTENTION_HPP
+
+#include "fast_gemm.hpp"
+
+namespace cv { namespace dnn {
+
+// Fused scaled dot-product attention: Y = Softmax(scale * Q * K^T) * V, computed per (batch, head).
+// Keys and values are processed in tiles with online softmax (flash attention), so the
+// seq_len x kv_len score matrix is never materialized.
+//
+// Q: [batch * num_heads, seq_len, qk_head_size], the head step is seq_len * qk_head_size.
+// K: [batch * num_heads, kv_len, qk_head_size] with the head step kv_head_step_k (>= kv_len * qk_head_size).
+// V: [batch * num_heads, kv_len, v_head_size] with the head step kv_head_step_v (>= kv_len * v_head_size).
+// Y: [batch, seq_len, num_heads * v_head_size], row stride is ldy.
+// If causal is true, the query i attends to the keys 0 ... kv_len - seq_len + i only
+// (queries are the last seq_len positions of the sequence, e.g. the new tokens of a decoder step).
+void fastAttention(size_t batch, size_t num_heads, size_t seq_len, size_t kv_len,
+                   size_t qk_head_size, size_t v_head_size, float scale, bool causal,
+                   const float *Q, const float *K, size_t kv_head_step_k,
+                   const float *V, size_t kv_head_step_v,
+                   float *Y, size_t ldy, const FastGemmOpt &opt);
+
+}} // cv::dnn
+
+#endif // OPENCV_DNN_FAST_ATTENTION_HPP
@@ -12,6 +12,8 @@
 #include "../../precomp.hpp"
 #include "fast_gemm.hpp"
 
+#include <opencv2/core/hal/hal.hpp>
+
 #define CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 #include "fast_gemm_kernels.simd.hpp"
 #include "layers/cpu_kernels/fast_gemm_kernels.simd_declarations.hpp"
@@ -20,6 +22,80 @@
 
 namespace cv { namespace dnn {
 
+bool fastGemmSupportsFP16B() {
+#if CV_TRY_AVX2
+    return checkHardwareSupport(CPU_AVX2) && checkHardwareSupport(CPU_FP16);
+#else
+    return false;
+#endif
+}
+
+bool FastGemmEpilogue::setActivation(const Ptr<ActivationLayer>& layer) {
+    minval = -FLT_MAX;
+    maxval = FLT_MAX;
+    ifMinMaxAct = false;
+    activ = NULL;
+    if (layer.empty())
+        return true;
+    // parameters of these layers depend on the channel, which is not known here
+    if (!layer.dynamicCast<ChannelsPReLULayer>().empty() || !layer.dynamicCast<BatchNormLayer>().empty())
+        return false;
+
+    Ptr<ReLULayer> activ_relu = layer.dynamicCast<ReLULayer>();
+    Ptr<ReLU6Layer> activ_relu6 = layer.dynamicCast<ReLU6Layer>();
+    if (!activ_relu.empty() && activ_relu->negativeSlope == 0.f) {
+        minval = 0.f;
+        ifMinMaxAct = true;
+    } else if (!activ_relu6.empty()) {
+        minval = activ_relu6->minValue;
+        maxval = activ_relu6->maxValue;
+        ifMinMaxAct = true;
+    } else {
+        activ = layer.get();
+    }
+    return true;
+}
+
+void FastGemmEpilogue::apply(float *C, size_t C_offset, int ldc, int i0, int mc, int j0, int nc) const {
+    const float *scale_ = scale ? scale + j0 : NULL, *bias_ = bias ? bias + j0 : NULL;
+    for (int i = 0; i < mc; i++) {
+        const size_t offset = C_offset + (size_t)(i0 + i) * ldc + j0;
+        float *c = C + offset;
+        const float *r = residual ? residual + offset : NULL;
+        int j = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const int nlanes = VTraits<v_float32>::vlanes();
+        v_float32 vmin = vx_setall_f32(minval), vmax = vx_setall_f32(maxval);
+        for (; j <= nc - nlanes; j += nlanes) {
+            v_float32 v = vx_load(c + j);
+            if (scale_)
+                v = v_mul(v, vx_load(scale_ + j));
+            if (bias_)
+                v = v_add(v, vx_load(bias_ + j));
+            if (r)
+                v = v_add(v, vx_load(r + j));
+            if (ifMinMaxAct)
+                v = v_min(v_max(v, vmin), vmax);
+            v_store(c + j, v);
+        }
+#endif
+        for (; j < nc; j++) {
+            float v = c[j];
+            if (scale_)
+                v *= scale_[j];
+            if (bias_)
+                v += bias_[j];
+            if (r)
+                v += r[j];
+            if (ifMinMaxAct)
+                v = std::min(std::max(v, minval), maxval);
+            c[j] = v;
+        }
+        if (activ)
+            activ->forwardSlice(c, c, nc, nc, 0, 1);
+    }
+}
+
 size_t fastGemmPackBSize(size_t N, size_t K, const FastGemmOpt &opt) {
 #if CV_TRY_NEON
     if (opt.use_neon) {
@@ -120,6 +196,16 @@ void fastGemmPackB(const Mat &B, std::vector<float> &packed_B, bool trans, FastG
     }
 }
 
+void fastGemmPackB(const Mat &B, std::vector<hfloat> &packed_B, bool trans, FastGemmOpt &opt) {
+    CV_Assert(opt.use_fp16_b);
+    std::vector<float> packed_B_f32;
+    fastGemmPackB(B, packed_B_f32, trans, opt);
+
+    packed_B.resize(packed_B_f32.size());
+    Mat dst(1, (int)packed_B.size(), CV_16F, packed_B.data());
+    Mat(packed_B_f32, false).reshape(1, 1).convertTo(dst, CV_16F);
+}
+
 void fastGemmPackB(bool trans, size_t N, size_t K, const float *B, size_t ldb, float *packed_B, const FastGemmOpt &opt) {
     size_t ldb0 = ldb, ldb1 = 1;
     if (trans) {
@@ -225,6 +311,23 @@ void fastGemm(bool trans_a, int M, int N, int K,
     }
 }
 
+void fastGemm(bool trans_a, int M, int N, int K,
+              float alpha, const float *A, int lda,
+              const FastGemmPackedB &packed_B, float beta,
+              float *C, int ldc, FastGemmOpt &opt, const FastGemmEpilogue *epilogue) {
+    if (!packed_B.isFP16() && (!epilogue || epilogue->empty()))
+        return fastGemm(trans_a, M, N, K, alpha, A, lda, packed_B.data(), beta, C, ldc, opt);
+
+    // FP16 B and the epilogue are supported by the batched kernels only
+    const size_t zero_offset = 0;
+    int lda0 = lda, lda1 = 1;
+    if (trans_a) {
+        std::swap(lda0, lda1);
+    }
+    fastGemmBatch(1, &zero_offset, &zero_offset, &zero_offset, M, N, K, alpha, A, lda0, lda1,
+                  packed_B, beta, C, ldc, opt, epilogue);
+}
+
 void fastGemm(bool trans_a, bool trans_b, int ma, int na, int mb, int nb,
               float alpha, const float *A, int lda0, int lda1, const float *B, int ldb0, int ldb1,
               float beta, float *C, int ldc, FastGemmOpt &opt) {
@@ -247,39 +350,28 @@ void fastGemm(bool trans_a, bool trans_b, int ma, int na, int mb, int nb,
         return fast_gemm_thin(alpha, beta, M, N, K, a, lda0, lda1, b, ldb0, c, ldc, opt.multi_thread);
     }
 
-#if CV_TRY_NEON
-    if (opt.use_neon) {
-        opt_NEON::fastGemmKernel(M, N, K, alpha, a, lda0, lda1,
-                                 b, ldb0, ldb1, beta,
-                                 c, ldc, sizeof(float), opt.multi_thread);
-    } else
-#endif
-#if CV_TRY_AVX2
-    if (opt.use_avx2) {
-        opt_AVX2::fastGemmKernel(M, N, K, alpha, a, lda0, lda1,
-                                 b, ldb0, ldb1, beta,
-                                 c, ldc, sizeof(float), opt.multi_thread);
-    } else
-#endif
-#if CV_TRY_AVX
-    if (opt.use_avx) {
-        opt_AVX::fastGemmKernel(M, N, K, alpha, a, lda0, lda1,
-                                 b, ldb0, ldb1, beta,
-                                 c, ldc, sizeof(float), opt.multi_thread);
-    } else
-#endif
-#if CV_TRY_LASX
-    if (opt.use_lasx) {
-        opt_LASX::fastGemmKernel(M, N, K, alpha, a, lda0, lda1,
-                                 b, ldb0, ldb1, beta,
-                                 c, ldc, sizeof(float), opt.multi_thread);
-    } else
-#endif
-    {
-        cpu_baseline::fastGemmKernel(M, N, K, alpha, a, lda0, lda1,
-                                     b, ldb0, ldb1, beta,
-                                     c, ldc, sizeof(float), opt.multi_thread);
+    // The packed GEMM of core (cv::gemm) supports matrices with one of the steps equal to 1
+    Mat A_copy, B_copy;
+    if (lda0 != 1 && lda1 != 1) {
+        A_copy.create(M, K, CV_32F);
+        for (int i = 0; i < M; i++)
+            for (int k = 0; k < K; k++)
+                A_copy.at<float>(i, k) = A[i * lda0 + k * lda1];
+        A = A_copy.ptr<const float>();
+        lda0 = K, lda1 = 1;
+    }
+    if (ldb0 != 1 && ldb1 != 1) {
+        B_copy.create(K, N, CV_32F);
+        for (int k = 0; k < K; k++)
+            for (int j = 0; j < N; j++)
+                B_copy.at<float>(k, j) = B[k * ldb0 + j * ldb1];
+        B = B_copy.ptr<const float>();
+        ldb0 = N, ldb1 = 1;
     }
+    int flags = (lda1 == 1 ? 0 : GEMM_1_T) | (ldb1 == 1 ? 0 : GEMM_2_T);
+    hal::gemm32f(A, (lda1 == 1 ? lda0 : lda1) * sizeof(float), B, (ldb1 == 1 ? ldb0 : ldb1) * sizeof(float),
+                 alpha, C, ldc * sizeof(float), beta, C, ldc * sizeof(float),
+                 lda1 == 1 ? M : K, lda1 == 1 ? K : M, N, flags);
 }
 
 void fastGemm(bool trans_a, bool trans_b,
@@ -312,71 +404,97 @@ void fastGemm(bool trans_a, bool trans_b,
 
 void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                    int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
-                   const float *B, int ldb0, int ldb1, float beta, float *C, int ldc, FastGemmOpt &opt) {
+                   const float *B, int ldb0, int ldb1, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue) {
+    if (epilogue && epilogue->empty())
+        epilogue = NULL;
     const char *a = (const char *)A;
     const char *b = (const char *)B;
     char *c = (char *)C;
 
 #if CV_TRY_NEON
     if (opt.use_neon) {
-        opt_NEON::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float));
+        opt_NEON::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float), epilogue);
     } else
 #endif
 #if CV_TRY_AVX2
     if (opt.use_avx2) {
-        opt_AVX2::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float));
+        opt_AVX2::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float), epilogue);
     } else
 #endif
 #if CV_TRY_AVX
     if (opt.use_avx) {
-        opt_AVX::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float));
+        opt_AVX::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float), epilogue);
     } else
 #endif
 #if CV_TRY_LASX
     if (opt.use_lasx) {
-        opt_LASX::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float));
+        opt_LASX::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float), epilogue);
     } else
 #endif
     {
-        cpu_baseline::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float));
+        cpu_baseline::fastGemmBatchKernel(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, ldb0, ldb1, beta, c, ldc, sizeof(float), epilogue);
     }
 }
 
 void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *packed_B_offsets, const size_t *C_offsets,
                    int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
-                   const float *packed_B, float beta, float *C, int ldc, FastGemmOpt &opt) {
+                   const float *packed_B, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue) {
+    if (epilogue && epilogue->empty())
+        epilogue = NULL;
     const char *a = (const char *)A;
     const char *b = (const char *)packed_B;
     char *c = (char *)C;
 
 #if CV_TRY_NEON
     if (opt.use_neon) {
-        opt_NEON::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float));
+        opt_NEON::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float), opt.multi_thread, epilogue);
     } else
 #endif
 #if CV_TRY_AVX2
     if (opt.use_avx2) {
-        opt_AVX2::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float));
+        opt_AVX2::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float), opt.multi_thread, epilogue);
     } else
 #endif
 #if CV_TRY_AVX
     if (opt.use_avx) {
-        opt_AVX::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float));
+        opt_AVX::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float), opt.multi_thread, epilogue);
     } else
 #endif
 #if CV_TRY_LASX
     if (opt.use_lasx) {
-        opt_LASX::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float));
+        opt_LASX::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float), opt.multi_thread, epilogue);
+    } else
+#endif
+    {
+        cpu_baseline::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float), opt.multi_thread, epilogue);
+    }
+}
+
+void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *packed_B_offsets, const size_t *C_offsets,
+                   int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
+                   const FastGemmPackedB &packed_B, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue) {
+    if (!packed_B.isFP16())
+        return fastGemmBatch(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, A, lda0, lda1,
+                             packed_B.data(), beta, C, ldc, opt, epilogue);
+    if (epilogue && epilogue->empty())
+        epilogue = NULL;
+#if CV_TRY_AVX2
+    if (opt.use_fp16_b) {
+        opt_AVX2::fastGemmBatchKernelF16B(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, (const char *)A, lda0, lda1,
+                                          packed_B.dataFP16(), beta, (char *)C, ldc, opt.multi_thread, epilogue);
     } else
 #endif
     {
-        cpu_baseline::fastGemmBatchKernel(batch, A_offsets, packed_B_offsets, C_offsets, M, N, K, alpha, a, lda0, lda1, b, beta, c, ldc, sizeof(float));
+        CV_Error(Error::StsNotImplemented, "DNN/fastGemmBatch: FP16 packed B is not supported by this CPU");
     }
 }
 
 void fastGemmBatch(bool trans_a, bool trans_b,
                    float alpha, const Mat &A, const Mat &B,
-                   float beta, Mat &C, FastGemmOpt &opt) {
+                   float beta, Mat &C, FastGemmOpt &opt, const FastGemmEpilogue *epilogue) {
     CV_CheckTypeEQ(A.type(), B.type(), "DNN/fastGemmBatch: A and B should have the same type");
     CV_CheckTypeEQ(B.type(), C.type(), "DNN/fastGemmBatch: B and C should have the same type");
     CV_CheckTypeEQ(A.type(), CV_32F, "DNN/fastGemmBatch: only support float32 for now");
@@ -396,7 +514,7 @@ void fastGemmBatch(bool trans_a, bool trans_b,
 
     fastGemmBatch(helper.batch, helper.A_offsets.data(), helper.B_offsets.data(), helper.C_offsets.data(),
                   helper.M, helper.N, helper.K, alpha, a, helper.lda0, helper.lda1, b, helper.ldb0,
-                  helper.ldb1, beta, c, helper.ldc, opt);
+                  helper.ldb1, beta, c, helper.ldc, opt, epilogue);
 }
 
 }} // cv::dnn
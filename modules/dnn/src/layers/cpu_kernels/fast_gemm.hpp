@@ -14,14 +14,19 @@
 
 #include "opencv2/core/hal/intrin.hpp"
 #include <opencv2/dnn/shape_utils.hpp>
+#include <opencv2/dnn/all_layers.hpp>
 
 namespace cv { namespace dnn {
 
+// Returns true if FP16 packed B matrices are supported (x86 with AVX2 and F16C)
+bool fastGemmSupportsFP16B();
+
 struct FastGemmOpt {
     bool use_avx;
     bool use_avx2;
     bool use_neon;
     bool use_lasx;
+    bool use_fp16_b; // FP16 packed B is supported (AVX2 with F16C)
     bool multi_thread;
 
     FastGemmOpt() {
@@ -29,6 +34,7 @@ struct FastGemmOpt {
         use_avx2 = false;
         use_neon = false;
         use_lasx = false;
+        use_fp16_b = false;
         multi_thread = false;
     }
 
@@ -37,6 +43,7 @@ struct FastGemmOpt {
         use_avx2 = checkHardwareSupport(CPU_AVX2);
         use_neon = checkHardwareSupport(CPU_NEON);
         use_lasx = checkHardwareSupport(CPU_LASX);
+        use_fp16_b = fastGemmSupportsFP16B();
         multi_thread = true;
     }
 
@@ -45,6 +52,67 @@ struct FastGemmOpt {
     }
 };
 
+// Packed constant B matrix. It is either computed by fastGemmPackB() or loaded with
+// the compiled network (see Net::save()), then it refers to the mapped file.
+// FP16 matrices (DNN_TARGET_CPU_FP16 on x86) are used by fastGemm() and fastGemmBatch() only.
+struct FastGemmPackedB {
+    std::vector<float> buf;
+    std::vector<hfloat> buf_fp16;
+    Mat imported;
+
+    bool isFP16() const { return imported.empty() ? !buf_fp16.empty() : imported.depth() == CV_16F; }
+    const float *data() const {
+        CV_DbgAssert(!isFP16());
+        return imported.empty() ? buf.data() : imported.ptr<float>();
+    }
+    const hfloat *dataFP16() const { return imported.empty() ? buf_fp16.data() : imported.ptr<hfloat>(); }
+    size_t size() const { return !imported.empty() ? imported.total() : isFP16() ? buf_fp16.size() : buf.size(); }
+    Mat exportData() const {
+        if (!imported.empty())
+            return imported;
+        return isFP16() ? Mat(1, (int)buf_fp16.size(), CV_16F, (void*)buf_fp16.data()) : Mat(buf, false);
+    }
+    void importData(const Mat &m) {
+        CV_Check(m.type(), m.type() == CV_32F || m.type() == CV_16F, "DNN: unexpected packed weights");
+        CV_Assert(m.isContinuous());
+        buf.clear();
+        buf_fp16.clear();
+        imported = m.reshape(1, 1);
+    }
+};
+
+// Elementwise operations fused into fastGemm() and fastGemmBatch(). They are applied to every tile
+// of C right after it is computed, while the tile is in cache:
+//     C = activation(C * scale + bias + residual)
+// scale and bias have N elements, residual has the same layout as C (the same offsets and ldc).
+struct FastGemmEpilogue {
+    const float *scale;
+    const float *bias;
+    const float *residual;
+    float minval, maxval;
+    bool ifMinMaxAct;  // activation is clipping by [minval, maxval] (ReLU, ReLU6)
+    ActivationLayer *activ;  // any other elementwise activation, e.g. GELU or Swish (SiLU)
+
+    FastGemmEpilogue() {
+        scale = bias = residual = NULL;
+        minval = -FLT_MAX;
+        maxval = FLT_MAX;
+        ifMinMaxAct = false;
+        activ = NULL;
+    }
+
+    bool empty() const {
+        return !scale && !bias && !residual && !ifMinMaxAct && !activ;
+    }
+
+    // Sets the fused activation, empty layer resets it. Returns false if the activation can't be fused.
+    // The caller keeps the layer alive.
+    bool setActivation(const Ptr<ActivationLayer>& layer);
+
+    // Applies the epilogue to mc x nc block of C starting at C + C_offset + i0 * ldc + j0
+    void apply(float *C, size_t C_offset, int ldc, int i0, int mc, int j0, int nc) const;
+};
+
 struct MatMulHelper {
     std::vector<size_t> A_offsets;
     std::vector<size_t> B_offsets;
@@ -154,12 +222,18 @@ struct MatMulHelper {
 size_t fastGemmPackBSize(size_t N, size_t K, const FastGemmOpt &opt);
 
 void fastGemmPackB(const Mat &m, std::vector<float> &packed_B, bool trans, FastGemmOpt &opt);
+// Packs B in FP16, requires opt.use_fp16_b. The layout is the same as of FP32 packed B.
+void fastGemmPackB(const Mat &m, std::vector<hfloat> &packed_B, bool trans, FastGemmOpt &opt);
 void fastGemmPackB(bool trans, size_t N, size_t K, const float *B, size_t ldb, float *packed_B, const FastGemmOpt &opt);
 
 void fastGemm(bool trans_a, int M, int N, int K,
               float alpha, const float *A, int lda,
               const float *packed_B, float beta,
               float *C, int ldc, FastGemmOpt &opt);
+void fastGemm(bool trans_a, int M, int N, int K,
+              float alpha, const float *A, int lda,
+              const FastGemmPackedB &packed_B, float beta,
+              float *C, int ldc, FastGemmOpt &opt, const FastGemmEpilogue *epilogue = NULL);
 void fastGemm(bool trans_a, bool trans_b, int ma, int na, int mb, int nb,
               float alpha, const float *A, int lda0, int lda1, const float *B, int ldb0, int ldb1,
               float beta, float *C, int ldc, FastGemmOpt &opt);
@@ -167,14 +241,23 @@ void fastGemm(bool trans_a, bool trans_b,
               float alpha, const Mat &A, const Mat &B,
               float beta, Mat &C, FastGemmOpt &opt);
 
+// Batched (grouped) GEMM: C[i] = alpha * A[i] * B[i] + beta * C[i], the matrices are located by the offsets.
+// Tiles of all the matrices are processed by a single parallel loop, so many small matrices load all the threads.
+// Constant packed B is shared by all the matrices if packed_B_offsets are zeros.
 void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                    int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
-                   const float *B, int ldb0, int ldb1, float beta, float *C, int ldc, FastGemmOpt &opt);
+                   const float *B, int ldb0, int ldb1, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue = NULL);
 void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                    int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
-                   const float *packed_B, float beta, float *C, int ldc, FastGemmOpt &opt);
+                   const float *packed_B, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue = NULL);
+void fastGemmBatch(size_t batch, const size_t *A_offsets, const size_t *packed_B_offsets, const size_t *C_offsets,
+                   int M, int N, int K, float alpha, const float *A, int lda0, int lda1,
+                   const FastGemmPackedB &packed_B, float beta, float *C, int ldc, FastGemmOpt &opt,
+                   const FastGemmEpilogue *epilogue = NULL);
 void fastGemmBatch(bool trans_a, bool trans_b, float alpha, const Mat &A,
-                   const Mat &B, float beta, Mat &C, FastGemmOpt &opt);
+                   const Mat &B, float beta, Mat &C, FastGemmOpt &opt, const FastGemmEpilogue *epilogue = NULL);
 
 }} // cv::dnn
 
@@ -11,8 +11,8 @@
 
 #include <opencv2/core/hal/intrin.hpp>
 #include <opencv2/core/utility.hpp> // parallel_for_
+#include "fast_gemm.hpp" // FastGemmEpilogue
 
-#define FAST_GEMM_STORAGE (1<<20) // 2^20
 #define FAST_GEMM_MAX_STACKBUF (1 << 14)
 
 #define FAST_GEMM_F32_MC 64
@@ -80,20 +80,18 @@ int fastGemmPackBSize(int N, int K);
 
 void fastGemmPackBKernel(const char *B, char *packed_B, int N, int K, int ldb0, int ldb1, int esz);
 
-void fastGemmKernel(int M, int N, int K,
-                    float alpha, const char *A, int lda0, int lda1,
-                    const char *B, int ldb0, int ldb1,
-                    float beta, char *C, int ldc, int esz, bool multi_thread);
 void fastGemmKernel(int M, int N, int K,
                     float alpha, const char *A, int lda0, int lda1,
                     const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread);
 
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz);
+                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz,
+                         const FastGemmEpilogue *epilogue);
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *packed_B, float beta, char *C, int ldc, int esz);
+                         const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread,
+                         const FastGemmEpilogue *epilogue);
 
 FAST_GEMM_IMPLEMENT_PACK(8, _f32, float, float)
 FAST_GEMM_IMPLEMENT_PACK(12, _f32, float, float)
@@ -176,75 +174,6 @@ static void fast_gemm_macro_kernel(int m, int n, int k,
     }
 }
 
-void fastGemmKernel(int M, int N, int K,
-                    float alpha, const char *A, int lda0, int lda1,
-                    const char *B, int ldb0, int ldb1,
-                    float beta, char *C, int ldc, int esz, bool multi_thread) {
-    int GEMM_MC = FAST_GEMM_F32_MC,
-        GEMM_NC = FAST_GEMM_F32_NC,
-        GEMM_MR = FAST_GEMM_F32_MR,
-        GEMM_NR = FAST_GEMM_F32_NR;
-
-    int MC = (((GEMM_MC < M ? GEMM_MC : M) + GEMM_MR - 1) / GEMM_MR) * GEMM_MR;
-    int NC = (((GEMM_NC < N ? GEMM_NC : N) + GEMM_NR - 1) / GEMM_NR) * GEMM_NR;
-    int KC = FAST_GEMM_STORAGE / ((MC + NC) * esz);
-    KC = KC > 8 ? KC : 8;
-    KC = KC < K ? KC : K;
-
-    size_t buff_size = KC * (MC + NC) * esz;
-    bool use_stackbuff = buff_size <= FAST_GEMM_MAX_STACKBUF;
-    int m_tiles = (M + MC - 1) / MC;
-    int n_tiles = (N + NC - 1) / NC;
-    int total_tiles = m_tiles * n_tiles;
-
-    auto fn = [&](const Range &r) {
-        char* packed_a = (char*)(use_stackbuff ? alloca(buff_size) : malloc(buff_size));
-        char* packed_b = packed_a + KC * MC * esz;
-        int start = r.start;
-        int end = r.end;
-
-        for (int tile_idx = start; tile_idx < end; tile_idx++) {
-            int i0 = (tile_idx / n_tiles) * MC;
-            int j0 = (tile_idx % n_tiles) * NC;
-            int mc = M - i0 < MC ? M - i0 : MC;
-            int nc = N - j0 < NC ? N - j0 : NC;
-            int ldc_block = ldc;
-            char* c_block = C + (i0 * ldc + j0) * esz;
-
-            if (beta == 0.f) {
-                for(int i = 0; i < mc; i++)
-                    memset(c_block + i * ldc_block * esz, 0, nc * esz);
-            } else if (beta != 1.f) {
-                for(int i = 0; i < mc; i++) {
-                    float* c_i = (float*)c_block + i * ldc_block;
-                    for(int j = 0; j < nc; j++)
-                        c_i[j] *= beta;
-                }
-            }
-
-            for(int k0 = 0; k0 < K; k0 += KC)
-            {
-                int kc = K - k0 < KC ? K - k0 : KC;
-                fast_gemm_pack8_f32(mc, kc, A + (i0 * lda0 + k0 * lda1) * esz, lda0, lda1, packed_a);
-                fast_gemm_pack12_f32(nc, kc, B + (k0 * ldb0 + j0 * ldb1) * esz, ldb1, ldb0, packed_b);
-                fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
-            }
-        }
-
-        if (!use_stackbuff) {
-            free(packed_a);
-        }
-    };
-
-    if (multi_thread) {
-        int cost_per_thread = static_cast<int>((K / KC) * (MC / GEMM_MR) * (NC / GEMM_NR));
-        double nstripes = (size_t)total_tiles * cost_per_thread * (1 / 1024.0);
-        parallel_for_(Range(0, total_tiles), fn, nstripes);
-    } else {
-        fn(Range(0, total_tiles));
-    }
-}
-
 void fastGemmKernel(int M, int N, int K,
                     float alpha, const char *A, int lda0, int lda1,
                     const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread) {
@@ -315,7 +244,8 @@ void fastGemmKernel(int M, int N, int K,
 
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz) {
+                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz,
+                         const FastGemmEpilogue *epilogue) {
     int GEMM_MC = FAST_GEMM_F32_MC,
         GEMM_NC = FAST_GEMM_F32_NC,
         GEMM_MR = FAST_GEMM_F32_MR,
@@ -374,6 +304,9 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
                 // run kernel
                 fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
             }
+
+            if (epilogue)
+                epilogue->apply((float*)C, C_offsets[batch_index], ldc, i0, mc, j0, nc);
         }
 
         if (!use_stackbuff) {
@@ -389,7 +322,8 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
 
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *packed_B, float beta, char *C, int ldc, int esz) {
+                         const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread,
+                         const FastGemmEpilogue *epilogue) {
     int GEMM_MC = FAST_GEMM_F32_MC,
         GEMM_NC = FAST_GEMM_F32_NC,
         GEMM_MR = FAST_GEMM_F32_MR,
@@ -447,6 +381,9 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
                 fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
                 packed_b += _nc * kc;
             }
+
+            if (epilogue)
+                epilogue->apply((float*)C, C_offsets[batch_index], ldc, i0, mc, j0, nc);
         }
 
         if (!use_stackbuff) {
@@ -457,12 +394,15 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
     int total = batch * total_tiles;
     int cost_per_thread = static_cast<int>((K / KC) * (MC / GEMM_MR) * (NC / GEMM_NR));
     double nstripes = (size_t)total * cost_per_thread * (1 / 1024.0);
-    parallel_for_(Range(0, total), fn, nstripes);
+    if (multi_thread) {
+        parallel_for_(Range(0, total), fn, nstripes);
+    } else {
+        fn(Range(0, total));
+    }
 }
 
 }}} // cv::dnn::cpu_baseline
 
-#undef FAST_GEMM_STORAGE
 #undef FAST_GEMM_MAX_STACKBUF
 #ifdef FAST_GEMM_F32_MC
 #undef FAST_GEMM_F32_MC
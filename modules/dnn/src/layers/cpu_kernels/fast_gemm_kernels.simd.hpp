@@ -11,8 +11,8 @@
 
 #include <opencv2/core/hal/intrin.hpp>
 #include <opencv2/core/utility.hpp> // parallel_for_
+#include "fast_gemm.hpp" // FastGemmEpilogue
 
-#define FAST_GEMM_STORAGE (1<<20) // 2^20
 #define FAST_GEMM_MAX_STACKBUF (1 << 14)
 
 #if CV_AVX
@@ -119,20 +119,24 @@ int fastGemmPackBSize(int N, int K);
 
 void fastGemmPackBKernel(const char *B, char *packed_B, int N, int K, int ldb0, int ldb1, int esz);
 
-void fastGemmKernel(int M, int N, int K,
-                    float alpha, const char *A, int lda0, int lda1,
-                    const char *B, int ldb0, int ldb1,
-                    float beta, char *C, int ldc, int esz, bool multi_thread);
 void fastGemmKernel(int M, int N, int K,
                     float alpha, const char *A, int lda0, int lda1,
                     const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread);
 
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz);
+                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz,
+                         const FastGemmEpilogue *epilogue);
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *packed_B, float beta, char *C, int ldc, int esz);
+                         const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread,
+                         const FastGemmEpilogue *epilogue);
+
+// FP16 packed B (x86 with F16C), FP32 A, C and accumulation. Only the AVX2 instance is implemented.
+void fastGemmBatchKernelF16B(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
+                             int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
+                             const hfloat *packed_B, float beta, char *C, int ldc, bool multi_thread,
+                             const FastGemmEpilogue *epilogue);
 
 #ifndef CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 
@@ -233,9 +237,16 @@ FAST_GEMM_IMPLEMENT_PACK(12, _f32, float, float) // b packer
 #define _mm256_fmadd_ps(a, b, c) _mm256_add_ps(c, _mm256_mul_ps(a, b))
 #endif
 
-static inline void fast_gemm12x8_f32(int k, const char *a_, const char *b_, char *c_, int ldc, float alpha) {
+static inline __m256 fast_gemm_load_b8(const float *b) { return _mm256_loadu_ps(b); }
+#if CV_AVX2
+static inline __m256 fast_gemm_load_b8(const hfloat *b) { return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)b)); }
+#endif
+
+// TB is the type of packed B elements, FP16 ones are converted to FP32 on load.
+template<typename TB>
+static inline void fast_gemm12x8(int k, const char *a_, const char *b_, char *c_, int ldc, float alpha) {
     const float* a = (const float*)a_;
-    const float* b = (const float*)b_;
+    const TB* b = (const TB*)b_;
     float* c = (float*)c_;
 
     __m256 s00 = _mm256_setzero_ps(),
@@ -251,7 +262,7 @@ static inline void fast_gemm12x8_f32(int k, const char *a_, const char *b_, char
            s100 = _mm256_setzero_ps(),
            s110 = _mm256_setzero_ps();
     for (int p = 0; p < k; p++, a += FAST_GEMM_F32_MR, b += FAST_GEMM_F32_NR) {
-        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b0 = fast_gemm_load_b8(b);
 
         __m256 a0 = _mm256_set1_ps(*a);
         s00 = _mm256_fmadd_ps(b0, a0, s00);
@@ -303,6 +314,10 @@ static inline void fast_gemm12x8_f32(int k, const char *a_, const char *b_, char
 #undef FAST_GEMM_FINALE
 }
 
+static inline void fast_gemm12x8_f32(int k, const char *a_, const char *b_, char *c_, int ldc, float alpha) {
+    fast_gemm12x8<float>(k, a_, b_, c_, ldc, alpha);
+}
+
 #elif CV_LASX // LASX (32 x 256-bit registers)
 
 FAST_GEMM_IMPLEMENT_PACK(12, _f32, float, float) // a packer
@@ -491,10 +506,13 @@ static inline void fast_gemm8x12_f32(int k, const char *a_, const char *b_,
 
 #endif
 
+// TB is the type of packed B elements, only AVX2 kernel supports FP16 ones.
+template<typename TB = float>
 static inline void fast_gemm_macro_kernel(int m, int n, int k,
                                           const char *packed_A, const char *packed_B,
                                           float alpha, char *c, int ldc0, int esz) {
     int ldc0_esz = ldc0 * esz;
+    const int besz = (int)sizeof(TB);
 
     double tempC[FAST_GEMM_F32_MR * FAST_GEMM_F32_NR]; // make sure the buffer is big enough
     for(int i = 0; i < m; i += FAST_GEMM_F32_MR) {
@@ -514,13 +532,13 @@ static inline void fast_gemm_macro_kernel(int m, int n, int k,
                     memcpy(cptr + p * (ldc * esz), cptr0 + p * ldc0_esz, nr_esz);
             }
 #if CV_NEON && CV_NEON_AARCH64
-            fast_gemm8x12_f32(k, packed_A + i * k * esz, packed_B + j * k * esz, cptr, ldc, alpha);
+            fast_gemm8x12_f32(k, packed_A + i * k * esz, packed_B + j * k * besz, cptr, ldc, alpha);
 #elif CV_AVX
-            fast_gemm12x8_f32(k, packed_A + i * k * esz, packed_B + j * k * esz, cptr, ldc, alpha);
+            fast_gemm12x8<TB>(k, packed_A + i * k * esz, packed_B + j * k * besz, cptr, ldc, alpha);
 #elif CV_LASX
-            fast_gemm12x16_f32(k, packed_A + i * k * esz, packed_B + j * k * esz, cptr, ldc, alpha);
+            fast_gemm12x16_f32(k, packed_A + i * k * esz, packed_B + j * k * besz, cptr, ldc, alpha);
 #elif CV_SIMD128
-            fast_gemm8x12_f32(k, packed_A + i * k * esz, packed_B + j * k * esz, cptr, ldc, alpha);
+            fast_gemm8x12_f32(k, packed_A + i * k * esz, packed_B + j * k * besz, cptr, ldc, alpha);
 #endif
 
             if (partial) {
@@ -564,97 +582,6 @@ void fastGemmPackBKernel(const char *B, char *packed_B, int N, int K, int ldb0,
     }
 }
 
-void fastGemmKernel(int M, int N, int K,
-                    float alpha, const char *A, int lda0, int lda1,
-                    const char *B, int ldb0, int ldb1,
-                    float beta, char *C, int ldc, int esz, bool multi_thread) {
-    int GEMM_MC = FAST_GEMM_F32_MC,
-        GEMM_NC = FAST_GEMM_F32_NC,
-        GEMM_MR = FAST_GEMM_F32_MR,
-        GEMM_NR = FAST_GEMM_F32_NR;
-
-    int MC = (((GEMM_MC < M ? GEMM_MC : M) + GEMM_MR - 1) / GEMM_MR) * GEMM_MR;
-    int NC = (((GEMM_NC < N ? GEMM_NC : N) + GEMM_NR - 1) / GEMM_NR) * GEMM_NR;
-    int KC = FAST_GEMM_STORAGE / ((MC + NC) * esz);
-    KC = KC > 8 ? KC : 8;
-    KC = KC < K ? KC : K;
-
-    size_t buff_size = KC * (MC + NC) * esz;
-    bool use_stackbuff = buff_size <= FAST_GEMM_MAX_STACKBUF;
-    int m_tiles = (M + MC - 1) / MC;
-    int n_tiles = (N + NC - 1) / NC;
-    int total_tiles = m_tiles * n_tiles;
-
-    auto fn = [&](const Range &r) {
-        char* packed_a = (char*)(use_stackbuff ? alloca(buff_size) : malloc(buff_size));
-        char* packed_b = packed_a + KC * MC * esz;
-        int start = r.start;
-        int end = r.end;
-
-        for (int tile_idx = start; tile_idx < end; tile_idx++) {
-            int i0 = (tile_idx / n_tiles) * MC;
-            int j0 = (tile_idx % n_tiles) * NC;
-            int mc = M - i0 < MC ? M - i0 : MC;
-            int nc = N - j0 < NC ? N - j0 : NC;
-            int ldc_block = ldc;
-            char* c_block = C + (i0 * ldc + j0) * esz;
-
-            if (beta == 0.f) {
-                for(int i = 0; i < mc; i++)
-                    memset(c_block + i * ldc_block * esz, 0, nc * esz);
-            } else if (beta != 1.f) {
-                for(int i = 0; i < mc; i++) {
-                    float* c_i = (float*)c_block + i * ldc_block;
-                    for(int j = 0; j < nc; j++)
-                        c_i[j] *= beta;
-                }
-            }
-
-            for(int k0 = 0; k0 < K; k0 += KC)
-            {
-                int kc = K - k0 < KC ? K - k0 : KC;
-                // pack a
-#if CV_NEON && CV_NEON_AARCH64
-                fast_gemm_pack8_f32(mc, kc, A + (i0 * lda0 + k0 * lda1) * esz, lda0, lda1, packed_a);
-#elif CV_AVX
-                fast_gemm_pack12_f32(mc, kc, A + (i0 * lda0 + k0 * lda1) * esz, lda0, lda1, packed_a);
-#elif CV_LASX
-                fast_gemm_pack12_f32(mc, kc, A + (i0 * lda0 + k0 * lda1) * esz, lda0, lda1, packed_a);
-#elif CV_SIMD128
-                fast_gemm_pack8_f32(mc, kc, A + (i0 * lda0 + k0 * lda1) * esz, lda0, lda1, packed_a);
-#endif
-
-                // pack b
-#if CV_NEON && CV_NEON_AARCH64
-                fast_gemm_pack12_f32(nc, kc, B + (k0 * ldb0 + j0 * ldb1) * esz, ldb1, ldb0, packed_b);
-#elif CV_AVX
-                fast_gemm_pack8_f32(nc, kc, B + (k0 * ldb0 + j0 * ldb1) * esz, ldb1, ldb0, packed_b);
-#elif CV_LASX
-                fast_gemm_pack16_f32(nc, kc, B + (k0 * ldb0 + j0 * ldb1) * esz, ldb1, ldb0, packed_b);
-#elif CV_SIMD128
-                fast_gemm_pack12_f32(nc, kc, B + (k0 * ldb0 + j0 * ldb1) * esz, ldb1, ldb0, packed_b);
-#endif
-
-                // run kernel
-                fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
-            }
-        }
-
-        if (!use_stackbuff) {
-            free(packed_a);
-        }
-    };
-
-    if (multi_thread) {
-        int cost_per_thread = static_cast<int>((K / KC) * (MC / GEMM_MR) * (NC / GEMM_NR));
-        double nstripes = (size_t)total_tiles * cost_per_thread * (1 / 1024.0);
-        parallel_for_(Range(0, total_tiles), fn, nstripes);
-    } else {
-        fn(Range(0, total_tiles));
-    }
-
-}
-
 void fastGemmKernel(int M, int N, int K,
                     float alpha, const char *A, int lda0, int lda1,
                     const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread) {
@@ -736,7 +663,8 @@ void fastGemmKernel(int M, int N, int K,
 
 void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
                          int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz) {
+                         const char *B, int ldb0, int ldb1, float beta, char *C, int ldc, int esz,
+                         const FastGemmEpilogue *epilogue) {
     int GEMM_MC = FAST_GEMM_F32_MC,
         GEMM_NC = FAST_GEMM_F32_NC,
         GEMM_MR = FAST_GEMM_F32_MR,
@@ -811,6 +739,9 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
                 // run kernel
                 fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
             }
+
+            if (epilogue)
+                epilogue->apply((float*)C, C_offsets[batch_index], ldc, i0, mc, j0, nc);
         }
 
         if (!use_stackbuff) {
@@ -824,9 +755,13 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
     parallel_for_(Range(0, total), fn, nstripes);
 }
 
-void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
-                         int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
-                         const char *packed_B, float beta, char *C, int ldc, int esz) {
+// TB is the type of packed B elements.
+template<typename TB>
+static void fast_gemm_batch_packed(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
+                                   int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
+                                   const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread,
+                                   const FastGemmEpilogue *epilogue) {
+    const int besz = (int)sizeof(TB);
     int GEMM_MC = FAST_GEMM_F32_MC,
         GEMM_NC = FAST_GEMM_F32_NC,
         GEMM_MR = FAST_GEMM_F32_MR,
@@ -859,7 +794,7 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
             int nc = N - j0 < NC ? N - j0 : NC;
             int ldc_block = ldc;
             const char *a_block = A + A_offsets[batch_index] * esz;
-            packed_b = packed_B + B_offsets[batch_index] * esz + j0 * K * esz;
+            packed_b = packed_B + B_offsets[batch_index] * besz + j0 * K * besz;
             char* c_block = C + C_offsets[batch_index] * esz + (i0 * ldc + j0) * esz;
 
             if (beta == 0.f) {
@@ -873,7 +808,7 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
                 }
             }
 
-            int _nc = static_cast<int>((nc + GEMM_NR - 1) / GEMM_NR) * GEMM_NR * esz;
+            int _nc = static_cast<int>((nc + GEMM_NR - 1) / GEMM_NR) * GEMM_NR * besz;
             for(int k0 = 0; k0 < K; k0 += KC)
             {
                 int kc = K - k0 < KC ? K - k0 : KC;
@@ -889,9 +824,12 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
 #endif
 
                 // run kernel
-                fast_gemm_macro_kernel(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
+                fast_gemm_macro_kernel<TB>(mc, nc, kc, packed_a, packed_b, alpha, c_block, ldc_block, esz);
                 packed_b += _nc * kc;
             }
+
+            if (epilogue)
+                epilogue->apply((float*)C, C_offsets[batch_index], ldc, i0, mc, j0, nc);
         }
 
         if (!use_stackbuff) {
@@ -902,16 +840,38 @@ void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_
     int total = batch * total_tiles;
     int cost_per_thread = static_cast<int>((K / KC) * (MC / GEMM_MR) * (NC / GEMM_NR));
     double nstripes = (size_t)total * cost_per_thread * (1 / 1024.0);
-    parallel_for_(Range(0, total), fn, nstripes);
+    if (multi_thread) {
+        parallel_for_(Range(0, total), fn, nstripes);
+    } else {
+        fn(Range(0, total));
+    }
 }
 
+void fastGemmBatchKernel(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
+                         int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
+                         const char *packed_B, float beta, char *C, int ldc, int esz, bool multi_thread,
+                         const FastGemmEpilogue *epilogue) {
+    fast_gemm_batch_packed<float>(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, A, lda0, lda1,
+                                  packed_B, beta, C, ldc, esz, multi_thread, epilogue);
+}
+
+#if CV_AVX2
+void fastGemmBatchKernelF16B(size_t batch, const size_t *A_offsets, const size_t *B_offsets, const size_t *C_offsets,
+                             int M, int N, int K, float alpha, const char *A, int lda0, int lda1,
+                             const hfloat *packed_B, float beta, char *C, int ldc, bool multi_thread,
+                             const FastGemmEpilogue *epilogue) {
+    fast_gemm_batch_packed<hfloat>(batch, A_offsets, B_offsets, C_offsets, M, N, K, alpha, A, lda0, lda1,
+                                   (const char *)packed_B, beta, C, ldc, (int)sizeof(float), multi_thread, epilogue);
+}
+#endif
+
+
 #endif // CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
 
 CV_CPU_OPTIMIZATION_NAMESPACE_END
 
 }} // cv::dnn
 
-#undef FAST_GEMM_STORAGE
 #undef FAST_GEMM_MAX_STACKBUF
 #ifdef FAST_GEMM_F32_MC
 #undef FAST_GEMM_F32_MC
@@ -0,0 +1,306 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "../../precomp.hpp"
+#include "sparse_weights.hpp"
+
+#include "opencv2/core/hal/intrin.hpp"
+
+namespace cv {
+namespace dnn {
+
+double SparseWeights::density() const
+{
+    int nblockRows = (int)rowStart.size();
+    return nblockRows > 0 && cols > 0 ? (double)blockCol.size() / ((double)nblockRows * cols) : 1.0;
+}
+
+// Calls fn(first row, number of rows) for every block row
+template<typename Fn>
+static void forEachBlockRow(int rows, int ngroups, Fn fn)
+{
+    CV_Assert(ngroups > 0 && rows % ngroups == 0);
+    int rowsPerGroup = rows / ngroups;
+    for (int g = 0; g < ngroups; g++)
+    {
+        for (int r = 0; r < rowsPerGroup; r += SPARSE_BLOCK_ROWS)
+            fn(g * rowsPerGroup + r, std::min((int)SPARSE_BLOCK_ROWS, rowsPerGroup - r));
+    }
+}
+
+double getBlockDensity(const Mat& weights, int ngroups)
+{
+    CV_Assert(weights.dims == 2 && weights.type() == CV_32F);
+    const int rows = weights.rows, cols = weights.cols;
+    int64 blocks = 0, nonzero = 0;
+    forEachBlockRow(rows, ngroups, [&](int r0, int nrows) {
+        for (int c = 0; c < cols; c++)
+        {
+            bool zero = true;
+            for (int i = 0; i < nrows && zero; i++)
+                zero = weights.at<float>(r0 + i, c) == 0.f;
+            nonzero += !zero;
+        }
+        blocks += cols;
+    });
+    return blocks > 0 ? (double)nonzero / blocks : 1.0;
+}
+
+bool useSparseWeights(const Mat& weights, int ngroups)
+{
+    size_t threshold = getParam_DNN_SPARSE_WEIGHTS_THRESHOLD();
+    if (threshold > 100 || weights.empty())
+        return false;
+    return 1.0 - getBlockDensity(weights, ngroups) >= threshold * 0.01;
+}
+
+void packSparseWeights(const Mat& weights, int ngroups, SparseWeights& sw)
+{
+    CV_Assert(weights.dims == 2 && weights.type() == CV_32F);
+    sw = SparseWeights();
+    sw.rows = weights.rows;
+    sw.cols = weights.cols;
+    sw.blockOfs.push_back(0);
+    forEachBlockRow(sw.rows, ngroups, [&](int r0, int nrows) {
+        sw.rowStart.push_back(r0);
+        for (int c = 0; c < sw.cols; c++)
+        {
+            float w[SPARSE_BLOCK_ROWS] = {};
+            bool zero = true;
+            for (int i = 0; i < nrows; i++)
+            {
+                w[i] = weights.at<float>(r0 + i, c);
+                zero = zero && w[i] == 0.f;
+            }
+            if (zero)
+                continue;
+            sw.blockCol.push_back(c);
+            sw.values.insert(sw.values.end(), w, w + SPARSE_BLOCK_ROWS);
+        }
+        sw.blockOfs.push_back((int)sw.blockCol.size());
+    });
+}
+
+void runSparseFullyConnected(const Mat& src, const SparseWeights& sw, const float* bias,
+                             Mat& dst, const ActivationLayer* activ)
+{
+    CV_Assert_N(!sw.empty(), src.dims == 2, dst.dims == 2, src.type() == CV_32F, dst.type() == CV_32F,
+                src.cols == sw.cols, dst.cols == sw.rows, src.rows == dst.rows);
+    const int M = src.rows, nblockRows = (int)sw.rowStart.size();
+    // Weights of a block are applied to MTILE rows of the input at once
+    const int MTILE = 4;
+    const int mtiles = (M + MTILE - 1) / MTILE;
+
+    parallel_for_(Range(0, mtiles * nblockRows), [&](const Range& r) {
+        for (int task = r.start; task < r.end; task++)
+        {
+            int m0 = (task / nblockRows) * MTILE, br = task % nblockRows;
+            int nm = std::min(MTILE, M - m0);
+            int k0 = sw.rowStart[br];
+            int nrows = (br + 1 < nblockRows ? sw.rowStart[br + 1] : sw.rows) - k0;
+            const int* cols = sw.blockCol.data();
+            const float* w = sw.values.data();
+            const float* sptr[MTILE];
+            for (int i = 0; i < MTILE; i++)
+                sptr[i] = src.ptr<float>(m0 + std::min(i, nm - 1));
+
+            float acc[MTILE][SPARSE_BLOCK_ROWS];
+            for (int i = 0; i < MTILE; i++)
+            {
+                for (int k = 0; k < SPARSE_BLOCK_ROWS; k++)
+                    acc[i][k] = bias && k < nrows ? bias[k0 + k] : 0.f;
+            }
+            int j = sw.blockOfs[br], jend = sw.blockOfs[br + 1];
+#if CV_SIMD128
+            v_float32x4 s0 = v_load(acc[0]), s1 = v_load(acc[1]), s2 = v_load(acc[2]), s3 = v_load(acc[3]);
+            for (; j < jend; j++)
+            {
+                v_float32x4 vw = v_load(w + j * SPARSE_BLOCK_ROWS);
+                int c = cols[j];
+                s0 = v_fma(vw, v_setall_f32(sptr[0][c]), s0);
+                s1 = v_fma(vw, v_setall_f32(sptr[1][c]), s1);
+                s2 = v_fma(vw, v_setall_f32(sptr[2][c]), s2);
+                s3 = v_fma(vw, v_setall_f32(sptr[3][c]), s3);
+            }
+            v_store(acc[0], s0);
+            v_store(acc[1], s1);
+            v_store(acc[2], s2);
+            v_store(acc[3], s3);
+#endif
+            for (; j < jend; j++)
+            {
+                const float* wj = w + j * SPARSE_BLOCK_ROWS;
+                int c = cols[j];
+                for (int i = 0; i < MTILE; i++)
+                {
+                    for (int k = 0; k < SPARSE_BLOCK_ROWS; k++)
+                        acc[i][k] += wj[k] * sptr[i][c];
+                }
+            }
+
+            for (int i = 0; i < nm; i++)
+            {
+                float* dptr = dst.ptr<float>(m0 + i) + k0;
+                for (int k = 0; k < nrows; k++)
+                    dptr[k] = acc[i][k];
+                if (activ)
+                    activ->forwardSlice(dptr, dptr, 1, 1, k0, k0 + nrows);
+            }
+        }
+    });
+}
+
+void packSparseConvWeights(const Mat& weights, int ngroups, const std::vector<size_t>& kernel_size,
+                           const std::vector<size_t>& dilations, const std::vector<size_t>& pads_begin,
+                           SparseWeights& sw)
+{
+    CV_Assert_N(kernel_size.size() == 2, dilations.size() == 2, pads_begin.size() == 2);
+    packSparseWeights(weights, ngroups, sw);
+
+    const int kh = (int)kernel_size[0], kw = (int)kernel_size[1];
+    const int Cg = sw.cols / (kh * kw);
+    CV_Assert(Cg * kh * kw == sw.cols);
+    const int rowsPerGroup = sw.rows / ngroups;
+    const int nblockRows = (int)sw.rowStart.size();
+    size_t nblocks = sw.blockCol.size();
+    sw.blockChannel.resize(nblocks);
+    sw.blockDy.resize(nblocks);
+    sw.blockDx.resize(nblocks);
+    for (int br = 0; br < nblockRows; br++)
+    {
+        int g = sw.rowStart[br] / rowsPerGroup;
+        for (int j = sw.blockOfs[br]; j < sw.blockOfs[br + 1]; j++)
+        {
+            int col = sw.blockCol[j];
+            int c = col / (kh * kw), ky = (col / kw) % kh, kx = col % kw;
+            sw.blockChannel[j] = g * Cg + c;
+            sw.blockDy[j] = ky * (int)dilations[0] - (int)pads_begin[0];
+            sw.blockDx[j] = kx * (int)dilations[1] - (int)pads_begin[1];
+        }
+    }
+}
+
+void runSparseConv(const Mat& input, Mat& output, const SparseWeights& sw, const std::vector<size_t>& strides,
+                   const float* bias, const ActivationLayer* activ, bool fusedAdd)
+{
+    CV_Assert_N(!sw.blockChannel.empty() || sw.blockCol.empty(), strides.size() == 2,
+                input.dims == 4, output.dims == 4, input.type() == CV_32F, output.type() == CV_32F,
+                input.isContinuous(), output.isContinuous(), input.size[0] == output.size[0],
+                output.size[1] == sw.rows);
+    const int N = input.size[0], H = input.size[2], W = input.size[3];
+    const int Ho = output.size[2], Wo = output.size[3];
+    const int stride_h = (int)strides[0], stride_w = (int)strides[1];
+    const size_t inpPlane = (size_t)H * W, outPlane = (size_t)Ho * Wo;
+    const int nblockRows = (int)sw.rowStart.size();
+
+    int dxMin = 0, dxMax = 0;
+    if (!sw.blockDx.empty())
+    {
+        dxMin = *std::min_element(sw.blockDx.begin(), sw.blockDx.end());
+        dxMax = *std::max_element(sw.blockDx.begin(), sw.blockDx.end());
+    }
+
+    // Rows of the output are split into stripes if there are not enough tasks
+    int ntasks0 = N * nblockRows;
+    int ystripes = std::max(std::min((getNumThreads() * 4 + ntasks0 - 1) / std::max(ntasks0, 1), Ho), 1);
+    int stripeRows = (Ho + ystripes - 1) / ystripes;
+    ystripes = (Ho + stripeRows - 1) / stripeRows;
+
+    parallel_for_(Range(0, ntasks0 * ystripes), [&](const Range& r) {
+        std::vector<float> dummy(Wo);
+        for (int task = r.start; task < r.end; task++)
+        {
+            int n = task / (nblockRows * ystripes), rest = task % (nblockRows * ystripes);
+            int br = rest / ystripes, y0 = (rest % ystripes) * stripeRows, y1 = std::min(y0 + stripeRows, Ho);
+            int k0 = sw.rowStart[br];
+            int nrows = (br + 1 < nblockRows ? sw.rowStart[br + 1] : sw.rows) - k0;
+            int jstart = sw.blockOfs[br], jend = sw.blockOfs[br + 1];
+            const float* inp = input.ptr<float>(n);
+            float* out0 = output.ptr<float>(n) + k0 * outPlane;
+            float b[SPARSE_BLOCK_ROWS] = {};
+            for (int i = 0; i < nrows; i++)
+                b[i] = bias ? bias[k0 + i] : 0.f;
+
+            for (int y = y0; y < y1; y++)
+            {
+                // rows of the block which are out of the block row have zero weights
+                float* orow[SPARSE_BLOCK_ROWS];
+                for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                    orow[i] = i < nrows ? out0 + i * outPlane + y * Wo : dummy.data();
+
+                auto computePixel = [&](int x) {
+                    float s[SPARSE_BLOCK_ROWS];
+                    for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                        s[i] = b[i] + (fusedAdd ? orow[i][x] : 0.f);
+                    for (int j = jstart; j < jend; j++)
+                    {
+                        int yi = y * stride_h + sw.blockDy[j], xi = x * stride_w + sw.blockDx[j];
+                        if ((unsigned)yi >= (unsigned)H || (unsigned)xi >= (unsigned)W)
+                            continue;
+                        float v = inp[sw.blockChannel[j] * inpPlane + yi * W + xi];
+                        const float* w = sw.values.data() + j * SPARSE_BLOCK_ROWS;
+                        for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                            s[i] += w[i] * v;
+                    }
+                    for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                        orow[i][x] = s[i];
+                };
+
+                int x = 0;
+#if CV_SIMD128
+                if (stride_w == 1)
+                {
+                    // Inputs of all the blocks are inside the row for x in [xstart, xend)
+                    int xstart = std::min(std::max(-dxMin, 0), Wo), xend = std::max(std::min(Wo, W - dxMax), xstart);
+                    for (; x < xstart; x++)
+                        computePixel(x);
+                    for (; x + 8 <= xend; x += 8)
+                    {
+                        v_float32x4 s[SPARSE_BLOCK_ROWS][2];
+                        for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                        {
+                            v_float32x4 vb = v_setall_f32(b[i]);
+                            s[i][0] = fusedAdd ? v_add(v_load(orow[i] + x), vb) : vb;
+                            s[i][1] = fusedAdd ? v_add(v_load(orow[i] + x + 4), vb) : vb;
+                        }
+                        for (int j = jstart; j < jend; j++)
+                        {
+                            int yi = y * stride_h + sw.blockDy[j];
+                            if ((unsigned)yi >= (unsigned)H)
+                                continue;
+                            const float* iptr = inp + sw.blockChannel[j] * inpPlane + yi * W + x + sw.blockDx[j];
+                            const float* w = sw.values.data() + j * SPARSE_BLOCK_ROWS;
+                            v_float32x4 x0 = v_load(iptr), x1 = v_load(iptr + 4);
+                            v_float32x4 w0 = v_setall_f32(w[0]), w1 = v_setall_f32(w[1]);
+                            v_float32x4 w2 = v_setall_f32(w[2]), w3 = v_setall_f32(w[3]);
+                            s[0][0] = v_fma(x0, w0, s[0][0]); s[0][1] = v_fma(x1, w0, s[0][1]);
+                            s[1][0] = v_fma(x0, w1, s[1][0]); s[1][1] = v_fma(x1, w1, s[1][1]);
+                            s[2][0] = v_fma(x0, w2, s[2][0]); s[2][1] = v_fma(x1, w2, s[2][1]);
+                            s[3][0] = v_fma(x0, w3, s[3][0]); s[3][1] = v_fma(x1, w3, s[3][1]);
+                        }
+                        for (int i = 0; i < SPARSE_BLOCK_ROWS; i++)
+                        {
+                            v_store(orow[i] + x, s[i][0]);
+                            v_store(orow[i] + x + 4, s[i][1]);
+                        }
+                    }
+                }
+#endif
+                for (; x < Wo; x++)
+                    computePixel(x);
+            }
+
+            if (activ)
+            {
+                for (int i = 0; i < nrows; i++)
+                {
+                    float* ptr = out0 + i * outPlane + y0 * Wo;
+                    activ->forwardSlice(ptr, ptr, (y1 - y0) * Wo, outPlane, k0 + i, k0 + i + 1);
+                }
+            }
+        }
+    });
+}
+
+}} // namespace cv::dnn
@@ -0,0 +1,58 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef OPENCV_DNN_SPARSE_WEIGHTS_HPP
+#define OPENCV_DNN_SPARSE_WEIGHTS_HPP
+
+#include <opencv2/dnn/all_layers.hpp>
+
+namespace cv {
+namespace dnn {
+
+// Number of consecutive rows (output channels) of a block, a block is a part of one column.
+enum { SPARSE_BLOCK_ROWS = 4 };
+
+// Weights of pruned models in block compressed sparse row format: blocks with all weights equal
+// to zero are not stored. Rows of a block belong to the same group.
+struct SparseWeights
+{
+    int rows = 0, cols = 0;
+    std::vector<int> rowStart;   // first row of every block row
+    std::vector<int> blockOfs;   // first block of every block row and the total number of blocks
+    std::vector<int> blockCol;   // column of every block
+    std::vector<float> values;   // SPARSE_BLOCK_ROWS weights of every block, zeros for rows out of the block row
+
+    // Convolution: input channel and offsets of the input pixel of every block
+    std::vector<int> blockChannel, blockDy, blockDx;
+
+    bool empty() const { return blockOfs.empty(); }
+    // Fraction of blocks which are stored
+    double density() const;
+};
+
+// Fraction of blocks with non-zero weights in rows x cols matrix of weights, rows of every group
+// are split into blocks separately.
+double getBlockDensity(const Mat& weights, int ngroups);
+
+// Returns true if the sparse kernels are faster for the weights, see OPENCV_DNN_SPARSE_WEIGHTS_THRESHOLD.
+bool useSparseWeights(const Mat& weights, int ngroups);
+
+void packSparseWeights(const Mat& weights, int ngroups, SparseWeights& sw);
+
+// dst = src * weights^T + bias, src is M x cols and dst is M x rows.
+void runSparseFullyConnected(const Mat& src, const SparseWeights& weights, const float* bias,
+                             Mat& dst, const ActivationLayer* activ);
+
+// Columns of the weights are (input channel of the group, kernel y, kernel x).
+void packSparseConvWeights(const Mat& weights, int ngroups, const std::vector<size_t>& kernel_size,
+                           const std::vector<size_t>& dilations, const std::vector<size_t>& pads_begin,
+                           SparseWeights& sw);
+
+// Direct 2D convolution which skips zero blocks. If fusedAdd is set, the output is added to the result.
+void runSparseConv(const Mat& input, Mat& output, const SparseWeights& weights, const std::vector<size_t>& strides,
+                   const float* bias, const ActivationLayer* activ, bool fusedAdd);
+
+}} // namespace cv::dnn
+
+#endif // OPENCV_DNN_SPARSE_WEIGHTS_HPP
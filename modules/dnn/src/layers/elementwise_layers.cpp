@@ -102,13 +102,15 @@ public:
     {
     public:
         const Func* func_;
+        const std::vector<Ptr<ActivationLayer> >* activs_;
         const Mat* src_;
         Mat* dst_;
         int nstripes_;
 
-        PBody(const Func &func, const Mat &src, Mat& dst, int nstripes)
+        PBody(const Func &func, const std::vector<Ptr<ActivationLayer> >& activs, const Mat &src, Mat& dst, int nstripes)
         {
             func_ = &func;
+            activs_ = &activs;
             src_ = &src;
             dst_ = &dst;
             nstripes_ = nstripes;
@@ -134,11 +136,35 @@ public:
             size_t stripeStart = r.start*stripeSize;
             size_t stripeEnd = std::min(r.end*stripeSize, planeSize);
 
+            if (activs_->empty())
+            {
+                for( int i = 0; i < nsamples; i++ )
+                {
+                    const float* srcptr = src_->ptr<float>(i) + stripeStart;
+                    float* dstptr = dst_->ptr<float>(i) + stripeStart;
+                    func_->apply(srcptr, dstptr, stripeStart, (int)(stripeEnd - stripeStart), planeSize, 0, outCn);
+                }
+                return;
+            }
+
+            // The fused activations are applied to blocks of the stripe while they are in cache
+            const int blockSize = 1 << 12;
             for( int i = 0; i < nsamples; i++ )
             {
-                const float* srcptr = src_->ptr<float>(i) + stripeStart;
-                float* dstptr = dst_->ptr<float>(i) + stripeStart;
-                func_->apply(srcptr, dstptr, stripeStart, (int)(stripeEnd - stripeStart), planeSize, 0, outCn);
+                for( size_t ofs = stripeStart; ofs < stripeEnd; ofs += blockSize )
+                {
+                    int len = (int)std::min(stripeEnd - ofs, (size_t)blockSize);
+                    int cnBlock = std::max(blockSize / len, 1);
+                    for( int cn0 = 0; cn0 < outCn; cn0 += cnBlock )
+                    {
+                        int cn1 = std::min(cn0 + cnBlock, outCn);
+                        const float* srcptr = src_->ptr<float>(i) + cn0 * planeSize + ofs;
+                        float* dstptr = dst_->ptr<float>(i) + cn0 * planeSize + ofs;
+                        func_->apply(srcptr, dstptr, (int)ofs, len, planeSize, cn0, cn1);
+                        for( size_t k = 0; k < activs_->size(); k++ )
+                            (*activs_)[k]->forwardSlice(dstptr, dstptr, len, planeSize, cn0, cn1);
+                    }
+                }
             }
         }
     };
@@ -261,7 +287,7 @@ public:
                       src.isContinuous() && dst.isContinuous() && src.type() == CV_32F);
 
             const int nstripes = getNumThreads();
-            PBody body(func, src, dst, nstripes);
+            PBody body(func, fusedActivs, src, dst, nstripes);
             parallel_for_(Range(0, nstripes), body, nstripes);
         }
     }
@@ -269,6 +295,22 @@ public:
     void forwardSlice(const float* src, float* dst, int len, size_t planeSize, int cn0, int cn1) const CV_OVERRIDE
     {
         func.apply(src, dst, -1, len, planeSize, cn0, cn1);
+        for (size_t k = 0; k < fusedActivs.size(); k++)
+            fusedActivs[k]->forwardSlice(dst, dst, len, planeSize, cn0, cn1);
+    }
+
+    // A chain of activations is evaluated in a single pass over the data
+    virtual bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE
+    {
+        if (layer.empty())
+        {
+            fusedActivs.clear();
+            return false;
+        }
+        if (!IS_DNN_CPU_TARGET(this->preferableTarget) || !isPointwiseActivation(layer))
+            return false;
+        fusedActivs.push_back(layer);
+        return true;
     }
 
 #ifdef HAVE_CUDA
@@ -301,6 +343,7 @@ public:
     }
 
     Func func;
+    std::vector<Ptr<ActivationLayer> > fusedActivs;
 };
 
 #ifdef HAVE_OPENCL
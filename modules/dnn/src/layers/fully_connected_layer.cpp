@@ -51,6 +51,7 @@
 #include "../op_vkcom.hpp"
 
 #include <opencv2/dnn/shape_utils.hpp>
+#include "cpu_kernels/sparse_weights.hpp"
 
 #ifdef HAVE_OPENCL
 #include "opencl_kernels_dnn.hpp"
@@ -344,14 +345,20 @@ public:
         bool useLASX;
     };
 
-#ifdef HAVE_OPENCL
     virtual void finalize(InputArrayOfArrays, OutputArrayOfArrays) CV_OVERRIDE
     {
+#ifdef HAVE_OPENCL
         innerProductOp.release();
         umat_blobs.clear();
         half_blobs.clear();
+#endif
+        // Pruned weights are packed once, zero blocks are skipped by the CPU kernel
+        if (sparseWeights.empty() && !blobs.empty() && !isMatMul && useSparseWeights(weightsMat, 1))
+            packSparseWeights(weightsMat, 1, sparseWeights);
     }
 
+#ifdef HAVE_OPENCL
+
     bool forward_ocl(InputArrayOfArrays inps, OutputArrayOfArrays outs, InputArrayOfArrays internals)
     {
         std::vector<UMat> inputs;
@@ -551,6 +558,11 @@ public:
                     Mat srcMat = input[i].reshape(1, outerSize);
                     Mat dstMat = output[i].reshape(1, outerSize);
 
+                    if (!sparseWeights.empty())
+                    {
+                        runSparseFullyConnected(srcMat, sparseWeights, biasMat.ptr<float>(), dstMat, activ.get());
+                        continue;
+                    }
                     const int nstripes = getNumThreads();
                     FullyConnected::run(srcMat, weightsMat, biasMat, dstMat, activ.get(), nstripes);
                 }
@@ -928,9 +940,14 @@ public:
                 innerSize = inputs[1][0];
         }
 
+        // Zero blocks of pruned weights are skipped by the sparse kernel
+        double density = 1.0;
+        if (!blobs.empty() && !isMatMul && useSparseWeights(weightsMat, 1))
+            density = getBlockDensity(weightsMat, 1);
+
         for(int i = 0; i < outputs.size(); i++)
         {
-            flops += CV_BIG_INT(3)*innerSize*total(outputs[i]);
+            flops += (int64)(3.0*innerSize*density)*total(outputs[i]);
         }
 
         return flops;
@@ -938,6 +955,7 @@ public:
 
     bool bias;
     Mat weightsMat, biasMat, oriMat;
+    SparseWeights sparseWeights;  // packed weightsMat if it is pruned
     bool transA, transB;
     bool isMatMul = false;
     Ptr<ActivationLayer> activ;
@@ -17,10 +17,12 @@ using namespace cv::dnn::cuda4dnn;
 
 #include <opencv2/dnn/shape_utils.hpp>
 #include "cpu_kernels/fast_gemm.hpp"
+#include "../shared_weights.hpp"
+#include "../net_profiler.hpp"
 
 namespace cv { namespace dnn {
 
-class GemmLayerImpl CV_FINAL : public GemmLayer {
+class GemmLayerImpl CV_FINAL : public GemmLayer, public SharedWeightsHolder, public LayerKernelInfo, public LayerFinalizeInfo {
 public:
     GemmLayerImpl(const LayerParams& params) {
         setParamsFrom(params);
@@ -107,6 +109,7 @@ public:
         if (beta != 0 && !C.empty()) {
             broadcast_C.clear();
             broadcast_C.resize(M * N, 0.f);
+            broadcast_C_shape = shape(M, N);
 
             const float *ptr_c = C.ptr<const float>();
             const auto shape_C = shape(C);
@@ -143,28 +146,69 @@ public:
         }
     }
 
-    virtual void finalize(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr) CV_OVERRIDE {
+    std::string getKernelName() const CV_OVERRIDE {
+        if (!const_B)
+            return "fastGemmBatch";
+        return packed_B && packed_B->isFP16() ? "fastGemm/packed_B_FP16" : "fastGemm/packed_B";
+    }
+
+    bool exportPacked(std::string& key, std::vector<Mat>& data) const CV_OVERRIDE {
+        if (!packed_B || packedKey.empty())
+            return false;
+        key = packedKey;
+        data.assign(1, packed_B->exportData());
+        return true;
+    }
+
+    void importPacked(const std::string& key, const std::vector<Mat>& data) CV_OVERRIDE {
+        CV_Assert(sharedWeights && !blobs.empty());
+        CV_CheckEQ(data.size(), (size_t)1, "DNN/Gemm: unexpected packed weights");
+        auto packed = makePtr<FastGemmPackedB>();
+        packed->importData(data[0]);
+        sharedWeights->preload(key, std::vector<Mat>(1, blobs[0]), packed);
+    }
+
+    virtual void finalize(InputArrayOfArrays, OutputArrayOfArrays) CV_OVERRIDE {
         opt.init();
 
         // pack B if it is const
         if (const_B) {
-            fastGemmPackB(blobs[0], packed_B, trans_b, opt);
+            const bool useFP16 = preferableTarget == DNN_TARGET_CPU_FP16 && opt.use_fp16_b;
+            std::function<Ptr<FastGemmPackedB>()> pack = [&]() {
+                auto packed = makePtr<FastGemmPackedB>();
+                if (useFP16)
+                    fastGemmPackB(blobs[0], packed->buf_fp16, trans_b, opt);
+                else
+                    fastGemmPackB(blobs[0], packed->buf, trans_b, opt);
+                return packed;
+            };
+            if (sharedWeights) {
+                // Layout of packed weights depends on the platform, so it is a part of the key.
+                packedKey = format("%s/gemm:transB=%d,fp16=%d,isa=%d%d%d%d", name.c_str(), (int)trans_b, (int)useFP16,
+                                   (int)opt.use_avx, (int)opt.use_avx2, (int)opt.use_neon, (int)opt.use_lasx);
+                packed_B = sharedWeights->get<FastGemmPackedB>(packedKey, std::vector<Mat>(1, blobs[0]), pack);
+            } else {
+                packed_B = pack();
+            }
         }
 
-        // also pre-broadcast bias
-        if (const_C) {
-            const auto &C = blobs.back();
+        // const bias is broadcast in forward() once for every output shape
+        broadcast_C_shape.clear();
+    }
 
-            std::vector<Mat> outputs;
-            outputs_arr.getMatVector(outputs);
-            const auto &Y = outputs[0];
-            const auto shape_Y = shape(Y);
-            size_t dims_Y = shape_Y.size();
-            int M = shape_Y[dims_Y - 2], N = shape_Y[dims_Y - 1];
+    // packing of B doesn't depend on the input shapes
+    bool isFinalizeShapeIndependent() const CV_OVERRIDE {
+        return true;
+    }
 
-            // broadcast
-            broadcastCWtihBeta(M, N, C);
-        }
+    // the activation is applied to tiles of Y by fastGemm
+    bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE {
+        if (!layer.empty() && (!activ.empty() || !IS_DNN_CPU_TARGET(preferableTarget)))
+            return false;
+        if (!epilogue.setActivation(layer))
+            return false;
+        activ = layer;
+        return true;
     }
 
     // Y = A * B + C, note that C is unidirectionaly broadcastable to (A * B).
@@ -196,6 +240,8 @@ public:
         if (have_bias) {
             if (!const_C) {
                 broadcastCWtihBeta(M, N, inputs.back());
+            } else if (broadcast_C_shape != shape(M, N)) {
+                broadcastCWtihBeta(M, N, blobs.back());
             }
             int step = M * N;
             CV_CheckEQ(broadcast_C.size(), static_cast<size_t>(step), "DNN/Gemm: C is not broadcast properly");
@@ -208,10 +254,10 @@ public:
         }
 
         if (const_B) {
-            CV_CheckGT(packed_B.size(), static_cast<size_t>(0), "DNN/Gemm: constant B is not pre-packed");
-            fastGemm(trans_a, M, N, K, alpha, A.ptr<const float>(), na, packed_B.data(), 1.f, Y.ptr<float>(), N, opt);
+            CV_CheckGT(packed_B ? packed_B->size() : 0, static_cast<size_t>(0), "DNN/Gemm: constant B is not pre-packed");
+            fastGemm(trans_a, M, N, K, alpha, A.ptr<const float>(), na, *packed_B, 1.f, Y.ptr<float>(), N, opt, &epilogue);
         } else {
-            fastGemmBatch(trans_a, trans_b, alpha, A, inputs[1], 1.f, Y, opt);
+            fastGemmBatch(trans_a, trans_b, alpha, A, inputs[1], 1.f, Y, opt, &epilogue);
         }
     }
 
@@ -368,10 +414,14 @@ private:
     bool const_B;
     bool const_C;
     bool have_bias;
-    std::vector<float> packed_B;
+    Ptr<FastGemmPackedB> packed_B;  // may be shared between copies of the network
+    std::string packedKey;
     std::vector<float> broadcast_C;
+    MatShape broadcast_C_shape;  // M, N of broadcast_C
     int real_ndims_C;
     FastGemmOpt opt;
+    Ptr<ActivationLayer> activ;
+    FastGemmEpilogue epilogue;
 };
 
 Ptr<GemmLayer> GemmLayer::create(const LayerParams& params) {
@@ -264,5 +264,12 @@ double getWeightScale(const Mat& weightsMat)
     return (realMax == realMin) ? 1.0 : std::max(-realMin, realMax)/127;
 }
 
+bool isPointwiseActivation(const Ptr<ActivationLayer>& layer)
+{
+    // PReLU is implemented by ChannelsPReLULayer too
+    return !layer.empty() && layer.dynamicCast<ChannelsPReLULayer>().empty() &&
+           layer.dynamicCast<BatchNormLayer>().empty();
+}
+
 }
 }
@@ -43,6 +43,7 @@
 #ifndef __OPENCV_DNN_LAYERS_LAYERS_COMMON_HPP__
 #define __OPENCV_DNN_LAYERS_LAYERS_COMMON_HPP__
 #include <opencv2/dnn.hpp>
+#include <opencv2/dnn/all_layers.hpp>
 #include <opencv2/dnn/shape_utils.hpp>
 
 #define CV_CPU_OPTIMIZATION_DECLARATIONS_ONLY
@@ -76,6 +77,10 @@ void getConvPoolPaddings(const std::vector<int>& inp, const std::vector<size_t>&
 
 // Used in quantized model. It will return the (Max_element - Min_element)/127.
 double getWeightScale(const Mat& weightsMat);
+
+// Returns true if the activation doesn't depend on the channel and the position of the element,
+// so it can be fused into another layer and applied to any slice of its output.
+bool isPointwiseActivation(const Ptr<ActivationLayer>& layer);
 }
 }
 
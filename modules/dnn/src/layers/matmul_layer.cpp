@@ -6,6 +6,8 @@
 
 #include <opencv2/dnn/shape_utils.hpp>
 #include "cpu_kernels/fast_gemm.hpp"
+#include "../shared_weights.hpp"
+#include "../net_profiler.hpp"
 
 // OpenVINO backend
 #include "../op_inf_engine.hpp"
@@ -25,7 +27,7 @@ using namespace cv::dnn::cuda4dnn;
 
 namespace cv { namespace dnn {
 
-class MatMulLayerImpl CV_FINAL : public MatMulLayer {
+class MatMulLayerImpl CV_FINAL : public MatMulLayer, public SharedWeightsHolder, public LayerKernelInfo {
 #ifdef HAVE_OPENCL
     UMat weight_umat, bias_umat;
 #endif
@@ -118,6 +120,28 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
         return false;
     }
 
+    std::string getKernelName() const CV_OVERRIDE {
+        if (!packed_input_B)
+            return "fastGemmBatch";
+        return packed_input_B->isFP16() ? "fastGemmBatch/packed_B_FP16" : "fastGemmBatch/packed_B";
+    }
+
+    bool exportPacked(std::string& key, std::vector<Mat>& data) const CV_OVERRIDE {
+        if (!packed_input_B || packedKey.empty())
+            return false;
+        key = packedKey;
+        data.assign(1, packed_input_B->exportData());
+        return true;
+    }
+
+    void importPacked(const std::string& key, const std::vector<Mat>& data) CV_OVERRIDE {
+        CV_Assert(sharedWeights && !blobs.empty());
+        CV_CheckEQ(data.size(), (size_t)1, "DNN/MatMul: unexpected packed weights");
+        auto packed = makePtr<FastGemmPackedB>();
+        packed->importData(data[0]);
+        sharedWeights->preload(key, std::vector<Mat>(1, blobs[0]), packed);
+    }
+
     virtual void finalize(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr) CV_OVERRIDE {
         opt.init();
 
@@ -131,8 +155,24 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
         helper.compute(trans_a, trans_b, A_shape, B_shape, C_shape);
 
         if (!blobs.empty()) {
-            fastGemmPackB(blobs[0], packed_input_B, trans_b, opt);
-            helper.updatePackedBOffsets(packed_input_B.size());
+            const bool useFP16 = preferableTarget == DNN_TARGET_CPU_FP16 && opt.use_fp16_b;
+            std::function<Ptr<FastGemmPackedB>()> pack = [&]() {
+                auto packed = makePtr<FastGemmPackedB>();
+                if (useFP16)
+                    fastGemmPackB(blobs[0], packed->buf_fp16, trans_b, opt);
+                else
+                    fastGemmPackB(blobs[0], packed->buf, trans_b, opt);
+                return packed;
+            };
+            if (sharedWeights) {
+                // Layout of packed weights depends on the platform, so it is a part of the key.
+                packedKey = format("%s/matmul:transB=%d,fp16=%d,isa=%d%d%d%d", name.c_str(), (int)trans_b, (int)useFP16,
+                                   (int)opt.use_avx, (int)opt.use_avx2, (int)opt.use_neon, (int)opt.use_lasx);
+                packed_input_B = sharedWeights->get<FastGemmPackedB>(packedKey, std::vector<Mat>(1, blobs[0]), pack);
+            } else {
+                packed_input_B = pack();
+            }
+            helper.updatePackedBOffsets(packed_input_B->size());
         }
 
         // broadcast bias if needed
@@ -168,12 +208,33 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
             }
         }
 
+        // const per-column bias is added by fastGemmBatch to the tiles of the output
+        epilogue.bias = NULL;
+        if ((inputs.size() + blobs.size()) >= 3 && blobs.size() >= 2 && real_ndims_C == 1 &&
+            blobs.back().total() == (size_t)C_shape.back()) {
+            const auto &bias_mat = blobs.back();
+            bias_row.resize(bias_mat.total());
+            for (size_t j = 0; j < bias_row.size(); j++)
+                bias_row[j] = beta * bias_mat.ptr<const float>()[j];
+            epilogue.bias = bias_row.data();
+        }
+
 #ifdef HAVE_OPENCL
         weight_umat.release();
         bias_umat.release();
 #endif
     }
 
+    // the activation is applied to tiles of Y by fastGemmBatch
+    bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE {
+        if (!layer.empty() && (!activ.empty() || !IS_DNN_CPU_TARGET(preferableTarget)))
+            return false;
+        if (!epilogue.setActivation(layer))
+            return false;
+        activ = layer;
+        return true;
+    }
+
     // works like Y = numpy.matmul(A, B)
     void forward(InputArrayOfArrays inputs_arr, OutputArrayOfArrays outputs_arr, OutputArrayOfArrays internals_arr) CV_OVERRIDE {
         CV_TRACE_FUNCTION();
@@ -198,7 +259,10 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
         const auto *a = A.ptr<const float>();
         auto *y = Y.ptr<float>();
         // add bias if existed
-        if ((inputs.size() + blobs.size()) >= 3) {
+        float gemm_beta = beta;
+        if (epilogue.bias) {
+            gemm_beta = 0.f;
+        } else if ((inputs.size() + blobs.size()) >= 3) {
             const auto &shape_Y = shape(Y);
             if (blobs.empty()) { // bias from input
                 const auto &bias_mat = inputs.back();
@@ -235,11 +299,11 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
             const auto *b = B.ptr<const float>();
             fastGemmBatch(helper.batch, helper.A_offsets.data(), helper.B_offsets.data(), helper.C_offsets.data(),
                           helper.M, helper.N, helper.K, alpha, a, helper.lda0, helper.lda1,
-                          b, helper.ldb0, helper.ldb1, beta, y, helper.ldc, opt);
+                          b, helper.ldb0, helper.ldb1, gemm_beta, y, helper.ldc, opt, &epilogue);
         } else {
             fastGemmBatch(helper.batch, helper.A_offsets.data(), helper.packed_B_offsets.data(), helper.C_offsets.data(),
                           helper.M, helper.N, helper.K, alpha, a, helper.lda0, helper.lda1,
-                          packed_input_B.data(), beta, y, helper.ldc, opt);
+                          *packed_input_B, gemm_beta, y, helper.ldc, opt, &epilogue);
         }
     }
 
@@ -471,11 +535,16 @@ class MatMulLayerImpl CV_FINAL : public MatMulLayer {
 
     int real_ndims_C;
 
-    std::vector<float> packed_input_B;
+    Ptr<FastGemmPackedB> packed_input_B;  // may be shared between copies of the network
+    std::string packedKey;
     Mat broadcast_bias;
 
     FastGemmOpt opt;
     MatMulHelper helper;
+
+    Ptr<ActivationLayer> activ;
+    std::vector<float> bias_row;  // beta * bias
+    FastGemmEpilogue epilogue;
 };
 
 Ptr<MatMulLayer> MatMulLayer::create(const LayerParams& params)
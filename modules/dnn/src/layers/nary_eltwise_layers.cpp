@@ -187,6 +187,8 @@ public:
 class NaryEltwiseLayerImpl CV_FINAL : public NaryEltwiseLayer
 {
     NaryEltwiseHelper helper;
+    std::vector<Ptr<ActivationLayer> > fusedActivs;
+    enum { activ_block_size = 1 << 12 };  // elements of the output, which are processed by the activations at once
 public:
     enum class OPERATION
     {
@@ -395,7 +397,10 @@ public:
             };
 
             double nstripes = plane_size * (1.0 / double(block_size));
-            parallel_for_(Range(0, plane_size), worker, nstripes);
+            // only the contiguous cases of the worker may process the range by parts
+            bool contiguous = dp == 1 && ((dp1 == 1 && dp2 == 1) || (dp1 == 1 && dp2 == 0) || (dp1 == 0 && dp2 == 1));
+            parallel_for_with_activations(Range(0, plane_size), worker, nstripes, (T*)data, 1,
+                                          contiguous ? activ_block_size : plane_size);
         } else { // parallelize across planes
             auto worker = [&](const Range &r) {
                 for (int plane_idx = r.start; plane_idx < r.end; plane_idx++) {
@@ -437,10 +442,53 @@ public:
                 }
             };
             double nstripes = nplanes * (1.0 / double(block_size));
-            parallel_for_(Range(0, nplanes), worker, nstripes);
+            parallel_for_with_activations(Range(0, nplanes), worker, nstripes, (T*)data, plane_size,
+                                          std::max(activ_block_size / plane_size, 1));
         }
     }
 
+    /*
+        Runs the worker over the range of elements or planes of the output (unit is their size).
+        The fused activations are applied to every block_size units of the output right after
+        they are computed, while they are in cache.
+    */
+    template <typename T, typename Worker>
+    void parallel_for_with_activations(const Range& range, const Worker& worker, double nstripes,
+                                       T* out, int unit, int block_size) const {
+        if (fusedActivs.empty()) {
+            parallel_for_(range, worker, nstripes);
+            return;
+        }
+        CV_Assert((std::is_same<T, float>::value));
+        parallel_for_(range, [&](const Range& r) {
+            for (int start = r.start; start < r.end; ) {
+                Range block(start, start + std::min(block_size, r.end - start));
+                worker(block);
+                float* ptr = (float*)(out + (size_t)block.start * unit);
+                int len = block.size() * unit;
+                for (size_t k = 0; k < fusedActivs.size(); k++)
+                    fusedActivs[k]->forwardSlice(ptr, ptr, len, len, 0, 1);
+                start = block.end;
+            }
+        }, nstripes);
+    }
+
+    // A following pointwise activation is fused into the arithmetic binary operations
+    virtual bool setActivation(const Ptr<ActivationLayer>& layer) CV_OVERRIDE {
+        if (layer.empty()) {
+            fusedActivs.clear();
+            return false;
+        }
+        const bool arithmetic = op == OPERATION::ADD || op == OPERATION::SUM || op == OPERATION::SUB ||
+                                op == OPERATION::PROD || op == OPERATION::DIV || op == OPERATION::MAX ||
+                                op == OPERATION::MIN || op == OPERATION::MEAN;
+        if (!IS_DNN_CPU_TARGET(preferableTarget) || !arithmetic || helper.ninputs != 2 ||
+            !isPointwiseActivation(layer))
+            return false;
+        fusedActivs.push_back(layer);
+        return true;
+    }
+
     /*
         Elementwise binary operator (like +, -, x, /, etc.) which takes two operands
     */
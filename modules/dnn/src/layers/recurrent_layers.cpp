@@ -51,6 +51,7 @@ using namespace cv::dnn::cuda4dnn;
 #endif
 
 #include "layers_common.hpp"
+#include "cpu_kernels/fast_gemm.hpp"
 
 namespace cv
 {
@@ -105,6 +106,114 @@ static ActivationFunction get_activation_function(const String& activation) {
     }
 }
 
+static inline float sigmoid(float x)
+{
+    return 1.f / (1.f + std::exp(-x));
+}
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+static inline v_float32 v_sigmoid(const v_float32& x)
+{
+    const v_float32 one = vx_setall_f32(1.f);
+    return v_div(one, v_add(one, v_exp(v_sub(vx_setzero_f32(), x))));
+}
+
+static inline v_float32 v_tanh(const v_float32& x)
+{
+    const v_float32 one = vx_setall_f32(1.f);
+    v_float32 ax = v_abs(x), x2 = v_mul(x, x);
+    v_float32 e = v_exp(v_mul(ax, vx_setall_f32(-2.f)));
+    v_float32 t = v_div(v_sub(one, e), v_add(one, e));
+    // 1 - e loses precision near zero, the Taylor series is used there
+    v_float32 p = v_mul(ax, v_fma(x2, v_fma(x2, vx_setall_f32(2.f / 15), vx_setall_f32(-1.f / 3)), one));
+    t = v_select(v_lt(ax, vx_setall_f32(0.0625f)), p, t);
+    const v_uint32 signMask = vx_setall_u32(0x80000000);
+    return v_reinterpret_as_f32(v_or(v_reinterpret_as_u32(t), v_and(v_reinterpret_as_u32(x), signMask)));
+}
+#endif
+
+// LSTM cell with default activations, the rows of gates are [I, F, O, G] (preactivations):
+//     c_t = sigmoid(F) * c_{t-1} + sigmoid(I) * tanh(G),    h_t = sigmoid(O) * tanh(c_t)
+// Samples of the batch are processed in parallel.
+static void lstmCellForward(const Mat& gates, Mat& c, Mat& h, bool useCellClip, float cellClip)
+{
+    const int numOut = c.cols;
+    parallel_for_(Range(0, c.rows), [&](const Range& r)
+    {
+        for (int n = r.start; n < r.end; n++)
+        {
+            const float* gateI = gates.ptr<float>(n);
+            const float* gateF = gateI + numOut;
+            const float* gateO = gateF + numOut;
+            const float* gateG = gateO + numOut;
+            float* cn = c.ptr<float>(n);
+            float* hn = h.ptr<float>(n);
+            int j = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+            const int vlanes = VTraits<v_float32>::vlanes();
+            const v_float32 vclip = vx_setall_f32(cellClip), vnegclip = vx_setall_f32(-cellClip);
+            for (; j <= numOut - vlanes; j += vlanes)
+            {
+                v_float32 ct = v_add(v_mul(v_sigmoid(vx_load(gateF + j)), vx_load(cn + j)),
+                                     v_mul(v_sigmoid(vx_load(gateI + j)), v_tanh(vx_load(gateG + j))));
+                if (useCellClip)
+                    ct = v_max(v_min(ct, vclip), vnegclip);
+                v_store(cn + j, ct);
+                v_store(hn + j, v_mul(v_sigmoid(vx_load(gateO + j)), v_tanh(ct)));
+            }
+#endif
+            for (; j < numOut; j++)
+            {
+                float ct = sigmoid(gateF[j]) * cn[j] + sigmoid(gateI[j]) * std::tanh(gateG[j]);
+                if (useCellClip)
+                    ct = std::max(std::min(ct, cellClip), -cellClip);
+                cn[j] = ct;
+                hn[j] = sigmoid(gateO[j]) * std::tanh(ct);
+            }
+        }
+    });
+}
+
+// GRU cell, the rows of xGates and hGates are [Z, R, N], they are x_t * Wx^T + bx and h_{t-1} * Wh^T + bh,
+// where bx = [bx_z + bh_z, bx_r + bh_r, bx_n] and bh = [0, 0, bh_n]:
+//     z = sigmoid(xZ + hZ),  r = sigmoid(xR + hR),  n = tanh(xN + r * hN),  h_t = z * h_{t-1} + (1 - z) * n
+static void gruCellForward(const Mat& xGates, const Mat& hGates, Mat& h)
+{
+    const int numOut = h.cols;
+    parallel_for_(Range(0, h.rows), [&](const Range& r)
+    {
+        for (int n = r.start; n < r.end; n++)
+        {
+            const float* xZ = xGates.ptr<float>(n);
+            const float* xR = xZ + numOut;
+            const float* xN = xR + numOut;
+            const float* hZ = hGates.ptr<float>(n);
+            const float* hR = hZ + numOut;
+            const float* hN = hR + numOut;
+            float* hn = h.ptr<float>(n);
+            int j = 0;
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+            const int vlanes = VTraits<v_float32>::vlanes();
+            const v_float32 one = vx_setall_f32(1.f);
+            for (; j <= numOut - vlanes; j += vlanes)
+            {
+                v_float32 z = v_sigmoid(v_add(vx_load(xZ + j), vx_load(hZ + j)));
+                v_float32 rt = v_sigmoid(v_add(vx_load(xR + j), vx_load(hR + j)));
+                v_float32 nt = v_tanh(v_add(vx_load(xN + j), v_mul(rt, vx_load(hN + j))));
+                v_store(hn + j, v_add(v_mul(z, vx_load(hn + j)), v_mul(v_sub(one, z), nt)));
+            }
+#endif
+            for (; j < numOut; j++)
+            {
+                float z = sigmoid(xZ[j] + hZ[j]);
+                float rt = sigmoid(xR[j] + hR[j]);
+                float nt = std::tanh(xN[j] + rt * hN[j]);
+                hn[j] = z * hn[j] + (1.f - z) * nt;
+            }
+        }
+    });
+}
+
 class LSTMLayerImpl CV_FINAL : public LSTMLayer
 {
     int numTimeStamps, numSamples, numHidden;
@@ -132,12 +241,10 @@ class LSTMLayerImpl CV_FINAL : public LSTMLayer
     ActivationFunction h_activation;
     bool isDefaultActivations{true};
 
-#if CV_TRY_AVX
-    bool useAVX;
-#endif
-#if CV_TRY_AVX2
-    bool useAVX2;
-#endif
+    // Wx and Wh of every direction packed for fastGemm() by finalize()
+    std::vector<FastGemmPackedB> packedWx, packedWh;
+    Mat gatesBias;  // bias of every direction with forgetBias added
+    FastGemmOpt opt;
 
     // CUDA needs input blobs to be rearranged in a specific way, but some transformations
     // in ONNXImporter are destructive, so we keep a copy.
@@ -147,12 +254,6 @@ public:
 
     LSTMLayerImpl(const LayerParams& params)
         : numTimeStamps(0), numSamples(0)
-#if CV_TRY_AVX
-          , useAVX(checkHardwareSupport(CPU_AVX))
-#endif
-#if CV_TRY_AVX2
-          , useAVX2(checkHardwareSupport(CPU_AVX2))
-#endif
     {
         setParamsFrom(params);
 
@@ -295,17 +396,18 @@ public:
         else
             outTailShape_.assign(1, _numOut);
 
-        int _numSamples;
+        int _numSamples, _numTimeStamps = 1;
         if (useTimestampDim)
         {
             CV_Assert(inp0.size() >= 2 && total(inp0, 2) == _numInp);
             if (layout == SEQ_BATCH_HID) {
                 _numSamples = inp0[1];
-                outResShape.push_back(inp0[0]);
+                _numTimeStamps = inp0[0];
             } else {
                 _numSamples = inp0[0];
-                outResShape.push_back(inp0[1]);
+                _numTimeStamps = inp0[1];
             }
+            outResShape.push_back(_numTimeStamps);
         }
         else
         {
@@ -333,10 +435,10 @@ public:
             }
         }
 
-        internals.assign(1, shape(_numSamples, _numOut)); // hInternal
-        internals.push_back(shape(_numSamples, _numOut)); // cInternal
-        internals.push_back(shape(_numSamples, 1)); // dummyOnes
-        internals.push_back(shape(_numSamples, 4*_numOut)); // gates
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        internals.assign(1, shape(numDirs*_numSamples, _numOut)); // hInternal
+        internals.push_back(shape(numDirs*_numSamples, _numOut)); // cInternal
+        internals.push_back(shape(numDirs*_numTimeStamps*_numSamples, 4*_numOut)); // gates of all time steps
 
         return false;
     }
@@ -382,6 +484,24 @@ public:
         outTsShape.insert(outTsShape.end(), outTailShape.begin(), outTailShape.end());
         outTsShape.back() *= (1 + static_cast<int>(bidirectional));
 
+        // Weights are packed once, the input projection of all the time steps is a single GEMM
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        CV_CheckTypeEQ(Wh.type(), CV_32F, "");
+        opt.init();
+        packedWx.resize(numDirs);
+        packedWh.resize(numDirs);
+        gatesBias = blobs[2].reshape(1, numDirs).clone();
+        for (int i = 0; i < numDirs; i++)
+        {
+            fastGemmPackB(Wx.rowRange(i * Wx.rows / numDirs, (i + 1) * Wx.rows / numDirs), packedWx[i].buf, true, opt);
+            fastGemmPackB(Wh.rowRange(i * Wh.rows / numDirs, (i + 1) * Wh.rows / numDirs), packedWh[i].buf, true, opt);
+            if (forgetBias)
+            {
+                Mat gateF = gatesBias.row(i).colRange(numOut, 2*numOut);
+                add(gateF, forgetBias, gateF);
+            }
+        }
+
         allocated = true;
     }
 
@@ -419,178 +539,126 @@ public:
         Mat cOut = produceCellOutput ? output[0].clone() : Mat();
         const bool needYcTransform = !originalBlobs.empty(); // if the producer is onnx
         const int numDirs = 1 + static_cast<int>(bidirectional);
-        for (int i = 0; i < numDirs; ++i)
-        {
-            Mat Wh = blobs[0];
-            Mat Wx = blobs[1];
-            Mat bias = blobs[2];
-
-            Mat h_0, c_0;
-            // Handle h_0 and c_0 based on input size
-            h_0 = (input.size() >= 2) ? input[1].reshape(1, input[1].size[0] * input[1].size[1]) : blobs[3];
-            c_0 = (input.size() == 3) ? input[2].reshape(1, input[2].size[0] * input[2].size[1]) : blobs[4];
-
-            // Perform checks if input size is 2 or 3
-            if (input.size() >= 2) {
-                CV_CheckEQ(h_0.cols, Wh.cols, "");
-                CV_CheckEQ(h_0.cols, c_0.cols, "");
-                CV_CheckEQ(h_0.rows, c_0.rows, "");
-            }
 
+        Mat h_0, c_0;
+        // Handle h_0 and c_0 based on input size
+        h_0 = (input.size() >= 2) ? input[1].reshape(1, input[1].size[0] * input[1].size[1]) : blobs[3];
+        c_0 = (input.size() == 3) ? input[2].reshape(1, input[2].size[0] * input[2].size[1]) : blobs[4];
 
-            Mat pI, pF, pO;
+        // Perform checks if input size is 2 or 3
+        if (input.size() >= 2) {
+            CV_CheckEQ(h_0.cols, blobs[0].cols, "");
+            CV_CheckEQ(h_0.cols, c_0.cols, "");
+            CV_CheckEQ(h_0.rows, c_0.rows, "");
+        }
+        // initial state is either given for every sample or shared by all of them
+        CV_Check(h_0.rows, h_0.rows == numDirs * numSamples || h_0.rows == numDirs, "");
+        CV_Check(c_0.rows, c_0.rows == numDirs * numSamples || c_0.rows == numDirs, "");
 
-            Wh = Wh.rowRange(i * Wh.rows / numDirs, (i + 1) * Wh.rows / numDirs);
-            Wx = Wx.rowRange(i * Wx.rows / numDirs, (i + 1) * Wx.rows / numDirs);
-            bias = bias.colRange(i * bias.cols / numDirs, (i + 1) * bias.cols / numDirs);
-            h_0 = h_0.rowRange(i * h_0.rows / numDirs, (i + 1) * h_0.rows / numDirs);
-            c_0 = c_0.rowRange(i * c_0.rows / numDirs, (i + 1) * c_0.rows / numDirs);
+        // Directions are independent, each one uses its own part of the internal buffers
+        parallel_for_(Range(0, numDirs), [&](const Range& r)
+        {
+            for (int i = r.start; i < r.end; i++)
+                forwardDirection(i, input[0], h_0, c_0, output[0], cOut, internals);
+        });
+        // transpose to match batch first output
+        if (layout == BATCH_SEQ_HID){
+            cv::Mat tmp;
+            cv::transposeND(output[0], {1, 0, 2}, tmp);
+            output[0] = tmp;
+        }
+        if (needYcTransform && produceCellOutput)
+        {
+            fixCellState(cOut, numDirs);
+        }
+        if (produceCellOutput)
+        {
+            cOut.copyTo(output[1]);
+        }
+    }
 
-            if (usePeephole)
-            {
-                pI = blobs[5];
-                pF = blobs[6];
-                pO = blobs[7];
+    void forwardDirection(int i, const Mat& x, const Mat& h_0, const Mat& c_0, Mat& hOut, Mat& cOut,
+                          std::vector<Mat>& internals)
+    {
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        const int numOut = blobs[0].size[1], numInp = blobs[1].size[1];
+        const int numSamplesTotal = numTimeStamps*numSamples;
 
-                pI = pI.rowRange(i * pI.rows / numDirs, (i + 1) * pI.rows / numDirs);
-                pI = pI.colRange(i * pI.cols / numDirs, (i + 1) * pI.cols / numDirs);
+        Mat pI, pF, pO;
+        if (usePeephole)
+        {
+            pI = blobs[5];
+            pF = blobs[6];
+            pO = blobs[7];
 
-                pF = pF.rowRange(i * pF.rows / numDirs, (i + 1) * pF.rows / numDirs);
-                pF = pF.colRange(i * pF.cols / numDirs, (i + 1) * pF.cols / numDirs);
+            pI = pI.rowRange(i * pI.rows / numDirs, (i + 1) * pI.rows / numDirs);
+            pI = pI.colRange(i * pI.cols / numDirs, (i + 1) * pI.cols / numDirs);
 
-                pO = pO.rowRange(i * pO.rows / numDirs, (i + 1) * pO.rows / numDirs);
-                pO = pO.colRange(i * pO.cols / numDirs, (i + 1) * pO.cols / numDirs);
-            }
+            pF = pF.rowRange(i * pF.rows / numDirs, (i + 1) * pF.rows / numDirs);
+            pF = pF.colRange(i * pF.cols / numDirs, (i + 1) * pF.cols / numDirs);
 
-            int numOut = Wh.size[1];
-            Mat hInternal = internals[0], cInternal = internals[1],
-                    dummyOnes = internals[2], gates = internals[3];
-            h_0.copyTo(hInternal);
-            c_0.copyTo(cInternal);
-            dummyOnes.setTo(1.);
+            pO = pO.rowRange(i * pO.rows / numDirs, (i + 1) * pO.rows / numDirs);
+            pO = pO.colRange(i * pO.cols / numDirs, (i + 1) * pO.cols / numDirs);
+        }
 
-            int numSamplesTotal = numTimeStamps*numSamples;
-            Mat xTs = input[0].reshape(1, numSamplesTotal);
+        Mat hInternal = internals[0].rowRange(i * numSamples, (i + 1) * numSamples);
+        Mat cInternal = internals[1].rowRange(i * numSamples, (i + 1) * numSamples);
+        Mat gatesTs = internals[2].rowRange(i * numSamplesTotal, (i + 1) * numSamplesTotal);
+        repeat(h_0.rowRange(i * h_0.rows / numDirs, (i + 1) * h_0.rows / numDirs),
+               numSamples * numDirs / h_0.rows, 1, hInternal);
+        repeat(c_0.rowRange(i * c_0.rows / numDirs, (i + 1) * c_0.rows / numDirs),
+               numSamples * numDirs / c_0.rows, 1, cInternal);
 
-            Mat hOutTs = output[0].reshape(1, numSamplesTotal);
-            hOutTs = hOutTs.colRange(i * hOutTs.cols / numDirs, (i + 1) * hOutTs.cols / numDirs);
-            Mat cOutTs;
-            if (produceCellOutput)
-            {
-                cOutTs = cOut.reshape(1, numSamplesTotal);
-                cOutTs = cOutTs.colRange(i * cOutTs.cols / numDirs, (i + 1) * cOutTs.cols / numDirs);
-            }
+        Mat xTs = x.reshape(1, numSamplesTotal);
+        CV_Assert(xTs.isContinuous());
 
-#if CV_TRY_AVX2 || CV_TRY_AVX
-            bool canUseAvx = gates.isContinuous() && bias.isContinuous()
-                && Wx.depth() == CV_32F && gates.depth() == CV_32F
-                && bias.depth() == CV_32F && Wx.cols >= 8;
-            bool canUseAvx_hInternal = hInternal.isContinuous() && gates.isContinuous() && bias.isContinuous()
-                && Wh.depth() == CV_32F && hInternal.depth() == CV_32F && gates.depth() == CV_32F
-                && Wh.cols >= 8;
-#endif
-
-            int tsStart, tsEnd, tsInc;
-            if (reverse || i == 1) {
-                tsStart = numTimeStamps - 1;
-                tsEnd = -1;
-                tsInc = -1;
-            }
-            else {
-                tsStart = 0;
-                tsEnd = numTimeStamps;
-                tsInc = 1;
-            }
-            for (int ts = tsStart; ts != tsEnd; ts += tsInc)
-            {
-                Range curRowRange(ts*numSamples, (ts + 1)*numSamples);
-                Mat xCurr = xTs.rowRange(curRowRange);
+        Mat hOutTs = hOut.reshape(1, numSamplesTotal);
+        hOutTs = hOutTs.colRange(i * hOutTs.cols / numDirs, (i + 1) * hOutTs.cols / numDirs);
+        Mat cOutTs;
+        if (produceCellOutput)
+        {
+            cOutTs = cOut.reshape(1, numSamplesTotal);
+            cOutTs = cOutTs.colRange(i * cOutTs.cols / numDirs, (i + 1) * cOutTs.cols / numDirs);
+        }
 
-#if CV_TRY_AVX2
-                if (useAVX2 && canUseAvx && xCurr.isContinuous())
-                {
-                    for (int n = 0; n < xCurr.rows; n++) {
-                        opt_AVX2::fastGEMM1T(
-                            xCurr.ptr<float>(n),
-                            Wx.ptr<float>(),
-                            Wx.step1(),
-                            bias.ptr<float>(),
-                            gates.ptr<float>(n),
-                            Wx.rows,
-                            Wx.cols
-                        );
-                    }
-                }
-                else
-#endif
-#if CV_TRY_AVX
-                if (useAVX && canUseAvx && xCurr.isContinuous())
-                {
-                    for (int n = 0; n < xCurr.rows; n++) {
-                        opt_AVX::fastGEMM1T(
-                            xCurr.ptr<float>(n),
-                            Wx.ptr<float>(),
-                            Wx.step1(),
-                            bias.ptr<float>(),
-                            gates.ptr<float>(n),
-                            Wx.rows,
-                            Wx.cols
-                        );
-                    }
-                }
-                else
-#endif
-                {
-                    gemm(xCurr, Wx, 1, gates, 0, gates, GEMM_2_T);      // Wx * x_t
-                    gemm(dummyOnes, bias, 1, gates, 1, gates);          //+b
-                }
+        // x_t * Wx^T + b for all the time steps at once
+        FastGemmOpt gemmOpt = opt;
+        FastGemmEpilogue epilogue;
+        epilogue.bias = gatesBias.ptr<float>(i);
+        fastGemm(false, numSamplesTotal, 4*numOut, numInp, 1.f, xTs.ptr<float>(), (int)xTs.step1(),
+                 packedWx[i], 0.f, gatesTs.ptr<float>(), (int)gatesTs.step1(), gemmOpt, &epilogue);
+
+        int tsStart, tsEnd, tsInc;
+        if (reverse || i == 1) {
+            tsStart = numTimeStamps - 1;
+            tsEnd = -1;
+            tsInc = -1;
+        }
+        else {
+            tsStart = 0;
+            tsEnd = numTimeStamps;
+            tsInc = 1;
+        }
+        for (int ts = tsStart; ts != tsEnd; ts += tsInc)
+        {
+            Range curRowRange(ts*numSamples, (ts + 1)*numSamples);
+            Mat gates = gatesTs.rowRange(curRowRange);
 
-#if CV_TRY_AVX2
-                if (useAVX2 && canUseAvx_hInternal)
-                {
-                    for (int n = 0; n < hInternal.rows; n++) {
-                        opt_AVX2::fastGEMM1T(
-                            hInternal.ptr<float>(n),
-                            Wh.ptr<float>(),
-                            Wh.step1(),
-                            gates.ptr<float>(n),
-                            gates.ptr<float>(n),
-                            Wh.rows,
-                            Wh.cols
-                        );
-                    }
-                }
-                else
-#endif
-#if CV_TRY_AVX
-                if (useAVX && canUseAvx_hInternal)
-                {
-                    for (int n = 0; n < hInternal.rows; n++) {
-                        opt_AVX::fastGEMM1T(
-                            hInternal.ptr<float>(n),
-                            Wh.ptr<float>(),
-                            Wh.step1(),
-                            gates.ptr<float>(n),
-                            gates.ptr<float>(n),
-                            Wh.rows,
-                            Wh.cols
-                        );
-                    }
-                }
-                else
-#endif
-                {
-                    gemm(hInternal, Wh, 1, gates, 1, gates, GEMM_2_T);  //+Wh * h_{t-1}
-                }
+            //+Wh * h_{t-1}
+            fastGemm(false, numSamples, 4*numOut, numOut, 1.f, hInternal.ptr<float>(), (int)hInternal.step1(),
+                     packedWh[i], 1.f, gates.ptr<float>(), (int)gates.step1(), gemmOpt);
 
+            if (isDefaultActivations && !usePeephole)
+            {
+                lstmCellForward(gates, cInternal, hInternal, useCellClip, cellClip);
+            }
+            else
+            {
                 Mat gateI = gates.colRange(0*numOut, 1*numOut);
                 Mat gateF = gates.colRange(1*numOut, 2*numOut);
                 Mat gateO = gates.colRange(2*numOut, 3*numOut);
                 Mat gateG = gates.colRange(3*numOut, 4*numOut);
 
-                if (forgetBias)
-                    add(gateF, forgetBias, gateF);
-
                 if (usePeephole)
                 {
                     Mat gatesIF = gates.colRange(0, 2*numOut);
@@ -625,26 +693,12 @@ public:
                 //compute h_t
                 h_activation(cInternal, hInternal);
                 multiply(gateO, hInternal, hInternal);
-
-                //save results in output blobs
-                hInternal.copyTo(hOutTs.rowRange(curRowRange));
-                if (produceCellOutput)
-                    cInternal.copyTo(cOutTs.rowRange(curRowRange));
             }
-        }
-        // transpose to match batch first output
-        if (layout == BATCH_SEQ_HID){
-            cv::Mat tmp;
-            cv::transposeND(output[0], {1, 0, 2}, tmp);
-            output[0] = tmp;
-        }
-        if (needYcTransform && produceCellOutput)
-        {
-            fixCellState(cOut, numDirs);
-        }
-        if (produceCellOutput)
-        {
-            cOut.copyTo(output[1]);
+
+            //save results in output blobs
+            hInternal.copyTo(hOutTs.rowRange(curRowRange));
+            if (produceCellOutput)
+                cInternal.copyTo(cOutTs.rowRange(curRowRange));
         }
     }
 
@@ -962,6 +1016,11 @@ class GRULayerImpl CV_FINAL : public GRULayer
     MatShape outTsShape;    //shape of N output samples
     bool bidirectional;     // If true, produces both forward and reversed directions along time axis
 
+    // Wx and Wh of every direction packed for fastGemm() by finalize()
+    std::vector<FastGemmPackedB> packedWx, packedWh;
+    Mat xBias, hBias;  // biases of x_t * Wx^T and h_{t-1} * Wh^T, see gruCellForward()
+    FastGemmOpt opt;
+
 public:
 
     GRULayerImpl(const LayerParams& params) : numTimeStamps(0), numSamples(0)
@@ -1022,12 +1081,10 @@ public:
 
         outputs.assign(1, outResShape);
 
-        internals.assign(1, shape(_numSamples, _numOut));     // hInternal
-        internals.push_back(shape(_numSamples, 1));           // dummyOnes
-        internals.push_back(shape(_numSamples, 2 * _numOut)); // gates
-        internals.push_back(shape(_numSamples, 2 * _numOut)); // gates_b
-        internals.push_back(shape(_numSamples, 1 * _numOut)); // h_linear
-        internals.push_back(shape(_numSamples, _numOut));     // ones
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        internals.assign(1, shape(numDirs * _numSamples, _numOut));                  // hInternal
+        internals.push_back(shape(numDirs * inp0[0] * _numSamples, 3 * _numOut));   // x gates of all time steps
+        internals.push_back(shape(numDirs * _numSamples, 3 * _numOut));              // h gates
 
         return false;
     }
@@ -1058,6 +1115,23 @@ public:
         outTsShape.insert(outTsShape.end(), outTailShape.begin(), outTailShape.end());
         outTsShape.back() *= (1 + static_cast<int>(bidirectional));
 
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        CV_CheckTypeEQ(Wh.type(), CV_32F, "");
+        opt.init();
+        packedWx.resize(numDirs);
+        packedWh.resize(numDirs);
+        Mat bias = blobs[2].reshape(1, numDirs);
+        xBias = bias.colRange(0, 3 * numOut).clone();
+        hBias = Mat::zeros(numDirs, 3 * numOut, CV_32F);
+        for (int i = 0; i < numDirs; i++)
+        {
+            fastGemmPackB(Wx.rowRange(i * Wx.rows / numDirs, (i + 1) * Wx.rows / numDirs), packedWx[i].buf, true, opt);
+            fastGemmPackB(Wh.rowRange(i * Wh.rows / numDirs, (i + 1) * Wh.rows / numDirs), packedWh[i].buf, true, opt);
+            Mat b_rz = xBias.row(i).colRange(0, 2 * numOut);
+            add(b_rz, bias.row(i).colRange(3 * numOut, 5 * numOut), b_rz);
+            bias.row(i).colRange(5 * numOut, 6 * numOut).copyTo(hBias.row(i).colRange(2 * numOut, 3 * numOut));
+        }
+
         allocated = true;
     }
 
@@ -1078,82 +1152,66 @@ public:
         internals_arr.getMatVector(internals);
 
         const int numDirs = 1 + static_cast<int>(bidirectional);
-        for (int i = 0; i < numDirs; ++i)
+        const Mat& h_0 = blobs[3];
+        // initial state is either given for every sample or shared by all of them
+        CV_Check(h_0.rows, h_0.rows == numDirs * numSamples || h_0.rows == numDirs, "");
+
+        // Directions are independent, each one uses its own part of the internal buffers
+        parallel_for_(Range(0, numDirs), [&](const Range& r)
         {
-            const Mat &Wh = blobs[0].rowRange(i * blobs[0].rows / numDirs, (i + 1) * blobs[0].rows / numDirs);
-            const Mat &Wx = blobs[1].rowRange(i * blobs[1].rows / numDirs, (i + 1) * blobs[1].rows / numDirs);
-            const Mat &bias = blobs[2].colRange(i * blobs[2].cols / numDirs, (i + 1) * blobs[2].cols / numDirs);
-            const Mat &h_0 = blobs[3].rowRange(i * blobs[3].rows / numDirs, (i + 1) * blobs[3].rows / numDirs);
-
-            const Mat &bx = bias.colRange(0, bias.cols / 2);
-            const Mat &bh = bias.colRange(bias.cols / 2, bias.cols);
-
-            Mat hInternal = internals[0], dummyOnes = internals[1], gates = internals[2],
-                b_rz = internals[3], n_t = internals[4], ones = internals[5];
-            h_0.copyTo(hInternal);
-            dummyOnes.setTo(1.);
-            ones.setTo(1.);
-
-            int numOut = Wh.size[1];
-            const Mat& wx_rz = Wx.rowRange(0, 2 * numOut);
-            const Mat& wh_rz = Wh.rowRange(0, 2 * numOut);
-            b_rz = bx.colRange(0, 2 * numOut) + bh.colRange(0, 2 * numOut);
-            const Mat& wx_n = Wx.rowRange(2 * numOut, 3 * numOut);
-            const Mat& wh_n = Wh.rowRange(2 * numOut, 3 * numOut);
-            const Mat& b_in = bx.colRange(2 * numOut, 3 * numOut);
-            const Mat& b_hn = bh.colRange(2 * numOut, 3 * numOut);
-
-            int numSamplesTotal = numTimeStamps * numSamples;
-            Mat xTs = input[0].reshape(1, numSamplesTotal);
-
-            Mat hOutTs = output[0].reshape(1, numSamplesTotal);
-            hOutTs = hOutTs.colRange(i * hOutTs.cols / numDirs, (i + 1) * hOutTs.cols / numDirs);
-            Mat cOutTs = Mat();
-
-            int tsStart, tsEnd, tsInc;
-            if (i == 1) {
-                tsStart = numTimeStamps - 1;
-                tsEnd = -1;
-                tsInc = -1;
-            }
-            else {
-                tsStart = 0;
-                tsEnd = numTimeStamps;
-                tsInc = 1;
-            }
-            for (int ts = tsStart; ts != tsEnd; ts += tsInc)
-            {
-                Range curRowRange(ts * numSamples, (ts + 1) * numSamples);
-                Mat xCurr = xTs.rowRange(curRowRange);
-
-                // calculate r_t = sigmoid(x * Wx_r + h_(t-1) * Wh_r + b_r)
-                // calculate z_t = sigmoid(x * Wx_z + h_(t-1) * Wh_z + b_z)
-                gemm(xCurr, wx_rz, 1, gates, 0, gates, GEMM_2_T);      // x * Wx_rz
-                gemm(hInternal, wh_rz, 1, gates, 1, gates, GEMM_2_T);  // + h_(t-1) * Wh_rz
-                gemm(dummyOnes, b_rz, 1, gates, 1, gates);             // + b_rz
-                sigmoid(gates, gates);                                 // sigmoid()
-
-                Mat z = gates.colRange(0, gates.cols / 2);
-                Mat r = gates.colRange(gates.cols / 2, gates.cols);
-
-                // calculate n_t = tanh(r (*) (h_(t-1) * Wh_n + b_hn) + x * Wx_n + b_in)
-                gemm(hInternal, wh_n, 1, n_t, 0, n_t, GEMM_2_T);       // h_(t-1) * Wh_n
-                gemm(dummyOnes, b_hn, 1, n_t, 1, n_t);                 // + b_hn
-                multiply(r, n_t, n_t);                                 // r (*) (h_(t-1) * Wh_n + b_hn)
-
-                gemm(xCurr, wx_n, 1, n_t, 1, n_t, GEMM_2_T);          // + x * Wx_n
-                gemm(dummyOnes, b_in, 1, n_t, 1, n_t);                // + b_in
-                tanh(n_t, n_t);                                       // tanh()
-
-                //compute next h_t = z (*) h_(t-1) + (1 - z) (*) n_t
-                multiply(z, hInternal, hInternal);                    // z (*) h_{t-1}
-                subtract(ones, z, z);                                 // 1 - z
-                multiply(z, n_t, z);                                  // (1 - z) * n
-                add(z, hInternal, hInternal);                         // z (*) h_(t-1) + (1 - z) (*) n_t
-
-                //save results in output blobs
-                hInternal.copyTo(hOutTs.rowRange(curRowRange));
-            }
+            for (int i = r.start; i < r.end; i++)
+                forwardDirection(i, input[0], h_0, output[0], internals);
+        });
+    }
+
+    void forwardDirection(int i, const Mat& x, const Mat& h_0, Mat& hOut, std::vector<Mat>& internals)
+    {
+        const int numDirs = 1 + static_cast<int>(bidirectional);
+        const int numOut = blobs[0].size[1], numInp = blobs[1].size[1];
+        const int numSamplesTotal = numTimeStamps * numSamples;
+
+        Mat hInternal = internals[0].rowRange(i * numSamples, (i + 1) * numSamples);
+        Mat xGatesTs = internals[1].rowRange(i * numSamplesTotal, (i + 1) * numSamplesTotal);
+        Mat hGates = internals[2].rowRange(i * numSamples, (i + 1) * numSamples);
+        repeat(h_0.rowRange(i * h_0.rows / numDirs, (i + 1) * h_0.rows / numDirs),
+               numSamples * numDirs / h_0.rows, 1, hInternal);
+
+        Mat xTs = x.reshape(1, numSamplesTotal);
+        CV_Assert(xTs.isContinuous());
+
+        Mat hOutTs = hOut.reshape(1, numSamplesTotal);
+        hOutTs = hOutTs.colRange(i * hOutTs.cols / numDirs, (i + 1) * hOutTs.cols / numDirs);
+
+        // x_t * Wx^T + bx for all the time steps at once
+        FastGemmOpt gemmOpt = opt;
+        FastGemmEpilogue xEpilogue, hEpilogue;
+        xEpilogue.bias = xBias.ptr<float>(i);
+        hEpilogue.bias = hBias.ptr<float>(i);
+        fastGemm(false, numSamplesTotal, 3 * numOut, numInp, 1.f, xTs.ptr<float>(), (int)xTs.step1(),
+                 packedWx[i], 0.f, xGatesTs.ptr<float>(), (int)xGatesTs.step1(), gemmOpt, &xEpilogue);
+
+        int tsStart, tsEnd, tsInc;
+        if (i == 1) {
+            tsStart = numTimeStamps - 1;
+            tsEnd = -1;
+            tsInc = -1;
+        }
+        else {
+            tsStart = 0;
+            tsEnd = numTimeStamps;
+            tsInc = 1;
+        }
+        for (int ts = tsStart; ts != tsEnd; ts += tsInc)
+        {
+            Range curRowRange(ts * numSamples, (ts + 1) * numSamples);
+
+            // h_(t-1) * Wh^T + bh
+            fastGemm(false, numSamples, 3 * numOut, numOut, 1.f, hInternal.ptr<float>(), (int)hInternal.step1(),
+                     packedWh[i], 0.f, hGates.ptr<float>(), (int)hGates.step1(), gemmOpt, &hEpilogue);
+            gruCellForward(xGatesTs.rowRange(curRowRange), hGates, hInternal);
+
+            //save results in output blobs
+            hInternal.copyTo(hOutTs.rowRange(curRowRange));
         }
     }
 };
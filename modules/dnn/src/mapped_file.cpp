@@ -0,0 +1,183 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#if defined _WIN32
+#define WIN32_LEAN_AND_MEAN
+#undef NOMINMAX
+#define NOMINMAX
+#include <windows.h>
+#define OPENCV_DNN_MAPPED_FILE_WIN32 1
+#elif defined __linux__ || defined __APPLE__ || defined __FreeBSD__ || defined __QNX__ || defined __HAIKU__
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPENCV_DNN_MAPPED_FILE_POSIX 1
+#endif
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+
+Ptr<MappedFile> MappedFile::open(const std::string& path)
+{
+    CV_TRACE_FUNCTION();
+
+    Ptr<MappedFile> file(new MappedFile());
+#if defined OPENCV_DNN_MAPPED_FILE_WIN32
+    HANDLE fd = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fd == INVALID_HANDLE_VALUE)
+        CV_Error(Error::StsError, "DNN: can't open file: " + path);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fd, &size))
+    {
+        CloseHandle(fd);
+        CV_Error(Error::StsError, "DNN: can't get size of file: " + path);
+    }
+    file->size_ = (size_t)size.QuadPart;
+    if (file->size_ > 0 && getParam_DNN_MAP_WEIGHTS())
+    {
+        HANDLE mapping = CreateFileMappingA(fd, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (mapping)
+        {
+            file->data_ = (uchar*)MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+            if (file->data_)
+                file->handle_ = mapping;
+            else
+                CloseHandle(mapping);
+        }
+    }
+    CloseHandle(fd);
+#elif defined OPENCV_DNN_MAPPED_FILE_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        CV_Error(Error::StsError, "DNN: can't open file: " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        CV_Error(Error::StsError, "DNN: can't get size of file: " + path);
+    }
+    file->size_ = (size_t)st.st_size;
+    if (file->size_ > 0 && getParam_DNN_MAP_WEIGHTS())
+    {
+        // Private writable mapping: layers may modify their weights in-place without touching the file.
+        void* ptr = mmap(NULL, file->size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED)
+            file->data_ = (uchar*)ptr;
+    }
+    ::close(fd);
+#endif
+
+    if (!file->data_)
+    {
+        std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+        if (!ifs.is_open())
+            CV_Error(Error::StsError, "DNN: can't open file: " + path);
+        ifs.seekg(0, std::ios::end);
+        file->size_ = (size_t)ifs.tellg();
+        ifs.seekg(0, std::ios::beg);
+        file->buffer_.resize(file->size_);
+        if (file->size_ > 0)
+            ifs.read((char*)&file->buffer_[0], file->size_);
+        if (!ifs)
+            CV_Error(Error::StsError, "DNN: can't read file: " + path);
+        file->data_ = file->buffer_.empty() ? 0 : &file->buffer_[0];
+    }
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    if (!buffer_.empty())
+        return;
+#if defined OPENCV_DNN_MAPPED_FILE_WIN32
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (handle_)
+        CloseHandle((HANDLE)handle_);
+#elif defined OPENCV_DNN_MAPPED_FILE_POSIX
+    if (data_)
+        munmap(data_, size_);
+#endif
+}
+
+
+// Keeps the mapping alive while there are Mat headers which refer to it.
+class MappedFileAllocator CV_FINAL : public MatAllocator
+{
+public:
+    UMatData* wrap(const Ptr<MappedFile>& file, uchar* data, size_t size) const
+    {
+        UMatData* u = new UMatData(this);
+        u->data = u->origdata = data;
+        u->size = size;
+        u->userdata = new Ptr<MappedFile>(file);
+        return u;
+    }
+
+    UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                       AccessFlag flags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        // New buffers (e.g. Mat::create() for other shape) are allocated as usual.
+        return Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(UMatData* u, AccessFlag accessFlags, UMatUsageFlags usageFlags) const CV_OVERRIDE
+    {
+        return Mat::getStdAllocator()->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(UMatData* u) const CV_OVERRIDE
+    {
+        if (!u)
+            return;
+        CV_Assert(u->urefcount >= 0);
+        CV_Assert(u->refcount >= 0);
+        if (u->refcount == 0)
+        {
+            delete (Ptr<MappedFile>*)u->userdata;
+            u->userdata = 0;
+            delete u;
+        }
+    }
+};
+
+static MappedFileAllocator& getMappedFileAllocator()
+{
+    // Never destroyed: Mat objects may be released after static objects destruction.
+    static MappedFileAllocator* allocator = new MappedFileAllocator();
+    return *allocator;
+}
+
+Mat MappedFile::wrap(const Ptr<MappedFile>& file, size_t offset, int dims, const int* sizes, int type)
+{
+    CV_Assert(file);
+    if (dims == 0)
+        return Mat();
+
+    Mat m(dims, sizes, type, (void*)(file->data_ + offset));
+    const size_t size = m.total() * m.elemSize();
+    CV_Assert(offset <= file->size_ && size <= file->size_ - offset);
+
+    MappedFileAllocator& allocator = getMappedFileAllocator();
+    m.allocator = &allocator;
+    m.u = allocator.wrap(file, m.data, size);
+    m.addref();
+    return m;
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -0,0 +1,52 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_MAPPED_FILE_HPP__
+#define __OPENCV_DNN_SRC_MAPPED_FILE_HPP__
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/** @brief Read-only file mapped into memory.
+ *
+ * Pages are mapped copy-on-write: they are shared with other processes through the page cache
+ * until they are modified. If memory mapping is not available or disabled by OPENCV_DNN_MAP_WEIGHTS=0,
+ * the file is read into memory.
+ */
+class MappedFile
+{
+public:
+    /// Maps the whole file. Throws an exception if the file can't be opened.
+    static Ptr<MappedFile> open(const std::string& path);
+
+    ~MappedFile();
+
+    const uchar* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /** @brief Returns Mat header over the mapped memory.
+     *
+     * The Mat (and all its copies) keeps the mapping alive, so it may outlive the MappedFile object.
+     * @param file mapped file.
+     * @param offset offset of the data from the beginning of the file.
+     * @param dims number of dimensions. Empty Mat is returned for zero dimensions.
+     * @param sizes sizes of the dimensions.
+     * @param type type of the elements.
+     */
+    static Mat wrap(const Ptr<MappedFile>& file, size_t offset, int dims, const int* sizes, int type);
+
+private:
+    MappedFile() : data_(0), size_(0), handle_(0) {}
+
+    uchar* data_;
+    size_t size_;
+    void* handle_;  // platform specific, e.g. mapping object on Windows
+    std::vector<uchar> buffer_;  // used if mapping is not available
+};
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_MAPPED_FILE_HPP__
@@ -0,0 +1,256 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "memory_planner.hpp"
+
+#include <opencv2/core/utils/logger.hpp>
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+// Regions are aligned in the same way as regular Mat allocations
+static const size_t MEMORY_PLANNER_ALIGNMENT = 64;
+
+// Creates blob header over the arena memory. Blob shares the arena reference counter,
+// so the data stays valid while blob is used by the caller (e.g. after Net::forward).
+static Mat arenaBlob(const Mat& arena, size_t offset, const MatShape& shape, int type)
+{
+    CV_Assert(arena.isContinuous());
+    CV_Assert(offset + total(shape) * CV_ELEM_SIZE(type) <= arena.total());
+    Mat m((int)shape.size(), shape.data(), type, (void*)(arena.data + offset));
+    m.u = arena.u;
+    m.datastart = arena.datastart;
+    m.dataend = arena.dataend;
+    m.addref();
+    return m;
+}
+
+
+void MemoryPlanner::plan(const MapIdToLayerData& layers, const LayersShapesMap& layersShapes,
+                         const std::vector<LayerPin>& blobsToKeep)
+{
+    CV_TRACE_FUNCTION();
+
+    reset();
+
+    // Number of consumers of every layer output.
+    std::map<LayerPin, int> pinRefs;
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const std::vector<LayerPin>& inputs = it->second.inputBlobsId;
+        for (size_t i = 0; i < inputs.size(); i++)
+            pinRefs[inputs[i]] += 1;
+    }
+    // Extra references are never released, so kept blobs live till the end.
+    // The same is true for unconsumed outputs: they may be requested by user after forward pass.
+    for (size_t i = 0; i < blobsToKeep.size(); i++)
+        pinRefs[blobsToKeep[i]] += 1;
+
+    // Layers are executed in order of identifiers (see Net::Impl::forwardToLayer).
+    int step = 0;
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it, ++step)
+    {
+        const LayerData& ld = it->second;
+        if (ld.id == 0)
+            continue;  // network inputs are allocated separately
+
+        LayersShapesMap::const_iterator shapesIt = layersShapes.find(ld.id);
+        CV_Assert(shapesIt != layersShapes.end());
+        const ShapesVec& outShapes = shapesIt->second.out;
+        const ShapesVec& internalShapes = shapesIt->second.internal;
+        const size_t elemSize = CV_ELEM_SIZE(ld.dtype);
+
+        // The same rule as in BlobManager: layer works in-place if it is the only remaining consumer of the input.
+        int inPlaceRegion = -1;
+        if (shapesIt->second.supportInPlace && ld.inputBlobsId.size() == 1)
+        {
+            std::map<LayerPin, int>::const_iterator regionIt = pinToRegion.find(ld.inputBlobsId[0]);
+            if (regionIt != pinToRegion.end() && regions[regionIt->second].refs == 1)
+                inPlaceRegion = regionIt->second;
+        }
+
+        for (size_t i = 0; i < outShapes.size(); i++)
+        {
+            size_t size = alignSize(total(outShapes[i]) * elemSize, MEMORY_PLANNER_ALIGNMENT);
+            if (size == 0)
+                continue;
+            LayerPin pin(ld.id, (int)i);
+            std::map<LayerPin, int>::const_iterator refsIt = pinRefs.find(pin);
+            int refs = refsIt != pinRefs.end() ? refsIt->second : 0;
+
+            int regionIdx = inPlaceRegion;
+            if (regionIdx < 0)
+            {
+                regionIdx = (int)regions.size();
+                Region region = { size, 0, step, -1, refs };
+                regions.push_back(region);
+            }
+            else
+            {
+                // Unconsumed output keeps the shared memory till the end.
+                Region& region = regions[regionIdx];
+                region.size = std::max(region.size, size);
+                region.refs += refs ? refs : 1;
+            }
+            pinToRegion[pin] = regionIdx;
+        }
+
+        // Internal blobs are used by the layer only.
+        const int numOutputs = (int)std::max((size_t)1, outShapes.size());
+        for (size_t i = 0; i < internalShapes.size(); i++)
+        {
+            size_t size = alignSize(total(internalShapes[i]) * elemSize, MEMORY_PLANNER_ALIGNMENT);
+            if (size == 0)
+                continue;
+            int regionIdx = (int)regions.size();
+            Region region = { size, 0, step, step, 0 };
+            regions.push_back(region);
+            pinToRegion[LayerPin(ld.id, numOutputs + (int)i)] = regionIdx;
+        }
+
+        // Release inputs after execution of the layer.
+        for (size_t i = 0; i < ld.inputBlobsId.size(); i++)
+        {
+            std::map<LayerPin, int>::const_iterator regionIt = pinToRegion.find(ld.inputBlobsId[i]);
+            if (regionIt == pinToRegion.end())
+                continue;  // network input
+            Region& region = regions[regionIt->second];
+            CV_Assert(region.refs > 0);
+            if (--region.refs == 0)
+                region.last = step;
+        }
+    }
+
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        Region& region = regions[i];
+        if (region.last < 0)
+            region.last = INT_MAX;
+        blobsSize += region.size;
+    }
+
+    // Best-fit offsets assignment: the largest regions are placed first, every next region occupies
+    // the smallest gap between already placed regions with intersected live ranges.
+    std::vector<int> order(regions.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = (int)i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return regions[a].size > regions[b].size ||
+               (regions[a].size == regions[b].size && regions[a].first < regions[b].first);
+    });
+
+    std::vector<int> placed;
+    std::vector<std::pair<size_t, size_t> > busy;
+    placed.reserve(order.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        Region& region = regions[order[i]];
+
+        busy.clear();
+        for (size_t j = 0; j < placed.size(); j++)
+        {
+            const Region& other = regions[placed[j]];
+            if (other.first <= region.last && region.first <= other.last)
+                busy.push_back(std::make_pair(other.offset, other.offset + other.size));
+        }
+        std::sort(busy.begin(), busy.end());
+
+        size_t bestOffset = (size_t)-1, bestGap = (size_t)-1, top = 0;
+        for (size_t j = 0; j < busy.size(); j++)
+        {
+            if (busy[j].first > top)
+            {
+                size_t gap = busy[j].first - top;
+                if (gap >= region.size && gap < bestGap)
+                {
+                    bestGap = gap;
+                    bestOffset = top;
+                }
+            }
+            top = std::max(top, busy[j].second);
+        }
+        region.offset = bestOffset != (size_t)-1 ? bestOffset : top;
+        arenaSize = std::max(arenaSize, region.offset + region.size);
+        placed.push_back(order[i]);
+    }
+
+    CV_LOG_DEBUG(NULL, "DNN/MemoryPlanner: " << regions.size() << " regions, arena=" << arenaSize
+                       << " bytes, without reuse=" << blobsSize << " bytes");
+}
+
+
+void MemoryPlanner::allocate()
+{
+    CV_TRACE_FUNCTION();
+
+    arena.release();
+    if (arenaSize == 0)
+        return;
+    // Mat dimensions are limited by INT_MAX, so huge arenas are allocated as multiple rows.
+    const size_t maxCols = (size_t)1 << 30;
+    int cols = (int)std::min(arenaSize, maxCols);
+    int rows = (int)divUp(arenaSize, (unsigned)cols);
+    arena.create(rows, cols, CV_8UC1);
+}
+
+
+void MemoryPlanner::allocateBlobsForLayer(LayerData& ld, const LayerShapes& layerShapes) const
+{
+    CV_TRACE_FUNCTION();
+
+    std::vector<Mat>& outputBlobs = ld.outputBlobs;
+    std::vector<Mat>& internalBlobs = ld.internals;
+    const ShapesVec& outShapes = layerShapes.out;
+    const ShapesVec& internalShapes = layerShapes.internal;
+
+    outputBlobs.resize(std::max((size_t)1, outShapes.size()));  // layer produce at least one output blob
+    internalBlobs.resize(internalShapes.size());
+
+    CV_Assert(ld.requiredOutputs.size() <= outShapes.size());
+
+    if (ld.id == 0)
+    {
+        // Network inputs are not a part of the arena.
+        for (size_t i = 0; i < outShapes.size(); i++)
+        {
+            if (total(outShapes[i]))
+                outputBlobs[i].create(outShapes[i], ld.dtype);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < outShapes.size() + internalShapes.size(); i++)
+    {
+        bool isOutput = i < outShapes.size();
+        const MatShape& shape = isOutput ? outShapes[i] : internalShapes[i - outShapes.size()];
+        if (!total(shape))
+            continue;
+        int oid = isOutput ? (int)i : (int)(outputBlobs.size() + i - outShapes.size());
+        std::map<LayerPin, int>::const_iterator regionIt = pinToRegion.find(LayerPin(ld.id, oid));
+        CV_Assert(regionIt != pinToRegion.end());
+        Mat blob = arenaBlob(arena, regions[regionIt->second].offset, shape, ld.dtype);
+        if (isOutput)
+            outputBlobs[i] = blob;
+        else
+            internalBlobs[i - outShapes.size()] = blob;
+    }
+}
+
+
+void MemoryPlanner::reset()
+{
+    regions.clear();
+    pinToRegion.clear();
+    arenaSize = 0;
+    blobsSize = 0;
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -0,0 +1,68 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_MEMORY_PLANNER_HPP__
+#define __OPENCV_DNN_SRC_MEMORY_PLANNER_HPP__
+
+#include "layer_internals.hpp"  // LayerPin LayerData
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/** @brief Static memory planner for intermediate blobs.
+ *
+ * Unlike BlobManager, which greedily reuses the first free blob of the suitable size
+ * during allocation, the planner computes live ranges of all output and internal blobs
+ * over the layers execution order in advance and packs them into a single arena using
+ * best-fit offset assignment of the intervals. In-place computations are resolved
+ * with the same rules as in BlobManager.
+ */
+struct MemoryPlanner
+{
+public:
+    typedef std::map<int, LayerData> MapIdToLayerData;
+    typedef std::map<int, LayerShapes> LayersShapesMap;
+
+    MemoryPlanner() : arenaSize(0), blobsSize(0) {}
+
+    /// Builds the plan. Network inputs, unconsumed outputs and @p blobsToKeep stay alive till the end.
+    void plan(const MapIdToLayerData& layers, const LayersShapesMap& layersShapes,
+              const std::vector<LayerPin>& blobsToKeep);
+
+    /// Allocates the arena for the current plan. Memory of the previous arena is not reused.
+    void allocate();
+
+    /// Binds output and internal blobs of the layer to the planned regions of the arena.
+    void allocateBlobsForLayer(LayerData& ld, const LayerShapes& layerShapes) const;
+
+    /// Peak memory of intermediate blobs (arena size) in bytes.
+    size_t getArenaSize() const { return arenaSize; }
+
+    /// Memory in bytes which would be required without any reuse of blobs.
+    size_t getBlobsSize() const { return blobsSize; }
+
+    void reset();
+
+private:
+    struct Region
+    {
+        size_t size;
+        size_t offset;
+        int first, last;  // live range in execution steps (inclusive)
+        int refs;  // number of pending consumers during planning
+    };
+
+    std::vector<Region> regions;
+    std::map<LayerPin, int> pinToRegion;
+    size_t arenaSize;
+    size_t blobsSize;
+    Mat arena;
+};  // MemoryPlanner
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_MEMORY_PLANNER_HPP__
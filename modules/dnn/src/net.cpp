@@ -115,6 +115,20 @@ void Net::forward(std::vector<std::vector<Mat>>& outputBlobs,
     return impl->forward(outputBlobs, outBlobNames);
 }
 
+Net Net::clone() const
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->clone();
+}
+
+void Net::save(const String& path) const
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    impl->save(path);
+}
+
 // FIXIT drop from inference API
 Net Net::quantize(InputArrayOfArrays calibData, int inputsDtype, int outputsDtype, bool perChannel)
 {
@@ -124,6 +138,15 @@ Net Net::quantize(InputArrayOfArrays calibData, int inputsDtype, int outputsDtyp
     return impl->quantize(*this, calibData, inputsDtype, outputsDtype, perChannel);
 }
 
+// FIXIT drop from inference API
+Net Net::quantize(InputArrayOfArrays calibData, const QuantizationParams& params)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    CV_Assert(!empty());
+    return impl->quantize(*this, calibData, params);
+}
+
 // FIXIT drop from inference API
 void Net::getInputDetails(std::vector<float>& scales, std::vector<int>& zeropoints) const
 {
@@ -428,5 +451,40 @@ int64 Net::getPerfProfile(std::vector<double>& timings)
     return impl->getPerfProfile(timings);
 }
 
+void Net::enableProfiling(bool enable)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->enableProfiling(enable);
+}
+
+void Net::setNumInterOpThreads(int nthreads)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->setNumInterOpThreads(nthreads);
+}
+
+int Net::getNumInterOpThreads() const
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->numInterOpThreads;
+}
+
+String Net::dumpProfile()
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->dumpProfile();
+}
+
+void Net::dumpProfileToFile(const String& path)
+{
+    CV_TRACE_FUNCTION();
+    CV_Assert(impl);
+    return impl->dumpProfileToFile(path);
+}
+
 CV__DNN_INLINE_NS_END
 }}  // namespace cv::dnn
@@ -78,6 +78,16 @@ public:
         basePtr_->setPreferableBackend(net, backendId);
     }
 
+    Net clone() const override
+    {
+        CV_Assert(basePtr_);
+        // Layers of the base network are created from parameters
+        Net net = basePtr_->clone();
+        net.setPreferableBackend(preferableBackend);
+        net.setPreferableTarget(preferableTarget);
+        return net;
+    }
+
     void setPreferableTarget(int targetId) override
     {
         if (targetId != preferableTarget)
@@ -0,0 +1,367 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "net_impl.hpp"
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+
+
+// File layout:
+//   CompiledNetHeader
+//   metadata: JSON with the graph, layer parameters and descriptions of the blobs
+//   data: blobs, every blob is aligned to COMPILED_NET_BLOB_ALIGN bytes from the beginning of the section
+// Data section starts from a page boundary, so mapped blobs are aligned in memory as well.
+struct CompiledNetHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t metadataSize;
+    uint64_t dataOffset;
+};
+
+static const char COMPILED_NET_MAGIC[8] = { 'O', 'C', 'V', 'D', 'N', 'N', 'C', '\0' };
+static const uint32_t COMPILED_NET_VERSION = 1;
+static const uint32_t COMPILED_NET_BYTE_ORDER = 0x01020304;
+static const size_t COMPILED_NET_DATA_ALIGN = 4096;
+static const size_t COMPILED_NET_BLOB_ALIGN = 64;
+
+
+namespace {
+
+struct CompiledNetWriter
+{
+    std::vector<Mat> chunks;
+    size_t dataSize;
+
+    CompiledNetWriter() : dataSize(0) {}
+
+    void writeMat(FileStorage& fs, const Mat& m)
+    {
+        std::vector<int> shape(m.size.p, m.size.p + m.dims);
+        size_t offset = dataSize / COMPILED_NET_BLOB_ALIGN;
+        CV_Assert(offset <= (size_t)INT_MAX);
+        fs << "{" << "type" << m.type() << "shape" << shape << "offset" << (int)offset << "}";
+        if (m.empty())
+            return;
+        chunks.push_back(m.isContinuous() ? m : m.clone());
+        dataSize += alignSize(m.total() * m.elemSize(), COMPILED_NET_BLOB_ALIGN);
+    }
+
+    void writeMats(FileStorage& fs, const std::vector<Mat>& mats)
+    {
+        fs << "[";
+        for (size_t i = 0; i < mats.size(); i++)
+            writeMat(fs, mats[i]);
+        fs << "]";
+    }
+};
+
+// Strings are written with cv::write() as operator<< interprets values like "[" or "{" as structure markers.
+static void writeParams(FileStorage& fs, const LayerParams& params)
+{
+    fs << "[";
+    for (std::map<String, DictValue>::const_iterator it = params.begin(); it != params.end(); ++it)
+    {
+        const DictValue& value = it->second;
+        fs << "{";
+        write(fs, "name", it->first);
+        fs << "type" << (value.isString() ? "string" : value.isInt() ? "int" : "real");
+        fs << "values" << "[";
+        for (int i = 0; i < value.size(); i++)
+        {
+            if (value.isString())
+                write(fs, String(), value.get<String>(i));
+            else if (value.isInt())
+            {
+                // FileStorage keeps 32-bit integers only. Other values are exactly representable by double.
+                int64 v = value.get<int64>(i);
+                if (v >= INT_MIN && v <= INT_MAX)
+                    fs << (int)v;
+                else
+                    fs << (double)v;
+            }
+            else
+                fs << value.get<double>(i);
+        }
+        fs << "]" << "}";
+    }
+    fs << "]";
+}
+
+static LayerParams readParams(const FileNode& node)
+{
+    LayerParams params;
+    for (FileNodeIterator it = node.begin(); it != node.end(); ++it)
+    {
+        const FileNode& p = *it;
+        String name = (String)p["name"];
+        String type = (String)p["type"];
+        const FileNode values = p["values"];
+        if (type == "string")
+        {
+            std::vector<String> v;
+            values >> v;
+            params.set(name, DictValue::arrayString(v.begin(), (int)v.size()));
+        }
+        else if (type == "int")
+        {
+            std::vector<int64> v;
+            for (FileNodeIterator vit = values.begin(); vit != values.end(); ++vit)
+                v.push_back((int64)(double)*vit);
+            params.set(name, DictValue::arrayInt(v.begin(), (int)v.size()));
+        }
+        else if (type == "real")
+        {
+            std::vector<double> v;
+            values >> v;
+            params.set(name, DictValue::arrayReal(v.begin(), (int)v.size()));
+        }
+        else
+            CV_Error(Error::StsParseError, "DNN/Compiled: unknown type of parameter '" + name + "': " + type);
+    }
+    return params;
+}
+
+static void writePins(FileStorage& fs, const char* name, const std::vector<LayerPin>& pins)
+{
+    std::vector<int> v;
+    for (size_t i = 0; i < pins.size(); i++)
+    {
+        v.push_back(pins[i].lid);
+        v.push_back(pins[i].oid);
+    }
+    fs << name << v;
+}
+
+static std::vector<LayerPin> readPins(const FileNode& node)
+{
+    std::vector<int> v;
+    node >> v;
+    CV_Assert(v.size() % 2 == 0);
+    std::vector<LayerPin> pins;
+    for (size_t i = 0; i < v.size(); i += 2)
+        pins.push_back(LayerPin(v[i], v[i + 1]));
+    return pins;
+}
+
+static void writeNameToId(FileStorage& fs, const char* name, const std::map<String, int>& m)
+{
+    fs << name << "[";
+    for (std::map<String, int>::const_iterator it = m.begin(); it != m.end(); ++it)
+    {
+        fs << "{";
+        write(fs, "name", it->first);
+        fs << "id" << it->second << "}";
+    }
+    fs << "]";
+}
+
+static void readNameToId(const FileNode& node, std::map<String, int>& m)
+{
+    for (FileNodeIterator it = node.begin(); it != node.end(); ++it)
+        m[(String)(*it)["name"]] = (int)(*it)["id"];
+}
+
+static std::vector<Mat> readMats(const FileNode& node, const Ptr<MappedFile>& file, size_t dataOffset)
+{
+    std::vector<Mat> mats;
+    for (FileNodeIterator it = node.begin(); it != node.end(); ++it)
+    {
+        std::vector<int> shape;
+        (*it)["shape"] >> shape;
+        int type = (int)(*it)["type"];
+        size_t offset = dataOffset + (size_t)(int)(*it)["offset"] * COMPILED_NET_BLOB_ALIGN;
+        mats.push_back(MappedFile::wrap(file, offset, (int)shape.size(), shape.data(), type));
+    }
+    return mats;
+}
+
+}  // namespace
+
+
+void Net::Impl::save(const String& path) const
+{
+    CV_TRACE_FUNCTION();
+
+    CompiledNetWriter writer;
+    FileStorage fs(".json", FileStorage::WRITE | FileStorage::MEMORY);
+
+    fs << "inputs" << "[";
+    for (size_t i = 0; i < netInputLayer->outNames.size(); i++)
+        write(fs, String(), netInputLayer->outNames[i]);
+    fs << "]";
+    fs << "inputShapes" << "[";
+    for (size_t i = 0; i < netInputLayer->shapes.size(); i++)
+        fs << netInputLayer->shapes[i];
+    fs << "]";
+
+    // Graph is saved as it was loaded. Fusion and shapes inference are cheap and repeated after loading,
+    // but weights computed by layers during the initialization are saved to skip this step.
+    fs << "layers" << "[";
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        fs << "{" << "id" << ld.id;
+        if (ld.id != 0)
+        {
+            write(fs, "name", ld.name);
+            write(fs, "type", ld.type);
+            fs << "dtype" << ld.dtype;
+            fs << "params";
+            writeParams(fs, ld.params);
+            fs << "blobs";
+            writer.writeMats(fs, ld.params.blobs);
+        }
+        writePins(fs, "inputBlobsId", ld.inputBlobsId);
+        fs << "inputLayersId" << std::vector<int>(ld.inputLayersId.begin(), ld.inputLayersId.end());
+        fs << "requiredOutputs" << std::vector<int>(ld.requiredOutputs.begin(), ld.requiredOutputs.end());
+        writePins(fs, "consumers", ld.consumers);
+        fs << "}";
+    }
+    fs << "]";
+
+    writeNameToId(fs, "layerNameToId", layerNameToId);
+    writeNameToId(fs, "outputNameToId", outputNameToId);
+    fs << "lastLayerId" << lastLayerId;
+    fs << "hasDynamicShapes" << (int)hasDynamicShapes;
+    fs << "netWasQuantized" << (int)netWasQuantized;
+    fs << "fusion" << (int)fusion;
+    fs << "useWinograd" << (int)useWinograd;
+
+    fs << "packed" << "[";
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        const SharedWeightsHolder* holder = dynamic_cast<const SharedWeightsHolder*>(ld.layerInstance.get());
+        std::string key;
+        std::vector<Mat> data;
+        if (!holder || !holder->exportPacked(key, data))
+            continue;
+        fs << "{" << "id" << ld.id;
+        write(fs, "key", key);
+        fs << "data";
+        writer.writeMats(fs, data);
+        fs << "}";
+    }
+    fs << "]";
+
+    std::string metadata = fs.releaseAndGetString();
+
+    CompiledNetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COMPILED_NET_MAGIC, sizeof(header.magic));
+    header.version = COMPILED_NET_VERSION;
+    header.byteOrder = COMPILED_NET_BYTE_ORDER;
+    header.metadataSize = metadata.size();
+    header.dataOffset = alignSize(sizeof(header) + metadata.size(), COMPILED_NET_DATA_ALIGN);
+
+    std::ofstream ofs(path.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs.is_open())
+        CV_Error(Error::StsError, "DNN/Compiled: can't open file for writing: " + path);
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.write(metadata.data(), metadata.size());
+
+    const std::vector<char> padding(COMPILED_NET_DATA_ALIGN, 0);
+    ofs.write(padding.data(), header.dataOffset - sizeof(header) - metadata.size());
+    for (size_t i = 0; i < writer.chunks.size(); i++)
+    {
+        const Mat& m = writer.chunks[i];
+        size_t size = m.total() * m.elemSize();
+        ofs.write((const char*)m.data, size);
+        ofs.write(padding.data(), alignSize(size, COMPILED_NET_BLOB_ALIGN) - size);
+    }
+    if (!ofs)
+        CV_Error(Error::StsError, "DNN/Compiled: can't write file: " + path);
+}
+
+
+Net readNetFromCompiled(const String& path)
+{
+    CV_TRACE_FUNCTION();
+
+    Ptr<MappedFile> file = MappedFile::open(path);
+    CompiledNetHeader header;
+    if (file->size() < sizeof(header))
+        CV_Error(Error::StsParseError, "DNN/Compiled: file is too small: " + path);
+    memcpy(&header, file->data(), sizeof(header));
+    if (memcmp(header.magic, COMPILED_NET_MAGIC, sizeof(header.magic)) != 0)
+        CV_Error(Error::StsParseError, "DNN/Compiled: not a compiled network: " + path);
+    CV_CheckEQ((int)header.byteOrder, (int)COMPILED_NET_BYTE_ORDER, "DNN/Compiled: network is compiled on a platform with other byte order");
+    CV_CheckEQ((int)header.version, (int)COMPILED_NET_VERSION, "DNN/Compiled: unsupported version");
+    CV_Assert(header.metadataSize <= file->size() - sizeof(header));
+    CV_Assert(header.dataOffset >= sizeof(header) + header.metadataSize && header.dataOffset <= file->size());
+
+    std::string metadata((const char*)file->data() + sizeof(header), (size_t)header.metadataSize);
+    FileStorage fs(metadata, FileStorage::READ | FileStorage::MEMORY | FileStorage::FORMAT_JSON);
+    const size_t dataOffset = (size_t)header.dataOffset;
+
+    Net net;
+    Net::Impl& impl = net.getImplRef();
+
+    std::vector<String> inputs;
+    fs["inputs"] >> inputs;
+    impl.setInputsNames(inputs);
+    const FileNode inputShapes = fs["inputShapes"];
+    for (FileNodeIterator it = inputShapes.begin(); it != inputShapes.end(); ++it)
+    {
+        MatShape shape;
+        *it >> shape;
+        impl.netInputLayer->shapes.push_back(shape);
+    }
+
+    const FileNode layers = fs["layers"];
+    for (FileNodeIterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const FileNode& node = *it;
+        int id = (int)node["id"];
+        if (id != 0)
+        {
+            LayerParams params = readParams(node["params"]);
+            params.blobs = readMats(node["blobs"], file, dataOffset);
+            impl.layers.insert(std::make_pair(id, LayerData(id, (String)node["name"], (String)node["type"],
+                                                            (int)node["dtype"], params)));
+        }
+        LayerData& ld = impl.layers[id];
+        ld.inputBlobsId = readPins(node["inputBlobsId"]);
+        std::vector<int> v;
+        node["inputLayersId"] >> v;
+        ld.inputLayersId = std::set<int>(v.begin(), v.end());
+        node["requiredOutputs"] >> v;
+        ld.requiredOutputs = std::set<int>(v.begin(), v.end());
+        ld.consumers = readPins(node["consumers"]);
+    }
+
+    readNameToId(fs["layerNameToId"], impl.layerNameToId);
+    readNameToId(fs["outputNameToId"], impl.outputNameToId);
+    impl.lastLayerId = (int)fs["lastLayerId"];
+    impl.hasDynamicShapes = (int)fs["hasDynamicShapes"] != 0;
+    impl.netWasQuantized = (int)fs["netWasQuantized"] != 0;
+    impl.fusion = (int)fs["fusion"] != 0;
+    impl.useWinograd = (int)fs["useWinograd"] != 0;
+
+    // Layers convert the data back into their internal structures and preload them into the shared storage,
+    // so the weights are not packed again on the first run (and in clones of the network).
+    const FileNode packed = fs["packed"];
+    for (FileNodeIterator it = packed.begin(); it != packed.end(); ++it)
+    {
+        const FileNode& node = *it;
+        LayerData& ld = impl.getLayerData((int)node["id"]);
+        SharedWeightsHolder* holder = dynamic_cast<SharedWeightsHolder*>(impl.getLayerInstance(ld).get());
+        if (holder)
+            holder->importPacked((String)node["key"], readMats(node["data"], file, dataOffset));
+    }
+    return net;
+}
+
+
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -59,6 +59,11 @@ Net::Impl::Impl()
     preferableTarget = DNN_TARGET_CPU;
     hasDynamicShapes = false;
     useWinograd = true;
+    useMemoryPlanner = false;
+    profiling = false;
+    numInterOpThreads = 1;
+    setNumInterOpThreads(getParam_DNN_INTER_OP_THREADS());
+    sharedWeights = makePtr<SharedWeights>();
 }
 
 
@@ -95,6 +100,29 @@ void Net::Impl::clear()
 }
 
 
+void Net::Impl::resetAllocationPlans()
+{
+    allocationPlans.clear();
+    for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
+        it->second.finalized = false;
+}
+
+
+Net::Impl::AllocationPlan* Net::Impl::findAllocationPlan(const ShapesVec& inputShapes,
+                                                         const std::vector<LayerPin>& blobsToKeep_)
+{
+    for (std::list<AllocationPlan>::iterator it = allocationPlans.begin(); it != allocationPlans.end(); ++it)
+    {
+        if (it->inputShapes == inputShapes && it->blobsToKeep == blobsToKeep_)
+        {
+            allocationPlans.splice(allocationPlans.begin(), allocationPlans, it);
+            return &allocationPlans.front();
+        }
+    }
+    return NULL;
+}
+
+
 void Net::Impl::validateBackendAndTarget()
 {
     CV_TRACE_FUNCTION();
@@ -386,6 +414,7 @@ int Net::Impl::addLayer(const String& name, const String& type, const int& dtype
     layers.insert(std::make_pair(id, LayerData(id, name, type, dtype, params)));
     if (params.get<bool>("has_dynamic_shapes", false))
         hasDynamicShapes = true;
+    allocationPlans.clear();
 
     if (dtype == CV_8S)
         netWasQuantized = true;
@@ -412,6 +441,7 @@ void Net::Impl::connect(int outLayerId, int outNum, int inLayerId, int inNum)
     addLayerInput(ldInp, inNum, LayerPin(outLayerId, outNum));
     ldOut.requiredOutputs.insert(outNum);
     ldOut.consumers.push_back(LayerPin(inLayerId, outNum));
+    allocationPlans.clear();
 
     CV_LOG_VERBOSE(NULL, 0, "DNN: connect(" << outLayerId << ":" << outNum << " ==> " << inLayerId << ":" << inNum << ")");
 }
@@ -517,7 +547,10 @@ void Net::Impl::allocateLayer(int lid, const LayersShapesMap& layersShapes)
         ld.dtype = CV_16F;
 
     std::vector<LayerPin> pinsForInternalBlobs;
-    blobManager.allocateBlobsForLayer(ld, layerShapesIt->second, pinsForInternalBlobs);
+    if (useMemoryPlanner)
+        memoryPlanner.allocateBlobsForLayer(ld, layerShapesIt->second);
+    else
+        blobManager.allocateBlobsForLayer(ld, layerShapesIt->second, pinsForInternalBlobs);
     ld.outputBlobsWrappers.resize(ld.outputBlobs.size());
     for (int i = 0; i < ld.outputBlobs.size(); ++i)
         ld.outputBlobsWrappers[i] = wrap(ld.outputBlobs[i]);
@@ -534,8 +567,12 @@ void Net::Impl::allocateLayer(int lid, const LayersShapesMap& layersShapes)
         {
             inps[i] = *ld.inputBlobs[i];
         }
-        layerPtr->finalize(inps, ld.outputBlobs);
+        // finalize() of some layers depends on the target (e.g. FP16 weights for DNN_TARGET_CPU_FP16)
         layerPtr->preferableTarget = preferableTarget;
+        const LayerFinalizeInfo* finalizeInfo = dynamic_cast<const LayerFinalizeInfo*>(layerPtr.get());
+        if (!ld.finalized || !finalizeInfo || !finalizeInfo->isFinalizeShapeIndependent())
+            layerPtr->finalize(inps, ld.outputBlobs);
+        ld.finalized = true;
 #if 0
         std::cout << "\toutputs:";
         size_t noutputs = ld.outputBlobs.size();
@@ -548,13 +585,24 @@ void Net::Impl::allocateLayer(int lid, const LayersShapesMap& layersShapes)
     }
 
     // After allocation of layer, we decrease counters to it's input blobs.
-    blobManager.releaseReferences(ld.inputBlobsId);
-    blobManager.releaseReferences(pinsForInternalBlobs);
+    if (!useMemoryPlanner)
+    {
+        blobManager.releaseReferences(ld.inputBlobsId);
+        blobManager.releaseReferences(pinsForInternalBlobs);
+    }
 
     ld.flag = 1;
 }
 
 
+bool Net::Impl::isMemoryPlannerEnabled() const
+{
+    // Intermediate blobs of CPU targets are packed into a single arena by the static planner.
+    // Other targets keep the greedy blobs reuse because of backend wrappers which are bound to the host memory.
+    return preferableBackend == DNN_BACKEND_OPENCV && IS_DNN_CPU_TARGET(preferableTarget) &&
+           getParam_DNN_MEMORY_PLANNER() && !getParam_DNN_DISABLE_MEMORY_OPTIMIZATIONS();
+}
+
 void Net::Impl::allocateLayers(const std::vector<LayerPin>& blobsToKeep_)
 {
     CV_TRACE_FUNCTION();
@@ -576,11 +624,12 @@ void Net::Impl::allocateLayers(const std::vector<LayerPin>& blobsToKeep_)
         }
         inputShapes.push_back(shape(inp));
     }
-    LayersShapesMap layersShapes;
-    getLayersShapes(inputShapes, layersShapes);
 
     blobManager.reset();
+    memoryPlanner.reset();
     backendWrappers.clear();
+    if (interOpScheduler)
+        interOpScheduler->reset();
 
     for (auto& layer : layers)
     {
@@ -590,18 +639,56 @@ void Net::Impl::allocateLayers(const std::vector<LayerPin>& blobsToKeep_)
         ld.internalBlobsWrappers.clear();
     }
 
-    // Fake references to input blobs.
-    for (int i = 0; i < layers[0].outputBlobs.size(); ++i)
-        blobManager.addReference(LayerPin(0, i));
-    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    // Shapes inference and memory planning are done once for every set of input shapes,
+    // so switching between several input resolutions doesn't repeat them.
+    LayersShapesMap layersShapes;
+    useMemoryPlanner = isMemoryPlannerEnabled();
+    const AllocationPlan* cachedPlan = findAllocationPlan(inputShapes, blobsToKeep_);
+    if (cachedPlan)
     {
-        const LayerData& ld = it->second;
-        blobManager.addReferences(ld.inputBlobsId);
+        layersShapes = cachedPlan->layersShapes;
+        if (useMemoryPlanner)
+            memoryPlanner = cachedPlan->memoryPlanner;
     }
+    else
+    {
+        getLayersShapes(inputShapes, layersShapes);
+        if (useMemoryPlanner)
+        {
+            memoryPlanner.plan(layers, layersShapes, blobsToKeep_);
+            memoryPlanner.allocate();
+        }
 
-    for (int i = 0; i < blobsToKeep_.size(); i++)
+        const size_t cacheSize = getParam_DNN_PLAN_CACHE_SIZE();
+        if (cacheSize > 0)
+        {
+            AllocationPlan plan;
+            plan.inputShapes = inputShapes;
+            plan.blobsToKeep = blobsToKeep_;
+            plan.layersShapes = layersShapes;
+            if (useMemoryPlanner)
+                plan.memoryPlanner = memoryPlanner;
+            allocationPlans.push_front(plan);
+            while (allocationPlans.size() > cacheSize)
+                allocationPlans.pop_back();
+        }
+    }
+
+    if (!useMemoryPlanner)
     {
-        blobManager.addReference(blobsToKeep_[i]);
+        // Fake references to input blobs.
+        for (int i = 0; i < layers[0].outputBlobs.size(); ++i)
+            blobManager.addReference(LayerPin(0, i));
+        for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+        {
+            const LayerData& ld = it->second;
+            blobManager.addReferences(ld.inputBlobsId);
+        }
+
+        for (int i = 0; i < blobsToKeep_.size(); i++)
+        {
+            blobManager.addReference(blobsToKeep_[i]);
+        }
     }
 
     for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); it++)
@@ -623,6 +710,7 @@ void Net::Impl::forwardLayer(LayerData& ld)
 
     if (!ld.skip)
     {
+        const int64 startTick = profiling ? getTickCount() : 0;
         TickMeter tm;
         tm.start();
 
@@ -848,6 +936,8 @@ void Net::Impl::forwardLayer(LayerData& ld)
         tm.stop();
         int64 t = tm.getTimeTicks();
         layersTimings[ld.id] = (t > 0) ? t : t + 1;  // zero for skipped layers only
+        if (profiling)
+            profiler->addSample(ld, startTick, t);
     }
     else
     {
@@ -866,23 +956,34 @@ void Net::Impl::forwardToLayer(LayerData& ld, bool clearFlags)
     {
         for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
             it->second.flag = 0;
+        if (profiling)
+            profiler->beginRun(layers);
     }
 
     // already was forwarded
     if (ld.flag)
         return;
 
-    // forward parents
-    for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end() && (it->second.id < ld.id); ++it)
+    // NetProfiler is not thread-safe, so layers are forwarded one by one while profiling
+    if (interOpScheduler && preferableBackend == DNN_BACKEND_OPENCV && !IS_DNN_OPENCL_TARGET(preferableTarget) && !profiling)
     {
-        LayerData& ld = it->second;
-        if (ld.flag)
-            continue;
-        forwardLayer(ld);
+        // forward parents and itself, independent layers concurrently
+        interOpScheduler->run(layers, ld.id, [this](LayerData& ld_) { forwardLayer(ld_); });
     }
+    else
+    {
+        // forward parents
+        for (MapIdToLayerData::iterator it = layers.begin(); it != layers.end() && (it->second.id < ld.id); ++it)
+        {
+            LayerData& ld = it->second;
+            if (ld.flag)
+                continue;
+            forwardLayer(ld);
+        }
 
-    // forward itself
-    forwardLayer(ld);
+        // forward itself
+        forwardLayer(ld);
+    }
 
 #ifdef HAVE_CUDA
     if (preferableBackend == DNN_BACKEND_CUDA)
@@ -1467,6 +1568,49 @@ void Net::Impl::setParam(int layer, int numParam, const Mat& blob)
     CV_Assert(numParam < (int)layerBlobs.size());
     // we don't make strong checks, use this function carefully
     layerBlobs[numParam] = blob;
+    ld.finalized = false;
+}
+
+
+Net Net::Impl::clone() const
+{
+    CV_TRACE_FUNCTION();
+
+    Net dstNet_;
+    Net::Impl& dstNet = *(dstNet_.impl);
+    dstNet.setInputsNames(netInputLayer->outNames);
+    dstNet.netInputLayer->shapes = netInputLayer->shapes;
+
+    // Layers are created again from parameters. Copies of parameters refer to the same weights.
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        if (ld.id != 0)
+        {
+            LayerParams params = ld.params;
+            dstNet.layers.insert(make_pair(ld.id, LayerData(ld.id, ld.name, ld.type, ld.dtype, params)));
+        }
+        LayerData& dstLd = dstNet.layers[ld.id];
+        dstLd.inputBlobsId = ld.inputBlobsId;
+        dstLd.inputLayersId = ld.inputLayersId;
+        dstLd.requiredOutputs = ld.requiredOutputs;
+        dstLd.consumers = ld.consumers;
+    }
+    dstNet.layerNameToId = layerNameToId;
+    dstNet.outputNameToId = outputNameToId;
+    dstNet.lastLayerId = lastLayerId;
+    dstNet.hasDynamicShapes = hasDynamicShapes;
+    dstNet.halideConfigFile = halideConfigFile;
+    dstNet.netWasQuantized = netWasQuantized;
+    dstNet.fusion = fusion;
+    dstNet.useWinograd = useWinograd;
+    dstNet.setNumInterOpThreads(numInterOpThreads);
+    dstNet.sharedWeights = sharedWeights;
+
+    // Backend may replace implementation of the network, so it is set after the graph is copied.
+    dstNet_.setPreferableBackend(preferableBackend);
+    dstNet_.setPreferableTarget(preferableTarget);
+    return dstNet_;
 }
 
 
@@ -2266,6 +2410,24 @@ void Net::Impl::getMemoryConsumption(
         weights += w[i];
         blobs += b[i];
     }
+
+    if (!isMemoryPlannerEnabled())
+        return;
+
+    // Report peak memory of intermediate blobs according to the static memory plan.
+    LayersShapesMap layersShapes;
+    getLayersShapes(netInputShapes, layersShapes);
+    MemoryPlanner planner;
+    planner.plan(layers, layersShapes, blobsToKeep);
+
+    // FIXIT netWasQuantized check is not enough - per layer check should be done
+    size_t elemSize = netWasQuantized ? sizeof(char) : sizeof(float);
+    blobs = planner.getArenaSize();
+    const ShapesVec& inputShapes = layersShapes[0].out;
+    for (size_t i = 0; i < inputShapes.size(); i++)
+    {
+        blobs += total(inputShapes[i]) * elemSize;
+    }
 }
 
 
@@ -2276,6 +2438,38 @@ int64 Net::Impl::getPerfProfile(std::vector<double>& timings) const
     return total;
 }
 
+void Net::Impl::enableProfiling(bool enable)
+{
+    if (enable && !profiling)
+        profiler = makePtr<NetProfiler>();
+    profiling = enable;
+}
+
+void Net::Impl::setNumInterOpThreads(int nthreads)
+{
+    nthreads = std::max(nthreads, 1);
+    if (nthreads == numInterOpThreads)
+        return;
+    numInterOpThreads = nthreads;
+    interOpScheduler.release();
+    if (nthreads > 1)
+        interOpScheduler = makePtr<InterOpScheduler>(nthreads);
+}
+
+String Net::Impl::dumpProfile() const
+{
+    if (!profiler)
+        CV_Error(Error::StsError, "DNN: profiling was not enabled, see Net::enableProfiling()");
+    return profiler->summary();
+}
+
+void Net::Impl::dumpProfileToFile(const String& path) const
+{
+    if (!profiler)
+        CV_Error(Error::StsError, "DNN: profiling was not enabled, see Net::enableProfiling()");
+    profiler->writeTrace(path);
+}
+
 void Net::Impl::getMemoryConsumption(
         const std::vector<MatShape>& netInputShapes,
         std::vector<int>& layerIds, std::vector<size_t>& weights,
@@ -2317,6 +2511,7 @@ void Net::Impl::enableWinograd(bool useWinograd_)
     if (useWinograd != useWinograd_)
     {
         useWinograd = useWinograd_;
+        resetAllocationPlans();
 
         for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); it++)
         {
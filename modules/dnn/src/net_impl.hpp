@@ -22,9 +22,15 @@
 
 #include <opencv2/core/utils/logger.hpp>
 
+#include <list>
+
 #include "layer_internals.hpp"  // LayerPin LayerData DataLayer
 
 #include "legacy_backend.hpp"  // wrapMat BlobManager OpenCLBackendWrapper
+#include "memory_planner.hpp"  // MemoryPlanner
+#include "shared_weights.hpp"  // SharedWeights
+#include "net_profiler.hpp"  // NetProfiler
+#include "inter_op_scheduler.hpp"  // InterOpScheduler
 
 namespace cv {
 namespace dnn {
@@ -52,6 +58,19 @@ struct Net::Impl : public detail::NetImplBase
     std::map<String, int> layerNameToId;
     std::map<std::string, int> outputNameToId;  // use registerOutput() to populate outputs
     BlobManager blobManager;
+    MemoryPlanner memoryPlanner;
+    bool useMemoryPlanner;  // memoryPlanner is used instead of blobManager for the current allocation
+
+    // Shapes of blobs and memory plan of the network allocated for the specific input shapes.
+    struct AllocationPlan
+    {
+        ShapesVec inputShapes;
+        std::vector<LayerPin> blobsToKeep;
+        LayersShapesMap layersShapes;
+        MemoryPlanner memoryPlanner;  // planned and allocated if useMemoryPlanner
+    };
+    std::list<AllocationPlan> allocationPlans;  // the most recently used plan first
+    Ptr<SharedWeights> sharedWeights;  // shared with copies of the network, see clone()
     int preferableBackend;
     int preferableTarget;
     String halideConfigFile;
@@ -67,6 +86,10 @@ struct Net::Impl : public detail::NetImplBase
     bool isAsync;  // FIXIT: drop
     bool useWinograd;
     std::vector<int64> layersTimings;
+    bool profiling;
+    Ptr<NetProfiler> profiler;  // collected profile, kept after profiling is disabled
+    int numInterOpThreads;
+    Ptr<InterOpScheduler> interOpScheduler;  // set if numInterOpThreads > 1
 
 
     virtual bool empty() const;
@@ -79,6 +102,10 @@ struct Net::Impl : public detail::NetImplBase
 
     virtual void clear();
 
+    /// Drops cached allocation plans and finalization of layers (graph, backend or target is changed)
+    void resetAllocationPlans();
+    AllocationPlan* findAllocationPlan(const ShapesVec& inputShapes, const std::vector<LayerPin>& blobsToKeep_);
+
 
     virtual void validateBackendAndTarget();
 
@@ -107,6 +134,9 @@ struct Net::Impl : public detail::NetImplBase
         {
             CV_Error(Error::StsError, "Can't create layer \"" + ld.name + "\" of type \"" + ld.type + "\"");
         }
+        SharedWeightsHolder* holder = dynamic_cast<SharedWeightsHolder*>(ld.layerInstance.get());
+        if (holder)
+            holder->sharedWeights = sharedWeights;
 
         return ld.layerInstance;
     }
@@ -156,6 +186,9 @@ struct Net::Impl : public detail::NetImplBase
     virtual void setInput(InputArray blob, const String& name, double scalefactor, const Scalar& mean);
     Mat getParam(int layer, int numParam) const;
     void setParam(int layer, int numParam, const Mat& blob);
+    /// Creates the network again from layers parameters. Backend implementations which wrap another one clone the base network.
+    virtual Net clone() const;
+    void save(const String& path) const;
     std::vector<Ptr<Layer>> getLayerInputs(int layerId) const;
     std::vector<String> getLayerNames() const;
 
@@ -217,6 +250,8 @@ struct Net::Impl : public detail::NetImplBase
     void enableWinograd(bool useWinograd_);
 
     void allocateLayers(const std::vector<LayerPin>& blobsToKeep_);
+    /// Intermediate blobs are allocated by the static memory planner (otherwise by BlobManager)
+    bool isMemoryPlannerEnabled() const;
 
     virtual void forwardLayer(LayerData& ld);
 
@@ -265,6 +300,10 @@ struct Net::Impl : public detail::NetImplBase
             std::vector<int>& layerIds, std::vector<size_t>& weights,
             std::vector<size_t>& blobs) /*const*/;
     int64 getPerfProfile(std::vector<double>& timings) const;
+    void enableProfiling(bool enable);
+    void setNumInterOpThreads(int nthreads);
+    String dumpProfile() const;
+    void dumpProfileToFile(const String& path) const;
 
     // TODO drop
     LayerPin getLatestLayerPin(const std::vector<LayerPin>& pins) const;
@@ -284,6 +323,11 @@ struct Net::Impl : public detail::NetImplBase
 
     // FIXIT drop from inference API
     Net quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype, int outputsDtype, bool perChannel) /*const*/;
+    Net quantize(Net& net, InputArrayOfArrays calibData, const QuantizationParams& params) /*const*/;
+    // Creates a network where all the layers except fp32Layers are quantized if they support it
+    Net buildQuantizedNet(const std::vector<std::vector<float> >& scales, const std::vector<std::vector<int> >& zeropoints,
+                          const std::set<int>& fp32Layers, int inputsDtype, int outputsDtype, bool perChannel,
+                          std::vector<int>* quantizedLayers = NULL);
     void getInputDetails(std::vector<float>& scales, std::vector<int>& zeropoints) /*const*/;
     void getOutputDetails(std::vector<float>& scales, std::vector<int>& zeropoints) /*const*/;
 
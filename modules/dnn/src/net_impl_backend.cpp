@@ -191,6 +191,7 @@ void Net::Impl::setPreferableBackend(Net& net, int backendId)
     if (preferableBackend != backendId)
     {
         clear();
+        resetAllocationPlans();
         if (backendId == DNN_BACKEND_INFERENCE_ENGINE_NGRAPH)
         {
 #if defined(HAVE_INF_ENGINE)
@@ -256,15 +257,14 @@ void Net::Impl::setPreferableTarget(int targetId)
                 preferableTarget = DNN_TARGET_CUDA;
 #endif
         }
-#if !defined(__arm64__) || !__arm64__
-        if (targetId == DNN_TARGET_CPU_FP16)
+        if (targetId == DNN_TARGET_CPU_FP16 && !haveCPU_FP16Target())
         {
-            CV_LOG_WARNING(NULL, "DNN: fall back to DNN_TARGET_CPU. Only ARM v8 CPU is supported by DNN_TARGET_CPU_FP16.");
+            CV_LOG_WARNING(NULL, "DNN: fall back to DNN_TARGET_CPU. Only ARM v8 CPU and x86 CPU with AVX2 and F16C are supported by DNN_TARGET_CPU_FP16.");
             targetId = DNN_TARGET_CPU;
         }
-#endif
 
         clear();
+        resetAllocationPlans();
 
         if (targetId == DNN_TARGET_CPU_FP16)
         {
@@ -94,6 +94,17 @@ public:
         basePtr_->setPreferableBackend(net, backendId);
     }
 
+    Net clone() const override
+    {
+        if (!basePtr_)
+            CV_Error(Error::StsNotImplemented, "DNN: Net::clone() is not supported for networks loaded by OpenVINO native loader");
+        // Layers of the base network are created from parameters
+        Net net = basePtr_->clone();
+        net.setPreferableBackend(preferableBackend);
+        net.setPreferableTarget(preferableTarget);
+        return net;
+    }
+
     void setPreferableTarget(int targetId) override
     {
         if (preferableTarget != targetId)
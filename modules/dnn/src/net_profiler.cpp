@@ -0,0 +1,198 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "net_profiler.hpp"
+
+#include <set>
+#include <sstream>
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+static size_t blobBytes(const Mat& m)
+{
+    return m.total() * m.elemSize();
+}
+
+NetProfiler::NetProfiler()
+    : startTick(getTickCount())
+{
+}
+
+void NetProfiler::beginRun(const MapIdToLayerData& layers)
+{
+    // Blobs may share memory (in-place layers, reused buffers, memory planner arena)
+    std::set<const UMatData*> buffers;
+    size_t memory = 0;
+    for (MapIdToLayerData::const_iterator it = layers.begin(); it != layers.end(); ++it)
+    {
+        const LayerData& ld = it->second;
+        for (int k = 0; k < 2; k++)
+        {
+            const std::vector<Mat>& blobs = k == 0 ? ld.outputBlobs : ld.internals;
+            for (size_t i = 0; i < blobs.size(); i++)
+            {
+                const UMatData* u = blobs[i].u;
+                if (u && buffers.insert(u).second)
+                    memory += u->size;
+                else if (!u)
+                    memory += blobBytes(blobs[i]);
+            }
+        }
+    }
+    Run run;
+    run.start = getTickCount();
+    run.memory = memory;
+    runs.push_back(run);
+}
+
+void NetProfiler::addSample(const LayerData& ld, int64 start, int64 ticks)
+{
+    if (runs.empty())
+        return;  // layer is called outside of Net::forward()
+
+    const Ptr<Layer>& layer = ld.layerInstance;
+    std::vector<MatShape> inputShapes(ld.inputBlobs.size()), outputShapes(ld.outputBlobs.size());
+    Sample sample;
+    sample.layerId = ld.id;
+    sample.run = (int)runs.size() - 1;
+    sample.start = start;
+    sample.duration = ticks;
+    sample.bytes = 0;
+    for (size_t i = 0; i < ld.inputBlobs.size(); i++)
+    {
+        inputShapes[i] = shape(*ld.inputBlobs[i]);
+        sample.bytes += blobBytes(*ld.inputBlobs[i]);
+    }
+    for (size_t i = 0; i < ld.outputBlobs.size(); i++)
+    {
+        outputShapes[i] = shape(ld.outputBlobs[i]);
+        sample.bytes += blobBytes(ld.outputBlobs[i]);
+    }
+    for (size_t i = 0; i < layer->blobs.size(); i++)
+        sample.bytes += blobBytes(layer->blobs[i]);
+    sample.flops = (double)layer->getFLOPS(inputShapes, outputShapes);
+    sample.threads = getNumThreads();
+    const LayerKernelInfo* kernelInfo = dynamic_cast<const LayerKernelInfo*>(layer.get());
+    if (kernelInfo)
+        sample.kernel = kernelInfo->getKernelName();
+    samples.push_back(sample);
+
+    if (layersInfo.find(ld.id) == layersInfo.end())
+    {
+        LayerInfo& info = layersInfo[ld.id];
+        info.name = ld.name;
+        info.type = ld.type;
+    }
+}
+
+std::string NetProfiler::summary() const
+{
+    struct LayerStat
+    {
+        int id;
+        int calls;
+        int64 total, minTicks, maxTicks;
+        double flops;
+        size_t bytes;
+        std::string kernel;
+    };
+    std::map<int, LayerStat> stats;
+    int64 total = 0;
+    int threads = 0;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        const Sample& s = samples[i];
+        std::map<int, LayerStat>::iterator it = stats.find(s.layerId);
+        if (it == stats.end())
+        {
+            LayerStat stat = { s.layerId, 0, 0, s.duration, s.duration, 0.0, 0, std::string() };
+            it = stats.insert(std::make_pair(s.layerId, stat)).first;
+        }
+        LayerStat& stat = it->second;
+        stat.calls++;
+        stat.total += s.duration;
+        stat.minTicks = std::min(stat.minTicks, s.duration);
+        stat.maxTicks = std::max(stat.maxTicks, s.duration);
+        stat.flops += s.flops;
+        stat.bytes += s.bytes;
+        stat.kernel = s.kernel;
+        total += s.duration;
+        threads = std::max(threads, s.threads);
+    }
+
+    std::vector<LayerStat> sorted;
+    for (std::map<int, LayerStat>::const_iterator it = stats.begin(); it != stats.end(); ++it)
+        sorted.push_back(it->second);
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const LayerStat& a, const LayerStat& b) { return a.total > b.total; });
+
+    size_t peakMemory = 0;
+    for (size_t i = 0; i < runs.size(); i++)
+        peakMemory = std::max(peakMemory, runs[i].memory);
+
+    const double ms = 1000.0 / getTickFrequency();
+    std::ostringstream out;
+    out << format("Runs: %d, mean time: %.3f ms, peak memory of blobs: %.3f MB, threads: %d\n",
+                  (int)runs.size(), runs.empty() ? 0.0 : total * ms / runs.size(), peakMemory / (1024.0 * 1024.0), threads);
+    out << format("%5s %-32s %-20s %-24s %6s %10s %10s %10s %7s %10s %8s %10s\n",
+                  "id", "name", "type", "kernel", "calls", "mean(ms)", "min(ms)", "max(ms)", "time(%)",
+                  "MFLOP", "GFLOPS", "MB");
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        const LayerStat& stat = sorted[i];
+        const LayerInfo& info = layersInfo.at(stat.id);
+        const double meanMs = stat.total * ms / stat.calls;
+        out << format("%5d %-32s %-20s %-24s %6d %10.3f %10.3f %10.3f %7.2f %10.3f %8.2f %10.3f\n",
+                      stat.id, info.name.c_str(), info.type.c_str(), stat.kernel.c_str(), stat.calls,
+                      meanMs, stat.minTicks * ms, stat.maxTicks * ms,
+                      total > 0 ? 100.0 * stat.total / total : 0.0,
+                      stat.flops / stat.calls * 1e-6,
+                      stat.total > 0 ? stat.flops / (stat.total * ms) * 1e-6 : 0.0,
+                      (double)stat.bytes / stat.calls / (1024.0 * 1024.0));
+    }
+    return out.str();
+}
+
+void NetProfiler::writeTrace(const std::string& path) const
+{
+    FileStorage fs(path, FileStorage::WRITE | FileStorage::FORMAT_JSON);
+    CV_Assert(fs.isOpened());
+
+    // Timestamps are in microseconds from the start of profiling
+    const double us = 1e6 / getTickFrequency();
+    fs << "displayTimeUnit" << "ms";
+    fs << "traceEvents" << "[";
+    for (size_t i = 0; i < runs.size(); i++)
+    {
+        fs << "{" << "name" << "blobs memory" << "ph" << "C" << "pid" << 0
+           << "ts" << (runs[i].start - startTick) * us
+           << "args" << "{" << "bytes" << (double)runs[i].memory << "}" << "}";
+    }
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        const Sample& s = samples[i];
+        const LayerInfo& info = layersInfo.at(s.layerId);
+        // names are written with write() as operator<< treats strings starting with brackets specially
+        fs << "{";
+        write(fs, "name", info.name);
+        write(fs, "cat", info.type);
+        fs << "ph" << "X" << "pid" << 0 << "tid" << 0
+           << "ts" << (s.start - startTick) * us << "dur" << s.duration * us
+           << "args" << "{" << "id" << s.layerId << "run" << s.run;
+        write(fs, "kernel", s.kernel);
+        fs << "flops" << s.flops << "bytes" << (double)s.bytes << "threads" << s.threads
+           << "}" << "}";
+    }
+    fs << "]";
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
@@ -0,0 +1,81 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_NET_PROFILER_HPP__
+#define __OPENCV_DNN_SRC_NET_PROFILER_HPP__
+
+#include "layer_internals.hpp"  // LayerData
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/// Base class of layers which choose between several kernels. The name is reported by NetProfiler.
+struct LayerKernelInfo
+{
+    virtual ~LayerKernelInfo() {}
+
+    /// Name of the kernel used by forward(), e.g. "FastConv/Winograd".
+    virtual std::string getKernelName() const = 0;
+};
+
+/** @brief Collects per-layer statistics of forward passes (see Net::enableProfiling()).
+ *
+ * Every layer call is stored as a separate sample, so the profile of many runs can be
+ * exported as a Chrome trace. FLOPs, bytes and kernel are taken at the moment of the call,
+ * because they depend on the input shapes.
+ */
+class NetProfiler
+{
+public:
+    typedef std::map<int, LayerData> MapIdToLayerData;
+
+    NetProfiler();
+
+    /// Starts a new forward pass. Size of the allocated network blobs is recorded for the run.
+    void beginRun(const MapIdToLayerData& layers);
+
+    /// Records the layer call which started at @p startTick and took @p ticks.
+    void addSample(const LayerData& ld, int64 startTick, int64 ticks);
+
+    /// Text table with per-layer statistics over all runs, the slowest layers first.
+    std::string summary() const;
+
+    /// Writes all samples in Chrome trace event format (JSON).
+    void writeTrace(const std::string& path) const;
+
+private:
+    struct Sample
+    {
+        int layerId;
+        int run;
+        int64 start, duration;  // ticks
+        double flops;
+        size_t bytes;  // inputs, outputs and weights
+        int threads;
+        std::string kernel;
+    };
+
+    struct Run
+    {
+        int64 start;
+        size_t memory;  // bytes of the network blobs
+    };
+
+    struct LayerInfo
+    {
+        std::string name, type;
+    };
+
+    int64 startTick;
+    std::vector<Run> runs;
+    std::vector<Sample> samples;
+    std::map<int, LayerInfo> layersInfo;
+};
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_NET_PROFILER_HPP__
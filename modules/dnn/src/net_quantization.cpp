@@ -6,20 +6,152 @@
 
 #include "net_impl.hpp"
 
+#include <opencv2/core/utils/logger.hpp>
+
 namespace cv {
 namespace dnn {
 CV__DNN_INLINE_NS_BEGIN
 
 
+QuantizationParams::QuantizationParams()
+    : inputsDtype(CV_32F)
+    , outputsDtype(CV_32F)
+    , perChannel(true)
+    , calibration(DNN_CALIB_MINMAX)
+    , percentile(99.99)
+    , maxError(0)
+{
+    // nothing
+}
+
+// Threshold of |x| which minimizes KL divergence between the histogram and its quantized version
+// with the given number of levels (the "entropy" calibration of TensorRT).
+static double getEntropyThreshold(const std::vector<double>& hist, double binWidth, int levels)
+{
+    const int nbins = (int)hist.size();
+    int bestThreshold = nbins;
+    double bestDivergence = DBL_MAX;
+    std::vector<double> p(nbins), q(nbins);
+    for (int threshold = levels; threshold <= nbins; threshold++)
+    {
+        // Reference distribution, the clipped outliers are accumulated in the last bin
+        std::copy(hist.begin(), hist.begin() + threshold, p.begin());
+        for (int i = threshold; i < nbins; i++)
+            p[threshold - 1] += hist[i];
+
+        // Merge bins without the outliers into levels and spread every level uniformly over its non-empty bins,
+        // so clipping of the outliers is penalized
+        for (int level = 0; level < levels; level++)
+        {
+            int start = level * threshold / levels, end = (level + 1) * threshold / levels;
+            double sum = 0;
+            int nonzero = 0;
+            for (int i = start; i < end; i++)
+            {
+                sum += hist[i];
+                nonzero += hist[i] > 0;
+            }
+            for (int i = start; i < end; i++)
+                q[i] = hist[i] > 0 ? sum / nonzero : 0;
+        }
+
+        double psum = 0, qsum = 0;
+        for (int i = 0; i < threshold; i++)
+        {
+            psum += p[i];
+            qsum += q[i];
+        }
+        if (psum <= 0 || qsum <= 0)
+            continue;
+        double divergence = 0;
+        for (int i = 0; i < threshold; i++)
+        {
+            if (p[i] > 0)
+                divergence += q[i] > 0 ? p[i] / psum * std::log((p[i] / psum) / (q[i] / qsum)) : 1.0;  // smoothing
+        }
+        if (divergence < bestDivergence)
+        {
+            bestDivergence = divergence;
+            bestThreshold = threshold;
+        }
+    }
+    return bestThreshold * binWidth;
+}
+
+// Range of values which is mapped to [INT8_MIN, INT8_MAX]
+static void getCalibrationRange(const Mat& src, const QuantizationParams& params, double& rmin, double& rmax)
+{
+    const int nbins = 2048;
+    cv::minMaxIdx(src, &rmin, &rmax);
+    // Histograms of small tensors (e.g. scores of a classifier) are too sparse for the statistics
+    if (params.calibration == DNN_CALIB_MINMAX || src.depth() != CV_32F || rmin == rmax || src.total() < nbins)
+        return;
+
+    Mat values = src.isContinuous() ? src : src.clone();
+    const float* data = values.ptr<float>();
+    const size_t total = values.total();
+    if (params.calibration == DNN_CALIB_PERCENTILE)
+    {
+        CV_CheckGT(params.percentile, 50.0, "");
+        CV_CheckLE(params.percentile, 100.0, "");
+        std::vector<double> hist(nbins, 0);
+        double binWidth = (rmax - rmin) / nbins;
+        for (size_t i = 0; i < total; i++)
+            hist[std::min((int)((data[i] - rmin) / binWidth), nbins - 1)]++;
+
+        double tail = total * (100.0 - params.percentile) / 100.0;
+        double lower = rmin, upper = rmax, sum = 0;
+        for (int i = 0; i < nbins && sum + hist[i] <= tail; i++)
+        {
+            sum += hist[i];
+            lower = rmin + (i + 1) * binWidth;
+        }
+        sum = 0;
+        for (int i = nbins - 1; i >= 0 && sum + hist[i] <= tail; i--)
+        {
+            sum += hist[i];
+            upper = rmin + i * binWidth;
+        }
+        if (lower < upper)
+        {
+            rmin = lower;
+            rmax = upper;
+        }
+    }
+    else if (params.calibration == DNN_CALIB_ENTROPY)
+    {
+        // Symmetric range, or [0, threshold] if there are no negative values (e.g. after ReLU)
+        bool positive = rmin >= 0;
+        double amax = std::max(std::abs(rmin), std::abs(rmax));
+        std::vector<double> hist(nbins, 0);
+        double binWidth = amax / nbins;
+        for (size_t i = 0; i < total; i++)
+        {
+            // Zeros (e.g. produced by ReLU) are represented exactly with any range, their peak
+            // would move the threshold down
+            if (positive && data[i] == 0)
+                continue;
+            hist[std::min((int)(std::abs(data[i]) / binWidth), nbins - 1)]++;
+        }
+
+        double threshold = getEntropyThreshold(hist, binWidth, positive ? 256 : 128);
+        rmin = positive ? 0.0 : std::max(rmin, -threshold);
+        rmax = std::min(rmax, threshold);
+    }
+    else
+        CV_Error(Error::StsBadArg, cv::format("Unknown calibration method: %d", (int)params.calibration));
+}
+
 // FIXIT drop from inference API
 static
-void getQuantizationParams(const Mat& src, std::vector<float>& scales, std::vector<int>& zeropoints)
+void getQuantizationParams(const Mat& src, const QuantizationParams& params,
+                           std::vector<float>& scales, std::vector<int>& zeropoints)
 {
     const int qmin = -128; // INT8_MIN
     const int qmax = 127;  // INT8_MAX
 
     double rmin, rmax, sc, zp;
-    cv::minMaxIdx(src, &rmin, &rmax);
+    getCalibrationRange(src, params, rmin, rmax);
 
     // 0 must be present in the range [rmin, rmax]
     rmin = std::min(rmin, 0.0);
@@ -32,9 +164,42 @@ void getQuantizationParams(const Mat& src, std::vector<float>& scales, std::vect
     zeropoints.push_back((int)std::round(zp));
 }
 
-// FIXIT drop from inference API
+// Relative L2 error of the network outputs
+static double getQuantizationError(Net& net, const std::vector<Mat>& inputs, const std::vector<String>& inputNames,
+                                   const std::vector<Mat>& refs)
+{
+    for (size_t i = 0; i < inputs.size(); i++)
+        net.setInput(inputs[i], inputNames[i]);
+    std::vector<String> outNames = net.getUnconnectedOutLayersNames();
+    CV_CheckEQ(outNames.size(), refs.size(), "");
+    std::vector<Mat> outs;
+    net.forward(outs, outNames);
+    double error = 0, norm = 0;
+    for (size_t i = 0; i < outs.size(); i++)
+    {
+        Mat out;
+        outs[i].convertTo(out, CV_32F);
+        CV_CheckEQ(out.total(), refs[i].total(), "");
+        error += cv::norm(out.reshape(1, 1), refs[i].reshape(1, 1), NORM_L2SQR);
+        norm += cv::norm(refs[i], NORM_L2SQR);
+    }
+    return std::sqrt(error / std::max(norm, (double)FLT_MIN));
+}
+
 Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype, int outputsDtype, bool perChannel)
 {
+    QuantizationParams params;
+    params.inputsDtype = inputsDtype;
+    params.outputsDtype = outputsDtype;
+    params.perChannel = perChannel;
+    return quantize(net, calibData, params);
+}
+
+// FIXIT drop from inference API
+Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, const QuantizationParams& params)
+{
+    const int inputsDtype = params.inputsDtype, outputsDtype = params.outputsDtype;
+
     // Net can be quantized only once.
     if (netWasQuantized)
         CV_Error(Error::StsBadArg, "Cannot quantize a quantized net");
@@ -53,20 +218,21 @@ Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype,
     enableFusion(false);
     enableWinograd(false);
 
+    std::vector<Mat> calibInputs;
+    std::vector<String> calibNames;
     if (calibData.isMat())
     {
-        setInput(calibData.getMat(), /*name=*/"", /*scalefactor=*/1.0, /*mean=*/Scalar());
+        calibInputs.push_back(calibData.getMat());
+        calibNames.push_back("");
     }
     else if (calibData.isMatVector())
     {
-        std::vector<Mat> calibDataVec;
-        calibData.getMatVector(calibDataVec);
-
-        std::vector<String> inpNames = netInputLayer->outNames;
-        CV_CheckEQ(calibDataVec.size(), inpNames.size(), "Calibration data size should be equal to number of inputs");
-        for (int i = 0; i < calibDataVec.size(); i++)
-            setInput(calibDataVec[i], inpNames[i], /*scalefactor=*/1.0, /*mean=*/Scalar());
+        calibData.getMatVector(calibInputs);
+        calibNames = netInputLayer->outNames;
+        CV_CheckEQ(calibInputs.size(), calibNames.size(), "Calibration data size should be equal to number of inputs");
     }
+    for (size_t i = 0; i < calibInputs.size(); i++)
+        setInput(calibInputs[i], calibNames[i], /*scalefactor=*/1.0, /*mean=*/Scalar());
 
     std::vector<String> outNames = getUnconnectedOutLayersNames();
     std::vector<LayerPin> pins;
@@ -112,19 +278,24 @@ Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype,
         else if (ld.type == "Split" || ld.type == "Slice" || ld.type == "Crop")
         {
             std::vector<float> inp_sc; std::vector<int> inp_zp;
-            getQuantizationParams(*ld.inputBlobs[0], inp_sc, inp_zp);
+            getQuantizationParams(*ld.inputBlobs[0], params, inp_sc, inp_zp);
             sc.assign(ld.outputBlobs.size(), inp_sc[0]);
             zp.assign(ld.outputBlobs.size(), inp_zp[0]);
         }
         else
         {
             for (int i = 0; i < ld.outputBlobs.size(); i++)
-                getQuantizationParams(ld.outputBlobs[i], sc, zp);
+                getQuantizationParams(ld.outputBlobs[i], params, sc, zp);
         }
         scales.push_back(sc);
         zeropoints.push_back(zp);
     }
 
+    // Outputs of the FP32 network to measure the error of quantization
+    std::vector<Mat> refs(pins.size());
+    for (size_t i = 0; i < pins.size(); i++)
+        getLayerData(pins[i].lid).outputBlobs[pins[i].oid].convertTo(refs[i], CV_32F);
+
     // For some layers, the input and output scales/zeropoints must be equal so that rescaling of inputs
     // is not needed during quantized inference. We start from the last layer and modify the layer's input scales/zeropoints
     // TODO : Need a different approach. Current solution fails when 2 such layers have the same input layer
@@ -160,14 +331,129 @@ Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype,
         }
     }
 
+    std::set<int> fp32Layers;
+    for (size_t i = 0; i < params.fp32Layers.size(); i++)
+    {
+        int lid = getLayerId(params.fp32Layers[i]);
+        if (lid < 0)
+            CV_Error(Error::StsObjectNotFound, "Layer \"" + params.fp32Layers[i] + "\" not found");
+        fp32Layers.insert(lid);
+    }
+
+    if (!params.calibrationTable.empty())
+    {
+        FileStorage fs(params.calibrationTable, FileStorage::READ);
+        if (!fs.isOpened())
+            CV_Error(Error::StsError, "Can't open calibration table " + params.calibrationTable);
+        FileNode nodes = fs["layers"];
+        std::set<int> found;
+        for (FileNodeIterator it = nodes.begin(); it != nodes.end(); ++it)
+        {
+            FileNode node = *it;
+            std::string name = (std::string)node["name"];
+            int lid = getLayerId(name);
+            if (lid < 0)
+                CV_Error(Error::StsParseError, "Calibration table " + params.calibrationTable + " has unknown layer \"" + name + "\"");
+            std::vector<float> sc;
+            std::vector<int> zp;
+            node["scales"] >> sc;
+            node["zeropoints"] >> zp;
+            CV_CheckEQ(sc.size(), scales[lid].size(), "Number of scales doesn't match outputs of the layer");
+            CV_CheckEQ(zp.size(), zeropoints[lid].size(), "Number of zeropoints doesn't match outputs of the layer");
+            scales[lid] = sc;
+            zeropoints[lid] = zp;
+            if ((int)node["fp32"] != 0)
+                fp32Layers.insert(lid);
+            found.insert(lid);
+        }
+        if (found.size() != layers.size())
+            CV_Error(Error::StsParseError, "Calibration table " + params.calibrationTable + " doesn't match the network");
+    }
+
+    // Quantized layers which are the most sensitive to quantization are moved to FP32 one by one
+    // until the error of the network is acceptable.
+    std::map<int, double> sensitivity;
+    if (params.maxError > 0)
+    {
+        auto getError = [&](const std::set<int>& fp32, std::vector<int>* quantized) {
+            Net qnet = buildQuantizedNet(scales, zeropoints, fp32, CV_32F, CV_32F, params.perChannel, quantized);
+            qnet.setPreferableBackend(DNN_BACKEND_OPENCV);
+            qnet.enableFusion(originalFusion);
+            return getQuantizationError(qnet, calibInputs, calibNames, refs);
+        };
+        std::vector<int> candidates;
+        double error = getError(fp32Layers, &candidates);
+        CV_LOG_INFO(NULL, "DNN/quantize: error of the quantized network: " << error);
+        if (error > params.maxError)
+        {
+            // Sensitivity of a layer is the error of the network where only this layer is quantized
+            std::vector<std::pair<double, int> > order;
+            for (size_t i = 0; i < candidates.size(); i++)
+            {
+                std::set<int> others(fp32Layers);
+                for (size_t j = 0; j < candidates.size(); j++)
+                {
+                    if (j != i)
+                        others.insert(candidates[j]);
+                }
+                double layerError = getError(others, NULL);
+                sensitivity[candidates[i]] = layerError;
+                order.push_back(std::make_pair(-layerError, candidates[i]));
+            }
+            std::sort(order.begin(), order.end());
+            for (size_t i = 0; i < order.size() && error > params.maxError; i++)
+            {
+                fp32Layers.insert(order[i].second);
+                error = getError(fp32Layers, NULL);
+                CV_LOG_INFO(NULL, "DNN/quantize: layer \"" << getLayerName(order[i].second) << "\" is kept in FP32"
+                            " (sensitivity " << -order[i].first << "), error of the network: " << error);
+            }
+        }
+    }
+
+    if (!params.saveCalibrationTable.empty())
+    {
+        FileStorage fs(params.saveCalibrationTable, FileStorage::WRITE);
+        if (!fs.isOpened())
+            CV_Error(Error::StsError, "Can't write calibration table " + params.saveCalibrationTable);
+        fs << "layers" << "[";
+        for (Impl::MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
+        {
+            int lid = it->first;
+            fs << "{";
+            fs << "name" << it->second.name;
+            fs << "scales" << scales[lid];
+            fs << "zeropoints" << zeropoints[lid];
+            fs << "fp32" << (int)fp32Layers.count(lid);
+            if (sensitivity.count(lid))
+                fs << "sensitivity" << sensitivity[lid];
+            fs << "}";
+        }
+        fs << "]";
+    }
+
+    Net dstNet_ = buildQuantizedNet(scales, zeropoints, fp32Layers, inputsDtype, outputsDtype, params.perChannel);
+    dstNet_.setPreferableBackend(prefBackend);
+    dstNet_.setPreferableTarget(prefTarget);
+    dstNet_.enableFusion(originalFusion);
+
+    // Restore FP32 Net's backend, target and fusion
+    setPreferableBackend(net, prefBackend);
+    setPreferableTarget(prefTarget);
+    enableFusion(originalFusion);
+    return dstNet_;
+}
+
+Net Net::Impl::buildQuantizedNet(const std::vector<std::vector<float> >& scales,
+                                 const std::vector<std::vector<int> >& zeropoints,
+                                 const std::set<int>& fp32Layers, int inputsDtype, int outputsDtype, bool perChannel,
+                                 std::vector<int>* quantizedLayers)
+{
     // Create a new Net and add quantized layers to it.
     Net dstNet_;
     Net::Impl& dstNet = *(dstNet_.impl);
     dstNet.netWasQuantized = true;
     dstNet.setInputsNames(netInputLayer->outNames);
-    dstNet.setPreferableBackend(dstNet_, prefBackend);
-    dstNet.setPreferableTarget(prefTarget);
-    dstNet.enableFusion(originalFusion);
 
     for (Impl::MapIdToLayerData::iterator it = layers.begin(); it != layers.end(); it++)
     {
@@ -200,10 +486,12 @@ Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype,
 
         // Quantize layer
         Ptr<Layer> layer = ld.layerInstance;
-        if (layer->tryQuantize(inp_out_sc, inp_out_zp, ld.params))
+        if (!fp32Layers.count(ld.id) && layer->tryQuantize(inp_out_sc, inp_out_zp, ld.params))
         {
             ld.type += "Int8";
             ld.dtype = CV_8S;
+            if (quantizedLayers)
+                quantizedLayers->push_back(ld.id);
         }
         ld.params.set("scales", DictValue::arrayReal(inp_out_sc[1].data(), inp_out_sc[1].size()));
         ld.params.set("zeropoints", DictValue::arrayInt(inp_out_zp[1].data(), inp_out_zp[1].size()));
@@ -254,10 +542,6 @@ Net Net::Impl::quantize(Net& net, InputArrayOfArrays calibData, int inputsDtype,
             dstNet.addLayerToPrev(lp.name, lp.type, outputsDtype, lp);
         }
     }
-    // Restore FP32 Net's backend, target and fusion
-    setPreferableBackend(net, prefBackend);
-    setPreferableTarget(prefTarget);
-    enableFusion(originalFusion);
     return dstNet_;
 }
 
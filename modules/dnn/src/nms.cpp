@@ -9,6 +9,7 @@
 #include "nms.inl.hpp"
 
 #include <opencv2/imgproc.hpp>
+#include <opencv2/core/hal/intrin.hpp>
 
 namespace cv { namespace dnn {
 CV__DNN_INLINE_NS_BEGIN
@@ -19,13 +20,153 @@ static inline float rectOverlap(const T& a, const T& b)
     return 1.f - static_cast<float>(jaccardDistance(a, b));
 }
 
+// Boxes kept by NMS of axis-aligned rectangles. Coordinates are stored by components, so a candidate
+// is checked against a block of kept boxes at once. Only the boxes which may intersect the candidate
+// go to the exact overlap computation, so the result is the same as of NMSFast_.
+template <typename Rect_t>
+class KeptRects
+{
+public:
+    void push_back(const std::vector<Rect_t>& bboxes, int idx)
+    {
+        const Rect_t& b = bboxes[idx];
+        if (b.area() > 0)
+        {
+            x1.push_back((float)b.x);
+            y1.push_back((float)b.y);
+            x2.push_back((float)(b.x + b.width));
+            y2.push_back((float)(b.y + b.height));
+        }
+        else
+        {
+            // degenerate boxes are always checked exactly
+            const float inf = std::numeric_limits<float>::infinity();
+            x1.push_back(-inf);
+            y1.push_back(-inf);
+            x2.push_back(inf);
+            y2.push_back(inf);
+        }
+        indices.push_back(idx);
+    }
+
+    // Returns true if the box overlaps one of the kept boxes by more than threshold (or by NaN, as NMSFast_ does).
+    bool overlaps(const std::vector<Rect_t>& bboxes, int idx, float threshold) const
+    {
+        const Rect_t& b = bboxes[idx];
+        const int n = (int)indices.size();
+        int k = 0;
+        if (!(b.area() > 0))
+        {
+            for (; k < n; k++)
+            {
+                if (!(rectOverlap(b, bboxes[indices[k]]) <= threshold))
+                    return true;
+            }
+            return false;
+        }
+
+        const float bx1 = (float)b.x, by1 = (float)b.y;
+        const float bx2 = (float)(b.x + b.width), by2 = (float)(b.y + b.height);
+#if CV_SIMD
+        const int vlanes = VTraits<v_float32>::vlanes();
+        const v_float32 vbx1 = vx_setall_f32(bx1), vby1 = vx_setall_f32(by1);
+        const v_float32 vbx2 = vx_setall_f32(bx2), vby2 = vx_setall_f32(by2);
+        for (; k <= n - vlanes; k += vlanes)
+        {
+            v_float32 ix1 = v_max(vx_load(x1.data() + k), vbx1), ix2 = v_min(vx_load(x2.data() + k), vbx2);
+            v_float32 iy1 = v_max(vx_load(y1.data() + k), vby1), iy2 = v_min(vx_load(y2.data() + k), vby2);
+            if (!v_check_any(v_and(v_le(ix1, ix2), v_le(iy1, iy2))))
+                continue;
+            for (int j = k; j < k + vlanes; j++)
+            {
+                if (!(rectOverlap(b, bboxes[indices[j]]) <= threshold))
+                    return true;
+            }
+        }
+#endif
+        for (; k < n; k++)
+        {
+            if (std::max(x1[k], bx1) <= std::min(x2[k], bx2) && std::max(y1[k], by1) <= std::min(y2[k], by2) &&
+                !(rectOverlap(b, bboxes[indices[k]]) <= threshold))
+                return true;
+        }
+        return false;
+    }
+
+private:
+    std::vector<float> x1, y1, x2, y2;
+    std::vector<int> indices;
+};
+
+// NMS of rectangles, optionally separated by classes: boxes of different classes never suppress each other.
+// Classes are processed in parallel if the threshold is not adaptive.
+template <typename Rect_t>
+static void NMSRects_(const std::vector<Rect_t>& bboxes, const std::vector<float>& scores, const int* class_ids,
+                      const float score_threshold, const float nms_threshold, const float eta, const int top_k,
+                      std::vector<int>& indices)
+{
+    std::vector<std::pair<float, int> > score_index_vec;
+    GetMaxScoreIndex(scores, score_threshold, top_k, score_index_vec);
+    indices.clear();
+
+    if (class_ids && eta >= 1)
+    {
+        std::map<int, std::vector<int> > class2positions;
+        for (size_t i = 0; i < score_index_vec.size(); i++)
+            class2positions[class_ids[score_index_vec[i].second]].push_back((int)i);
+        std::vector<const std::vector<int>*> groups;
+        for (std::map<int, std::vector<int> >::const_iterator it = class2positions.begin(); it != class2positions.end(); ++it)
+            groups.push_back(&it->second);
+
+        std::vector<uchar> keep(score_index_vec.size(), 0);
+        parallel_for_(Range(0, (int)groups.size()), [&](const Range& r)
+        {
+            for (int g = r.start; g < r.end; g++)
+            {
+                KeptRects<Rect_t> kept;
+                const std::vector<int>& positions = *groups[g];
+                for (size_t i = 0; i < positions.size(); i++)
+                {
+                    const int idx = score_index_vec[positions[i]].second;
+                    if (!kept.overlaps(bboxes, idx, nms_threshold))
+                    {
+                        kept.push_back(bboxes, idx);
+                        keep[positions[i]] = 1;
+                    }
+                }
+            }
+        });
+        for (size_t i = 0; i < score_index_vec.size(); i++)
+        {
+            if (keep[i])
+                indices.push_back(score_index_vec[i].second);
+        }
+        return;
+    }
+
+    // the adaptive threshold depends on all the kept boxes, so they are processed in order of scores
+    std::map<int, KeptRects<Rect_t> > kept;
+    float adaptive_threshold = nms_threshold;
+    for (size_t i = 0; i < score_index_vec.size(); i++)
+    {
+        const int idx = score_index_vec[i].second;
+        KeptRects<Rect_t>& classKept = kept[class_ids ? class_ids[idx] : 0];
+        if (classKept.overlaps(bboxes, idx, adaptive_threshold))
+            continue;
+        classKept.push_back(bboxes, idx);
+        indices.push_back(idx);
+        if (eta < 1 && adaptive_threshold > 0.5)
+            adaptive_threshold *= eta;
+    }
+}
+
 void NMSBoxes(const std::vector<Rect>& bboxes, const std::vector<float>& scores,
                           const float score_threshold, const float nms_threshold,
                           std::vector<int>& indices, const float eta, const int top_k)
 {
     CV_Assert_N(bboxes.size() == scores.size(), score_threshold >= 0,
         nms_threshold >= 0, eta > 0);
-    NMSFast_(bboxes, scores, score_threshold, nms_threshold, eta, top_k, indices, rectOverlap);
+    NMSRects_(bboxes, scores, NULL, score_threshold, nms_threshold, eta, top_k, indices);
 }
 
 void NMSBoxes(const std::vector<Rect2d>& bboxes, const std::vector<float>& scores,
@@ -34,7 +175,7 @@ void NMSBoxes(const std::vector<Rect2d>& bboxes, const std::vector<float>& score
 {
     CV_Assert_N(bboxes.size() == scores.size(), score_threshold >= 0,
         nms_threshold >= 0, eta > 0);
-    NMSFast_(bboxes, scores, score_threshold, nms_threshold, eta, top_k, indices, rectOverlap);
+    NMSRects_(bboxes, scores, NULL, score_threshold, nms_threshold, eta, top_k, indices);
 }
 
 static inline float rotatedRectIOU(const RotatedRect& a, const RotatedRect& b)
@@ -58,41 +199,6 @@ void NMSBoxes(const std::vector<RotatedRect>& bboxes, const std::vector<float>&
     NMSFast_(bboxes, scores, score_threshold, nms_threshold, eta, top_k, indices, rotatedRectIOU);
 }
 
-template<class Rect_t>
-static inline void NMSBoxesBatchedImpl(const std::vector<Rect_t>& bboxes,
-                                       const std::vector<float>& scores, const std::vector<int>& class_ids,
-                                       const float score_threshold, const float nms_threshold,
-                                       std::vector<int>& indices, const float eta, const int top_k)
-{
-    double x1, y1, x2, y2, max_coord = 0;
-    for (int i = 0; i < bboxes.size(); i++)
-    {
-        x1 = bboxes[i].x;
-        y1 = bboxes[i].y;
-        x2 = x1 + bboxes[i].width;
-        y2 = y1 + bboxes[i].height;
-
-        max_coord = std::max(x1, max_coord);
-        max_coord = std::max(y1, max_coord);
-        max_coord = std::max(x2, max_coord);
-        max_coord = std::max(y2, max_coord);
-    }
-
-    // calculate offset and add offset to each bbox
-    std::vector<Rect_t> bboxes_offset;
-    double offset;
-    for (int i = 0; i < bboxes.size(); i++)
-    {
-        offset = class_ids[i] * (max_coord + 1);
-        bboxes_offset.push_back(
-            Rect_t(bboxes[i].x + offset, bboxes[i].y + offset,
-                   bboxes[i].width, bboxes[i].height)
-        );
-    }
-
-    NMSFast_(bboxes_offset, scores, score_threshold, nms_threshold, eta, top_k, indices, rectOverlap);
-}
-
 void NMSBoxesBatched(const std::vector<Rect>& bboxes,
                      const std::vector<float>& scores, const std::vector<int>& class_ids,
                      const float score_threshold, const float nms_threshold,
@@ -100,7 +206,7 @@ void NMSBoxesBatched(const std::vector<Rect>& bboxes,
 {
     CV_Assert_N(bboxes.size() == scores.size(), scores.size() == class_ids.size(), nms_threshold >= 0, eta > 0);
 
-    NMSBoxesBatchedImpl(bboxes, scores, class_ids, score_threshold, nms_threshold, indices, eta, top_k);
+    NMSRects_(bboxes, scores, class_ids.data(), score_threshold, nms_threshold, eta, top_k, indices);
 }
 
 void NMSBoxesBatched(const std::vector<Rect2d>& bboxes,
@@ -110,7 +216,7 @@ void NMSBoxesBatched(const std::vector<Rect2d>& bboxes,
 {
     CV_Assert_N(bboxes.size() == scores.size(), scores.size() == class_ids.size(), nms_threshold >= 0, eta > 0);
 
-    NMSBoxesBatchedImpl(bboxes, scores, class_ids, score_threshold, nms_threshold, indices, eta, top_k);
+    NMSRects_(bboxes, scores, class_ids.data(), score_threshold, nms_threshold, eta, top_k, indices);
 }
 
 void softNMSBoxes(const std::vector<Rect>& bboxes,
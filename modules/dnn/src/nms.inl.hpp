@@ -23,6 +23,13 @@ static inline bool SortScorePairDescend(const std::pair<float, T>& pair1,
     return pair1.first > pair2.first;
 }
 
+// Equal scores are ordered by index, as the stable sort of pairs in order of indices does
+static inline bool SortScoreIndexPairDescend(const std::pair<float, int>& pair1,
+                                             const std::pair<float, int>& pair2)
+{
+    return pair1.first > pair2.first || (pair1.first == pair2.first && pair1.second < pair2.second);
+}
+
 } // namespace
 
 // Get max scores with corresponding indices.
@@ -43,15 +50,19 @@ inline void GetMaxScoreIndex(const std::vector<float>& scores, const float thres
         }
     }
 
-    // Sort the score pair according to the scores in descending order
-    std::stable_sort(score_index_vec.begin(), score_index_vec.end(),
-                     SortScorePairDescend<int>);
-
-    // Keep top_k scores if needed.
+    // Keep top_k scores if needed. Only these are sorted then.
     if (top_k > 0 && top_k < (int)score_index_vec.size())
     {
+        std::partial_sort(score_index_vec.begin(), score_index_vec.begin() + top_k, score_index_vec.end(),
+                          SortScoreIndexPairDescend);
         score_index_vec.resize(top_k);
     }
+    else
+    {
+        // Sort the score pair according to the scores in descending order
+        std::stable_sort(score_index_vec.begin(), score_index_vec.end(),
+                         SortScorePairDescend<int>);
+    }
 }
 
 // Do non maximum suppression given bboxes and scores.
@@ -63,7 +63,8 @@ public:
 class ONNXGraphWrapper : public ImportGraphWrapper
 {
 public:
-    ONNXGraphWrapper(opencv_onnx::GraphProto& _net) : net(_net)
+    ONNXGraphWrapper(opencv_onnx::GraphProto& _net, const InitializerReader& _readInitializer)
+        : net(_net), readInitializer(_readInitializer)
     {
         // Add a fake initializer with empty name.
         // Some ONNX models skip their inputs. For example,
@@ -127,7 +128,7 @@ public:
     Mat getMatFromInitializer(int idx)
     {
         const opencv_onnx::TensorProto& tensor_proto = net.initializer(idx);
-        return getMatFromTensor(tensor_proto);
+        return readInitializer ? readInitializer(tensor_proto) : getMatFromTensor(tensor_proto);
     }
 
     std::string getNameOfInitializer(int idx) const
@@ -174,6 +175,7 @@ public:
 private:
     int numInputs, numInitializers;
     opencv_onnx::GraphProto& net;
+    InitializerReader readInitializer;
 };
 
 static Mat extractConstant(const Ptr<ImportGraphWrapper>& net, int node_id, int input_id)
@@ -1662,7 +1664,7 @@ public:
     }
 };
 
-void simplifySubgraphs(opencv_onnx::GraphProto& net)
+void simplifySubgraphs(opencv_onnx::GraphProto& net, const InitializerReader& readInitializer)
 {
     std::vector<Ptr<Subgraph> > subgraphs;
     subgraphs.push_back(makePtr<BiasedMatmulSubgraph>());
@@ -1698,7 +1700,7 @@ void simplifySubgraphs(opencv_onnx::GraphProto& net)
         subgraphs.push_back(makePtr<AttentionSingleHeadSubGraph>());
     }
 
-    simplifySubgraphs(Ptr<ImportGraphWrapper>(new ONNXGraphWrapper(net)), subgraphs);
+    simplifySubgraphs(Ptr<ImportGraphWrapper>(new ONNXGraphWrapper(net, readInitializer)), subgraphs);
 }
 
 Mat getMatFromTensor(const opencv_onnx::TensorProto& tensor_proto)
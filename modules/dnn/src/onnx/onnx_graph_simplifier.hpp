@@ -21,7 +21,10 @@
 namespace cv { namespace dnn {
 CV__DNN_INLINE_NS_BEGIN
 
-void simplifySubgraphs(opencv_onnx::GraphProto& net);
+// Reads data of the initializer which is not stored in the message (e.g. external data)
+typedef std::function<Mat(const opencv_onnx::TensorProto&)> InitializerReader;
+
+void simplifySubgraphs(opencv_onnx::GraphProto& net, const InitializerReader& readInitializer = InitializerReader());
 
 template<typename T1, typename T2>
 void convertInt64ToInt32(const T1& src, T2& dst, int size)
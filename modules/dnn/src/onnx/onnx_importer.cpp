@@ -18,6 +18,7 @@
 #include <opencv2/core/utils/logger.hpp>
 
 #include <opencv2/core/utils/configuration.private.hpp>
+#include <opencv2/core/utils/filesystem.hpp>
 
 
 #ifdef HAVE_PROTOBUF
@@ -44,6 +45,7 @@
 #endif
 
 #include "onnx_graph_simplifier.hpp"
+#include "../mapped_file.hpp"
 #endif
 
 namespace cv {
@@ -82,6 +84,10 @@ class ONNXImporter
 
     std::map<std::string, Mat> getGraphTensors(
                                     const opencv_onnx::GraphProto& graph_proto);
+    void registerGraphTensors(opencv_onnx::GraphProto& graph_proto);
+    void releaseInitializers(const opencv_onnx::NodeProto& node_proto);
+    Mat getInitializer(const opencv_onnx::TensorProto& tensor_proto);
+    void parseModel(const uchar* data, size_t size);
     Mat getBlob(const opencv_onnx::NodeProto& node_proto, int index);
     Mat getBlob(const std::string& input_name);
     TensorInfo getBlobExtraInfo(const opencv_onnx::NodeProto& node_proto, int index);
@@ -116,9 +122,22 @@ protected:
     opencv_onnx::GraphProto* graph_proto;
     std::string framework_name;
 
+    Ptr<MappedFile> modelFile;  // set if the model is read from a file
+    const uchar* modelData;  // serialized model, valid during the import
+    // Location of initializers raw_data in modelData (offset, size). The data is not copied into the protobuf messages.
+    std::map<const opencv_onnx::TensorProto*, std::pair<size_t, size_t> > initializersData;
+
+    std::string modelDir;  // external data files are located relative to the model file
+    std::map<std::string, Ptr<MappedFile> > externalDataFiles;
+
     std::map<std::string, Mat> constBlobs;
     std::map<std::string, TensorInfo> constBlobsExtraInfo;
 
+    // Lazy import: initializers are loaded by getBlob() when the first consumer is created,
+    // constBlobs keeps empty placeholders for the pending ones.
+    std::map<std::string, opencv_onnx::TensorProto*> pendingInitializers;
+    std::map<std::string, int> initializerUses;  // number of not processed node inputs
+
     std::map<std::string, MatShape> outShapes;  // List of internal blobs shapes.
     bool hasDynamicShapes;  // Whether the model has inputs with dynamic shapes
     typedef std::map<std::string, MatShape>::iterator IterShape_t;
@@ -227,6 +246,12 @@ private:
         bool param = utils::getConfigurationParameterBool("OPENCV_DNN_ONNX_USE_LEGACY_NAMES", false);
         return param;
     }
+    bool lazyInitializers;
+    bool getParamLazyInitializers()
+    {
+        bool param = utils::getConfigurationParameterBool("OPENCV_DNN_ONNX_LAZY_INITIALIZERS", true);
+        return param;
+    }
     std::string extractNodeName(const opencv_onnx::NodeProto& node_proto);
 };
 
@@ -266,23 +291,27 @@ ONNXImporter::ONNXImporter(Net& net, const char *onnxFile)
     , dstNet(net)
     , onnx_opset(0)
     , useLegacyNames(getParamUseLegacyNames())
+    , lazyInitializers(getParamLazyInitializers())
 {
     hasDynamicShapes = false;
     CV_Assert(onnxFile);
     CV_LOG_DEBUG(NULL, "DNN/ONNX: processing ONNX model from file: " << onnxFile);
 
-    std::fstream input(onnxFile, std::ios::in | std::ios::binary);
-    if (!input)
+    // Initializers refer to the mapped pages, so they are not copied and are shared between processes
+    try
     {
-        CV_Error(Error::StsBadArg, cv::format("Can't read ONNX file: %s", onnxFile));
+        modelFile = MappedFile::open(onnxFile);
     }
-
-    if (!model_proto.ParseFromIstream(&input))
+    catch (const cv::Exception&)
     {
-        CV_Error(Error::StsUnsupportedFormat, cv::format("Failed to parse ONNX model: %s", onnxFile));
+        CV_Error(Error::StsBadArg, cv::format("Can't read ONNX file: %s", onnxFile));
     }
+    modelData = modelFile->data();
+    modelDir = utils::fs::getParent(onnxFile);
 
+    parseModel(modelFile->data(), modelFile->size());
     populateNet();
+    modelData = 0;
 }
 
 ONNXImporter::ONNXImporter(Net& net, const char* buffer, size_t sizeBuffer)
@@ -290,26 +319,133 @@ ONNXImporter::ONNXImporter(Net& net, const char* buffer, size_t sizeBuffer)
     , dstNet(net)
     , onnx_opset(0)
     , useLegacyNames(getParamUseLegacyNames())
+    , lazyInitializers(getParamLazyInitializers())
 {
     hasDynamicShapes = false;
     CV_LOG_DEBUG(NULL, "DNN/ONNX: processing in-memory ONNX model (" << sizeBuffer << " bytes)");
 
-    struct _Buf : public std::streambuf
-            {
-        _Buf(const char* buffer, size_t sizeBuffer)
+    // Initializers are copied from the buffer directly, without intermediate protobuf strings
+    modelData = (const uchar*)buffer;
+    parseModel((const uchar*)buffer, sizeBuffer);
+    populateNet();
+    modelData = 0;
+}
+
+static bool readVarint(const uchar*& ptr, const uchar* end, uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; ptr < end && shift < 64; shift += 7)
+    {
+        uchar b = *ptr++;
+        value |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void writeVarint(std::string& dst, uint64_t value)
+{
+    for (; value >= 0x80; value >>= 7)
+        dst += (char)((value & 0x7f) | 0x80);
+    dst += (char)value;
+}
+
+// Copies serialized message field by field. Length-delimited fields are passed to 'process',
+// which returns false to copy the field as is. Returns false for malformed or unsupported input.
+template <typename Fn>
+static bool copyMessage(const uchar* begin, const uchar* end, std::string& dst, Fn process)
+{
+    for (const uchar* ptr = begin; ptr < end;)
+    {
+        const uchar* fieldBegin = ptr;
+        uint64_t tag = 0, value = 0;
+        if (!readVarint(ptr, end, tag))
+            return false;
+        switch (tag & 7)
         {
-            char* p = const_cast<char*>(buffer);
-            setg(p, p, p + sizeBuffer);
+        case 0: if (!readVarint(ptr, end, value)) return false; break;
+        case 1: if (end - ptr < 8) return false; ptr += 8; break;
+        case 5: if (end - ptr < 4) return false; ptr += 4; break;
+        case 2:
+            if (!readVarint(ptr, end, value) || value > (uint64_t)(end - ptr))
+                return false;
+            ptr += value;
+            if (process((int)(tag >> 3), ptr - value, ptr))
+                continue;
+            break;
+        default:
+            return false;  // groups are not used by ONNX
         }
-            };
-
-    _Buf buf(buffer, sizeBuffer);
-    std::istream input(&buf);
+        dst.append((const char*)fieldBegin, ptr - fieldBegin);
+    }
+    return true;
+}
 
-    if (!model_proto.ParseFromIstream(&input))
-        CV_Error(Error::StsUnsupportedFormat, "Failed to parse onnx model from in-memory byte array.");
+// Removes raw_data of ModelProto.graph.initializer. Positions of the data are stored into 'rawData'
+// in order of the initializers, (0, 0) for initializers without raw_data.
+static bool stripInitializersData(const uchar* data, size_t size, std::string& dst,
+                                  std::vector<std::pair<size_t, size_t> >& rawData)
+{
+    bool ok = true;
+    int numGraphs = 0;
+    ok = copyMessage(data, data + size, dst, [&](int field, const uchar* graphBegin, const uchar* graphEnd)
+    {
+        if (field != 7 || !ok)  // ModelProto.graph
+            return false;
+        numGraphs++;
+        std::string graph;
+        ok = copyMessage(graphBegin, graphEnd, graph, [&](int field, const uchar* tensorBegin, const uchar* tensorEnd)
+        {
+            if (field != 5 || !ok)  // GraphProto.initializer
+                return false;
+            std::string tensor;
+            std::pair<size_t, size_t> raw(0, 0);
+            ok = copyMessage(tensorBegin, tensorEnd, tensor, [&](int field, const uchar* rawBegin, const uchar* rawEnd)
+            {
+                if (field != 9 || rawBegin == rawEnd)  // TensorProto.raw_data
+                    return false;
+                raw = std::make_pair((size_t)(rawBegin - data), (size_t)(rawEnd - rawBegin));
+                return true;
+            });
+            rawData.push_back(raw);
+            writeVarint(graph, (5 << 3) | 2);
+            writeVarint(graph, tensor.size());
+            graph += tensor;
+            return true;
+        });
+        writeVarint(dst, (7 << 3) | 2);
+        writeVarint(dst, graph.size());
+        dst += graph;
+        return true;
+    });
+    return ok && numGraphs == 1;
+}
 
-    populateNet();
+void ONNXImporter::parseModel(const uchar* data, size_t size)
+{
+    std::string stripped;
+    std::vector<std::pair<size_t, size_t> > rawData;
+    if (stripInitializersData(data, size, stripped, rawData))
+    {
+        if (!model_proto.ParseFromString(stripped))
+            CV_Error(Error::StsUnsupportedFormat, "Failed to parse ONNX model");
+        stripped.clear();
+        const opencv_onnx::GraphProto& graph = model_proto.graph();
+        CV_Assert(graph.initializer_size() == (int)rawData.size());
+        for (int i = 0; i < graph.initializer_size(); i++)
+        {
+            if (rawData[i].second > 0)
+                initializersData[&graph.initializer(i)] = rawData[i];
+        }
+    }
+    else
+    {
+        CV_LOG_DEBUG(NULL, "DNN/ONNX: initializers data can't be located, parse the whole model");
+        CV_CheckLE(size, (size_t)std::numeric_limits<int>::max(), "DNN/ONNX: model is too large, use external data");
+        if (!model_proto.ParseFromArray(data, (int)size))
+            CV_Error(Error::StsUnsupportedFormat, "Failed to parse ONNX model");
+    }
 }
 
 
@@ -373,6 +509,191 @@ void releaseONNXTensor(opencv_onnx::TensorProto& tensor_proto)
     if (!tensor_proto.raw_data().empty()) {
         delete tensor_proto.release_raw_data();
     }
+    // Clear() keeps the capacity of repeated fields, swap them with empty ones to free the memory
+    ::google::protobuf::RepeatedField<float>().Swap(tensor_proto.mutable_float_data());
+    ::google::protobuf::RepeatedField<double>().Swap(tensor_proto.mutable_double_data());
+    ::google::protobuf::RepeatedField<int32_t>().Swap(tensor_proto.mutable_int32_data());
+    ::google::protobuf::RepeatedField< ::google::protobuf::int64>().Swap(tensor_proto.mutable_int64_data());
+}
+
+// TensorProto.external_data (13) and TensorProto.data_location (14) are not a part of the bundled schema,
+// so they are kept by protobuf as unknown fields.
+static bool getExternalDataInfo(const opencv_onnx::TensorProto& tensor_proto, std::string& location,
+                                size_t& offset, size_t& length)
+{
+    const ::google::protobuf::UnknownFieldSet& fields = tensor_proto.GetReflection()->GetUnknownFields(tensor_proto);
+    if (fields.empty())
+        return false;
+
+    bool isExternal = false;
+    location.clear();
+    offset = length = 0;
+    for (int i = 0; i < fields.field_count(); i++)
+    {
+        const ::google::protobuf::UnknownField& field = fields.field(i);
+        if (field.number() == 14 && field.type() == ::google::protobuf::UnknownField::TYPE_VARINT)
+        {
+            isExternal = field.varint() == 1;  // DataLocation::EXTERNAL
+        }
+        else if (field.number() == 13 && field.type() == ::google::protobuf::UnknownField::TYPE_LENGTH_DELIMITED)
+        {
+            opencv_onnx::StringStringEntryProto entry;
+            if (!entry.ParseFromString(field.length_delimited()))
+                CV_Error(Error::StsParseError, "DNN/ONNX: can't parse external data of tensor: " + tensor_proto.name());
+            if (entry.key() == "location")
+                location = entry.value();
+            else if (entry.key() == "offset")
+                offset = (size_t)std::stoull(entry.value());
+            else if (entry.key() == "length")
+                length = (size_t)std::stoull(entry.value());
+        }
+    }
+    if (!isExternal)
+        return false;
+    if (location.empty())
+        CV_Error(Error::StsParseError, "DNN/ONNX: location of external data is not specified for tensor: " + tensor_proto.name());
+    return true;
+}
+
+// Creates Mat from tensor data stored outside of the protobuf message. If 'file' is set,
+// 32-bit and int8 tensors refer to the mapped pages, otherwise the data is copied.
+// 'length' is the size of the data (0 if not specified), 'available' - size of the data source after the offset.
+static Mat getMatFromData(const opencv_onnx::TensorProto& tensor_proto, const Ptr<MappedFile>& file,
+                          const uchar* base, size_t offset, size_t length, size_t available)
+{
+    std::vector<int> sizes;
+    size_t total = 1;
+    for (int i = 0; i < tensor_proto.dims_size(); i++)
+    {
+        sizes.push_back((int)tensor_proto.dims(i));
+        total *= (size_t)tensor_proto.dims(i);
+    }
+    if (sizes.empty())
+        sizes.assign(1, 1);
+
+    const opencv_onnx::TensorProto_DataType datatype = tensor_proto.data_type();
+    size_t elemSize = 0;
+    switch (datatype)
+    {
+    case opencv_onnx::TensorProto_DataType_INT8:
+    case opencv_onnx::TensorProto_DataType_UINT8: elemSize = 1; break;
+    case opencv_onnx::TensorProto_DataType_FLOAT16: elemSize = 2; break;
+    case opencv_onnx::TensorProto_DataType_FLOAT:
+    case opencv_onnx::TensorProto_DataType_INT32: elemSize = 4; break;
+    case opencv_onnx::TensorProto_DataType_DOUBLE:
+    case opencv_onnx::TensorProto_DataType_INT64: elemSize = 8; break;
+    default:
+        {
+            std::string errorMsg = "Unsupported data type: " + opencv_onnx::TensorProto_DataType_Name(datatype);
+            if (!DNN_DIAGNOSTICS_RUN)
+                CV_Error(Error::StsUnsupportedFormat, errorMsg);
+            CV_LOG_ERROR(NULL, errorMsg);
+            return Mat();
+        }
+    }
+    if (length == 0)
+        length = total * elemSize;
+    CV_CheckEQ(length, total * elemSize, "DNN/ONNX: unexpected size of tensor data");
+    CV_CheckLE(length, available, "DNN/ONNX: tensor data is out of file");
+
+    // Other types are converted as in getMatFromTensor().
+    Mat blob;
+    const uchar* data = base + offset;
+#if CV_STRONG_ALIGNMENT
+    // Aligned pointer is required, misaligned data is copied
+    const bool aligned = ((size_t)data & (elemSize - 1)) == 0;
+#else
+    const bool aligned = true;
+#endif
+    if (datatype == opencv_onnx::TensorProto_DataType_FLOAT || datatype == opencv_onnx::TensorProto_DataType_INT32 ||
+        datatype == opencv_onnx::TensorProto_DataType_INT8)
+    {
+        int type = datatype == opencv_onnx::TensorProto_DataType_FLOAT ? CV_32F :
+                   datatype == opencv_onnx::TensorProto_DataType_INT32 ? CV_32S : CV_8S;
+        if (file)
+            blob = MappedFile::wrap(file, offset, (int)sizes.size(), sizes.data(), type);
+        else
+            blob = Mat(sizes, type, (void*)data);
+        if (!file || !aligned)
+            blob = blob.clone();
+    }
+    else
+    {
+        AutoBuffer<int64_t, 16> aligned_val;
+        if (!aligned)
+        {
+            aligned_val.allocate(divUp(length, sizeof(int64_t)));
+            memcpy(aligned_val.data(), data, length);
+            data = (const uchar*)aligned_val.data();
+        }
+        if (datatype == opencv_onnx::TensorProto_DataType_INT64)
+        {
+            blob.create(sizes, CV_32SC1);
+            const int64_t* src = reinterpret_cast<const int64_t*>(data);
+            int32_t* dst = reinterpret_cast<int32_t*>(blob.data);
+            convertInt64ToInt32(src, dst, (int)blob.total());
+        }
+        else if (datatype == opencv_onnx::TensorProto_DataType_UINT8)
+        {
+            // uint8 tensors are converted to int8, see getMatFromTensor()
+            Mat(sizes, CV_8U, (void*)data).convertTo(blob, CV_8S, 1.0, -128);
+        }
+        else
+        {
+            int type = datatype == opencv_onnx::TensorProto_DataType_FLOAT16 ? CV_16F : CV_64F;
+            Mat(sizes, type, (void*)data).convertTo(blob, CV_32F);
+        }
+    }
+    if (tensor_proto.dims_size() == 0)
+        blob.dims = 1;  // To force 1-dimensional cv::Mat for scalars.
+    return blob;
+}
+
+static void checkExternalDataLocation(const std::string& location)
+{
+    // Location is relative to the model file (or to the current directory for in-memory models)
+    bool valid = !location.empty() && location[0] != '/' && location[0] != '\\' && location.find(':') == std::string::npos;
+    for (size_t pos = 0; valid && pos <= location.size();)
+    {
+        size_t next = std::min(location.find_first_of("/\\", pos), location.size());
+        valid = location.compare(pos, next - pos, "..") != 0;
+        pos = next + 1;
+    }
+    if (!valid)
+        CV_Error(Error::StsBadArg, "DNN/ONNX: external data location must be inside of the model directory: " + location);
+}
+
+Mat ONNXImporter::getInitializer(const opencv_onnx::TensorProto& tensor_proto)
+{
+    std::map<const opencv_onnx::TensorProto*, std::pair<size_t, size_t> >::const_iterator it = initializersData.find(&tensor_proto);
+    if (it != initializersData.end())
+    {
+        CV_Assert(modelData);
+        return getMatFromData(tensor_proto, modelFile, modelData, it->second.first, it->second.second, it->second.second);
+    }
+
+    std::string location;
+    size_t offset = 0, length = 0;
+    if (!getExternalDataInfo(tensor_proto, location, offset, length))
+        return getMatFromTensor(tensor_proto);
+
+    checkExternalDataLocation(location);
+    Ptr<MappedFile>& file = externalDataFiles[location];
+    if (!file)
+    {
+        const std::string path = utils::fs::join(modelDir, location);
+        CV_LOG_DEBUG(NULL, "DNN/ONNX: mapping external data file: " << path);
+        try
+        {
+            file = MappedFile::open(path);
+        }
+        catch (const cv::Exception&)
+        {
+            CV_Error(Error::StsError, "DNN/ONNX: can't open external data file: " + path);
+        }
+    }
+    CV_CheckLE(offset, file->size(), "DNN/ONNX: external data is out of file");
+    return getMatFromData(tensor_proto, file, file->data(), offset, length, file->size() - offset);
 }
 
 void runLayer(LayerParams& params, const std::vector<Mat>& inputs,
@@ -417,7 +738,7 @@ std::map<std::string, Mat> ONNXImporter::getGraphTensors(
     {
         const opencv_onnx::TensorProto& tensor_proto = graph_proto.initializer(i);
         dumpTensorProto(i, tensor_proto, "initializer");
-        Mat mat = getMatFromTensor(tensor_proto);
+        Mat mat = getInitializer(tensor_proto);
         releaseONNXTensor(const_cast<opencv_onnx::TensorProto&>(tensor_proto));  // drop already loaded data
 
         if (DNN_DIAGNOSTICS_RUN && mat.empty())
@@ -429,6 +750,43 @@ std::map<std::string, Mat> ONNXImporter::getGraphTensors(
     return layers_weights;
 }
 
+void ONNXImporter::registerGraphTensors(opencv_onnx::GraphProto& graph_proto)
+{
+    for (int i = 0; i < graph_proto.initializer_size(); i++)
+    {
+        opencv_onnx::TensorProto* tensor_proto = graph_proto.mutable_initializer(i);
+        dumpTensorProto(i, *tensor_proto, "initializer");
+        if (!constBlobs.insert(std::make_pair(tensor_proto->name(), Mat())).second)
+            continue;
+        pendingInitializers[tensor_proto->name()] = tensor_proto;
+        constBlobsExtraInfo.insert(std::make_pair(tensor_proto->name(), TensorInfo(tensor_proto->dims_size())));
+    }
+    for (int i = 0; i < graph_proto.node_size(); i++)
+    {
+        const opencv_onnx::NodeProto& node_proto = graph_proto.node(i);
+        for (int j = 0; j < node_proto.input_size(); j++)
+        {
+            if (pendingInitializers.count(node_proto.input(j)))
+                initializerUses[node_proto.input(j)]++;
+        }
+    }
+}
+
+// Drops initializers which are not used by the remaining nodes. Layers keep references to their weights,
+// so this frees data which has been converted or repacked on import.
+void ONNXImporter::releaseInitializers(const opencv_onnx::NodeProto& node_proto)
+{
+    for (int i = 0; i < node_proto.input_size(); i++)
+    {
+        std::map<std::string, int>::iterator it = initializerUses.find(node_proto.input(i));
+        if (it == initializerUses.end() || --it->second > 0)
+            continue;
+        constBlobs[it->first].release();
+        pendingInitializers.erase(it->first);
+        initializerUses.erase(it);
+    }
+}
+
 static DictValue parse(const ::google::protobuf::RepeatedField< ::google::protobuf::int64>& src) {
     std::vector<int32_t> dst(src.size());
     convertInt64ToInt32(src, dst, src.size());
@@ -592,11 +950,18 @@ Mat ONNXImporter::getBlob(const opencv_onnx::NodeProto& node_proto, int index)
 
 Mat ONNXImporter::getBlob(const std::string& input_name)
 {
-    std::map<std::string, Mat>::const_iterator constBlob = constBlobs.find(input_name);
+    std::map<std::string, Mat>::iterator constBlob = constBlobs.find(input_name);
     if (constBlob == constBlobs.end())
     {
         CV_Error(Error::StsBadArg, std::string("Blob ") + input_name + " not found in const blobs");
     }
+    std::map<std::string, opencv_onnx::TensorProto*>::iterator pending = pendingInitializers.find(input_name);
+    if (pending != pendingInitializers.end())
+    {
+        constBlob->second = getInitializer(*pending->second);
+        releaseONNXTensor(*pending->second);
+        pendingInitializers.erase(pending);
+    }
     return constBlob->second;
 }
 
@@ -810,12 +1175,15 @@ void ONNXImporter::populateNet()
 
     parseOperatorSet();
 
-    simplifySubgraphs(*graph_proto);
+    simplifySubgraphs(*graph_proto, [this](const opencv_onnx::TensorProto& tensor_proto) { return getInitializer(tensor_proto); });
 
     const int layersSize = graph_proto->node_size();
     CV_LOG_DEBUG(NULL, "DNN/ONNX: graph simplified to " << layersSize << " nodes");
 
-    constBlobs = getGraphTensors(*graph_proto);  // scan GraphProto.initializer
+    if (lazyInitializers && !DNN_DIAGNOSTICS_RUN)
+        registerGraphTensors(*graph_proto);  // initializers are loaded by the consuming nodes
+    else
+        constBlobs = getGraphTensors(*graph_proto);  // scan GraphProto.initializer
     std::vector<String> netInputs;  // map with network inputs (without const blobs)
     // Add all the inputs shapes. It includes as constant blobs as network's inputs shapes.
     for (int i = 0; i < graph_proto->input_size(); ++i)
@@ -890,6 +1258,7 @@ void ONNXImporter::populateNet()
     {
         const opencv_onnx::NodeProto& node_proto = graph_proto->node(li);
         handleNode(node_proto);
+        releaseInitializers(node_proto);
     }
 
     // register outputs
@@ -1644,7 +2013,7 @@ void ONNXImporter::parseLSTM(LayerParams& layerParams, const opencv_onnx::NodePr
     }
     const int input_size = x_shape[2];
     const int hidden_size = layerParams.get<int>("hidden_size");
-    const int num_directions = constBlobs[lstm_proto.input(1)].size[0];
+    const int num_directions = getBlob(lstm_proto, 1).size[0];
 
     int w_size[] = {num_directions, 4*hidden_size, input_size};
     lstm_extractConsts(layerParams, lstm_proto, 1, w_size, sizeof(w_size) / sizeof(w_size[0])); // W
@@ -3862,7 +4231,16 @@ void ONNXImporter::parseAttention(LayerParams& params, const opencv_onnx::NodePr
     auto param_qkv_hidden_sizes = params.get("qkv_hidden_sizes");
     CV_CheckEQ(param_qkv_hidden_sizes.size(), 3, "ONNXImporter/parseAttention: qkv_hidden_sizes is must and only have three elements");
 
-    for (size_t i = 1; i < node_proto.input_size(); i++) {
+    // Optional inputs: mask_index (3), past (4), relative_position_bias (5), past_sequence_length (6)
+    for (int i = 3; i < node_proto.input_size(); i++) {
+        if (i != 4 && !node_proto.input(i).empty())
+            CV_Error(Error::StsNotImplemented, format("ONNXImporter/parseAttention: optional input %d is not supported", i));
+    }
+    if (node_proto.input_size() > 4 && !node_proto.input(4).empty())
+        CV_CheckTrue(constBlobs.find(node_proto.input(4)) == constBlobs.end(), "ONNXImporter/parseAttention: constant past is not supported");
+    params.set("has_present", node_proto.output_size() > 1 && !node_proto.output(1).empty());
+
+    for (int i = 1; i < std::min(node_proto.input_size(), 3); i++) {
         if (constBlobs.find(node_proto.input(i)) != constBlobs.end()) {
             Mat blob = getBlob(node_proto, i);
             params.blobs.push_back(blob);
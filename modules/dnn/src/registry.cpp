@@ -17,6 +17,7 @@
 
 #include "backend.hpp"
 #include "factory.hpp"
+#include "layers/cpu_kernels/fast_gemm.hpp"
 
 #ifdef HAVE_CUDA
 #include "cuda4dnn/init.hpp"
@@ -26,6 +27,15 @@ namespace cv {
 namespace dnn {
 CV__DNN_INLINE_NS_BEGIN
 
+bool haveCPU_FP16Target()
+{
+#if defined(__arm64__) && __arm64__
+    return true;
+#else
+    // On x86 only weights are stored in FP16, computations are done in FP32
+    return fastGemmSupportsFP16B();
+#endif
+}
 
 class BackendRegistry
 {
@@ -65,10 +75,7 @@ private:
         }
 #endif
 
-        bool haveBackendCPU_FP16 = false;
-#if defined(__arm64__) && __arm64__
-        haveBackendCPU_FP16 = true;
-#endif
+        bool haveBackendCPU_FP16 = haveCPU_FP16Target();
 
         if (haveBackendOpenVINO && openvino::checkTarget(DNN_TARGET_CPU))
         {
@@ -0,0 +1,86 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#include "precomp.hpp"
+
+#include "shared_weights.hpp"
+
+namespace cv {
+namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+
+std::shared_ptr<void> SharedWeights::getImpl(const std::string& key, const std::vector<Mat>& sources,
+                                             const std::function<std::shared_ptr<void>()>& create)
+{
+    CV_TRACE_FUNCTION();
+
+    {
+        std::shared_ptr<void> data = findImpl(key, sources);
+        if (data)
+            return data;
+    }
+
+    std::ostringstream ss;
+    ss << key;
+    for (size_t i = 0; i < sources.size(); i++)
+        ss << ":" << (const void*)sources[i].data;
+    const std::string fullKey = ss.str();
+
+    // Computation is serialized, so concurrent copies of the network don't pack the same weights twice.
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::map<std::string, Entry>::iterator it = entries.find(fullKey);
+    if (it != entries.end())
+    {
+        std::shared_ptr<void> data = it->second.data.lock();
+        if (data)
+            return data;
+    }
+
+    // Drop data which is not used anymore.
+    for (it = entries.begin(); it != entries.end();)
+    {
+        if (it->second.data.expired())
+            it = entries.erase(it);
+        else
+            ++it;
+    }
+
+    std::shared_ptr<void> data = create();
+    CV_Assert(data);
+    Entry& entry = entries[fullKey];
+    entry.sources = sources;
+    entry.data = data;
+    return data;
+}
+
+std::shared_ptr<void> SharedWeights::findImpl(const std::string& key, const std::vector<Mat>& sources)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, PreloadedEntry>::const_iterator it = preloaded.find(key);
+    if (it == preloaded.end() || it->second.sources.size() != sources.size())
+        return std::shared_ptr<void>();
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        if (it->second.sources[i].data != sources[i].data)
+            return std::shared_ptr<void>();
+    }
+    return it->second.data;
+}
+
+void SharedWeights::preload(const std::string& key, const std::vector<Mat>& sources, const std::shared_ptr<void>& data)
+{
+    CV_Assert(data);
+    std::lock_guard<std::mutex> lock(mutex);
+    PreloadedEntry& entry = preloaded[key];
+    entry.sources = sources;
+    entry.data = data;
+}
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
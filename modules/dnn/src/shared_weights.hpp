@@ -0,0 +1,104 @@
+// This file is part of OpenCV project.
+// It is subject to the license terms in the LICENSE file found in the top-level directory
+// of this distribution and at http://opencv.org/license.html.
+
+#ifndef __OPENCV_DNN_SRC_SHARED_WEIGHTS_HPP__
+#define __OPENCV_DNN_SRC_SHARED_WEIGHTS_HPP__
+
+#include <functional>
+#include <mutex>
+
+namespace cv { namespace dnn {
+CV__DNN_INLINE_NS_BEGIN
+inline namespace detail {
+
+/** @brief Storage of data computed from constant weights (e.g. prepacked kernels).
+ *
+ * The storage is shared between the network and its copies created by Net::clone(),
+ * so every copy reuses the data computed by others instead of repacking the same weights.
+ * Entries are identified by the key and addresses of the source blobs. The storage
+ * doesn't own the computed data: it is released together with the last layer which uses it.
+ * Data loaded together with a compiled network (see readNetFromCompiled()) is preloaded
+ * and is owned by the storage.
+ */
+class SharedWeights
+{
+public:
+    /** @brief Returns the data for the key or computes it by @p create if there is no alive one.
+     *  @param key description of the data, e.g. layer name and packing parameters.
+     *  @param sources constant blobs which the data is computed from.
+     *  @param create function which computes the data.
+     */
+    template<typename T>
+    Ptr<T> get(const std::string& key, const std::vector<Mat>& sources, const std::function<Ptr<T>()>& create)
+    {
+        return std::static_pointer_cast<T>(getImpl(key, sources, [&]() -> std::shared_ptr<void> { return create(); }));
+    }
+
+    /// Returns preloaded data for the key and the source blobs or empty pointer.
+    template<typename T>
+    Ptr<T> find(const std::string& key, const std::vector<Mat>& sources)
+    {
+        return std::static_pointer_cast<T>(findImpl(key, sources));
+    }
+
+    /** @brief Stores the data computed in advance, e.g. by another process.
+     *  The data is returned only for the same source blobs, so it is not used
+     *  if the weights are replaced (e.g. by Net::setParam()) before the first run.
+     */
+    void preload(const std::string& key, const std::vector<Mat>& sources, const std::shared_ptr<void>& data);
+
+private:
+    std::shared_ptr<void> getImpl(const std::string& key, const std::vector<Mat>& sources,
+                                  const std::function<std::shared_ptr<void>()>& create);
+    std::shared_ptr<void> findImpl(const std::string& key, const std::vector<Mat>& sources);
+
+    struct Entry
+    {
+        // Source blobs are kept to guarantee that their addresses are not reused by other weights.
+        std::vector<Mat> sources;
+        std::weak_ptr<void> data;
+    };
+
+    struct PreloadedEntry
+    {
+        std::vector<Mat> sources;
+        std::shared_ptr<void> data;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Entry> entries;
+    std::map<std::string, PreloadedEntry> preloaded;
+};
+
+
+/// Base class of layers which use SharedWeights. Storage is set by the network on layer creation.
+struct SharedWeightsHolder
+{
+    virtual ~SharedWeightsHolder() {}
+
+    /** @brief Exports the data computed from the weights to save it with the network (see Net::save()).
+     *  @param key key of the data, the same as used for SharedWeights.
+     *  @param data exported data. Mats may refer to the internal buffers of the layer.
+     *  @returns false if the layer has no such data.
+     */
+    virtual bool exportPacked(std::string& key, std::vector<Mat>& data) const
+    {
+        CV_UNUSED(key); CV_UNUSED(data);
+        return false;
+    }
+
+    /// Converts data created by exportPacked() back and preloads it to the sharedWeights storage.
+    virtual void importPacked(const std::string& key, const std::vector<Mat>& data)
+    {
+        CV_UNUSED(key); CV_UNUSED(data);
+    }
+
+    Ptr<SharedWeights> sharedWeights;
+};
+
+
+}  // namespace detail
+CV__DNN_INLINE_NS_END
+}}  // namespace cv::dnn
+#endif  // __OPENCV_DNN_SRC_SHARED_WEIGHTS_HPP__
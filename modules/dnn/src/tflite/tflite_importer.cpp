@@ -3,6 +3,7 @@
 // of this distribution and at http://opencv.org/license.html.
 
 #include "../precomp.hpp"
+#include "../mapped_file.hpp"
 
 #ifdef HAVE_FLATBUFFERS
 #include "schema_generated.h"
@@ -25,8 +26,12 @@ using namespace opencv_tflite;
 class TFLiteImporter {
 public:
     TFLiteImporter(Net& net, const char* modelBuffer, size_t bufSize);
+    TFLiteImporter(Net& net, const Ptr<MappedFile>& modelFile);
 
 private:
+    void init(const char* modelBuffer, size_t bufSize);
+
+    Ptr<MappedFile> modelFile;  // if set, constant tensors refer to the mapped model
     const opencv_tflite::Model* model;
     const flatbuffers::Vector<flatbuffers::Offset<opencv_tflite::Tensor> >* modelTensors;
     std::map<int, Mat> allTensors;
@@ -117,11 +122,30 @@ Mat TFLiteImporter::parseTensor(const Tensor& tensor)
     default:
         CV_Error(Error::StsNotImplemented, format("Parse tensor with type %s", EnumNameTensorType(tensor.type())));
     }
-    return shape.empty() ? Mat() : Mat(shape, dtype, const_cast<void*>(data));
+    if (shape.empty())
+        return Mat();
+    if (modelFile)
+    {
+        size_t offset = (const uchar*)data - modelFile->data();
+        return MappedFile::wrap(modelFile, offset, (int)shape.size(), shape.data(), dtype);
+    }
+    return Mat(shape, dtype, const_cast<void*>(data));
 }
 
 TFLiteImporter::TFLiteImporter(Net& dstNet, const char* modelBuffer, size_t bufSize)
     : dstNet(dstNet), dispatch(buildDispatchMap())
+{
+    init(modelBuffer, bufSize);
+}
+
+TFLiteImporter::TFLiteImporter(Net& dstNet, const Ptr<MappedFile>& modelFile)
+    : modelFile(modelFile), dstNet(dstNet), dispatch(buildDispatchMap())
+{
+    CV_Assert(modelFile);
+    init((const char*)modelFile->data(), modelFile->size());
+}
+
+void TFLiteImporter::init(const char* modelBuffer, size_t bufSize)
 {
     flatbuffers::Verifier verifier((const uint8_t*)modelBuffer, bufSize);
     if (!VerifyModelBuffer(verifier)) {
@@ -1129,23 +1153,19 @@ void TFLiteImporter::getQuantParams(const Operator& op, float& inpScale, int& in
 Net readNetFromTFLite(const String &modelPath) {
     Net net;
 
-    std::vector<char> content;
-
-    const std::ios::openmode mode = std::ios::in | std::ios::binary;
-    std::ifstream ifs(modelPath, mode);
-    if (!ifs.is_open())
+    // Constant tensors become Mat headers over the mapped model, so weights are not copied
+    Ptr<MappedFile> modelFile;
+    try
+    {
+        modelFile = MappedFile::open(modelPath);
+    }
+    catch (const cv::Exception&)
+    {
         CV_Error(Error::StsError, cv::format("DNN/TFLite: can't open model file '%s'", modelPath.c_str()));
+    }
+    CV_Assert(modelFile->size() > 0);
 
-    ifs.seekg(0, std::ios::end);
-    const size_t sz = ifs.tellg();
-    CV_Assert(sz > 0);
-    content.resize(sz);
-    ifs.seekg(0, std::ios::beg);
-
-    ifs.read(content.data(), sz);
-    CV_Assert(!ifs.bad());
-
-    TFLiteImporter(net, content.data(), content.size());
+    TFLiteImporter(net, modelFile);
     return net;
 }
 
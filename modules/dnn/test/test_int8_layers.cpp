@@ -160,6 +160,211 @@ TEST_P(Test_Int8_layers, Convolution3D)
     testLayer("conv3d_bias", "ONNX", 0.00129, 0.00249);
 }
 
+// Quantized convolution must match the integer reference exactly.
+TEST(Test_Int8_layers_synthetic, Convolution2D)
+{
+    struct ConvParams { int N, C, K, groups, H, W, kernel, stride, pad, dilation; bool lut, conv1d; };
+    const ConvParams configs[] = {
+        {1, 16, 32, 1, 10, 10, 1, 1, 0, 1, false, false},  // 1x1
+        {2, 5, 7, 1, 9, 11, 3, 1, 1, 1, true, false},  // channels are not aligned by 4
+        {1, 8, 12, 2, 13, 13, 3, 2, 1, 1, false, false},  // groups, stride
+        {1, 6, 10, 1, 12, 12, 3, 1, 2, 2, false, false},  // dilation
+        {1, 3, 5, 1, 7, 40, 5, 1, 2, 1, false, false},
+        {2, 6, 9, 1, 1, 30, 3, 2, 1, 1, true, true},  // 1D, kernel_size of size 1
+    };
+    const int inpZp = -3, outZp = 5;
+    RNG& rng = theRNG();
+
+    for (size_t t = 0; t < sizeof(configs)/sizeof(configs[0]); t++)
+    {
+        const ConvParams& p = configs[t];
+        SCOPED_TRACE(cv::format("config %d", (int)t));
+        const int Cg = p.C / p.groups, Kg = p.K / p.groups;
+        // 1D convolution is checked as a 2D one with kernel height 1
+        const int kh = p.conv1d ? 1 : p.kernel, padH = p.conv1d ? 0 : p.pad;
+        const int strideH = p.conv1d ? 1 : p.stride, dilationH = p.conv1d ? 1 : p.dilation;
+        const int Ho = (p.H + 2*padH - dilationH*(kh - 1) - 1) / strideH + 1;
+        const int Wo = (p.W + 2*p.pad - p.dilation*(p.kernel - 1) - 1) / p.stride + 1;
+        const int dims = p.conv1d ? 3 : 4;
+
+        int wshape[] = {p.K, Cg, p.kernel, p.kernel};
+        Mat weights(dims, wshape, CV_8S), bias(1, p.K, CV_32S), multipliers(1, p.K, CV_32F);
+        rng.fill(weights, RNG::UNIFORM, -128, 128);
+        rng.fill(bias, RNG::UNIFORM, -1000, 1000);
+        rng.fill(multipliers, RNG::UNIFORM, 0.001, 0.02);
+
+        int ishape[] = {p.N, p.C, p.H, p.W};
+        if (p.conv1d)
+            ishape[2] = p.W;
+        Mat input(dims, ishape, CV_8S);
+        rng.fill(input, RNG::UNIFORM, -128, 128);
+
+        LayerParams lp;
+        lp.type = "ConvolutionInt8";
+        lp.name = "conv";
+        if (p.conv1d)
+        {
+            lp.set("kernel_size", DictValue::arrayInt(&p.kernel, 1));
+            lp.set("stride", DictValue::arrayInt(&p.stride, 1));
+            lp.set("pad", DictValue::arrayInt(&p.pad, 1));
+            lp.set("dilation", DictValue::arrayInt(&p.dilation, 1));
+        }
+        else
+        {
+            lp.set("kernel_size", p.kernel);
+            lp.set("stride", p.stride);
+            lp.set("pad", p.pad);
+            lp.set("dilation", p.dilation);
+        }
+        lp.set("num_output", p.K);
+        lp.set("group", p.groups);
+        lp.set("input_scale", 1.f);
+        lp.set("input_zeropoint", inpZp);
+        lp.set("scales", 1.f);
+        lp.set("zeropoints", outZp);
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        lp.blobs.push_back(multipliers);
+        Ptr<Layer> layer = ConvolutionLayerInt8::create(lp);
+
+        Mat lut;
+        if (p.lut)
+        {
+            lut.create(1, 256, CV_8S);
+            rng.fill(lut, RNG::UNIFORM, -128, 128);
+            LayerParams activParams;
+            activParams.type = "ReLUInt8";
+            activParams.set("input_scale", 1.f);
+            activParams.set("input_zeropoint", 0);
+            activParams.set("scales", 1.f);
+            activParams.set("zeropoints", 0);
+            activParams.blobs.push_back(lut);
+            Ptr<ActivationLayer> activ = ActivationLayerInt8::create(activParams);
+            ASSERT_TRUE(layer->setActivation(activ));
+        }
+
+        int oshape[] = {p.N, p.K, Ho, Wo};
+        if (p.conv1d)
+            oshape[2] = Wo;
+        std::vector<Mat> inputs(1, input), outputs(1, Mat(dims, oshape, CV_8S)), internals;
+        layer->finalize(inputs, outputs);
+        layer->forward(inputs, outputs, internals);
+
+        Mat ref(dims, oshape, CV_8S);
+        for (int n = 0; n < p.N; n++)
+        for (int k = 0; k < p.K; k++)
+        for (int y = 0; y < Ho; y++)
+        for (int x = 0; x < Wo; x++)
+        {
+            int g = k / Kg, s = bias.at<int>(k);
+            for (int c = 0; c < Cg; c++)
+            for (int ky = 0; ky < kh; ky++)
+            for (int kx = 0; kx < p.kernel; kx++)
+            {
+                int yi = y*strideH - padH + ky*dilationH, xi = x*p.stride - p.pad + kx*p.dilation;
+                int v = yi >= 0 && yi < p.H && xi >= 0 && xi < p.W ?
+                        input.ptr<int8_t>(n)[((g*Cg + c)*p.H + yi)*p.W + xi] : inpZp;
+                s += v * weights.ptr<int8_t>(k)[(c*kh + ky)*p.kernel + kx];
+            }
+            int out = saturate_cast<int8_t>(outZp + cvRound(s*multipliers.at<float>(k)));
+            if (p.lut)
+                out = lut.at<int8_t>(out + 128);
+            ref.ptr<int8_t>(n)[(k*Ho + y)*Wo + x] = (int8_t)out;
+        }
+        EXPECT_EQ(0, cvtest::norm(ref, outputs[0], NORM_INF));
+    }
+}
+
+TEST(Test_Int8_quantize, calibration_and_mixed_precision)
+{
+    Net net;
+    {
+        LayerParams lp;
+        lp.type = "Convolution";
+        lp.name = "conv1";
+        lp.set("kernel_size", 3);
+        lp.set("pad", 1);
+        lp.set("num_output", 8);
+        int wshape[] = {8, 4, 3, 3};
+        Mat weights(4, wshape, CV_32F), bias(1, 8, CV_32F);
+        randu(weights, -0.5f, 0.5f);
+        randu(bias, -0.5f, 0.5f);
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.type = "ReLU";
+        lp.name = "relu1";
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    {
+        LayerParams lp;
+        lp.type = "InnerProduct";
+        lp.name = "fc";
+        lp.set("num_output", 10);
+        Mat weights(10, 8 * 8 * 8, CV_32F), bias(1, 10, CV_32F);
+        randu(weights, -0.1f, 0.1f);
+        randu(bias, -0.5f, 0.5f);
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+    }
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+    int ishape[] = {16, 4, 8, 8};
+    Mat input(4, ishape, CV_32F);
+    randn(input, 0.0, 1.0);
+    net.setInput(input);
+    Mat ref = net.forward().clone();
+
+    const QuantizationCalibration methods[] = { DNN_CALIB_MINMAX, DNN_CALIB_PERCENTILE, DNN_CALIB_ENTROPY };
+    for (int i = 0; i < 3; i++)
+    {
+        SCOPED_TRACE(cv::format("calibration %d", (int)methods[i]));
+        QuantizationParams params;
+        params.calibration = methods[i];
+        Net qnet = net.quantize(input, params);
+        EXPECT_EQ("ConvolutionInt8", qnet.getLayer("conv1")->type);
+        EXPECT_EQ("InnerProductInt8", qnet.getLayer("fc")->type);
+        qnet.setInput(input);
+        Mat out = qnet.forward();
+        EXPECT_LT(cvtest::norm(out, ref, NORM_L2 | NORM_RELATIVE), 0.1);
+    }
+
+    // All the layers are kept in FP32 if the error can't be reached
+    {
+        QuantizationParams params;
+        params.maxError = 1e-9;
+        Net qnet = net.quantize(input, params);
+        EXPECT_EQ("Convolution", qnet.getLayer("conv1")->type);
+        EXPECT_EQ("InnerProduct", qnet.getLayer("fc")->type);
+        qnet.setInput(input);
+        normAssert(ref, qnet.forward(), "", 1e-5, 1e-4);
+    }
+
+    // The calibration table reproduces the quantized network
+    const std::string path = cv::tempfile(".yml");
+    QuantizationParams params;
+    params.calibration = DNN_CALIB_ENTROPY;
+    params.fp32Layers.push_back("fc");
+    params.saveCalibrationTable = path;
+    Net qnet = net.quantize(input, params);
+    EXPECT_EQ("ConvolutionInt8", qnet.getLayer("conv1")->type);
+    EXPECT_EQ("InnerProduct", qnet.getLayer("fc")->type);
+    qnet.setInput(input);
+    Mat out = qnet.forward().clone();
+
+    QuantizationParams loaded;
+    loaded.calibrationTable = path;
+    Net qnet2 = net.quantize(input, loaded);
+    EXPECT_EQ("InnerProduct", qnet2.getLayer("fc")->type);
+    qnet2.setInput(input);
+    normAssert(out, qnet2.forward(), "", 0, 0);
+    remove(path.c_str());
+}
+
 TEST_P(Test_Int8_layers, Flatten)
 {
     testLayer("flatten", "TensorFlow", 0.0036, 0.0069, 1, 1, false, true, true);
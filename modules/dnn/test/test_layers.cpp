@@ -725,6 +725,96 @@ TEST(Layer_LSTM_Test_Accuracy_, Reverse)
 }
 
 
+static float sigmoidRef(float x) { return 1.f / (1.f + std::exp(-x)); }
+
+// Step by step LSTM (gates IFOG) and GRU (gates ZRN) of the layout [seq, batch, hidden], both directions
+static Mat recurrentReference(const Mat& x, const Mat& Wh, const Mat& Wx, const Mat& b, const Mat& h0, const Mat& c0,
+                              int numDirs, bool gru)
+{
+    const int T = x.size[0], N = x.size[1], D = x.size[2], H = Wh.cols, G = gru ? 3 : 4;
+    int outSz[] = {T, N, numDirs * H};
+    Mat out(3, outSz, CV_32F);
+    for (int d = 0; d < numDirs; d++)
+    {
+        Mat wh = Wh.rowRange(d * G * H, (d + 1) * G * H), wx = Wx.rowRange(d * G * H, (d + 1) * G * H);
+        Mat h = h0.rowRange(d * N, (d + 1) * N).clone(), c = gru ? Mat() : c0.rowRange(d * N, (d + 1) * N).clone();
+        for (int k = 0; k < T; k++)
+        {
+            const int t = d == 0 ? k : T - 1 - k;
+            Mat xt(N, D, CV_32F, (void*)x.ptr<float>(t)), xg, hg;
+            gemm(xt, wx, 1, noArray(), 0, xg, GEMM_2_T);
+            gemm(h, wh, 1, noArray(), 0, hg, GEMM_2_T);
+            for (int n = 0; n < N; n++)
+            {
+                const float* bias = b.ptr<float>() + d * (gru ? 6 : 4) * H;
+                for (int j = 0; j < H; j++)
+                {
+                    float* hn = h.ptr<float>(n);
+                    if (gru)
+                    {
+                        float z = sigmoidRef(xg.at<float>(n, j) + hg.at<float>(n, j) + bias[j] + bias[3 * H + j]);
+                        float r = sigmoidRef(xg.at<float>(n, H + j) + hg.at<float>(n, H + j) + bias[H + j] + bias[4 * H + j]);
+                        float nt = std::tanh(xg.at<float>(n, 2 * H + j) + bias[2 * H + j] +
+                                             r * (hg.at<float>(n, 2 * H + j) + bias[5 * H + j]));
+                        hn[j] = z * hn[j] + (1 - z) * nt;
+                    }
+                    else
+                    {
+                        float g[4];
+                        for (int q = 0; q < 4; q++)
+                            g[q] = xg.at<float>(n, q * H + j) + hg.at<float>(n, q * H + j) + bias[q * H + j];
+                        float& cn = c.at<float>(n, j);
+                        cn = sigmoidRef(g[1]) * cn + sigmoidRef(g[0]) * std::tanh(g[3]);
+                        hn[j] = sigmoidRef(g[2]) * std::tanh(cn);
+                    }
+                    out.ptr<float>(t, n)[d * H + j] = hn[j];
+                }
+            }
+        }
+    }
+    return out;
+}
+
+typedef testing::TestWithParam<tuple<bool, bool> > Layer_Recurrent_Test;
+TEST_P(Layer_Recurrent_Test, Accuracy)
+{
+    const bool gru = get<0>(GetParam());
+    const int numDirs = get<1>(GetParam()) ? 2 : 1;
+    const int T = 7, N = 3, D = 13, H = 21, G = gru ? 3 : 4;
+    Mat Wh(numDirs * G * H, H, CV_32F), Wx(numDirs * G * H, D, CV_32F);
+    Mat b(1, numDirs * (gru ? 6 : 4) * H, CV_32F), h0(numDirs * N, H, CV_32F), c0(numDirs * N, H, CV_32F);
+    randu(Wh, -0.5, 0.5);
+    randu(Wx, -0.5, 0.5);
+    randu(b, -0.5, 0.5);
+    randu(h0, -1, 1);
+    randu(c0, -1, 1);
+    int inpSz[] = {T, N, D};
+    Mat inp(3, inpSz, CV_32F);
+    randu(inp, -1, 1);
+
+    LayerParams lp;
+    lp.set("bidirectional", numDirs == 2);
+    lp.blobs.push_back(Wh);
+    lp.blobs.push_back(Wx);
+    lp.blobs.push_back(b);
+    lp.blobs.push_back(h0);
+    Ptr<Layer> layer;
+    if (gru)
+        layer = GRULayer::create(lp);
+    else
+    {
+        lp.blobs.push_back(c0);
+        layer = LSTMLayer::create(lp);
+    }
+
+    std::vector<Mat> inputs(1, inp), outputs;
+    runLayer(layer, inputs, outputs);
+    ASSERT_EQ(1, outputs.size());
+    normAssert(recurrentReference(inp, Wh, Wx, b, h0, c0, numDirs, gru), outputs[0], "", 1e-5, 1e-4);
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, Layer_Recurrent_Test, Combine(testing::Bool(), testing::Bool()));
+
 class Layer_RNN_Test : public ::testing::Test
 {
 public:
@@ -1843,6 +1933,88 @@ TEST(Layer_Test_ReduceMean, accuracy_input_0)
     }
 }
 
+static Mat attentionReference(const Mat& input, const Mat& weight, const Mat& bias, int num_heads, bool causal)
+{
+    const int seq_len = input.size[1], hidden = weight.cols / 3, head_size = hidden / num_heads;
+    Mat qkv = input.reshape(1, seq_len) * weight + repeat(bias.reshape(1, 1), seq_len, 1);
+    Mat out(seq_len, hidden, CV_32F);
+    for (int n = 0; n < num_heads; n++)
+    {
+        Mat q = qkv.colRange(n * head_size, (n + 1) * head_size);
+        Mat k = qkv.colRange(hidden + n * head_size, hidden + (n + 1) * head_size);
+        Mat v = qkv.colRange(2 * hidden + n * head_size, 2 * hidden + (n + 1) * head_size);
+        Mat scores = q * k.t() / std::sqrt((float)head_size);
+        for (int i = 0; i < seq_len; i++)
+        {
+            Mat row = scores.row(i);
+            int len = causal ? i + 1 : seq_len;
+            double maxVal;
+            minMaxLoc(row.colRange(0, len), 0, &maxVal);
+            exp(row - maxVal, row);
+            row.colRange(len, seq_len).setTo(0);
+            row /= sum(row)[0];
+        }
+        Mat(scores * v).copyTo(out.colRange(n * head_size, (n + 1) * head_size));
+    }
+    return out.reshape(1, std::vector<int>{1, seq_len, hidden});
+}
+
+// Decoder steps with the key/value cache must produce the same result as the whole sequence
+TEST(Layer_Test_Attention, kv_cache)
+{
+    const int num_heads = 2, hidden = 16, input_hidden = 12, seq_len = 150, prefix_len = 130;
+
+    Mat weight(input_hidden, 3 * hidden, CV_32F), bias(3 * hidden, 1, CV_32F);
+    randu(weight, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    int qkv_hidden_sizes[] = {hidden, hidden, hidden};
+    LayerParams lp;
+    lp.type = "Attention";
+    lp.name = "attention";
+    lp.set("num_heads", num_heads);
+    lp.set("qkv_hidden_sizes", DictValue::arrayInt(qkv_hidden_sizes, 3));
+    lp.set("unidirectional", true);
+    lp.set("has_present", true);
+    lp.blobs.push_back(weight);
+    lp.blobs.push_back(bias);
+
+    Mat input(std::vector<int>{1, seq_len, input_hidden}, CV_32F);
+    randu(input, -1.0f, 1.0f);
+    Mat ref = attentionReference(input, weight, bias, num_heads, true);
+
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setInput(input);
+    std::vector<Mat> outs;
+    net.forward(outs, lp.name);
+    ASSERT_EQ(outs.size(), (size_t)2);
+    normAssert(ref, outs[0], "whole sequence");
+    Mat present = outs[1].clone();
+
+    std::vector<Range> prefix(3, Range::all()), rest(3, Range::all());
+    prefix[1] = Range(0, prefix_len);
+    rest[1] = Range(prefix_len, seq_len);
+
+    net.setInput(input(prefix).clone());
+    net.forward(outs, lp.name);
+    normAssert(ref(prefix), outs[0], "prefix");
+    Mat past = outs[1].clone();
+
+    Net step;
+    step.setInputsNames({"input", "past"});
+    int id = step.addLayer(lp.name, lp.type, lp);
+    step.connect(0, 0, id, 0);
+    step.connect(0, 1, id, 1);
+    step.setPreferableBackend(DNN_BACKEND_OPENCV);
+    step.setInput(input(rest).clone(), "input");
+    step.setInput(past, "past");
+    step.forward(outs, lp.name);
+    normAssert(ref(rest), outs[0], "step");
+    normAssert(present, outs[1], "present");
+}
+
 
 // Check if relu is not fused to convolution if we requested it's output
 TEST(Layer_Test_Convolution, relu_fusion)
@@ -1876,6 +2048,187 @@ TEST(Layer_Test_Convolution, relu_fusion)
     normAssert(input, output);
 }
 
+TEST(Layer_Test_Convolution, autotune)
+{
+    const int C = 16, K = 32;
+    int weightsShape[] = {K, C, 3, 3};
+    Mat weights(4, &weightsShape[0], CV_32F), bias(1, K, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    Net nets[2];
+    for (int i = 0; i < 2; i++)
+    {
+        LayerParams lp;
+        lp.set("kernel_size", 3);
+        lp.set("pad", 1);
+        lp.set("num_output", K);
+        lp.set("autotune", i == 1);
+        lp.type = "Convolution";
+        lp.name = "testConv";
+        lp.blobs.push_back(weights);
+        lp.blobs.push_back(bias);
+        nets[i].addLayerToPrev(lp.name, lp.type, lp);
+        nets[i].setPreferableBackend(DNN_BACKEND_OPENCV);
+    }
+
+    // The algorithm and blocking are selected again for every new shape
+    const int sizes[] = {24, 13, 24};
+    for (int i = 0; i < 3; i++)
+    {
+        int sz[] = {1, C, sizes[i], sizes[i]};
+        Mat input(4, &sz[0], CV_32F);
+        randu(input, -1.0f, 1.0f);
+        Mat ref, out;
+        nets[0].setInput(input);
+        ref = nets[0].forward();
+        nets[1].setInput(input);
+        out = nets[1].forward();
+        normAssert(ref, out, "", 1e-4, 1e-3);
+
+        // the selected kernel is reused by the next runs
+        out = nets[1].forward();
+        normAssert(ref, out, "", 1e-4, 1e-3);
+    }
+}
+
+// Zeros blocks of 4 consecutive output channels, the rest of weights are random
+static Mat getPrunedWeights(const std::vector<int>& shape, float sparsity, RNG& rng)
+{
+    Mat weights(shape, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    Mat w2d = weights.reshape(1, shape[0]);
+    for (int r = 0; r < w2d.rows; r += 4)
+    {
+        for (int c = 0; c < w2d.cols; c++)
+        {
+            if (rng.uniform(0.f, 1.f) < sparsity)
+                w2d(Range(r, std::min(r + 4, w2d.rows)), Range(c, c + 1)).setTo(0);
+        }
+    }
+    return weights;
+}
+
+// Tiny values instead of zeros prevent the sparse kernels from being used
+static Mat getDenseWeights(const Mat& weights)
+{
+    Mat dense = weights.clone();
+    dense.setTo(1e-30f, weights == 0);
+    return dense;
+}
+
+TEST(Layer_Test_Convolution, sparse_weights)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    const int C = 16, K = 16, H = 11, W = 21;
+    const int groups[] = {1, 2}, strides_h[] = {1, 2};
+    for (int i = 0; i < 2; i++)
+    {
+        std::vector<int> weightsShape = {K, C / groups[i], 3, 3};
+        Mat weights = getPrunedWeights(weightsShape, 0.9f, rng);
+        Mat bias(1, K, CV_32F), addendWeights(std::vector<int>{K, C, 1, 1}, CV_32F);
+        randu(bias, -1.0f, 1.0f);
+        randu(addendWeights, -1.0f, 1.0f);
+
+        int sz[] = {2, C, H, W};
+        Mat input(4, &sz[0], CV_32F);
+        randu(input, -1.0f, 1.0f);
+
+        Mat outs[2];
+        int64 flops[2];
+        for (int j = 0; j < 2; j++)
+        {
+            // Convolution is fused with the activation and, with stride 1, with the sum
+            Net net;
+            int addendId = -1;
+            if (strides_h[i] == 1)
+            {
+                LayerParams addendParams;
+                addendParams.set("kernel_size", 1);
+                addendParams.set("num_output", K);
+                addendParams.set("bias_term", false);
+                addendParams.type = "Convolution";
+                addendParams.name = "testAddend";
+                addendParams.blobs.push_back(addendWeights);
+                addendId = net.addLayerToPrev(addendParams.name, addendParams.type, addendParams);
+            }
+
+            LayerParams lp;
+            lp.set("kernel_size", 3);
+            lp.set("pad", 1);
+            lp.set("stride_h", strides_h[i]);
+            lp.set("stride_w", 1);
+            lp.set("group", groups[i]);
+            lp.set("num_output", K);
+            lp.type = "Convolution";
+            lp.name = "testConv";
+            lp.blobs.push_back(j == 0 ? getDenseWeights(weights) : weights);
+            lp.blobs.push_back(bias);
+            int convId = net.addLayer(lp.name, lp.type, lp);
+            net.connect(0, 0, convId, 0);
+
+            if (addendId >= 0)
+            {
+                LayerParams sumParams;
+                sumParams.type = "NaryEltwise";
+                sumParams.name = "testSum";
+                sumParams.set("operation", "add");
+                int sumId = net.addLayer(sumParams.name, sumParams.type, sumParams);
+                net.connect(convId, 0, sumId, 0);
+                net.connect(addendId, 0, sumId, 1);
+            }
+            LayerParams reluParams;
+            reluParams.type = "ReLU";
+            reluParams.name = "testReLU";
+            net.addLayerToPrev(reluParams.name, reluParams.type, reluParams);
+
+            net.setPreferableBackend(DNN_BACKEND_OPENCV);
+            net.setInput(input);
+            outs[j] = net.forward();
+            flops[j] = net.getFLOPS(std::vector<int>(sz, sz + 4));
+        }
+        normAssert(outs[0], outs[1], "", 1e-5, 1e-4);
+        EXPECT_LT(flops[1], flops[0] / 2);
+    }
+}
+
+TEST(Layer_Test_InnerProduct, sparse_weights)
+{
+    RNG& rng = TS::ptr()->get_rng();
+    const int N = 7, C = 96, K = 30;
+    std::vector<int> weightsShape = {K, C};
+    Mat weights = getPrunedWeights(weightsShape, 0.9f, rng);
+    Mat bias(1, K, CV_32F), input(N, C, CV_32F);
+    randu(bias, -1.0f, 1.0f);
+    randu(input, -1.0f, 1.0f);
+
+    Mat outs[2];
+    int64 flops[2];
+    for (int j = 0; j < 2; j++)
+    {
+        Net net;
+        LayerParams lp;
+        lp.set("num_output", K);
+        lp.type = "InnerProduct";
+        lp.name = "testFC";
+        lp.blobs.push_back(j == 0 ? getDenseWeights(weights) : weights);
+        lp.blobs.push_back(bias);
+        net.addLayerToPrev(lp.name, lp.type, lp);
+
+        LayerParams reluParams;
+        reluParams.type = "ReLU";
+        reluParams.name = "testReLU";
+        net.addLayerToPrev(reluParams.name, reluParams.type, reluParams);
+
+        net.setPreferableBackend(DNN_BACKEND_OPENCV);
+        net.setInput(input);
+        outs[j] = net.forward();
+        flops[j] = net.getFLOPS(shape(N, C));
+    }
+    normAssert(outs[0], outs[1], "", 1e-5, 1e-4);
+    EXPECT_LT(flops[1], flops[0] / 2);
+}
+
 typedef testing::TestWithParam<tuple<bool, tuple<Backend, Target> > > Layer_Test_Eltwise_unequal;
 TEST_P(Layer_Test_Eltwise_unequal, accuracy_input_0_truncate)
 {
@@ -2558,6 +2911,134 @@ INSTANTIATE_TEST_CASE_P(TestLayerFusion, ConvolutionActivationFusion, Combine(
                  TestLayerFusion::dnnBackendsAndTargetsForFusionTests()
 ));
 
+typedef TestWithParam<tuple<bool, std::string, tuple<Backend, Target> > > MatMulActivationFusion;
+TEST_P(MatMulActivationFusion, Accuracy)
+{
+    //          input
+    //            |
+    // -----------------------
+    // |       matmul        |
+    // -----------------------
+    //            |
+    // -----------------------
+    // |     activation      |
+    // -----------------------
+    //            |
+    //         output
+
+    const int batch_size = 2, M = 9, K = 16, N = 20;
+    int inputShape[] = {batch_size, M, K};
+    Mat input(3, &inputShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    bool bias_term = get<0>(GetParam());
+    LayerParams matmulParams;
+    matmulParams.type = "MatMul";
+    matmulParams.name = "matmul";
+    Mat weights(K, N, CV_32F);
+    randu(weights, -0.5f, 0.5f);
+    matmulParams.blobs.push_back(weights);
+    if (bias_term)
+    {
+        Mat bias(1, N, CV_32F);
+        randu(bias, -1.0f, 1.0f);
+        matmulParams.blobs.push_back(bias.reshape(1, N));
+        matmulParams.set("real_ndims_C", 1);
+    }
+
+    std::string actType = get<1>(GetParam());
+    LayerParams activationParams;
+    TestLayerFusion::makeDefaultTestActivationLayer(activationParams, actType, M);
+
+    Backend backendId = get<0>(get<2>(GetParam()));
+    Target targetId = get<1>(get<2>(GetParam()));
+
+    Net net;
+    int matmulId = net.addLayer(matmulParams.name, matmulParams.type, matmulParams);
+    int activId = net.addLayerToPrev(activationParams.name, activationParams.type, activationParams);
+    net.connect(0, 0, matmulId, 0);
+
+    // the activation is applied to the output tiles by fastGemmBatch
+    std::vector<int> expectedFusedLayers;
+    if (backendId == DNN_BACKEND_OPENCV && (targetId == DNN_TARGET_CPU || targetId == DNN_TARGET_CPU_FP16) &&
+        actType != "ChannelsPReLU")
+        expectedFusedLayers.push_back(activId);
+    TestLayerFusion::test(input, net, backendId, targetId, expectedFusedLayers);
+}
+INSTANTIATE_TEST_CASE_P(TestLayerFusion, MatMulActivationFusion, Combine(
+/* bias */       testing::Bool(),
+/* activation */ TestLayerFusion::activationLayersList(),
+                 TestLayerFusion::dnnBackendsAndTargetsForFusionTests()
+));
+
+typedef TestWithParam<tuple<std::string, tuple<Backend, Target> > > ElementwiseChainFusion;
+TEST_P(ElementwiseChainFusion, Accuracy)
+{
+    //          input
+    //            |
+    // -----------------------
+    // | eltwise or activation |  <- const (mul, add)
+    // -----------------------
+    //            |
+    //  Swish -> Power -> TanH
+    //            |
+    //         output
+
+    int inputShape[] = {2, 8, 16, 16};
+    Mat input(4, &inputShape[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    std::string headType = get<0>(GetParam());
+    Backend backendId = get<0>(get<1>(GetParam()));
+    Target targetId = get<1>(get<1>(GetParam()));
+
+    Net net;
+    if (headType == "mul" || headType == "add")
+    {
+        // per-channel and scalar operands are broadcast differently
+        int constShape[] = {1, headType == "mul" ? inputShape[1] : 1, 1, 1};
+        LayerParams constParams;
+        constParams.type = "Const";
+        constParams.name = "const";
+        Mat B(4, &constShape[0], CV_32F);
+        randu(B, -1.0f, 1.0f);
+        constParams.blobs.push_back(B);
+        int constId = net.addLayer(constParams.name, constParams.type, constParams);
+
+        LayerParams eltwiseParams;
+        eltwiseParams.type = "NaryEltwise";
+        eltwiseParams.name = "eltwise";
+        eltwiseParams.set("operation", headType);
+        int eltwiseId = net.addLayer(eltwiseParams.name, eltwiseParams.type, eltwiseParams);
+        net.connect(0, 0, eltwiseId, 0);
+        net.connect(constId, 0, eltwiseId, 1);
+    }
+    else
+    {
+        LayerParams activationParams;
+        TestLayerFusion::makeDefaultTestActivationLayer(activationParams, headType, inputShape[1]);
+        int activId = net.addLayer(activationParams.name, activationParams.type, activationParams);
+        net.connect(0, 0, activId, 0);
+    }
+
+    std::vector<int> expectedFusedLayers;
+    const char* chain[] = {"Swish", "Power", "TanH"};
+    for (int i = 0; i < 3; i++)
+    {
+        LayerParams params;
+        TestLayerFusion::makeDefaultTestActivationLayer(params, chain[i], inputShape[1]);
+        params.name = format("activation_%d", i);
+        int id = net.addLayerToPrev(params.name, params.type, params);
+        if (backendId == DNN_BACKEND_OPENCV && (targetId == DNN_TARGET_CPU || targetId == DNN_TARGET_CPU_FP16))
+            expectedFusedLayers.push_back(id);
+    }
+    TestLayerFusion::test(input, net, backendId, targetId, expectedFusedLayers);
+}
+INSTANTIATE_TEST_CASE_P(TestLayerFusion, ElementwiseChainFusion, Combine(
+/* head */ Values("mul", "add", "Sigmoid", "ReLU", "ChannelsPReLU"),
+           TestLayerFusion::dnnBackendsAndTargetsForFusionTests()
+));
+
 typedef TestWithParam<tuple<bool, std::string, bool, tuple<Backend, Target> > > ConvolutionEltwiseFusion;
 TEST_P(ConvolutionEltwiseFusion, Accuracy)
 {
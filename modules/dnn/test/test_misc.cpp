@@ -10,6 +10,9 @@
 #include <opencv2/core/ocl.hpp>
 #include <opencv2/core/opencl/ocl_defs.hpp>
 #include <opencv2/dnn/layer.details.hpp>  // CV_DNN_REGISTER_LAYER_CLASS
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+#include <thread>
+#endif
 
 namespace opencv_test { namespace {
 
@@ -242,6 +245,95 @@ TEST(blobFromImagesWithParams_4ch, multi_image)
     EXPECT_EQ(0, cvtest::norm(2 * blob0, blob1, NORM_INF));
 }
 
+// Step by step conversion of 8-bit image, as in the generic implementation
+static Mat blobFromImageReference(const Mat& img, const Image2BlobParams& param)
+{
+    Mat src = img;
+    Size imgSize = img.size(), size = param.size;
+    if (param.paddingmode == DNN_PMODE_CROP_CENTER)
+    {
+        float f = std::max(size.width / (float)imgSize.width, size.height / (float)imgSize.height);
+        resize(img, src, Size(), f, f, INTER_LINEAR);
+        src = src(Rect(Point(0.5 * (src.cols - size.width), 0.5 * (src.rows - size.height)), size));
+    }
+    else if (param.paddingmode == DNN_PMODE_LETTERBOX)
+    {
+        float f = std::min(size.width / (float)imgSize.width, size.height / (float)imgSize.height);
+        int rh = int(imgSize.height * f), rw = int(imgSize.width * f);
+        resize(img, src, Size(rw, rh), 0, 0, INTER_LINEAR);
+        int top = (size.height - rh) / 2, left = (size.width - rw) / 2;
+        cv::copyMakeBorder(src, src, top, size.height - top - rh, left, size.width - left - rw,
+                           BORDER_CONSTANT, param.borderValue);
+    }
+    else
+        resize(img, src, size, 0, 0, INTER_LINEAR);
+
+    const int cn = img.channels();
+    const bool swapRB = param.swapRB && cn > 2;
+    Scalar mean = param.mean, scale = param.scalefactor;
+    if (swapRB)
+    {
+        std::swap(mean[0], mean[2]);
+        std::swap(scale[0], scale[2]);
+    }
+    src.convertTo(src, CV_32F);
+    cv::subtract(src, mean, src);
+    cv::multiply(src, scale, src);
+
+    std::vector<Mat> ch;
+    split(src, ch);
+    if (swapRB)
+        std::swap(ch[0], ch[2]);
+    Mat blob;
+    if (param.datalayout == DNN_LAYOUT_NHWC)
+    {
+        merge(ch, blob);
+        int sz[] = {1, size.height, size.width, cn};
+        return blob.reshape(1, 4, sz);
+    }
+    vconcat(ch, blob);
+    int sz[] = {1, cn, size.height, size.width};
+    return blob.reshape(1, 4, sz);
+}
+
+TEST(blobFromImagesWithParams, fused_8u)
+{
+    const ImagePaddingMode modes[] = {DNN_PMODE_NULL, DNN_PMODE_CROP_CENTER, DNN_PMODE_LETTERBOX};
+    const int channels[] = {1, 3, 4};
+    const DataLayout layouts[] = {DNN_LAYOUT_NCHW, DNN_LAYOUT_NHWC};
+    for (int ci = 0; ci < 3; ci++)
+    for (int mi = 0; mi < 3; mi++)
+    for (int li = 0; li < 2; li++)
+    for (int swapRB = 0; swapRB < 2; swapRB++)
+    {
+        const int cn = channels[ci];
+        SCOPED_TRACE(cv::format("cn=%d mode=%d layout=%d swapRB=%d", cn, (int)modes[mi], (int)layouts[li], swapRB));
+        Mat img0(37, 53, CV_8UC(cn)), img1(45, 30, CV_8UC(cn));
+        randu(img0, 0, 256);
+        randu(img1, 0, 256);
+
+        Image2BlobParams param(Scalar(1 / 58.4, 1 / 57.1, 1 / 57.4, 0.5), Size(41, 29), Scalar(123.7, 116.3, 103.5, 10),
+                               swapRB != 0, CV_32F, layouts[li], modes[mi], Scalar(114, 115, 116, 117));
+        Mat blob = blobFromImagesWithParams(std::vector<Mat>{img0, img1}, param);
+        ASSERT_EQ(4, blob.dims);
+        ASSERT_EQ(2, blob.size[0]);
+        Mat ref0 = blobFromImageReference(img0, param), ref1 = blobFromImageReference(img1, param);
+        Mat blob0 = Mat(ref0.dims, ref0.size.p, CV_32F, blob.ptr<float>(0));
+        Mat blob1 = Mat(ref1.dims, ref1.size.p, CV_32F, blob.ptr<float>(1));
+        EXPECT_LE(cvtest::norm(ref0, blob0, NORM_INF), 1e-5);
+        EXPECT_LE(cvtest::norm(ref1, blob1, NORM_INF), 1e-5);
+
+        param.ddepth = CV_16F;
+        Mat blob16 = blobFromImagesWithParams(std::vector<Mat>{img0, img1}, param);
+        ASSERT_EQ(CV_16F, blob16.depth());
+        Mat ref16, blob16to32;
+        blob.convertTo(ref16, CV_16F);
+        ref16.convertTo(ref16, CV_32F);
+        blob16.convertTo(blob16to32, CV_32F);
+        EXPECT_EQ(0, cvtest::norm(ref16, blob16to32, NORM_INF));
+    }
+}
+
 TEST(readNet, Regression)
 {
     Net net = readNet(findDataFile("dnn/squeezenet_v1.1.prototxt"),
@@ -615,6 +707,600 @@ TEST(Net, forwardAndRetrieve)
     normAssert(outBlobs[0][1], inp.rowRange(2, 4), "second part");
 }
 
+TEST(Net, memory_planner)
+{
+    std::string prototxt =
+        "input: \"data\"\n"
+        "layer { name: \"a\" type: \"Eltwise\" bottom: \"data\" bottom: \"data\" top: \"a\" }\n"
+        "layer { name: \"b\" type: \"Eltwise\" bottom: \"a\" bottom: \"a\" top: \"b\" }\n"
+        "layer { name: \"c\" type: \"Eltwise\" bottom: \"b\" bottom: \"a\" top: \"c\" }\n"
+        "layer { name: \"d\" type: \"Eltwise\" bottom: \"c\" bottom: \"c\" top: \"d\" }\n"
+        "layer { name: \"e\" type: \"Eltwise\" bottom: \"d\" bottom: \"d\" top: \"e\" }\n";
+    Net net = readNetFromCaffe(&prototxt[0], prototxt.size());
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    int inpSize[] = {1, 4, 16, 16};
+    Mat inp(4, &inpSize[0], CV_32F);
+    randu(inp, -1, 1);
+
+    // Intermediate blobs share memory but requested outputs are kept.
+    for (int i = 0; i < 2; i++)
+    {
+        net.setInput(inp);
+        std::vector<Mat> outs;
+        net.forward(outs, std::vector<String>{"b", "e"});
+        ASSERT_EQ(outs.size(), (size_t)2);
+        normAssert(outs[0], inp * 4, "b");
+        normAssert(outs[1], inp * 24, "e");
+        EXPECT_NE(outs[0].data, outs[1].data);
+    }
+
+    // Output of the last forward pass stays valid after network reallocation.
+    net.setInput(inp);
+    Mat out = net.forward("e");
+    net.setInput(inp * 2);
+    Mat out2 = net.forward("d");
+    normAssert(out, inp * 24, "e");
+    normAssert(out2, inp * 24, "d");
+
+    // The peak memory is less than sum of all intermediate blobs
+    MatShape inpShape(inpSize, inpSize + 4);
+    size_t weights = 0, blobs = 0;
+    net.getMemoryConsumption(inpShape, weights, blobs);
+    std::vector<int> layerIds;
+    std::vector<size_t> layerWeights, layerBlobs;
+    net.getMemoryConsumption(inpShape, layerIds, layerWeights, layerBlobs);
+    size_t totalBlobs = 0;
+    for (size_t i = 0; i < layerBlobs.size(); i++)
+        totalBlobs += layerBlobs[i];
+    EXPECT_EQ(totalBlobs, inp.total() * inp.elemSize() * 6);
+    EXPECT_LT(blobs, totalBlobs);
+}
+
+TEST(Net, batching_scheduler)
+{
+    std::string prototxt =
+        "input: \"data\"\n"
+        "layer { name: \"a\" type: \"Eltwise\" bottom: \"data\" bottom: \"data\" top: \"a\" }\n"
+        "layer { name: \"b\" type: \"ReLU\" bottom: \"a\" top: \"b\" }\n";
+    Net net = readNetFromCaffe(&prototxt[0], prototxt.size());
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    // Requests with different batch sizes and spatial sizes.
+    const int batches[] = {1, 2, 1, 3, 1, 2};
+    const int sizes[] = {8, 8, 8, 8, 5, 8};
+    std::vector<Mat> inputs;
+    std::vector<AsyncArray> results;
+    {
+        BatchingScheduler scheduler(net, 4, 50.0);
+        for (int i = 0; i < 6; i++)
+        {
+            int inpSize[] = {batches[i], 3, sizes[i], sizes[i]};
+            Mat inp(4, &inpSize[0], CV_32F);
+            randu(inp, -1, 1);
+            inputs.push_back(inp);
+            results.push_back(scheduler.forwardAsync(inp));
+        }
+        Mat out;
+        ASSERT_TRUE(results[0].get(out, std::chrono::seconds(10)));
+        Mat ref;
+        max(inputs[0] * 2, 0, ref);
+        normAssert(ref, out);
+        results[0].release();
+    }
+
+    // Destructor of the scheduler processes all the pending requests.
+    for (size_t i = 1; i < results.size(); i++)
+    {
+        ASSERT_TRUE(results[i].valid());
+        Mat out, ref;
+        ASSERT_TRUE(results[i].get(out, std::chrono::seconds(0)));
+        max(inputs[i] * 2, 0, ref);
+        normAssert(ref, out, cv::format("request %d", (int)i).c_str());
+    }
+}
+
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+TEST(Net, batching_scheduler_concurrent)
+{
+    std::string prototxt =
+        "input: \"data\"\n"
+        "layer { name: \"a\" type: \"Eltwise\" bottom: \"data\" bottom: \"data\" top: \"a\" }\n"
+        "layer { name: \"b\" type: \"ReLU\" bottom: \"a\" top: \"b\" }\n";
+    Net net = readNetFromCaffe(&prototxt[0], prototxt.size());
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    const int numThreads = 4, numRequests = 16;
+    std::vector<std::vector<Mat> > inputs(numThreads), outputs(numThreads);
+    std::vector<std::vector<bool> > received(numThreads);
+    {
+        BatchingScheduler scheduler(net, 8, 5.0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++)
+        {
+            threads.push_back(std::thread([&, t]() {
+                RNG rng(t);
+                for (int i = 0; i < numRequests; i++)
+                {
+                    int inpSize[] = {1 + (i + t) % 3, 3, 4, 4};
+                    Mat inp(4, &inpSize[0], CV_32F);
+                    rng.fill(inp, RNG::UNIFORM, -1, 1);
+                    inputs[t].push_back(inp);
+
+                    AsyncArray result = scheduler.forwardAsync(inp);
+                    Mat out;
+                    // Every 4th result is abandoned, the scheduler must skip it
+                    received[t].push_back(i % 4 != 3 && result.get(out, std::chrono::seconds(10)));
+                    outputs[t].push_back(out);
+                }
+            }));
+        }
+        for (size_t t = 0; t < threads.size(); t++)
+            threads[t].join();
+    }
+
+    for (int t = 0; t < numThreads; t++)
+    {
+        ASSERT_EQ((size_t)numRequests, outputs[t].size());
+        for (int i = 0; i < numRequests; i++)
+        {
+            if (i % 4 == 3)
+                continue;
+            ASSERT_TRUE(received[t][i]) << cv::format("thread %d, request %d", t, i);
+            Mat ref;
+            max(inputs[t][i] * 2, 0, ref);
+            normAssert(ref, outputs[t][i], cv::format("thread %d, request %d", t, i).c_str());
+        }
+    }
+}
+#endif
+
+TEST(Net, clone_shared_weights)
+{
+    int weightsSize[] = {8, 3, 3, 3};
+    Mat weights(4, &weightsSize[0], CV_32F), bias(1, 8, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    LayerParams lp;
+    lp.set("kernel_size", 3);
+    lp.set("pad", 1);
+    lp.set("num_output", 8);
+    lp.set("bias_term", true);
+    lp.type = "Convolution";
+    lp.name = "conv";
+    lp.blobs.push_back(weights);
+    lp.blobs.push_back(bias);
+
+    LayerParams relu;
+    relu.type = "ReLU";
+    relu.name = "relu";
+
+    Net net;
+    net.addLayerToPrev(lp.name, lp.type, lp);
+    net.addLayerToPrev(relu.name, relu.type, relu);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    const int numNets = 3;
+    std::vector<Mat> inputs(numNets), refs(numNets);
+    for (int i = 0; i < numNets; i++)
+    {
+        int inpSize[] = {1, 3, 16, 16};
+        inputs[i].create(4, &inpSize[0], CV_32F);
+        randu(inputs[i], -1.0f, 1.0f);
+        net.setInput(inputs[i]);
+        refs[i] = net.forward().clone();
+    }
+
+    std::vector<Net> nets(1, net);
+    for (int i = 1; i < numNets; i++)
+    {
+        nets.push_back(net.clone());
+        ASSERT_EQ(nets[i].getLayerNames(), net.getLayerNames());
+        EXPECT_EQ(nets[i].getParam("conv", 0).data, weights.data);
+    }
+
+    std::vector<Mat> outs(numNets);
+#ifndef OPENCV_DISABLE_THREAD_SUPPORT
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numNets; i++)
+    {
+        threads.push_back(std::thread([&, i]() {
+            nets[i].setInput(inputs[i]);
+            outs[i] = nets[i].forward();
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+#else
+    for (int i = 0; i < numNets; i++)
+    {
+        nets[i].setInput(inputs[i]);
+        outs[i] = nets[i].forward();
+    }
+#endif
+    for (int i = 0; i < numNets; i++)
+    {
+        normAssert(refs[i], outs[i], cv::format("net %d", i).c_str());
+        if (i > 0)
+        {
+            EXPECT_NE(outs[i].data, outs[0].data);
+        }
+    }
+}
+
+TEST(Net, save_compiled)
+{
+    int weightsSize[] = {8, 3, 3, 3};
+    Mat weights(4, &weightsSize[0], CV_32F), bias(1, 8, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    LayerParams conv;
+    conv.set("kernel_size", 3);
+    conv.set("pad", 1);
+    conv.set("num_output", 8);
+    conv.set("bias_term", true);
+    conv.type = "Convolution";
+    conv.name = "conv";
+    conv.blobs.push_back(weights);
+    conv.blobs.push_back(bias);
+
+    // Fused into the convolution
+    LayerParams bn;
+    bn.set("eps", 1e-3);
+    bn.type = "BatchNorm";
+    bn.name = "bn";
+    bn.blobs.push_back(Mat(1, 8, CV_32F));
+    bn.blobs.push_back(Mat(1, 8, CV_32F));
+    bn.blobs.push_back(Mat(1, 1, CV_32F, Scalar(1)));
+    randu(bn.blobs[0], -1.0f, 1.0f);
+    randu(bn.blobs[1], 0.5f, 1.0f);
+
+    LayerParams relu;
+    relu.type = "ReLU";
+    relu.name = "relu";
+
+    LayerParams flatten;
+    flatten.type = "Flatten";
+    flatten.name = "flatten";
+
+    LayerParams gemm;
+    gemm.set("transB", true);
+    gemm.set("constB", true);
+    gemm.type = "Gemm";
+    gemm.name = "gemm";
+    gemm.blobs.push_back(Mat(10, 8 * 16 * 16, CV_32F));
+    randu(gemm.blobs[0], -0.1f, 0.1f);
+
+    Net net;
+    net.addLayerToPrev(conv.name, conv.type, conv);
+    net.addLayerToPrev(bn.name, bn.type, bn);
+    net.addLayerToPrev(relu.name, relu.type, relu);
+    net.addLayerToPrev(flatten.name, flatten.type, flatten);
+    net.addLayerToPrev(gemm.name, gemm.type, gemm);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    int inpSize[] = {1, 3, 16, 16};
+    Mat input(4, &inpSize[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+    net.setInput(input);
+    Mat ref = net.forward().clone();
+
+    const std::string path = cv::tempfile(".cvdnn");
+    net.save(path);
+
+    Net compiled = readNetFromCompiled(path);
+    ASSERT_EQ(compiled.getLayerNames(), net.getLayerNames());
+    compiled.setPreferableBackend(DNN_BACKEND_OPENCV);
+    compiled.setPreferableTarget(DNN_TARGET_CPU);
+    compiled.setInput(input);
+    Mat out = compiled.forward();
+    EXPECT_EQ(0, cvtest::norm(ref, out, NORM_INF));
+
+    // Copies of the network refer to the same mapped weights and use the preloaded packed weights,
+    // so weights changed in place (without Net::setParam()) are not packed again.
+    Net loaded = readNet(path);
+    loaded.getParam("conv").setTo(0);
+    loaded.getParam("gemm").setTo(0);
+    Net copy = loaded.clone();
+    EXPECT_EQ(copy.getParam("conv").data, loaded.getParam("conv").data);
+    EXPECT_EQ(copy.getParam("gemm").data, loaded.getParam("gemm").data);
+    copy.setInput(input);
+    out = copy.forward();
+    EXPECT_EQ(0, cvtest::norm(ref, out, NORM_INF));
+
+    // Weights replaced before the first run are packed again
+    Mat gemmWeights(10, 8 * 16 * 16, CV_32F);
+    randu(gemmWeights, -0.1f, 0.1f);
+    ref = net.forward("flatten") * gemmWeights.t();
+    compiled = readNetFromCompiled(path);
+    compiled.setParam("gemm", 0, gemmWeights);
+    compiled.setInput(input);
+    out = compiled.forward();
+    EXPECT_LE(cvtest::norm(ref, out, NORM_INF), 1e-4);
+
+    compiled = Net();
+    loaded = Net();
+    copy = Net();
+    remove(path.c_str());
+}
+
+TEST(Net, cpu_fp16_weights)
+{
+    std::vector<Target> targets = getAvailableTargets(DNN_BACKEND_OPENCV);
+    if (std::find(targets.begin(), targets.end(), DNN_TARGET_CPU_FP16) == targets.end())
+        throw SkipTestException("DNN_TARGET_CPU_FP16 is not supported");
+
+    int weightsSize[] = {32, 16, 3, 3};
+    Mat weights(4, &weightsSize[0], CV_32F), bias(1, 32, CV_32F);
+    randu(weights, -0.1f, 0.1f);
+    randu(bias, -0.1f, 0.1f);
+
+    LayerParams conv;
+    conv.set("kernel_size", 3);
+    conv.set("pad", 1);
+    conv.set("num_output", 32);
+    conv.set("bias_term", true);
+    conv.type = "Convolution";
+    conv.name = "conv";
+    conv.blobs.push_back(weights);
+    conv.blobs.push_back(bias);
+
+    LayerParams flatten;
+    flatten.type = "Flatten";
+    flatten.name = "flatten";
+
+    LayerParams gemm;
+    gemm.set("transB", true);
+    gemm.set("constB", true);
+    gemm.type = "Gemm";
+    gemm.name = "gemm";
+    gemm.blobs.push_back(Mat(37, 32 * 12 * 12, CV_32F));
+    randu(gemm.blobs[0], -0.01f, 0.01f);
+
+    Net net;
+    net.addLayerToPrev(conv.name, conv.type, conv);
+    net.addLayerToPrev(flatten.name, flatten.type, flatten);
+    net.addLayerToPrev(gemm.name, gemm.type, gemm);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+
+    int inpSize[] = {2, 16, 12, 12};
+    Mat input(4, &inpSize[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+
+    net.setPreferableTarget(DNN_TARGET_CPU);
+    net.setInput(input);
+    Mat ref = net.forward().clone();
+
+    net.setPreferableTarget(DNN_TARGET_CPU_FP16);
+    net.setInput(input);
+    Mat out = net.forward();
+    normAssert(ref, out, "", 4e-3, 2e-2);
+}
+
+TEST(Net, profiling)
+{
+    int weightsSize[] = {8, 3, 3, 3};
+    Mat weights(4, &weightsSize[0], CV_32F);
+    randu(weights, -1.0f, 1.0f);
+
+    LayerParams conv;
+    conv.set("kernel_size", 3);
+    conv.set("num_output", 8);
+    conv.set("bias_term", false);
+    conv.type = "Convolution";
+    conv.name = "conv";
+    conv.blobs.push_back(weights);
+
+    LayerParams pool;
+    pool.set("pool", "max");
+    pool.set("kernel_size", 2);
+    pool.set("stride", 2);
+    pool.type = "Pooling";
+    pool.name = "pool";
+
+    Net net;
+    net.addLayerToPrev(conv.name, conv.type, conv);
+    net.addLayerToPrev(pool.name, pool.type, pool);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    int inpSize[] = {1, 3, 10, 10};
+    Mat input(4, &inpSize[0], CV_32F);
+    randu(input, -1.0f, 1.0f);
+    net.setInput(input);
+
+    EXPECT_THROW(net.dumpProfile(), cv::Exception);
+    net.forward();
+
+    const int runs = 3;
+    net.enableProfiling(true);
+    for (int i = 0; i < runs; i++)
+        net.forward();
+    net.enableProfiling(false);
+    net.forward();  // not recorded
+
+    std::string summary = net.dumpProfile();
+    EXPECT_NE(summary.find("Runs: 3"), std::string::npos) << summary;
+    EXPECT_NE(summary.find("FastConv/generic"), std::string::npos) << summary;
+    EXPECT_NE(summary.find("pool"), std::string::npos) << summary;
+
+    const std::string path = cv::tempfile(".json");
+    net.dumpProfileToFile(path);
+    FileStorage fs(path, FileStorage::READ);
+    ASSERT_TRUE(fs.isOpened());
+    FileNode events = fs["traceEvents"];
+    ASSERT_TRUE(events.isSeq());
+    int convEvents = 0, memoryEvents = 0;
+    for (FileNodeIterator it = events.begin(); it != events.end(); ++it)
+    {
+        FileNode event = *it;
+        if ((std::string)event["ph"] == "C")
+        {
+            EXPECT_GT((double)event["args"]["bytes"], 0.0);
+            memoryEvents++;
+        }
+        else if ((std::string)event["name"] == "conv")
+        {
+            EXPECT_EQ((std::string)event["ph"], "X");
+            EXPECT_GE((double)event["dur"], 0.0);
+            EXPECT_EQ((double)event["args"]["flops"], (double)net.getFLOPS(net.getLayerId("conv"), MatShape(inpSize, inpSize + 4)));
+            convEvents++;
+        }
+    }
+    EXPECT_EQ(memoryEvents, runs);
+    EXPECT_EQ(convEvents, runs);
+    fs.release();
+    remove(path.c_str());
+}
+
+TEST(Net, dynamic_input_shapes)
+{
+    Mat weights(6, 16, CV_32F), bias(1, 6, CV_32F);
+    randu(weights, -1.0f, 1.0f);
+    randu(bias, -1.0f, 1.0f);
+
+    LayerParams gemmParams;
+    gemmParams.set("transB", true);
+    gemmParams.set("constB", true);
+    gemmParams.set("constC", true);
+    gemmParams.set("have_bias", true);
+    gemmParams.set("real_ndims_C", 1);
+    gemmParams.type = "Gemm";
+    gemmParams.name = "gemm";
+    gemmParams.blobs.push_back(weights);
+    gemmParams.blobs.push_back(bias.reshape(1, 6));
+
+    LayerParams relu;
+    relu.type = "ReLU";
+    relu.name = "relu";
+
+    Net net;
+    net.addLayerToPrev(gemmParams.name, gemmParams.type, gemmParams);
+    net.addLayerToPrev(relu.name, relu.type, relu);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+
+    // Allocation plans of the both shapes are reused after the first two runs
+    const int batches[] = {2, 5, 2, 5, 1, 2};
+    for (int i = 0; i < 6; i++)
+    {
+        Mat input(batches[i], 16, CV_32F);
+        randu(input, -1.0f, 1.0f);
+        Mat ref;
+        gemm(input, weights, 1.0, repeat(bias, batches[i], 1), 1.0, ref, GEMM_2_T);
+        ref = max(ref, 0.0f);
+
+        net.setInput(input);
+        Mat out = net.forward();
+        normAssert(ref, out, format("batch=%d", batches[i]).c_str());
+    }
+}
+
+TEST(Net, inter_op_parallel)
+{
+    // Inception-like block: three branches are concatenated
+    std::vector<Mat> weights(4);
+    for (int i = 0; i < 4; i++)
+    {
+        int kernel = i == 1 ? 3 : 1;
+        int weightsSize[] = {4, 8, kernel, kernel};
+        weights[i].create(4, &weightsSize[0], CV_32F);
+        randu(weights[i], -1.0f, 1.0f);
+    }
+    auto makeNet = [&](int numInterOpThreads)
+    {
+        Net net;
+        std::vector<int> branches;
+        for (int i = 0; i < 4; i++)
+        {
+            LayerParams conv;
+            conv.set("kernel_size", weights[i].size[2]);
+            conv.set("pad", weights[i].size[2] / 2);
+            conv.set("num_output", 4);
+            conv.set("bias_term", false);
+            conv.type = "Convolution";
+            conv.name = format("conv%d", i);
+            conv.blobs.push_back(weights[i]);
+            int inputId = 0;
+            if (i == 2)
+            {
+                LayerParams pool;
+                pool.set("pool", "max");
+                pool.set("kernel_size", 3);
+                pool.set("pad", 1);
+                pool.type = "Pooling";
+                pool.name = "pool";
+                inputId = net.addLayer(pool.name, pool.type, pool);
+                net.connect(0, 0, inputId, 0);
+            }
+            int convId = net.addLayer(conv.name, conv.type, conv);
+            net.connect(inputId, 0, convId, 0);
+            if (i == 0)
+            {
+                LayerParams relu;
+                relu.type = "ReLU";
+                relu.name = "relu";
+                int reluId = net.addLayer(relu.name, relu.type, relu);
+                net.connect(convId, 0, reluId, 0);
+                convId = reluId;
+            }
+            branches.push_back(convId);
+        }
+        LayerParams concat;
+        concat.set("axis", 1);
+        concat.type = "Concat";
+        concat.name = "concat";
+        int concatId = net.addLayer(concat.name, concat.type, concat);
+        for (int i = 0; i < 3; i++)
+            net.connect(branches[i], 0, concatId, i);
+
+        LayerParams sum;
+        sum.type = "Eltwise";
+        sum.name = "sum";
+        int sumId = net.addLayer(sum.name, sum.type, sum);
+        net.connect(branches[2], 0, sumId, 0);
+        net.connect(branches[3], 0, sumId, 1);
+
+        net.setPreferableBackend(DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(DNN_TARGET_CPU);
+        net.setNumInterOpThreads(numInterOpThreads);
+        EXPECT_EQ(numInterOpThreads, net.getNumInterOpThreads());
+        return net;
+    };
+    Net ref = makeNet(1), net = makeNet(4);
+    EXPECT_EQ(4, net.clone().getNumInterOpThreads());
+
+    std::vector<String> outNames;
+    outNames.push_back("concat");
+    outNames.push_back("sum");
+    const int sizes[] = {12, 7, 12};
+    for (int i = 0; i < 3; i++)
+    {
+        int inpSize[] = {1, 8, sizes[i], sizes[i]};
+        Mat input(4, &inpSize[0], CV_32F);
+        randu(input, -1.0f, 1.0f);
+        ref.setInput(input);
+        net.setInput(input);
+
+        std::vector<Mat> refOuts, outs;
+        ref.forward(refOuts, outNames);
+        net.forward(outs, outNames);
+        ASSERT_EQ(refOuts.size(), outs.size());
+        for (size_t j = 0; j < outs.size(); j++)
+            normAssert(refOuts[j], outs[j], outNames[j].c_str(), 0, 0);
+
+        // Only the required part of the graph
+        normAssert(ref.forward("conv1"), net.forward("conv1"), "conv1", 0, 0);
+    }
+}
+
 #ifdef HAVE_INF_ENGINE
 static const std::chrono::milliseconds async_timeout(10000);
 
@@ -67,6 +67,88 @@ TEST(BatchedNMS, Accuracy)
         ASSERT_EQ(indices[i], ref_indices[i]);
 }
 
+// Straightforward NMS: boxes are compared with all the kept boxes of the same class
+template<typename Rect_t>
+static void referenceNMS(const std::vector<Rect_t>& bboxes, const std::vector<float>& scores,
+                         const std::vector<int>& class_ids, float score_thresh, float nms_thresh,
+                         float eta, int top_k, std::vector<int>& indices)
+{
+    std::vector<std::pair<float, int> > order;
+    for (size_t i = 0; i < scores.size(); i++)
+        if (scores[i] > score_thresh)
+            order.push_back(std::make_pair(scores[i], (int)i));
+    std::stable_sort(order.begin(), order.end(),
+                     [](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+    if (top_k > 0 && top_k < (int)order.size())
+        order.resize(top_k);
+
+    indices.clear();
+    float threshold = nms_thresh;
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const int idx = order[i].second;
+        bool keep = true;
+        for (size_t k = 0; k < indices.size() && keep; k++)
+        {
+            if (class_ids[indices[k]] == class_ids[idx])
+                keep = 1.f - (float)jaccardDistance(bboxes[idx], bboxes[indices[k]]) <= threshold;
+        }
+        if (keep)
+        {
+            indices.push_back(idx);
+            if (eta < 1 && threshold > 0.5)
+                threshold *= eta;
+        }
+    }
+}
+
+typedef testing::TestWithParam<tuple<int, float, int> > NMS_random;
+TEST_P(NMS_random, Accuracy)
+{
+    const int numClasses = get<0>(GetParam());
+    const float eta = get<1>(GetParam());
+    const int top_k = get<2>(GetParam());
+    RNG& rng = theRNG();
+    const int n = 3000;
+    std::vector<Rect> bboxes(n);
+    std::vector<Rect2d> bboxes2d(n);
+    std::vector<float> scores(n);
+    std::vector<int> class_ids(n);
+    for (int i = 0; i < n; i++)
+    {
+        // a few degenerate boxes are included
+        bboxes[i] = Rect(rng.uniform(0, 600), rng.uniform(0, 400), rng.uniform(0, 80), rng.uniform(0, 80));
+        bboxes2d[i] = Rect2d(rng.uniform(0., 1.), rng.uniform(0., 1.), rng.uniform(0., 0.1), rng.uniform(0., 0.1));
+        scores[i] = (float)rng.uniform(0, 50) / 50;  // equal scores are ordered by index
+        class_ids[i] = rng.uniform(0, numClasses);
+    }
+    const float score_thresh = 0.1f, nms_thresh = 0.4f;
+
+    std::vector<int> indices, ref;
+    std::vector<int> sameClass(n, 0);
+    NMSBoxes(bboxes, scores, score_thresh, nms_thresh, indices, eta, top_k);
+    referenceNMS(bboxes, scores, sameClass, score_thresh, nms_thresh, eta, top_k, ref);
+    EXPECT_EQ(ref, indices);
+
+    NMSBoxes(bboxes2d, scores, score_thresh, nms_thresh, indices, eta, top_k);
+    referenceNMS(bboxes2d, scores, sameClass, score_thresh, nms_thresh, eta, top_k, ref);
+    EXPECT_EQ(ref, indices);
+
+    NMSBoxesBatched(bboxes, scores, class_ids, score_thresh, nms_thresh, indices, eta, top_k);
+    referenceNMS(bboxes, scores, class_ids, score_thresh, nms_thresh, eta, top_k, ref);
+    EXPECT_EQ(ref, indices);
+
+    NMSBoxesBatched(bboxes2d, scores, class_ids, score_thresh, nms_thresh, indices, eta, top_k);
+    referenceNMS(bboxes2d, scores, class_ids, score_thresh, nms_thresh, eta, top_k, ref);
+    EXPECT_EQ(ref, indices);
+}
+
+INSTANTIATE_TEST_CASE_P(/**/, NMS_random, Combine(
+    Values(1, 5, 80),
+    Values(1.f, 0.9f),
+    Values(0, 200)
+));
+
 TEST(SoftNMS, Accuracy)
 {
     //reference results are obtained using TF v2.7 tf.image.non_max_suppression_with_scores
@@ -3200,4 +3200,208 @@ TEST_P(Test_ONNX_layers, ClipDivSharedConstant) {
 
 INSTANTIATE_TEST_CASE_P(/**/, Test_ONNX_nets, dnnBackendsAndTargets());
 
+// Minimal protobuf encoder to create models with external data without test files
+static void pbRawVarint(std::string& buf, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        buf += (char)((v & 0x7f) | 0x80);
+    buf += (char)v;
+}
+
+static void pbVarint(std::string& buf, int field, uint64_t value)
+{
+    pbRawVarint(buf, (uint64_t)field << 3);
+    pbRawVarint(buf, value);
+}
+
+static void pbBytes(std::string& buf, int field, const std::string& value)
+{
+    pbRawVarint(buf, ((uint64_t)field << 3) | 2);
+    pbRawVarint(buf, value.size());
+    buf += value;
+}
+
+static std::string pbValueInfo(const std::string& name, const std::vector<int>& dims)
+{
+    std::string shape, tensorType, type, info;
+    for (int d : dims)
+    {
+        std::string dim;
+        pbVarint(dim, 1, d);       // TensorShapeProto.Dimension.dim_value
+        pbBytes(shape, 1, dim);    // TensorShapeProto.dim
+    }
+    pbVarint(tensorType, 1, 1);    // TypeProto.Tensor.elem_type = FLOAT
+    pbBytes(tensorType, 2, shape); // TypeProto.Tensor.shape
+    pbBytes(type, 1, tensorType);  // TypeProto.tensor_type
+    pbBytes(info, 1, name);        // ValueInfoProto.name
+    pbBytes(info, 2, type);        // ValueInfoProto.type
+    return info;
+}
+
+static std::string pbTensor(const std::string& name, int dataType, const std::vector<int>& dims)
+{
+    std::string tensor;
+    for (int d : dims)
+        pbVarint(tensor, 1, d);    // dims
+    pbVarint(tensor, 2, dataType); // data_type
+    pbBytes(tensor, 8, name);      // name
+    return tensor;
+}
+
+static void pbExternalData(std::string& tensor, const std::string& location, size_t offset, size_t length)
+{
+    const char* keys[] = {"location", "offset", "length"};
+    std::string values[] = {location, std::to_string(offset), std::to_string(length)};
+    for (int i = 0; i < 3; i++)
+    {
+        std::string entry;
+        pbBytes(entry, 1, keys[i]);
+        pbBytes(entry, 2, values[i]);
+        pbBytes(tensor, 13, entry);  // external_data
+    }
+    pbVarint(tensor, 14, 1);         // data_location = EXTERNAL
+}
+
+static std::string pbNode(const std::string& type, const std::string& inp0, const std::string& inp1, const std::string& out)
+{
+    std::string node;
+    pbBytes(node, 1, inp0);
+    pbBytes(node, 1, inp1);
+    pbBytes(node, 2, out);
+    pbBytes(node, 3, out);   // name
+    pbBytes(node, 4, type);  // op_type
+    return node;
+}
+
+static std::string pbModel(const std::vector<std::string>& nodes, const std::vector<std::string>& initializers,
+                           const std::vector<int>& inpShape, const std::vector<int>& outShape)
+{
+    std::string graph, opset, model;
+    for (const std::string& node : nodes)
+        pbBytes(graph, 1, node);
+    pbBytes(graph, 2, "graph");
+    for (const std::string& tensor : initializers)
+        pbBytes(graph, 5, tensor);
+    pbBytes(graph, 11, pbValueInfo("x", inpShape));
+    pbBytes(graph, 12, pbValueInfo("y", outShape));
+
+    pbVarint(opset, 2, 13);
+    pbVarint(model, 1, 7);      // ir_version
+    pbBytes(model, 7, graph);
+    pbBytes(model, 8, opset);
+    return model;
+}
+
+static void writeFile(const std::string& path, const std::string& content)
+{
+    std::ofstream ofs(path.c_str(), std::ios::binary);
+    ofs.write(content.data(), content.size());
+}
+
+TEST(Test_ONNX_importer, external_data)
+{
+    const int size = 6;
+    Mat input(1, size, CV_32F), weights(1, size, CV_32F), weightsFP16(1, size, CV_32F), scales(1, size, CV_32F);
+    randu(input, -1.0f, 1.0f);
+    randu(weights, -1.0f, 1.0f);
+    randu(weightsFP16, -1.0f, 1.0f);
+    randu(scales, -1.0f, 1.0f);
+    Mat halfs;
+    weightsFP16.convertTo(halfs, CV_16F);
+    halfs.convertTo(weightsFP16, CV_32F);
+    int64_t newShape[] = {2, 3};
+
+    const std::string modelPath = cv::tempfile(".onnx");
+    const std::string dataPath = cv::tempfile(".bin");
+    const std::string dataName = dataPath.substr(dataPath.find_last_of("/\\") + 1);
+
+    // Offsets are not multiples of element sizes
+    std::string data(13, '\0');
+    std::string w = pbTensor("w", 1, {1, size});  // FLOAT
+    pbExternalData(w, dataName, data.size(), size * sizeof(float));
+    data.append((const char*)weights.data, size * sizeof(float));
+    std::string h = pbTensor("h", 10, {1, size});  // FLOAT16
+    pbExternalData(h, dataName, data.size(), size * sizeof(hfloat));
+    data.append((const char*)halfs.data, size * sizeof(hfloat));
+    std::string s = pbTensor("s", 7, {2});  // INT64
+    pbExternalData(s, dataName, data.size(), sizeof(newShape));
+    data.append((const char*)newShape, sizeof(newShape));
+    writeFile(dataPath, data);
+
+    // Embedded initializer
+    std::string m = pbTensor("m", 1, {1, size});
+    pbBytes(m, 9, std::string((const char*)scales.data, size * sizeof(float)));  // raw_data
+
+    std::string model = pbModel({pbNode("Add", "x", "w", "a"), pbNode("Add", "a", "h", "b"),
+                                 pbNode("Mul", "b", "m", "c"), pbNode("Reshape", "c", "s", "y")},
+                                {w, h, s, m}, {1, size}, {2, 3});
+    writeFile(modelPath, model);
+
+    Mat ref = (input + weights + weightsFP16).mul(scales);
+    ref = ref.reshape(1, 2);
+
+    Net net = readNetFromONNX(modelPath);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+    net.setInput(input);
+    Mat out = net.forward();
+    ASSERT_EQ(shape(out), shape(ref));
+    EXPECT_LE(cvtest::norm(ref, out, NORM_INF), 1e-6);
+
+    // Location of external data is relative to the model file
+    std::vector<uchar> buffer(model.begin(), model.end());
+    EXPECT_ANY_THROW(readNetFromONNX(buffer));
+
+    // Location must not point out of the model directory
+    std::string outside = pbTensor("w", 1, {1, size});
+    pbExternalData(outside, "../" + dataName, 13, size * sizeof(float));
+    writeFile(modelPath, pbModel({pbNode("Add", "x", "w", "y")}, {outside}, {1, size}, {1, size}));
+    EXPECT_ANY_THROW(readNetFromONNX(modelPath));
+
+    // Embedded initializers of in-memory models
+    model = pbModel({pbNode("Mul", "x", "m", "y")}, {m}, {1, size}, {1, size});
+    buffer.assign(model.begin(), model.end());
+    net = readNetFromONNX(buffer);
+    buffer.clear();
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+    net.setInput(input);
+    out = net.forward();
+    EXPECT_EQ(0, cvtest::norm(input.mul(scales), out.reshape(1, 1), NORM_INF));
+
+    net = Net();
+    remove(modelPath.c_str());
+    remove(dataPath.c_str());
+}
+
+TEST(Test_ONNX_importer, lazy_initializers)
+{
+    const int size = 6;
+    Mat input(1, size, CV_32F), scales(1, size, CV_32F), shifts(1, size, CV_32F);
+    randu(input, -1.0f, 1.0f);
+    randu(scales, -1.0f, 1.0f);
+    randu(shifts, -1.0f, 1.0f);
+
+    std::string m = pbTensor("m", 1, {1, size});
+    pbBytes(m, 9, std::string((const char*)scales.data, size * sizeof(float)));  // raw_data
+    std::string k = pbTensor("k", 1, {1, size});
+    pbBytes(k, 4, std::string((const char*)shifts.data, size * sizeof(float)));  // packed float_data
+    std::string unused = pbTensor("u", 1, {1, size});
+    pbBytes(unused, 9, std::string(size * sizeof(float), '\0'));
+
+    // 'm' is used by several nodes, including a constant one which is folded on import
+    std::string model = pbModel({pbNode("Mul", "x", "m", "a"), pbNode("Add", "a", "m", "b"),
+                                 pbNode("Add", "m", "k", "c"), pbNode("Mul", "b", "c", "y")},
+                                {unused, m, k}, {1, size}, {1, size});
+    std::vector<uchar> buffer(model.begin(), model.end());
+    Net net = readNetFromONNX(buffer);
+    net.setPreferableBackend(DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(DNN_TARGET_CPU);
+    net.setInput(input);
+    Mat out = net.forward();
+
+    Mat ref = (input.mul(scales) + scales).mul(scales + shifts);
+    EXPECT_LE(cvtest::norm(ref, out.reshape(1, 1), NORM_INF), 1e-6);
+}
+
 }} // namespace